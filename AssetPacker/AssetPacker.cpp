@@ -0,0 +1,83 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+// Packs the data folder into an archive that FileSystem mounts instead of searching the
+// folder. Usage: AssetPacker [archive] [datafolder]
+#include "AssetArchive.h"
+#include "FileSystem.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Leviathan;
+// ------------------------------------ //
+//! Prints to the console as the engine logger isn't running
+class ConsoleReporter : public LErrorReporter {
+public:
+    void Write(const std::string& text) override
+    {
+        std::cout << text;
+    }
+
+    void WriteLine(const std::string& text) override
+    {
+        std::cout << text << std::endl;
+    }
+
+    void Info(const std::string& text) override
+    {
+        std::cout << "[INFO] " << text << std::endl;
+    }
+
+    void Warning(const std::string& text) override
+    {
+        std::cout << "[WARNING] " << text << std::endl;
+    }
+
+    void Error(const std::string& text) override
+    {
+        std::cerr << "[ERROR] " << text << std::endl;
+    }
+
+    void Fatal(const std::string& text) override
+    {
+        std::cerr << "[FATAL] " << text << std::endl;
+        std::exit(2);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    const std::string archive = argc > 1 ? argv[1] : FileSystem::GetDataArchive();
+
+    // Same as what FileSystem::Init searches so that the paths in the archive match //
+#ifdef _WIN32
+    const std::string folder = argc > 2 ? argv[2] : "./Data/";
+#else
+    const std::string folder = argc > 2 ? argv[2] : "./Data";
+#endif
+
+    ConsoleReporter reporter;
+
+    std::vector<std::string> files;
+
+    if(!FileSystem::GetFilesInDirectory(files, folder) || files.empty()) {
+
+        reporter.Error("No files in folder: " + folder);
+        return 1;
+    }
+
+    // Keeps the archive the same if the files haven't changed //
+    std::sort(files.begin(), files.end());
+
+    AssetArchivePackStats stats;
+
+    if(!AssetArchive::Pack(archive, files, &reporter, &stats))
+        return 1;
+
+    reporter.Info("Packed " + std::to_string(stats.Files) + " files (" +
+                  std::to_string(stats.CompressedFiles) + " compressed) into " + archive +
+                  ", " + std::to_string(stats.OriginalBytes) + " bytes stored as " +
+                  std::to_string(stats.StoredBytes));
+    return 0;
+}
@@ -0,0 +1,372 @@
+// ------------------------------------ //
+#include "AssetArchive.h"
+
+#include "Exceptions.h"
+
+#include "lz4/lz4.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include "WindowsInclude.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif //_WIN32
+
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT AssetArchive::AssetArchive(const std::string& file) : File(file)
+{
+#ifdef _WIN32
+    FileHandle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if(FileHandle == INVALID_HANDLE_VALUE) {
+
+        FileHandle = nullptr;
+        throw InvalidArgument("AssetArchive: cannot open file: " + file);
+    }
+
+    LARGE_INTEGER filesize;
+
+    if(!GetFileSizeEx(FileHandle, &filesize) || filesize.QuadPart == 0) {
+
+        CloseHandle(FileHandle);
+        throw InvalidArgument("AssetArchive: file is empty: " + file);
+    }
+
+    Size = static_cast<size_t>(filesize.QuadPart);
+
+    MappingHandle = CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if(MappingHandle)
+        Data = static_cast<const char*>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+    if(!Data) {
+
+        if(MappingHandle)
+            CloseHandle(MappingHandle);
+        CloseHandle(FileHandle);
+        throw InvalidArgument("AssetArchive: cannot map file: " + file);
+    }
+#else
+    const int fd = open(file.c_str(), O_RDONLY);
+
+    if(fd < 0)
+        throw InvalidArgument("AssetArchive: cannot open file: " + file);
+
+    struct stat st;
+
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+
+        close(fd);
+        throw InvalidArgument("AssetArchive: file is empty: " + file);
+    }
+
+    Size = static_cast<size_t>(st.st_size);
+
+    void* mapping = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps the file open //
+    close(fd);
+
+    if(mapping == MAP_FAILED)
+        throw InvalidArgument("AssetArchive: cannot map file: " + file);
+
+    Data = static_cast<const char*>(mapping);
+#endif //_WIN32
+
+    try {
+        _ValidateTable();
+    } catch(const InvalidArgument&) {
+
+        _Unmap();
+        throw;
+    }
+}
+
+DLLEXPORT AssetArchive::~AssetArchive()
+{
+    _Unmap();
+}
+// ------------------------------------ //
+void AssetArchive::_Unmap()
+{
+    if(!Data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(Data);
+    CloseHandle(MappingHandle);
+    CloseHandle(FileHandle);
+#else
+    munmap(const_cast<char*>(Data), Size);
+#endif //_WIN32
+
+    Data = nullptr;
+}
+// ------------------------------------ //
+void AssetArchive::_ValidateTable()
+{
+    if(Size < sizeof(Header))
+        throw InvalidArgument("AssetArchive: file is too small: " + File);
+
+    Table = reinterpret_cast<const Header*>(Data);
+
+    if(Table->Magic != ASSET_ARCHIVE_MAGIC)
+        throw InvalidArgument("AssetArchive: file is not an archive: " + File);
+
+    if(Table->Version != ASSET_ARCHIVE_VERSION)
+        throw InvalidArgument("AssetArchive: unsupported archive version: " + File);
+
+    // The table is checked fully here so that lookups don't need to check anything //
+    const uint64_t entriessize = static_cast<uint64_t>(Table->EntryCount) * sizeof(Entry);
+    const uint64_t bucketssize = static_cast<uint64_t>(Table->BucketCount) * sizeof(uint32_t);
+
+    if(Table->BucketCount == 0 || (Table->BucketCount & (Table->BucketCount - 1)) != 0 ||
+        Table->BucketCount < Table->EntryCount ||
+        Table->EntriesOffset % alignof(Entry) != 0 ||
+        Table->BucketsOffset % alignof(uint32_t) != 0 || Table->EntriesOffset > Size ||
+        entriessize > Size - Table->EntriesOffset || Table->BucketsOffset > Size ||
+        bucketssize > Size - Table->BucketsOffset || Table->PathsOffset > Size)
+        throw InvalidArgument("AssetArchive: archive has an invalid table: " + File);
+
+    Entries = reinterpret_cast<const Entry*>(Data + Table->EntriesOffset);
+    Buckets = reinterpret_cast<const uint32_t*>(Data + Table->BucketsOffset);
+
+    const uint64_t pathssize = Size - Table->PathsOffset;
+
+    for(uint32_t i = 0; i < Table->EntryCount; ++i) {
+
+        const Entry& entry = Entries[i];
+
+        if(static_cast<uint64_t>(entry.PathOffset) + entry.PathLength > pathssize ||
+            entry.DataOffset > Size || entry.StoredSize > Size - entry.DataOffset ||
+            entry.StoredSize > entry.OriginalSize)
+            throw InvalidArgument("AssetArchive: archive has an invalid entry: " + File);
+    }
+
+    for(uint32_t i = 0; i < Table->BucketCount; ++i) {
+
+        if(Buckets[i] > Table->EntryCount)
+            throw InvalidArgument("AssetArchive: archive has an invalid bucket: " + File);
+    }
+}
+// ------------------------------------ //
+DLLEXPORT const AssetArchive::Entry* AssetArchive::Find(std::string_view path) const
+{
+    const uint64_t hash = HashPath(path);
+    const uint32_t mask = Table->BucketCount - 1;
+
+    // Linear probing, there is always at least one empty bucket //
+    for(uint32_t i = static_cast<uint32_t>(hash) & mask, probes = 0;
+        probes < Table->BucketCount; i = (i + 1) & mask, ++probes) {
+
+        const uint32_t index = Buckets[i];
+
+        if(index == 0)
+            return nullptr;
+
+        const Entry& entry = Entries[index - 1];
+
+        if(entry.PathHash == hash && GetPath(entry) == path)
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+DLLEXPORT bool AssetArchive::ReadEntry(const Entry& entry, std::string& result) const
+{
+    result.resize(entry.OriginalSize);
+
+    if(entry.OriginalSize == 0)
+        return true;
+
+    if(!IsCompressed(entry)) {
+
+        std::memcpy(&result[0], Data + entry.DataOffset, entry.StoredSize);
+        return true;
+    }
+
+    const int decompressed = LZ4_decompress_safe(Data + entry.DataOffset, &result[0],
+        static_cast<int>(entry.StoredSize), static_cast<int>(entry.OriginalSize));
+
+    if(decompressed < 0 || static_cast<uint32_t>(decompressed) != entry.OriginalSize) {
+
+        result.clear();
+        return false;
+    }
+
+    return true;
+}
+// ------------------------------------ //
+DLLEXPORT uint64_t AssetArchive::HashPath(std::string_view path)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for(const char character : path) {
+
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+DLLEXPORT bool AssetArchive::Pack(const std::string& archivefile,
+    const std::vector<std::string>& files, LErrorReporter* errorreport,
+    AssetArchivePackStats* stats /*= nullptr*/)
+{
+    if(files.size() >= std::numeric_limits<uint32_t>::max() / 2) {
+
+        errorreport->Error("AssetArchive: Pack: too many files");
+        return false;
+    }
+
+    Header header;
+    header.Magic = ASSET_ARCHIVE_MAGIC;
+    header.Version = ASSET_ARCHIVE_VERSION;
+    header.EntryCount = static_cast<uint32_t>(files.size());
+
+    // At most half full so that the probe sequences stay short //
+    header.BucketCount = 1;
+    while(header.BucketCount < files.size() * 2)
+        header.BucketCount *= 2;
+
+    header.EntriesOffset = sizeof(Header);
+    header.BucketsOffset = header.EntriesOffset + sizeof(Entry) * files.size();
+    header.PathsOffset = header.BucketsOffset + sizeof(uint32_t) * header.BucketCount;
+
+    std::vector<Entry> entries(files.size());
+    std::vector<uint32_t> buckets(header.BucketCount, 0);
+    std::string paths;
+
+    std::unordered_set<std::string> seenpaths;
+
+    for(size_t i = 0; i < files.size(); ++i) {
+
+        if(!seenpaths.insert(files[i]).second) {
+
+            errorreport->Error("AssetArchive: Pack: duplicate file: " + files[i]);
+            return false;
+        }
+
+        Entry& entry = entries[i];
+        entry.PathHash = HashPath(files[i]);
+        entry.PathOffset = static_cast<uint32_t>(paths.size());
+        entry.PathLength = static_cast<uint32_t>(files[i].size());
+
+        paths += files[i];
+
+        const uint32_t mask = header.BucketCount - 1;
+        uint32_t bucket = static_cast<uint32_t>(entry.PathHash) & mask;
+
+        while(buckets[bucket] != 0)
+            bucket = (bucket + 1) & mask;
+
+        buckets[bucket] = static_cast<uint32_t>(i + 1);
+    }
+
+    std::ofstream writer(archivefile, std::ios::binary | std::ios::trunc);
+
+    if(!writer.is_open()) {
+
+        errorreport->Error("AssetArchive: Pack: cannot write file: " + archivefile);
+        return false;
+    }
+
+    // The table is written last once the data offsets are known //
+    const uint64_t datastart = header.PathsOffset + paths.size();
+    writer.seekp(datastart);
+
+    AssetArchivePackStats packstats;
+
+    std::string contents;
+    std::vector<char> compressed;
+
+    uint64_t offset = datastart;
+
+    for(size_t i = 0; i < files.size(); ++i) {
+
+        std::ifstream reader(files[i], std::ios::in | std::ios::binary);
+
+        if(!reader) {
+
+            errorreport->Error("AssetArchive: Pack: cannot read file: " + files[i]);
+            return false;
+        }
+
+        reader.seekg(0, std::ios::end);
+        const auto length = static_cast<uint64_t>(reader.tellg());
+
+        if(length > LZ4_MAX_INPUT_SIZE) {
+
+            errorreport->Error("AssetArchive: Pack: file is too large: " + files[i]);
+            return false;
+        }
+
+        contents.resize(static_cast<size_t>(length));
+        reader.seekg(0, std::ios::beg);
+        reader.read(&contents[0], contents.size());
+
+        Entry& entry = entries[i];
+        entry.DataOffset = offset;
+        entry.OriginalSize = static_cast<uint32_t>(contents.size());
+
+        // Only worth decompressing if it saves at least a sixteenth //
+        const int maxsize = static_cast<int>(contents.size() - contents.size() / 16) - 1;
+
+        int compressedsize = 0;
+
+        if(maxsize > 0) {
+
+            compressed.resize(maxsize);
+            compressedsize = LZ4_compress_limitedOutput(contents.data(), compressed.data(),
+                static_cast<int>(contents.size()), maxsize);
+        }
+
+        if(compressedsize > 0) {
+
+            entry.StoredSize = static_cast<uint32_t>(compressedsize);
+            writer.write(compressed.data(), compressedsize);
+            ++packstats.CompressedFiles;
+
+        } else {
+
+            entry.StoredSize = entry.OriginalSize;
+            writer.write(contents.data(), contents.size());
+        }
+
+        offset += entry.StoredSize;
+        packstats.OriginalBytes += entry.OriginalSize;
+        packstats.StoredBytes += entry.StoredSize;
+    }
+
+    packstats.Files = files.size();
+
+    writer.seekp(0);
+    writer.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    writer.write(
+        reinterpret_cast<const char*>(entries.data()), sizeof(Entry) * entries.size());
+    writer.write(
+        reinterpret_cast<const char*>(buckets.data()), sizeof(uint32_t) * buckets.size());
+    writer.write(paths.data(), paths.size());
+
+    if(!writer.good()) {
+
+        errorreport->Error("AssetArchive: Pack: writing failed: " + archivefile);
+        return false;
+    }
+
+    if(stats)
+        *stats = packstats;
+
+    return true;
+}
@@ -0,0 +1,165 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "ErrorReporter.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Leviathan {
+
+//! First bytes of an archive file, "LVPK"
+constexpr uint32_t ASSET_ARCHIVE_MAGIC = 0x4B50564C;
+
+//! Incremented when the layout of the archive files changes
+constexpr uint32_t ASSET_ARCHIVE_VERSION = 1;
+
+//! \brief How much packing compressed the files
+struct AssetArchivePackStats {
+
+    size_t Files = 0;
+
+    //! Files that were stored compressed. The rest didn't get enough smaller and are stored
+    //! as is
+    size_t CompressedFiles = 0;
+
+    uint64_t OriginalBytes = 0;
+    uint64_t StoredBytes = 0;
+};
+
+//! \brief Read only file archive that is memory mapped
+//!
+//! The archive has a header, a table of entries, a hash table of the entries by path, the
+//! paths and then the data of the files. Each file is its own LZ4 block, or stored as is if
+//! compressing it didn't help. Opening an archive checks every entry of the table once, so
+//! it takes time linear in the number of files, but no file data is read then. Lookups
+//! don't need to check anything and stored data is accessed directly from the mapping.
+//! \note The archive is in the byte order of the machine that packed it. All supported
+//! platforms are little endian
+//! \see FileSystem::MountArchive
+class AssetArchive {
+public:
+    struct Header {
+
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t EntryCount;
+
+        //! Always a power of two
+        uint32_t BucketCount;
+
+        uint64_t EntriesOffset;
+        uint64_t BucketsOffset;
+        uint64_t PathsOffset;
+    };
+
+    struct Entry {
+
+        uint64_t PathHash;
+        uint64_t DataOffset;
+
+        //! Offset from Header::PathsOffset
+        uint32_t PathOffset;
+        uint32_t PathLength;
+
+        //! If this is the same as OriginalSize the data isn't compressed
+        uint32_t StoredSize;
+        uint32_t OriginalSize;
+    };
+
+public:
+    //! \brief Maps an archive file
+    //! \exception InvalidArgument if the file can't be opened or isn't a valid archive
+    DLLEXPORT AssetArchive(const std::string& file);
+    DLLEXPORT ~AssetArchive();
+
+    AssetArchive(const AssetArchive& other) = delete;
+    AssetArchive& operator=(const AssetArchive& other) = delete;
+
+    //! \returns The entry with the path or null
+    DLLEXPORT const Entry* Find(std::string_view path) const;
+
+    //! \brief Copies or decompresses the data of an entry into result
+    //! \returns False if the data is corrupted
+    DLLEXPORT bool ReadEntry(const Entry& entry, std::string& result) const;
+
+    //! \returns The data of the entry in the mapping or an empty view if the entry is
+    //! compressed
+    //! \note The view is valid as long as this object is
+    inline std::string_view GetUncompressedData(const Entry& entry) const
+    {
+        if(IsCompressed(entry))
+            return std::string_view();
+
+        return std::string_view(Data + entry.DataOffset, entry.StoredSize);
+    }
+
+    inline bool IsCompressed(const Entry& entry) const
+    {
+        return entry.StoredSize != entry.OriginalSize;
+    }
+
+    inline std::string_view GetPath(const Entry& entry) const
+    {
+        return std::string_view(
+            Data + Table->PathsOffset + entry.PathOffset, entry.PathLength);
+    }
+
+    inline size_t GetEntryCount() const
+    {
+        return Table->EntryCount;
+    }
+
+    inline const Entry& GetEntry(size_t index) const
+    {
+        return Entries[index];
+    }
+
+    inline const std::string& GetFile() const
+    {
+        return File;
+    }
+
+    //! \brief Hash used for the paths in the archives (64 bit FNV-1a)
+    DLLEXPORT static uint64_t HashPath(std::string_view path);
+
+    //! \brief Writes an archive with files
+    //!
+    //! The files are stored with the paths as they are given here, so they should be
+    //! given like FileSystem finds them, for example "./Data/Textures/Logo.png"
+    //! \returns False if a file couldn't be read or the archive couldn't be written.
+    //! The errors are reported to errorreport
+    DLLEXPORT static bool Pack(const std::string& archivefile,
+        const std::vector<std::string>& files, LErrorReporter* errorreport,
+        AssetArchivePackStats* stats = nullptr);
+
+private:
+    void _ValidateTable();
+    void _Unmap();
+
+private:
+    const std::string File;
+
+    const char* Data = nullptr;
+    size_t Size = 0;
+
+#ifdef _WIN32
+    void* FileHandle = nullptr;
+    void* MappingHandle = nullptr;
+#endif //_WIN32
+
+    const Header* Table = nullptr;
+    const Entry* Entries = nullptr;
+
+    //! Index of an entry + 1 or 0 for empty buckets
+    const uint32_t* Buckets = nullptr;
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::AssetArchive;
+#endif
@@ -41,8 +41,31 @@ DLLEXPORT Leviathan::VariableBlock::VariableBlock(
         return;
     }
 
-    // check does it contain non numeric characters //
-    if(!StringOperations::IsStringNumeric<std::string>(valuetoparse)) {
+    // Check does it contain non numeric characters and find the decimal separator in the
+    // same pass //
+    bool numeric = true;
+    size_t decimalspot = std::string::npos;
+
+    for(size_t i = 0; i < valuetoparse.size(); ++i) {
+
+        const char current = valuetoparse[i];
+
+        if(current >= '0' && current <= '9')
+            continue;
+
+        if(current == '.') {
+
+            if(decimalspot == std::string::npos)
+                decimalspot = i;
+
+        } else if(current != '-' && current != '+') {
+
+            numeric = false;
+            break;
+        }
+    }
+
+    if(!numeric) {
 
         // check does it match true/false //
         bool possiblevalue = false;
@@ -75,27 +98,32 @@ DLLEXPORT Leviathan::VariableBlock::VariableBlock(
     }
 
     // Try to figure out what kind of a number it is //
-    size_t decimalspot = valuetoparse.find_first_of('.');
-    if(decimalspot != std::wstring::npos) {
+    if(decimalspot != std::string::npos) {
         // has decimal separator //
 
         // check does it need more decimal digits than a float has //
 
         if(valuetoparse.size() - 1 - decimalspot > FLT_DIG) {
             // create a double //
-            BlockData = new DoubleBlock(Convert::StringTo<double>(valuetoparse));
+            double value = 0;
+            Convert::ParseNumber(std::string_view(valuetoparse), value);
+            BlockData = new DoubleBlock(value);
 
         } else {
 
             // float should have space to hold all characters //
-            BlockData = new FloatBlock(Convert::StringTo<float>(valuetoparse));
+            float value = 0;
+            Convert::ParseNumber(std::string_view(valuetoparse), value);
+            BlockData = new FloatBlock(value);
         }
 
         return;
     }
 
     // Should be a plain old int //
-    BlockData = new IntBlock(Convert::StringTo<int>(valuetoparse));
+    int value = 0;
+    Convert::ParseNumber(std::string_view(valuetoparse), value);
+    BlockData = new IntBlock(value);
 }
 
 
@@ -198,7 +226,7 @@ DLLEXPORT void VariableBlock::AddDataToPacket(sf::Packet& packet) const
     if(BlockData != NULL) {
         packet << BlockData->Type;
     } else {
-        packet << 0;
+        packet << static_cast<short>(0);
         return;
     }
 
@@ -3,11 +3,19 @@
 
 #include "../../Iterators/StringIterator.h"
 #include "FileSystem.h"
+
+#include <atomic>
 #include <cstdint>
 #include <limits.h>
 
 using namespace Leviathan;
 using namespace std;
+
+//! Incremented whenever a name of an existing NamedVariableList changes
+static std::atomic<uint64_t> NameChangeCount{0};
+
+//! Source of unique NamedVars::Generation values
+static std::atomic<uint64_t> NamedVarsGeneration{0};
 // ------------------------------------ //
 NamedVariableList::NamedVariableList() : Datas(0), Name("") {}
 
@@ -477,6 +485,7 @@ DLLEXPORT void NamedVariableList::GetName(std::string& name) const
 void NamedVariableList::SetName(const std::string& name)
 {
     Name = name;
+    ++NameChangeCount;
 }
 
 bool NamedVariableList::CompareName(const std::string& name) const
@@ -484,6 +493,11 @@ bool NamedVariableList::CompareName(const std::string& name) const
     // just default comparison //
     return Name.compare(name) == 0;
 }
+
+DLLEXPORT uint64_t NamedVariableList::GetNameChangeCount()
+{
+    return NameChangeCount.load(std::memory_order_relaxed);
+}
 DLLEXPORT std::string Leviathan::NamedVariableList::ToText(
     int WhichSeparator /*= 0*/, bool AddAllBrackets /*= false*/) const
 {
@@ -566,7 +580,10 @@ DLLEXPORT std::string Leviathan::NamedVariableList::ToText(
 DLLEXPORT NamedVariableList& NamedVariableList::operator=(const NamedVariableList& other)
 {
     // copy values //
-    Name = other.Name;
+    if(Name != other.Name) {
+        Name = other.Name;
+        ++NameChangeCount;
+    }
 
     SAFE_DELETE_VECTOR(Datas);
     Datas.resize(other.Datas.size());
@@ -695,8 +712,10 @@ DLLEXPORT void NamedVariableList::SwitchValues(
     NamedVariableList& receiver, NamedVariableList& donator)
 {
     // only overwrite name if there is one //
-    if(donator.Name.size() > 0)
+    if(donator.Name.size() > 0 && receiver.Name != donator.Name) {
         receiver.Name = donator.Name;
+        ++NameChangeCount;
+    }
 
 
     SAFE_DELETE_VECTOR(receiver.Datas);
@@ -774,6 +793,11 @@ DLLEXPORT vector<VariableBlock*>& NamedVariableList::GetValues()
     return Datas;
 }
 // ---------------------------- NamedVars --------------------------------- //
+DLLEXPORT NamedVars::Key::Key(const std::string& name) :
+    Name(name), Hash(std::hash<std::string>()(name))
+{
+}
+// ------------------------------------ //
 NamedVars::NamedVars() : Variables()
 {
     // nothing to initialize //
@@ -791,6 +815,7 @@ NamedVars::NamedVars(const NamedVars& other)
 DLLEXPORT NamedVars::NamedVars(NamedVars* stealfrom) : Variables(stealfrom->Variables)
 {
     stealfrom->Variables.clear();
+    stealfrom->_OnVariablesChanged();
 }
 
 DLLEXPORT NamedVars::NamedVars(const std::string& datadump, LErrorReporter* errorreport) :
@@ -885,9 +910,11 @@ DLLEXPORT bool NamedVars::Add(std::shared_ptr<NamedVariableList> value)
     if(index >= Variables.size()) {
 
         Variables.push_back(value);
+        _OnVariableAdded();
         return true;
     }
 
+    // The name is the same so the index stays valid //
     Variables[index] = value;
     return false;
 }
@@ -895,7 +922,7 @@ DLLEXPORT bool NamedVars::Add(std::shared_ptr<NamedVariableList> value)
 DLLEXPORT bool NamedVars::SetValue(const std::string& name, const VariableBlock& value1)
 {
     GUARD_LOCK();
-    auto index = Find(name);
+    auto index = Find(guard, name);
 
     if(index >= Variables.size())
         return false;
@@ -922,7 +949,7 @@ DLLEXPORT bool NamedVars::SetValue(
     const std::string& name, const vector<VariableBlock*>& values)
 {
     GUARD_LOCK();
-    auto index = Find(name);
+    auto index = Find(guard, name);
 
     if(index >= Variables.size())
         return false;
@@ -935,21 +962,35 @@ DLLEXPORT bool NamedVars::SetValue(
 DLLEXPORT bool NamedVars::SetValue(NamedVariableList& nameandvalues)
 {
     GUARD_LOCK();
-    auto index = Find(nameandvalues.Name);
+    auto index = Find(guard, nameandvalues.Name);
     // index check //
     if(index >= Variables.size()) {
 
         Variables.push_back(
             shared_ptr<NamedVariableList>(new NamedVariableList(nameandvalues)));
+        _OnVariableAdded();
         return true;
     }
 
+    // The existing variable keeps its name so the name indexes stay valid //
     nameandvalues.Name.clear();
     // set values with "swap" //
     NamedVariableList::SwitchValues(*Variables[index].get(), nameandvalues);
     return true;
 }
 
+DLLEXPORT bool NamedVars::SetValue(const Key& name, const VariableBlock& value1)
+{
+    GUARD_LOCK();
+    auto index = Find(guard, name);
+
+    if(index >= Variables.size())
+        return false;
+
+    Variables[index]->SetValue(value1);
+    return true;
+}
+
 DLLEXPORT VariableBlock& NamedVars::GetValueNonConst(const std::string& name)
 {
     GUARD_LOCK();
@@ -984,6 +1025,23 @@ DLLEXPORT const VariableBlock* NamedVars::GetValue(const std::string& name) cons
     return Variables[index]->GetValueDirect();
 }
 
+DLLEXPORT const VariableBlock* NamedVars::GetValue(const Key& name) const
+{
+    GUARD_LOCK();
+    auto index = Find(guard, name);
+
+    if(index >= Variables.size()) {
+
+#ifndef ALTERNATIVE_EXCEPTIONS_FATAL
+        throw InvalidArgument("value not found");
+#else
+        return nullptr;
+#endif // ALTERNATIVE_EXCEPTIONS_FATAL
+    }
+
+    return Variables[index]->GetValueDirect();
+}
+
 DLLEXPORT bool NamedVars::GetValue(const std::string& name, VariableBlock& receiver) const
 {
     GUARD_LOCK();
@@ -1107,6 +1165,18 @@ DLLEXPORT NamedVariableList* Leviathan::NamedVars::GetValueDirectRaw(size_t inde
     return Variables[index].get();
 }
 
+DLLEXPORT NamedVariableList* NamedVars::GetValueDirectRaw(const Key& name) const
+{
+    GUARD_LOCK();
+    auto index = Find(guard, name);
+
+    if(index >= Variables.size()) {
+        return nullptr;
+    }
+
+    return Variables[index].get();
+}
+
 DLLEXPORT std::string Leviathan::NamedVars::Serialize(
     const std::string& lineprefix /*= ""*/) const
 {
@@ -1188,6 +1258,7 @@ DLLEXPORT void NamedVars::AddVar(shared_ptr<NamedVariableList> values)
     RemoveIfExists(values->GetName(), guard);
     // just add to vector //
     Variables.push_back(values);
+    _OnVariableAdded();
 }
 
 DLLEXPORT void NamedVars::AddVar(NamedVariableList* newvaluetoadd)
@@ -1196,6 +1267,7 @@ DLLEXPORT void NamedVars::AddVar(NamedVariableList* newvaluetoadd)
     RemoveIfExists(newvaluetoadd->GetName(), guard);
     // create new smart pointer and push back //
     Variables.push_back(shared_ptr<NamedVariableList>(newvaluetoadd));
+    _OnVariableAdded();
 }
 
 DLLEXPORT void NamedVars::AddVar(const std::string& name, VariableBlock* valuetosteal)
@@ -1205,6 +1277,7 @@ DLLEXPORT void NamedVars::AddVar(const std::string& name, VariableBlock* valueto
     // create new smart pointer and push back //
     Variables.push_back(
         shared_ptr<NamedVariableList>(new NamedVariableList(name, valuetosteal)));
+    _OnVariableAdded();
 }
 // ------------------------------------ //
 void NamedVars::Remove(size_t index)
@@ -1213,6 +1286,7 @@ void NamedVars::Remove(size_t index)
 
     // smart pointers //
     Variables.erase(Variables.begin() + index);
+    _OnVariablesChanged();
 }
 
 DLLEXPORT void NamedVars::Remove(const std::string& name)
@@ -1231,25 +1305,36 @@ DLLEXPORT void NamedVars::RemoveIfExists(const std::string& name, Lock& guard)
 
 
     Variables.erase(Variables.begin() + index);
+    _OnVariablesChanged();
 }
 // ------------------------------------ //
 bool NamedVars::LoadVarsFromFile(const std::string& file, LErrorReporter* errorreport)
 {
     // call datadump loaded with this object's vector //
-    return FileSystem::LoadDataDump(file, Variables, errorreport);
+    const bool loaded = FileSystem::LoadDataDump(file, Variables, errorreport);
+    _OnVariablesChanged();
+    return loaded;
 }
 vector<shared_ptr<NamedVariableList>>* NamedVars::GetVec()
 {
+    GUARD_LOCK();
+
+    // The caller may change anything //
+    _OnVariablesChanged();
     return &Variables;
 }
 void NamedVars::SetVec(vector<shared_ptr<NamedVariableList>>& vec)
 {
     GUARD_LOCK();
     Variables = vec;
+    _OnVariablesChanged();
 }
 // ------------------------------------ //
 DLLEXPORT size_t NamedVars::Find(Lock& guard, const std::string& name) const
 {
+    if(Variables.size() >= NAME_INDEX_THRESHOLD)
+        return _FindIndexed(guard, name, std::hash<std::string>()(name));
+
     for(size_t i = 0; i < Variables.size(); i++) {
         if(Variables[i]->CompareName(name))
             return i;
@@ -1257,6 +1342,107 @@ DLLEXPORT size_t NamedVars::Find(Lock& guard, const std::string& name) const
 
     return std::numeric_limits<size_t>::max();
 }
+
+DLLEXPORT size_t NamedVars::Find(Lock& guard, const Key& name) const
+{
+    const auto namechanges = NamedVariableList::GetNameChangeCount();
+
+    // Nothing has changed since the last lookup //
+    if(name.FoundIn == this && name.FoundGeneration == Generation &&
+        name.FoundNameChanges == namechanges && name.FoundIndex < Variables.size())
+        return name.FoundIndex;
+
+    size_t index;
+
+    if(Variables.size() >= NAME_INDEX_THRESHOLD) {
+
+        index = _FindIndexed(guard, name.Name, name.Hash);
+
+    } else {
+
+        index = std::numeric_limits<size_t>::max();
+
+        for(size_t i = 0; i < Variables.size(); i++) {
+            if(Variables[i]->CompareName(name.Name)) {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    if(index < Variables.size()) {
+
+        name.FoundIn = this;
+        name.FoundGeneration = Generation;
+        name.FoundNameChanges = namechanges;
+        name.FoundIndex = index;
+    }
+
+    return index;
+}
+
+size_t NamedVars::_FindIndexed(Lock& guard, const std::string& name, size_t hash) const
+{
+    const auto namechanges = NamedVariableList::GetNameChangeCount();
+
+    if(!NameIndexValid || IndexedCount != Variables.size() ||
+        IndexedNameChanges != namechanges) {
+
+        NameIndex.clear();
+        NameIndex.reserve(Variables.size());
+
+        std::hash<std::string> hasher;
+
+        for(size_t i = 0; i < Variables.size(); ++i)
+            NameIndex.emplace(hasher(Variables[i]->Name), i);
+
+        NameIndexValid = true;
+        IndexedCount = Variables.size();
+        IndexedNameChanges = namechanges;
+    }
+
+    // Duplicate names are possible so the first one needs to be returned like a linear
+    // search would //
+    size_t found = std::numeric_limits<size_t>::max();
+
+    const auto range = NameIndex.equal_range(hash);
+
+    for(auto iter = range.first; iter != range.second; ++iter) {
+
+        if(iter->second < found && Variables[iter->second]->CompareName(name))
+            found = iter->second;
+    }
+
+    return found;
+}
+
+void NamedVars::_OnVariablesChanged()
+{
+    Generation = _NextGeneration();
+    NameIndexValid = false;
+}
+
+void NamedVars::_OnVariableAdded()
+{
+    Generation = _NextGeneration();
+
+    // Appending doesn't move the other values so the index can be updated in place //
+    if(NameIndexValid && IndexedCount + 1 == Variables.size() &&
+        IndexedNameChanges == NamedVariableList::GetNameChangeCount()) {
+
+        NameIndex.emplace(std::hash<std::string>()(Variables.back()->Name), IndexedCount);
+        ++IndexedCount;
+
+    } else {
+
+        NameIndexValid = false;
+    }
+}
+
+uint64_t NamedVars::_NextGeneration()
+{
+    return ++NamedVarsGeneration;
+}
 // ------------------ Script compatible functions ------------------ //
 #ifdef LEVIATHAN_USING_ANGELSCRIPT
 ScriptSafeVariableBlock* NamedVars::GetScriptCompatibleValue(const std::string& name)
@@ -1287,6 +1473,7 @@ bool NamedVars::AddScriptCompatibleValue(ScriptSafeVariableBlock* value)
     try {
 
         Variables.push_back(shared_ptr<NamedVariableList>(new NamedVariableList(value)));
+        _OnVariableAdded();
         success = true;
 
     } catch(...) {
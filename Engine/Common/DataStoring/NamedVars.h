@@ -3,6 +3,7 @@
 #include "Define.h"
 // ------------------------------------ //
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 
@@ -141,6 +142,11 @@ public:
 
     DLLEXPORT void SetName(const std::string& name);
     DLLEXPORT bool CompareName(const std::string& name) const;
+
+    //! \brief Counts how many times the name of an existing list has been changed
+    //!
+    //! NamedVars uses this to know when its name index needs to be rebuilt
+    DLLEXPORT static uint64_t GetNameChangeCount();
     // ------------------------------------ //
     DLLEXPORT std::string ToText(int WhichSeparator = 0, bool AddAllBrackets = false) const;
 
@@ -183,6 +189,41 @@ class NamedVars : public ReferenceCounted, public ThreadSafe {
 public:
     REFERENCE_COUNTED_PTR_TYPE(NamedVars);
 
+    //! \brief A name with a precomputed hash that can be kept for repeated lookups
+    //!
+    //! Remembers where the value was found last so that as long as the NamedVars hasn't
+    //! been changed the next lookup doesn't need to compare any strings
+    //! \note A Key shouldn't be used from multiple threads at the same time
+    class Key {
+        friend NamedVars;
+
+    public:
+        DLLEXPORT Key(const std::string& name);
+
+        inline const std::string& GetName() const
+        {
+            return Name;
+        }
+
+        inline size_t GetHash() const
+        {
+            return Hash;
+        }
+
+    private:
+        std::string Name;
+        size_t Hash;
+
+        // Where this was last found //
+        mutable const NamedVars* FoundIn = nullptr;
+        mutable uint64_t FoundGeneration = 0;
+        mutable uint64_t FoundNameChanges = 0;
+        mutable size_t FoundIndex = 0;
+    };
+
+    //! Smaller NamedVars are searched without building the name index
+    static constexpr size_t NAME_INDEX_THRESHOLD = 8;
+
     DLLEXPORT NamedVars();
 
     //! \brief Constructs a NamedVars by stealing variables from another
@@ -220,8 +261,12 @@ public:
     DLLEXPORT bool SetValue(
         const std::string& name, const std::vector<VariableBlock*>& values);
 
+    //! \note If a variable with the name exists the values are moved from nameandvalues and
+    //! its name is cleared. It shouldn't be a variable of another NamedVars
     DLLEXPORT bool SetValue(NamedVariableList& nameandvalues);
 
+    DLLEXPORT bool SetValue(const Key& name, const VariableBlock& value1);
+
     DLLEXPORT size_t GetValueCount(const std::string& name) const;
 
     //! \returns True if index is valid
@@ -234,6 +279,8 @@ public:
 
     DLLEXPORT const VariableBlock* GetValue(const std::string& name) const;
 
+    DLLEXPORT const VariableBlock* GetValue(const Key& name) const;
+
     DLLEXPORT bool GetValue(const std::string& name, VariableBlock& receiver) const;
 
     //! \brief Gets a VariableBlock from the specified index on the block matching name
@@ -252,33 +299,20 @@ public:
     //! \warning You need to make sure that this is valid while the pointer is used
     DLLEXPORT NamedVariableList* GetValueDirectRaw(const std::string& name) const;
     DLLEXPORT NamedVariableList* GetValueDirectRaw(size_t index) const;
+    DLLEXPORT NamedVariableList* GetValueDirectRaw(const Key& name) const;
 
     template<class T>
     bool GetValueAndConvertTo(const std::string& name, T& receiver) const
     {
-        // use try block to catch all exceptions (not found and conversion fail //
         GUARD_LOCK();
-        try {
-            auto index = Find(guard, name);
-
-            if(index >= Variables.size())
-                return false;
-
-            const VariableBlock* tmpblock = Variables[index]->GetValueDirect();
-            if(tmpblock == NULL) {
-                return false;
-            }
-            if(!tmpblock->ConvertAndAssingToVariable<T>(receiver)) {
+        return _ConvertValueAt(Find(guard, name), receiver);
+    }
 
-                // Unallowed NamedVars block conversion
-                return false;
-            }
-        } catch(...) {
-            // variable not found / wrong type //
-            return false;
-        }
-        // correct variable has been set //
-        return true;
+    template<class T>
+    bool GetValueAndConvertTo(const Key& name, T& receiver) const
+    {
+        GUARD_LOCK();
+        return _ConvertValueAt(Find(guard, name), receiver);
     }
 
     DLLEXPORT std::vector<VariableBlock*>* GetValues(const std::string& name);
@@ -347,6 +381,8 @@ public:
     // ------------------------------------ //
     DLLEXPORT bool LoadVarsFromFile(const std::string& file, LErrorReporter* errorreport);
 
+    //! \note If the vector is modified after this returns the name index notices only changes
+    //! in the size of the vector. Call this again after other modifications
     DLLEXPORT std::vector<std::shared_ptr<NamedVariableList>>* GetVec();
     DLLEXPORT void SetVec(std::vector<std::shared_ptr<NamedVariableList>>& vec);
 
@@ -367,6 +403,18 @@ public:
     }
 
     DLLEXPORT size_t Find(Lock& guard, const std::string& name) const;
+
+    inline size_t Find(const Key& name) const
+    {
+        GUARD_LOCK();
+        return Find(guard, name);
+    }
+
+    //! \brief Finds a value using a Key
+    //!
+    //! If nothing has changed since the key was last used the remembered index is returned
+    //! directly
+    DLLEXPORT size_t Find(Lock& guard, const Key& name) const;
     // ------------------------------------ //
     template<class T>
     bool ShouldAddValueIfNotFoundOrWrongType(const std::string& name)
@@ -387,9 +435,60 @@ public:
         return false;
     }
 
+private:
+    //! \brief Helper for GetValueAndConvertTo
+    template<class T>
+    bool _ConvertValueAt(size_t index, T& receiver) const
+    {
+        // use try block to catch all exceptions (not found and conversion fail //
+        try {
+            if(index >= Variables.size())
+                return false;
+
+            const VariableBlock* tmpblock = Variables[index]->GetValueDirect();
+            if(tmpblock == NULL) {
+                return false;
+            }
+            if(!tmpblock->ConvertAndAssingToVariable<T>(receiver)) {
+
+                // Unallowed NamedVars block conversion
+                return false;
+            }
+        } catch(...) {
+            // variable not found / wrong type //
+            return false;
+        }
+        // correct variable has been set //
+        return true;
+    }
+
+    //! \brief Finds a name using NameIndex, rebuilding it if it is out of date
+    size_t _FindIndexed(Lock& guard, const std::string& name, size_t hash) const;
+
+    //! \brief Must be called after Variables is changed in any way other than appending
+    void _OnVariablesChanged();
+
+    //! \brief Called after a value is pushed to the end of Variables
+    void _OnVariableAdded();
+
+    static uint64_t _NextGeneration();
+
 private:
     std::vector<std::shared_ptr<NamedVariableList>> Variables;
 
+    //! Changes whenever Variables is changed. Unique between all NamedVars so that Keys can
+    //! tell if they are still valid
+    uint64_t Generation = _NextGeneration();
+
+    //! Maps name hashes to indexes in Variables. Only used with NAME_INDEX_THRESHOLD or more
+    //! variables
+    mutable std::unordered_multimap<size_t, size_t> NameIndex;
+    mutable bool NameIndexValid = false;
+
+    //! The values NameIndex was built for. If these change it needs to be rebuilt
+    mutable size_t IndexedCount = 0;
+    mutable uint64_t IndexedNameChanges = 0;
+
     //! If set the input data was invalid and this is in invalid state
     bool StateIsInvalid = false;
 };
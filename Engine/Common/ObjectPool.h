@@ -127,7 +127,6 @@ public:
         Elements.free(object);
 
         RemoveFromIndex(entity);
-        RemoveFromAdded(entity);
     }
 
     //! \return The found component or NULL
@@ -155,7 +154,22 @@ public:
         Elements.free(object);
 
         RemoveFromIndex(id);
-        RemoveFromAdded(id);
+    }
+
+    //! \brief Destroys a component based on id if exists
+    //! \returns True if destroyed
+    bool DestroyIfExists(KeyType id)
+    {
+        auto iter = Index.find(id);
+
+        if(iter == Index.end())
+            return false;
+
+        iter->second->~ElementType();
+        Elements.free(iter->second);
+
+        Index.erase(iter);
+        return true;
     }
 
     //! \brief Destroys without releasing elements based on ids in vector
@@ -235,18 +249,7 @@ protected:
     //! \note The component will only be deallocated once this object is destructed
     bool RemoveFromIndex(KeyType id)
     {
-
-        auto end = Index.end();
-        for(auto iter = Index.begin(); iter != end; ++iter) {
-
-            if(iter->first == id) {
-
-                Index.erase(iter);
-                return true;
-            }
-        }
-
-        return false;
+        return Index.erase(id) > 0;
     }
 
 protected:
@@ -533,20 +536,14 @@ public:
     //! \note This has to be used for objects that require calling Release
     void QueueDestroy(KeyType id)
     {
-        auto end = Index.end();
-        for(auto iter = Index.begin(); iter != end; ++iter) {
-
-            if(iter->first == id) {
-
-                Queued.push_back(std::make_tuple(iter->second, id));
+        auto iter = Index.find(id);
 
-                RemoveFromAdded(id);
+        if(iter == Index.end())
+            throw InvalidArgument("ID is not in index");
 
-                return;
-            }
-        }
+        Queued.push_back(std::make_tuple(iter->second, id));
 
-        throw InvalidArgument("ID is not in index");
+        RemoveFromAdded(id);
     }
 
     //! \brief Calls an function on all the objects in the pool
@@ -610,18 +607,7 @@ protected:
     //! \note The component will only be deallocated once this object is destructed
     bool RemoveFromIndex(KeyType id)
     {
-
-        auto end = Index.end();
-        for(auto iter = Index.begin(); iter != end; ++iter) {
-
-            if(iter->first == id) {
-
-                Index.erase(iter);
-                return true;
-            }
-        }
-
-        return false;
+        return Index.erase(id) > 0;
     }
 
     template<typename... Args>
@@ -0,0 +1,549 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2018 Henri Hyyryläinen
+#pragma once
+#include "Include.h"
+// ------------------------------------ //
+
+#include "Exceptions.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace Leviathan {
+
+//! \brief Maps integer keys to slots in a dense array
+//!
+//! The keys are split into fixed size pages that are allocated on demand so that large
+//! (but clustered) ids don't require allocating a huge array
+template<typename KeyType>
+class SparseSlotIndex {
+    static_assert(std::is_integral<KeyType>::value, "SparseSlotIndex requires integer keys");
+
+public:
+    //! Value stored for keys that don't have a slot
+    static constexpr uint32_t NO_SLOT = static_cast<uint32_t>(-1);
+
+    static constexpr size_t PAGE_SIZE = 1024;
+
+    //! \returns The slot of key or NO_SLOT
+    inline uint32_t Get(KeyType key) const
+    {
+        if(key < 0)
+            return NO_SLOT;
+
+        const size_t page = static_cast<size_t>(key) / PAGE_SIZE;
+
+        if(page >= Pages.size() || !Pages[page])
+            return NO_SLOT;
+
+        return Pages[page][static_cast<size_t>(key) % PAGE_SIZE];
+    }
+
+    //! \exception InvalidArgument if key is negative
+    void Set(KeyType key, uint32_t slot)
+    {
+        if(key < 0)
+            throw InvalidArgument("SparseSlotIndex can't hold negative keys");
+
+        const size_t page = static_cast<size_t>(key) / PAGE_SIZE;
+
+        if(page >= Pages.size())
+            Pages.resize(page + 1);
+
+        if(!Pages[page]) {
+
+            Pages[page] = std::make_unique<uint32_t[]>(PAGE_SIZE);
+
+            for(size_t i = 0; i < PAGE_SIZE; ++i)
+                Pages[page][i] = NO_SLOT;
+        }
+
+        Pages[page][static_cast<size_t>(key) % PAGE_SIZE] = slot;
+    }
+
+    inline void Remove(KeyType key)
+    {
+        if(Get(key) == NO_SLOT)
+            return;
+
+        Pages[static_cast<size_t>(key) / PAGE_SIZE][static_cast<size_t>(key) % PAGE_SIZE] =
+            NO_SLOT;
+    }
+
+    //! \brief Releases all pages
+    void Clear()
+    {
+        Pages.clear();
+    }
+
+private:
+    std::vector<std::unique_ptr<uint32_t[]>> Pages;
+};
+
+//! \brief Version of ObjectPoolTracked that keeps all elements packed in a single array
+//!
+//! The elements are stored contiguously with a parallel array of keys. A SparseSlotIndex
+//! maps keys to slots. Removing an element moves the last element into the freed slot
+//! (swap-remove) so iterating the elements never jumps around memory.
+//! \warning Pointers and references to elements are invalidated when a new element is added
+//! or an element is removed. So this can't be used for types that other objects keep
+//! pointers to (for example components that are part of system nodes)
+//! \note Added contains pointers that are refreshed when it is retrieved with GetAdded
+template<class ElementType, typename KeyType, bool AutoCleanupObjects = true>
+class ObjectPoolDense {
+    static_assert(std::is_move_constructible<ElementType>::value,
+        "ObjectPoolDense requires elements to be move constructible");
+
+    using StorageType =
+        typename std::aligned_storage<sizeof(ElementType), alignof(ElementType)>::type;
+
+public:
+    //! \brief Iterator over the packed elements that mimics the unordered_map iterator of
+    //! ObjectPool::GetIndex (iter->first is the key and iter->second the element pointer)
+    class IndexIterator {
+    public:
+        struct Entry {
+            KeyType first;
+            ElementType* second;
+        };
+
+        inline IndexIterator(ObjectPoolDense* pool, size_t slot) : Pool(pool), Slot(slot) {}
+
+        inline Entry operator*() const
+        {
+            return Entry{Pool->Keys[Slot], Pool->ElementAt(Slot)};
+        }
+
+        //! \note The returned proxy is stored in the iterator
+        inline const Entry* operator->()
+        {
+            Current = **this;
+            return &Current;
+        }
+
+        inline IndexIterator& operator++()
+        {
+            ++Slot;
+            return *this;
+        }
+
+        inline bool operator==(const IndexIterator& other) const
+        {
+            return Slot == other.Slot;
+        }
+
+        inline bool operator!=(const IndexIterator& other) const
+        {
+            return Slot != other.Slot;
+        }
+
+    private:
+        ObjectPoolDense* Pool;
+        size_t Slot;
+        Entry Current;
+    };
+
+    //! \brief Loopable view returned by GetIndex
+    //! \note Don't add or remove elements while looping
+    class IndexView {
+    public:
+        inline IndexView(ObjectPoolDense* pool) : Pool(pool) {}
+
+        inline IndexIterator begin() const
+        {
+            return IndexIterator(Pool, 0);
+        }
+
+        inline IndexIterator end() const
+        {
+            return IndexIterator(Pool, Pool->Count);
+        }
+
+        inline size_t size() const
+        {
+            return Pool->Count;
+        }
+
+        inline bool empty() const
+        {
+            return Pool->Count == 0;
+        }
+
+    private:
+        ObjectPoolDense* Pool;
+    };
+
+public:
+    ObjectPoolDense() : IndexAccess(this) {}
+
+    ~ObjectPoolDense()
+    {
+        if(AutoCleanupObjects)
+            Clear();
+    }
+
+    ObjectPoolDense(const ObjectPoolDense& other) = delete;
+    ObjectPoolDense& operator=(const ObjectPoolDense& other) = delete;
+
+    //! \brief Constructs a new component of the held type for entity
+    //! \exception Exception when component has not been created
+    template<typename... Args>
+    ElementType* ConstructNew(KeyType forentity, Args&&... args)
+    {
+        if(Find(forentity))
+            throw Exception("Entity with ID already has object in pool of this type");
+
+        if(Count == Capacity)
+            _Grow();
+
+        ElementType* created =
+            new(&Storage[Count]) ElementType(std::forward<Args>(args)...);
+
+        try {
+            Keys.push_back(forentity);
+            SlotIndex.Set(forentity, static_cast<uint32_t>(Count));
+        } catch(...) {
+
+            if(Keys.size() > Count)
+                Keys.pop_back();
+            created->~ElementType();
+            throw;
+        }
+
+        ++Count;
+
+        Added.push_back(std::make_tuple(created, forentity));
+        return created;
+    }
+
+    //! \brief Returns true if there are objects in Removed
+    bool HasElementsInRemoved() const
+    {
+        return !Removed.empty();
+    }
+
+    //! \brief Returns true if there are objects in Added
+    bool HasElementsInAdded() const
+    {
+        return !Added.empty();
+    }
+
+    //! \brief Returns true if there are objects in Queued
+    bool HasElementsInQueued() const
+    {
+        return !Queued.empty();
+    }
+
+    //! \brief Calls Release with the specified arguments on elements that are queued
+    //! for destruction
+    template<typename... Args>
+    void ReleaseQueued(Args&&... args)
+    {
+        for(const auto id : Queued) {
+
+            auto* object = Find(id);
+
+            if(!object)
+                continue;
+
+            _ReleaseCommon(object, id, true, std::forward<Args>(args)...);
+        }
+
+        Queued.clear();
+    }
+
+    //! \brief Calls Release on an object and then removes it from the pool
+    template<typename... Args>
+    void Release(KeyType id, bool addtoremoved, Args&&... args)
+    {
+        auto* object = Find(id);
+
+        if(!object)
+            throw NotFound("id not in pool");
+
+        _ReleaseCommon(object, id, addtoremoved, std::forward<Args>(args)...);
+    }
+
+    //! \brief Calls Release on an object if it is in this pool and
+    //! then removes it from the pool
+    template<typename... Args>
+    bool ReleaseIfExists(KeyType id, bool addtoremoved, Args&&... args)
+    {
+        auto* object = Find(id);
+
+        if(!object)
+            return false;
+
+        _ReleaseCommon(object, id, addtoremoved, std::forward<Args>(args)...);
+        return true;
+    }
+
+    //! \brief Removes elements that are queued for destruction
+    //! without calling release
+    void ClearQueued()
+    {
+        for(const auto id : Queued)
+            DestroyIfExists(id, true);
+
+        Queued.clear();
+    }
+
+    //! \brief Returns a reference to the vector of removed elements
+    //! \note The pointers in this are invalid and only the keys should be used
+    const auto& GetRemoved() const
+    {
+        return Removed;
+    }
+
+    //! \brief Returns a reference to the vector of added elements
+    //!
+    //! This updates the element pointers as they may have been moved after adding
+    auto& GetAdded()
+    {
+        for(auto& added : Added)
+            std::get<0>(added) = Find(std::get<1>(added));
+
+        return Added;
+    }
+
+    //! \brief Clears the added list
+    void ClearAdded()
+    {
+        Added.clear();
+    }
+
+    //! \brief Clears the removed list
+    void ClearRemoved()
+    {
+        Removed.clear();
+    }
+
+    //! \brief Destroys without releasing elements based on ids in vector
+    //! \param addtoremoved If true will add the elements to the Removed index
+    template<typename Any>
+    void RemoveBasedOnKeyTupleList(
+        const std::vector<std::tuple<Any, KeyType>>& values, bool addtoremoved = false)
+    {
+        for(auto iter = values.begin(); iter != values.end(); ++iter)
+            DestroyIfExists(std::get<1>(*iter), addtoremoved);
+    }
+
+    //! \brief Calls release on all objects and clears everything
+    template<typename... Args>
+    void ReleaseAllAndClear(Args&&... args)
+    {
+        for(size_t i = 0; i < Count; ++i)
+            ElementAt(i)->Release(std::forward<Args>(args)...);
+
+        Clear();
+    }
+
+    //! \brief Removes a specific id from the added list
+    void RemoveFromAdded(KeyType id)
+    {
+        for(auto iter = Added.begin(); iter != Added.end(); ++iter) {
+
+            if(std::get<1>(*iter) == id) {
+
+                Added.erase(iter);
+                return;
+            }
+        }
+    }
+
+    //! \return The found component or NULL
+    inline ElementType* Find(KeyType id) const
+    {
+        const auto slot = SlotIndex.Get(id);
+
+        if(slot == SparseSlotIndex<KeyType>::NO_SLOT)
+            return nullptr;
+
+        return ElementAt(slot);
+    }
+
+    //! \brief Destroys a component based on id
+    void Destroy(KeyType id, bool addtoremoved = true)
+    {
+        auto object = Find(id);
+
+        if(!object)
+            throw InvalidArgument("ID is not in index");
+
+        _DestroyCommon(object, id, addtoremoved);
+    }
+
+    //! \brief Destroys a component based on id if exists
+    bool DestroyIfExists(KeyType id, bool addtoremoved = true)
+    {
+        auto object = Find(id);
+
+        if(!object)
+            return false;
+
+        _DestroyCommon(object, id, addtoremoved);
+        return true;
+    }
+
+    //! \brief Queues destruction of an element
+    //! \exception InvalidArgument when key is not found (is already deleted)
+    void QueueDestroy(KeyType id)
+    {
+        if(!Find(id))
+            throw InvalidArgument("ID is not in index");
+
+        Queued.push_back(id);
+        RemoveFromAdded(id);
+    }
+
+    //! \brief Calls an function on all the objects in the pool
+    //! \param function The function that is called with all of the components of this type
+    //! the first parameter is the component, the second is the id of the entity owning the
+    //! component, the return value specifies
+    //! if the component should be destroyed (true being yes and false being no)
+    void Call(std::function<bool(ElementType&, KeyType)> function)
+    {
+        for(size_t i = 0; i < Count;) {
+
+            if(function(*ElementAt(i), Keys[i])) {
+
+                // The last element is moved here so this slot needs to be checked again
+                _RemoveSlot(i);
+
+            } else {
+
+                ++i;
+            }
+        }
+    }
+
+    //! \brief Destroys all elements
+    //! \note The memory is kept for reuse
+    void Clear()
+    {
+        for(size_t i = 0; i < Count; ++i)
+            ElementAt(i)->~ElementType();
+
+        Count = 0;
+        Keys.clear();
+        SlotIndex.Clear();
+
+        Removed.clear();
+        Queued.clear();
+        Added.clear();
+    }
+
+    auto GetObjectCount() const
+    {
+        return Count;
+    }
+
+    //! \brief Returns a view for looping all the elements
+    //! \note The loop order is the storage order
+    inline IndexView& GetIndex()
+    {
+        return IndexAccess;
+    }
+
+    //! \brief Direct access to the packed elements. Valid indexes are [0, GetObjectCount())
+    inline ElementType* GetElements()
+    {
+        return reinterpret_cast<ElementType*>(Storage.get());
+    }
+
+    //! \brief Direct access to the keys matching the elements in GetElements
+    inline const KeyType* GetKeys() const
+    {
+        return Keys.data();
+    }
+
+protected:
+    inline ElementType* ElementAt(size_t slot) const
+    {
+        return reinterpret_cast<ElementType*>(&Storage[slot]);
+    }
+
+    //! \brief Destroys the element in slot and moves the last element to its place
+    void _RemoveSlot(size_t slot)
+    {
+        const size_t last = Count - 1;
+
+        SlotIndex.Remove(Keys[slot]);
+        ElementAt(slot)->~ElementType();
+
+        if(slot != last) {
+
+            new(&Storage[slot]) ElementType(std::move(*ElementAt(last)));
+            ElementAt(last)->~ElementType();
+
+            Keys[slot] = Keys[last];
+            SlotIndex.Set(Keys[slot], static_cast<uint32_t>(slot));
+        }
+
+        Keys.pop_back();
+        --Count;
+    }
+
+    //! \brief Doubles the storage size, moving the existing elements
+    void _Grow()
+    {
+        const size_t newCapacity = Capacity > 0 ? Capacity * 2 : 16;
+
+        std::unique_ptr<StorageType[]> newStorage(new StorageType[newCapacity]);
+
+        for(size_t i = 0; i < Count; ++i) {
+
+            new(&newStorage[i]) ElementType(std::move(*ElementAt(i)));
+            ElementAt(i)->~ElementType();
+        }
+
+        Storage = std::move(newStorage);
+        Capacity = newCapacity;
+        Keys.reserve(newCapacity);
+    }
+
+    template<typename... Args>
+    void _ReleaseCommon(ElementType* object, KeyType id, bool addtoremoved, Args&&... args)
+    {
+        object->Release(std::forward<Args>(args)...);
+        _DestroyCommon(object, id, addtoremoved);
+    }
+
+    void _DestroyCommon(ElementType* object, KeyType id, bool addtoremoved)
+    {
+        if(addtoremoved)
+            Removed.push_back(std::make_tuple(object, id));
+
+        _RemoveSlot(SlotIndex.Get(id));
+        RemoveFromAdded(id);
+    }
+
+protected:
+    //! Packed elements, the first Count are constructed
+    std::unique_ptr<StorageType[]> Storage;
+    size_t Capacity = 0;
+    size_t Count = 0;
+
+    //! Key of each element in Storage
+    std::vector<KeyType> Keys;
+
+    //! Used for looking up the slot of an element belonging to id
+    SparseSlotIndex<KeyType> SlotIndex;
+
+    //! Used for detecting deleted elements later
+    std::vector<std::tuple<ElementType*, KeyType>> Removed;
+
+    //! Keys of elements that are queued for deletion
+    std::vector<KeyType> Queued;
+
+    //! Used for detecting created elements
+    std::vector<std::tuple<ElementType*, KeyType>> Added;
+
+    IndexView IndexAccess;
+};
+
+} // namespace Leviathan
@@ -77,11 +77,12 @@ constexpr float EPSILON = 0.00000001f;
 #define VALUE_TYPE_NAMED(x)
 #endif //LEVIATHAN_USING_ANGELSCRIPT
 
-// Logging macros //
-#define LOG_INFO(x) Logger::Get()->Info(x);
-#define LOG_WARNING(x) Logger::Get()->Warning(x);
-#define LOG_ERROR(x) Logger::Get()->Error(x);
-#define LOG_WRITE(x) Logger::Get()->Write(x);
+// Logging macros, the message isn't built if the level is disabled //
+#define LOG_INFO(x) {if(Logger::Get()->IsEnabled(LOG_LEVEL::Info)) Logger::Get()->Info(x);}
+#define LOG_WARNING(x) {if(Logger::Get()->IsEnabled(LOG_LEVEL::Warning)) \
+            Logger::Get()->Warning(x);}
+#define LOG_ERROR(x) {if(Logger::Get()->IsEnabled(LOG_LEVEL::Error)) Logger::Get()->Error(x);}
+#define LOG_WRITE(x) {if(Logger::Get()->IsEnabled(LOG_LEVEL::Info)) Logger::Get()->Write(x);}
 #define LOG_FATAL(x) Logger::Get()->Fatal(x + (", at: " __FILE__ "(" + std::to_string(__LINE__) + ")"));
 
 // Assertions for controlled crashing
@@ -46,6 +46,7 @@
 #include <SDL.h>
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <future>
 
@@ -56,7 +57,11 @@ using namespace std;
 static thread_local int MainThreadMagic = 0;
 constexpr auto THREAD_MAGIC = 42;
 
-DLLEXPORT Engine::Engine(LeviathanApplication* owner) : Owner(owner)
+DLLEXPORT Engine::Engine(LeviathanApplication* owner) :
+    TickEvent(std::make_unique<ReusableEvent<IntegerEventData>>(EVENT_TYPE_TICK)),
+    FrameBeginEvent(std::make_unique<ReusableEvent<IntegerEventData>>(EVENT_TYPE_FRAME_BEGIN)),
+    FrameEndEvent(std::make_unique<ReusableEvent<IntegerEventData>>(EVENT_TYPE_FRAME_END)),
+    Owner(owner)
 {
     // This makes sure that uninitialized engine will have at least some last frame time //
     LastTickTime = Time::GetTimeMs64();
@@ -188,6 +193,12 @@ DLLEXPORT bool Engine::Init(
         return false;
     }
 
+    // Keeps the file index up to date without searching the data folder again //
+    if(!MainFileHandler->ListenForDataFolderChanges(_ResourceRefreshHandler)) {
+
+        Logger::Get()->Warning("Engine: Init: cannot listen for changes in the data folder");
+    }
+
     // File parsing //
     ObjectFileProcessor::Initialize();
 
@@ -261,6 +272,9 @@ DLLEXPORT bool Engine::Init(
                 return;
             }
 
+            if(engine->ThreadedPhysics)
+                engine->_NewtonManager->SetPhysicsThreadCount(0);
+
             // next force application to load physical surface materials //
             engine->PhysMaterials = new PhysicsMaterialManager(engine->_NewtonManager);
             if(!engine->PhysMaterials) {
@@ -901,13 +915,7 @@ void Engine::Tick()
     // Update worlds //
     {
         Lock lock(GameWorldsLock);
-
-        // This will also update physics //
-        auto end = GameWorlds.end();
-        for(auto iter = GameWorlds.begin(); iter != end; ++iter) {
-
-            (*iter)->Tick(TickCount);
-        }
+        _TickWorlds();
     }
 
 
@@ -929,7 +937,7 @@ void Engine::Tick()
 
     // Send the tick event //
     if(MainEvents)
-        MainEvents->CallEvent(new Event(EVENT_TYPE_TICK, new IntegerEventData(TickCount)));
+        MainEvents->CallEvent(TickEvent->Get(TickCount));
 
     // Call the default app tick //
     Owner->Tick(TimePassed);
@@ -937,6 +945,56 @@ void Engine::Tick()
     TickTime = (int)(Time::GetTimeMs64() - CurTime);
 }
 
+bool Engine::_TickWorlds()
+{
+    // Ogre can only be used from the main thread //
+    if(TickWorldsInParallel && NoGui && _ThreadingManager && GameWorlds.size() > 1) {
+
+        _TickWorldsInParallel();
+        return true;
+    }
+
+    // This will also update physics //
+    auto end = GameWorlds.end();
+    for(auto iter = GameWorlds.begin(); iter != end; ++iter) {
+
+        (*iter)->Tick(TickCount);
+    }
+
+    return false;
+}
+
+void Engine::_TickWorldsInParallel()
+{
+    WorldTickOrder.clear();
+
+    for(const auto& world : GameWorlds)
+        WorldTickOrder.push_back(world.get());
+
+    // Overloaded worlds are started first so that they don't hold up the tick by starting
+    // last after all the other worlds //
+    std::stable_sort(WorldTickOrder.begin(), WorldTickOrder.end(),
+        [](GameWorld* first, GameWorld* second) {
+            return first->GetTickStatistics().LastTickMicroseconds >
+                   second->GetTickStatistics().LastTickMicroseconds;
+        });
+
+    const auto tick = TickCount;
+
+    // A failing world doesn't stop the other worlds from ticking, the exception is thrown
+    // once they are done //
+    _ThreadingManager->ParallelFor(
+        0, WorldTickOrder.size(), 1, [this, tick](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; ++i)
+                WorldTickOrder[i]->Tick(tick);
+        });
+}
+
+DLLEXPORT void Engine::SetTickWorldsInParallel(bool parallel)
+{
+    TickWorldsInParallel = parallel;
+}
+
 DLLEXPORT void Engine::PreFirstTick()
 {
 
@@ -974,8 +1032,7 @@ void Engine::RenderFrame()
     // advanced statistic start monitoring //
     RenderTimer->RenderingStart();
 
-    MainEvents->CallEvent(
-        new Event(EVENT_TYPE_FRAME_BEGIN, new IntegerEventData(SinceLastFrame)));
+    MainEvents->CallEvent(FrameBeginEvent->Get(SinceLastFrame));
 
     // Calculate parameters for GameWorld frame rendering systems //
     int64_t timeintick = Time::GetTimeMs64() - LastTickTime;
@@ -1006,7 +1063,7 @@ void Engine::RenderFrame()
         Graph->Frame();
 
     guard.lock();
-    MainEvents->CallEvent(new Event(EVENT_TYPE_FRAME_END, new IntegerEventData(FrameCount)));
+    MainEvents->CallEvent(FrameEndEvent->Get(FrameCount));
 
     // advanced statistics frame has ended //
     RenderTimer->RenderingEnd();
@@ -1105,25 +1162,18 @@ DLLEXPORT void Engine::MarkQuit()
 // ------------------------------------ //
 DLLEXPORT void Engine::Invoke(const std::function<void()>& function)
 {
-
-    RecursiveLock lock(InvokeLock);
-    InvokeQueue.push_back(function);
+    QueuedInvokes.Push(function);
 }
 
 DLLEXPORT void Engine::ProcessInvokes()
 {
+    // Invokes can queue more invokes, those are also ran now
+    QueuedInvokes.RunAll();
+}
 
-    RecursiveLock lock(InvokeLock);
-
-    while(!InvokeQueue.empty()) {
-
-        const auto& func = InvokeQueue.front();
-
-        // Recursive mutex allows the invoke to call extra invokes
-        func();
-
-        InvokeQueue.pop_front();
-    }
+DLLEXPORT InvokeQueueMetrics Engine::GetInvokeMetrics() const
+{
+    return QueuedInvokes.GetMetrics();
 }
 
 DLLEXPORT void Engine::RunOnMainThread(const std::function<void()>& function)
@@ -1285,6 +1335,16 @@ bool Engine::ParseSingleCommand(
             Logger::Get()->Info("Engine starting in non-GUI mode");
             continue;
         }
+        if(*splitval == "--parallelworlds") {
+            TickWorldsInParallel = true;
+            Logger::Get()->Info("Engine ticking worlds in parallel");
+            continue;
+        }
+        if(*splitval == "--threadedphysics") {
+            ThreadedPhysics = true;
+            Logger::Get()->Info("Engine simulating physics with all worker threads");
+            continue;
+        }
         if(*splitval == "--noleap") {
             NoLeap = true;
 
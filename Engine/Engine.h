@@ -5,6 +5,7 @@
 // ------------------------------------ //
 #include "Common/ThreadSafe.h"
 #include "Networking/CommonNetwork.h"
+#include "Threading/InvokeQueue.h"
 
 #include <functional>
 #include <inttypes.h>
@@ -89,6 +90,16 @@ public:
     //! any Get functions called in the invoke
     DLLEXPORT void Invoke(const std::function<void()>& function);
 
+    //! \brief Invoke that stores the callable directly without creating a std::function
+    template<class Callable>
+    void Invoke(Callable&& callable)
+    {
+        QueuedInvokes.Push(std::forward<Callable>(callable));
+    }
+
+    //! \returns Statistics about queued invokes and how long they waited
+    DLLEXPORT InvokeQueueMetrics GetInvokeMetrics() const;
+
     //! \brief Runs the function now if on the main thread otherwise calls Invoke
     DLLEXPORT void RunOnMainThread(const std::function<void()>& function);
 
@@ -234,6 +245,25 @@ public:
         NoGui = true;
     }
 
+    //! \brief Sets whether GameWorlds are ticked in parallel on the ThreadingManager
+    //!
+    //! Each world's Tick runs as its own task and Tick waits for all of them to finish.
+    //! Worlds that were the slowest on the previous tick are started first. Only used in
+    //! NoGui mode with more than one world as Ogre can't be used from multiple threads. Can
+    //! also be enabled with the --parallelworlds command line flag
+    //! \note There are no tick deadlines that are enforced. The measured tick times are
+    //! only kept as statistics and used for the start order, a slow world still delays the
+    //! whole engine tick
+    //! \note Worlds must not access other worlds or unsynchronized global state in their
+    //! ticks. Engine::Invoke, events, logging and sending to connections are safe
+    //! \see GameWorld::GetTickStatistics
+    DLLEXPORT void SetTickWorldsInParallel(bool parallel);
+
+    inline bool IsTickingWorldsInParallel() const
+    {
+        return TickWorldsInParallel;
+    }
+
     // Static access //
     DLLEXPORT static Engine* GetEngine();
     DLLEXPORT static Engine* Get();
@@ -262,9 +292,19 @@ protected:
     //! \note Should only be called on the client as this may break some simulations
     void _AdjustTickNumber(int tickamount, bool absolute);
 
-    //! \brief Handles InvokeQueue
+    //! \brief Runs everything in QueuedInvokes
     DLLEXPORT void ProcessInvokes();
 
+    //! \brief Ticks all GameWorlds, as separate tasks if SetTickWorldsInParallel allows it
+    //! \pre GameWorldsLock is locked
+    //! \returns True if the worlds were ticked in parallel
+    bool _TickWorlds();
+
+    //! \brief Ticks all GameWorlds as separate tasks
+    //! \pre GameWorldsLock is locked
+    //! \post WorldTickOrder has the worlds in the order they were started in
+    void _TickWorldsInParallel();
+
     //! Console input comes through this
     bool _ReceiveConsoleInput(const std::string& command);
 
@@ -287,6 +327,11 @@ protected:
     SoundDevice* Sound = nullptr;
     DataStore* Mainstore = nullptr;
     EventHandler* MainEvents = nullptr;
+
+    //! The events sent every tick and frame are reused to not allocate each time
+    std::unique_ptr<ReusableEvent<IntegerEventData>> TickEvent;
+    std::unique_ptr<ReusableEvent<IntegerEventData>> FrameBeginEvent;
+    std::unique_ptr<ReusableEvent<IntegerEventData>> FrameEndEvent;
     ScriptExecutor* MainScript = nullptr;
     ScriptConsole* MainConsole = nullptr;
     FileSystem* MainFileHandler = nullptr;
@@ -317,6 +362,9 @@ protected:
     //! Mutex that is locked when changing the worlds
     std::mutex GameWorldsLock;
 
+    //! Order of the worlds in _TickWorldsInParallel. Kept to not allocate each tick
+    std::vector<GameWorld*> WorldTickOrder;
+
     //! Mutex that is locked while NetworkHandler is used
     std::mutex NetworkHandlerLock;
 
@@ -341,6 +389,12 @@ protected:
     bool NoLeap = false;
     bool NoSTDInput = false;
 
+    //! \see SetTickWorldsInParallel
+    bool TickWorldsInParallel = false;
+
+    //! Set with --threadedphysics, makes Init set NewtonManager::SetPhysicsThreadCount to 0
+    bool ThreadedPhysics = false;
+
     //! \brief Set to true when initialized as a client
     //!
     //! Used to call client specific events
@@ -351,8 +405,7 @@ protected:
 
 
     // Invoke store //
-    RecursiveMutex InvokeLock;
-    std::list<std::function<void()>> InvokeQueue;
+    InvokeQueue QueuedInvokes;
 
     // Stores the command line before running it //
     std::vector<std::unique_ptr<std::string>> PassedCommands;
@@ -4,6 +4,10 @@
 #include "Components.h"
 
 #include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 using namespace Leviathan;
 // ------------------------------------ //
 
@@ -79,6 +83,219 @@ DLLEXPORT void PhysicsComponentState::Interpolate(
     target.SetTorque(tor);
 }
 // ------------------------------------ //
+namespace {
+
+//! Bits 0-2 are the position axes and bits 3-6 are the quaternion components
+constexpr uint8_t POSITION_STATE_ROTATION_SHIFT = 3;
+//! Set when the values are differences to a reference state
+constexpr uint8_t POSITION_STATE_IS_DELTA = 1 << 7;
+
+int32_t QuantizeValue(float value, float units)
+{
+    return static_cast<int32_t>(std::lround(value * units));
+}
+
+//! \brief Writes a zigzag encoded varint, values close to 0 take a single byte
+void WriteVarInt(sf::Packet& packet, int64_t value)
+{
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+
+    while(zigzag >= 0x80) {
+
+        packet << static_cast<uint8_t>((zigzag & 0x7f) | 0x80);
+        zigzag >>= 7;
+    }
+
+    packet << static_cast<uint8_t>(zigzag);
+}
+
+int64_t ReadVarInt(sf::Packet& packet)
+{
+    uint64_t zigzag = 0;
+
+    for(int shift = 0; shift < 64; shift += 7) {
+
+        uint8_t byte;
+
+        if(!(packet >> byte))
+            throw InvalidArgument("packet ended in the middle of a value");
+
+        zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+        if((byte & 0x80) == 0)
+            return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    }
+
+    throw InvalidArgument("packet has a too long value");
+}
+} // namespace
+
+DLLEXPORT PositionComponentState::PositionComponentState(
+    int32_t tick, const Position& position) :
+    ComponentState(tick, Position::TYPE)
+{
+    const Float3& pos = position.Members._Position;
+    const Float4& rot = position.Members._Orientation;
+
+    QuantizedPosition[0] = QuantizeValue(pos.X, POSITION_STATE_UNITS_PER_METER);
+    QuantizedPosition[1] = QuantizeValue(pos.Y, POSITION_STATE_UNITS_PER_METER);
+    QuantizedPosition[2] = QuantizeValue(pos.Z, POSITION_STATE_UNITS_PER_METER);
+
+    QuantizedRotation[0] = QuantizeValue(rot.X, ORIENTATION_STATE_UNITS);
+    QuantizedRotation[1] = QuantizeValue(rot.Y, ORIENTATION_STATE_UNITS);
+    QuantizedRotation[2] = QuantizeValue(rot.Z, ORIENTATION_STATE_UNITS);
+    QuantizedRotation[3] = QuantizeValue(rot.W, ORIENTATION_STATE_UNITS);
+
+    _UpdateMembers();
+
+    _Position.SetAllBitsInUpdated();
+    _Rotation.SetAllBitsInUpdated();
+}
+
+DLLEXPORT PositionComponentState::PositionComponentState(
+    int32_t tick, sf::Packet& packet, const PositionComponentState* reference) :
+    ComponentState(tick, Position::TYPE)
+{
+    uint8_t changed;
+
+    if(!(packet >> changed))
+        throw InvalidArgument("packet has invalid format");
+
+    const bool isDelta = (changed & POSITION_STATE_IS_DELTA) != 0;
+
+    if(isDelta && !reference)
+        throw InvalidArgument("delta update needs a reference state");
+
+    for(int i = 0; i < 3; ++i) {
+
+        const int32_t base = isDelta ? reference->QuantizedPosition[i] : 0;
+
+        if(changed & (1 << i)) {
+
+            QuantizedPosition[i] = static_cast<int32_t>(base + ReadVarInt(packet));
+            _Position.SetBit(i);
+
+        } else {
+            QuantizedPosition[i] = base;
+        }
+    }
+
+    for(int i = 0; i < 4; ++i) {
+
+        const int32_t base = isDelta ? reference->QuantizedRotation[i] : 0;
+
+        if(changed & (1 << (i + POSITION_STATE_ROTATION_SHIFT))) {
+
+            QuantizedRotation[i] = static_cast<int32_t>(base + ReadVarInt(packet));
+            _Rotation.SetBit(i);
+
+        } else {
+            QuantizedRotation[i] = base;
+        }
+    }
+
+    _UpdateMembers();
+
+    // Values copied from the reference are also valid //
+    if(isDelta) {
+
+        _Position.SetAllBitsInUpdated();
+        _Rotation.SetAllBitsInUpdated();
+    }
+}
+
+void PositionComponentState::_UpdateMembers()
+{
+    _Position.Value = Float3(QuantizedPosition[0] / POSITION_STATE_UNITS_PER_METER,
+        QuantizedPosition[1] / POSITION_STATE_UNITS_PER_METER,
+        QuantizedPosition[2] / POSITION_STATE_UNITS_PER_METER);
+
+    _Rotation.Value = Float4(QuantizedRotation[0] / ORIENTATION_STATE_UNITS,
+        QuantizedRotation[1] / ORIENTATION_STATE_UNITS,
+        QuantizedRotation[2] / ORIENTATION_STATE_UNITS,
+        QuantizedRotation[3] / ORIENTATION_STATE_UNITS);
+}
+// ------------------------------------ //
+DLLEXPORT void PositionComponentState::CreateUpdatePacket(
+    ComponentState* olderstate, sf::Packet& packet)
+{
+    const PositionComponentState* reference = nullptr;
+
+    if(olderstate && olderstate->ComponentType == ComponentType)
+        reference = static_cast<const PositionComponentState*>(olderstate);
+
+    uint8_t changed = reference ? POSITION_STATE_IS_DELTA : 0;
+
+    int64_t differences[7];
+
+    for(int i = 0; i < 3; ++i) {
+
+        differences[i] =
+            static_cast<int64_t>(QuantizedPosition[i]) -
+            (reference ? reference->QuantizedPosition[i] : 0);
+
+        // Full updates always contain everything even if it is 0 //
+        if(differences[i] != 0 || !reference)
+            changed |= 1 << i;
+    }
+
+    for(int i = 0; i < 4; ++i) {
+
+        differences[i + 3] =
+            static_cast<int64_t>(QuantizedRotation[i]) -
+            (reference ? reference->QuantizedRotation[i] : 0);
+
+        if(differences[i + 3] != 0 || !reference)
+            changed |= 1 << (i + POSITION_STATE_ROTATION_SHIFT);
+    }
+
+    packet << changed;
+
+    for(int i = 0; i < 7; ++i) {
+
+        if(changed & (1 << i))
+            WriteVarInt(packet, differences[i]);
+    }
+}
+
+DLLEXPORT bool PositionComponentState::FillMissingData(ComponentState& otherstate)
+{
+    if(otherstate.ComponentType != ComponentType)
+        return false;
+
+    const auto& other = static_cast<const PositionComponentState&>(otherstate);
+
+    for(int i = 0; i < 3; ++i) {
+
+        if(!_Position.IsBitSet(i) && other._Position.IsBitSet(i)) {
+
+            QuantizedPosition[i] = other.QuantizedPosition[i];
+            _Position.SetBit(i);
+        }
+    }
+
+    for(int i = 0; i < 4; ++i) {
+
+        if(!_Rotation.IsBitSet(i) && other._Rotation.IsBitSet(i)) {
+
+            QuantizedRotation[i] = other.QuantizedRotation[i];
+            _Rotation.SetBit(i);
+        }
+    }
+
+    _UpdateMembers();
+
+    return _Position.BitsSetUntil(2) && _Rotation.BitsSetUntil(3);
+}
+
+DLLEXPORT bool PositionComponentState::Matches(const PositionComponentState& other) const
+{
+    return std::equal(std::begin(QuantizedPosition), std::end(QuantizedPosition),
+               std::begin(other.QuantizedPosition)) &&
+           std::equal(std::begin(QuantizedRotation), std::end(QuantizedRotation),
+               std::begin(other.QuantizedRotation));
+}
+// ------------------------------------ //
 DLLEXPORT void PositionComponentState::Interpolate(
     Position& target, PositionComponentState& other, float progress)
 {
@@ -36,15 +36,55 @@ public:
     Member<Float3> Torque;
 };
 
+//! Positions are sent as multiples of 1 / POSITION_STATE_UNITS_PER_METER
+constexpr float POSITION_STATE_UNITS_PER_METER = 1024.f;
+
+//! Quaternion components are sent as multiples of 1 / ORIENTATION_STATE_UNITS
+constexpr float ORIENTATION_STATE_UNITS = 32767.f;
+
 //! \brief State for Position without a Physics
+//!
+//! The values are quantized when the state is created so that the server and the client
+//! have the exact same values for the states used as delta references
 class PositionComponentState : public ComponentState{
 public:
 
+    //! \brief Captures the current values of a Position
+    DLLEXPORT PositionComponentState(int32_t tick, const Position &position);
+
+    //! \brief Loads a state from data created by CreateUpdatePacket
+    //!
+    //! Values that weren't sent are copied from reference
+    //! \param reference The state the update was created against or null for full updates
+    //! \exception InvalidArgument if the packet is invalid or needs a reference
+    DLLEXPORT PositionComponentState(int32_t tick, sf::Packet &packet,
+        const PositionComponentState* reference);
+
+    //! \brief Writes a bitmask of the changed values and the changes
+    //!
+    //! Each changed value is written as a variable length difference to the older value, so
+    //! small movements take only a few bytes
+    DLLEXPORT void CreateUpdatePacket(ComponentState* olderstate,
+        sf::Packet &packet) override;
+
+    DLLEXPORT bool FillMissingData(ComponentState &otherstate) override;
+
+    //! \returns True if this has the same values as other
+    DLLEXPORT bool Matches(const PositionComponentState &other) const;
+
     //! \copydoc PhysicsComponentState::Interpolate
     DLLEXPORT void Interpolate(Position &target, PositionComponentState &other, float progress);
     
     Member<Float3> _Position;
     Member<Float4> _Rotation;
+
+protected:
+
+    //! \brief Sets the float members from the quantized values
+    void _UpdateMembers();
+
+    int32_t QuantizedPosition[3];
+    int32_t QuantizedRotation[4];
 };
 
 }
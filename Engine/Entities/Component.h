@@ -5,6 +5,7 @@
 #include "Define.h"
 
 #include "Common/ObjectPool.h"
+#include "Common/ObjectPoolDense.h"
 #include "Common/SFMLPackets.h"
 #include "EntityCommon.h"
 
@@ -17,7 +18,6 @@ enum class COMPONENT_TYPE : uint16_t{
     
     Position,
 
-    //! \todo Hidden as serialized data
     RenderNode,
 
     Sendable,
@@ -59,6 +59,9 @@ public:
     
     Component(const Component&) = delete;
     Component& operator =(const Component&) = delete;
+
+    //! Components can be moved so that they can be kept in DenseComponentHolder
+    Component(Component&& other) = default;
 };
 
 //! \brief Base class for all component data
@@ -98,7 +101,7 @@ public:
         //! \brief Returns true if BitNum bit is set in Updated
         inline bool IsBitSet(uint8_t BitNum = 0) const
         {
-            return (Updated & (1 << BitNum)) == 1;
+            return (Updated & (1 << BitNum)) != 0;
         }
 
         //! \brief Sets BitNum bit in Updated
@@ -172,10 +175,22 @@ public:
     
     
 
+};
+
+//! \brief Alternative ComponentHolder that keeps components packed in memory
+//!
+//! Faster to loop through than ComponentHolder but components move in memory when other
+//! components are added or removed
+//! \see ObjectPoolDense
+template<class ComponentType>
+    class DenseComponentHolder : public ObjectPoolDense<ComponentType, ObjectID>{
+public:
+
 };
 }
 
 #ifdef LEAK_INTO_GLOBAL
 using Leviathan::ComponentHolder;
+using Leviathan::DenseComponentHolder;
 #endif //LEAK_INTO_GLOBAL
 
@@ -683,6 +683,23 @@ DLLEXPORT void Sendable::ActiveConnection::CheckReceivedPackets()
         SentPackets.shrink_to_fit();
     }
 }
+
+DLLEXPORT std::shared_ptr<ComponentState> Sendable::ActiveConnection::GetDeltaReference(
+    int tick)
+{
+    if(!LastConfirmedData)
+        return nullptr;
+
+    if(tick >= LastConfirmedTickNumber + BASESENDABLE_STORED_RECEIVED_STATES - 1) {
+
+        // Data is too old and cannot be used //
+        LastConfirmedTickNumber = -1;
+        LastConfirmedData.reset();
+        return nullptr;
+    }
+
+    return LastConfirmedData;
+}
 // ------------------------------------ //
 DLLEXPORT Model::Model(
     Ogre::SceneManager* scene, Ogre::SceneNode* parent, const std::string& meshname) :
@@ -112,6 +112,13 @@ public:
         //! last confirmed
         DLLEXPORT void CheckReceivedPackets();
 
+        //! \brief Returns the state that an update for tick should be a delta against
+        //!
+        //! The client only keeps BASESENDABLE_STORED_RECEIVED_STATES states so a confirmed
+        //! state that is too old is dropped
+        //! \returns Null if a full update needs to be sent
+        DLLEXPORT std::shared_ptr<ComponentState> GetDeltaReference(int tick);
+
         //! \brief Adds a package to be checked for finalization in CheckReceivedPackages
         inline void AddSentPacket(int tick, std::shared_ptr<ComponentState> state,
             std::shared_ptr<SentNetworkThing> packet)
@@ -147,6 +154,17 @@ public:
         UpdateReceivers.push_back(std::make_shared<ActiveConnection>(connection));
     }
 
+    //! \returns True if connection is in UpdateReceivers
+    inline bool IsReceiver(const std::shared_ptr<Connection>& connection) const
+    {
+        for(const auto& receiver : UpdateReceivers) {
+            if(receiver->CorrespondingConnection == connection)
+                return true;
+        }
+
+        return false;
+    }
+
     REFERENCE_HANDLE_UNCOUNTED_TYPE(Sendable);
 
     //! Clients we have already sent a state to
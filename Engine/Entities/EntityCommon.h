@@ -13,11 +13,15 @@ using ObjectID = int32_t;
 // TODO: start using this everywhere
 constexpr ObjectID NULL_OBJECT = 0;
 
+//! Bitmask of component types an entity has. Used to match entities to system nodes
+using ComponentSignature = uint64_t;
+
 constexpr auto DEFAULT_RENDER_QUEUE = 50;
 
 } // namespace Leviathan
 
 #ifdef LEAK_INTO_GLOBAL
+using Leviathan::ComponentSignature;
 using Leviathan::NULL_OBJECT;
 using Leviathan::ObjectID;
 #endif
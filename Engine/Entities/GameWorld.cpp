@@ -1,6 +1,7 @@
 // ------------------------------------ //
 #include "GameWorld.h"
 
+#include "CommonStateObjects.h"
 #include "ScriptComponentHolder.h"
 #include "ScriptSystemWrapper.h"
 
@@ -14,6 +15,7 @@
 #include "Networking/NetworkRequest.h"
 #include "Networking/NetworkResponse.h"
 #include "Networking/NetworkServerInterface.h"
+#include "Networking/WireData.h"
 #include "Newton/PhysicalWorld.h"
 #include "Newton/PhysicsMaterialManager.h"
 #include "Rendering/GraphicalInputEntity.h"
@@ -21,6 +23,7 @@
 #include "Script/ScriptExecutor.h"
 #include "Serializers/EntitySerializer.h"
 #include "Threading/ThreadingManager.h"
+#include "TimeIncludes.h"
 
 // Camera interpolation
 #include "Generated/ComponentStates.h"
@@ -43,9 +46,15 @@
 
 #include "add_on/scriptarray/scriptarray.h"
 
+#include <algorithm>
+
 using namespace Leviathan;
 // ------------------------------------ //
 
+//! Entity snapshots sent to players are split into messages of at most this many bytes so
+//! that they fit in a single datagram
+constexpr size_t MAX_ENTITY_SNAPSHOT_SIZE = 32 * 1024;
+
 // Ray callbacks //
 static dFloat RayCallbackDataCallbackClosest(const NewtonBody* const body,
     const NewtonCollision* const shapeHit, const dFloat* const hitContact,
@@ -122,6 +131,10 @@ DLLEXPORT bool GameWorld::Init(
 
 DLLEXPORT void GameWorld::Release()
 {
+    // Physics callbacks may still be running //
+    if(_PhysicalWorld)
+        _PhysicalWorld->WaitForSimulation();
+
     _DoSystemsRelease();
 
     (*WorldDestroyed) = true;
@@ -368,8 +381,7 @@ DLLEXPORT Ogre::Ray GameWorld::CastRayFromCamera(float x, float y) const
 DLLEXPORT bool GameWorld::ShouldPlayerReceiveEntity(
     Position& atposition, Connection& connection)
 {
-
-    return true;
+    return Interest.IsPositionInRange(&connection, atposition.Members._Position);
 }
 
 DLLEXPORT bool GameWorld::IsConnectionInWorld(Connection& connection) const
@@ -416,74 +428,20 @@ DLLEXPORT void GameWorld::SetPlayerReceiveWorld(std::shared_ptr<ConnectedPlayer>
     // Update the position data //
     UpdatePlayersPositionData(*ply);
 
-    // Start sending initial update //
+    // Send the current state of the world. Entities that aren't in range are sent once
+    // they become relevant //
     Logger::Get()->Info(
         "Starting to send " + Convert::ToString(Entities.size()) + " to player");
 
-    // Now we can queue all objects for sending //
-    // TODO: make sure that all objects are sent
-    // TODO: redo this inside the world tick
-    // ThreadingManager::Get()->QueueTask(
-    //     new RepeatCountedTask(std::bind<void>([](
-    //                 std::shared_ptr<Connection> connection,
-    //                 std::shared_ptr<ConnectedPlayer> processingobject, GameWorld* world,
-    //                 std::shared_ptr<bool> WorldInvalid)
-    //             -> void
-    //     {
-    //         // Get the next object //
-    //         RepeatCountedTask* task =
-    //             dynamic_cast<RepeatCountedTask*>(TaskThread::GetThreadSpecificThreadObject()->
-    //             QuickTaskAccess.get());
-
-    //         LEVIATHAN_ASSERT(task, "wrong type passed to our task");
-
-    //         size_t num = task->GetRepeatCount();
-
-    //         if(*WorldInvalid){
-
-    //         taskstopprocessingobjectsforinitialsynclabel:
-
-    //             // Stop processing //
-    //             task->StopRepeating();
-    //             return;
-    //         }
-
-    //         // Stop if out of bounds //
-    //         if(num >= world->Entities.size()){
-
-    //             goto taskstopprocessingobjectsforinitialsynclabel;
-    //         }
-
-    //         // Get the object //
-    //         auto tosend = world->Entities[num];
-
-    //         // Skip if shouldn't send //
-    //         try{
-
-    //             auto& position = world->GetComponent<Position>(tosend);
-
-    //             if(!world->ShouldPlayerReceiveObject(position, *connection)){
-
-    //                 return;
-    //             }
-
-    //         } catch(const NotFound&){
-
-    //             // No position, should probably always send //
-    //         }
-
-
-    //         // Send it //
-    //         world->SendObjectToConnection(guard, tosend, connection);
-
-    //         return;
-
-    //     }, ply->GetConnection(), ply, this, WorldDestroyed), Entities.size()));
+    _SendMissingEntitiesToConnection(ply->GetConnection());
 }
 
 DLLEXPORT void GameWorld::SendToAllPlayers(
     const std::shared_ptr<NetworkResponse>& response, RECEIVE_GUARANTEE guarantee) const
 {
+    // The response is only serialized once for all the players //
+    std::shared_ptr<const sf::Packet> serialized;
+
     // Notify everybody that an entity has been destroyed //
     for(auto iter = ReceivingPlayers.begin(); iter != ReceivingPlayers.end(); ++iter) {
 
@@ -494,12 +452,17 @@ DLLEXPORT void GameWorld::SendToAllPlayers(
             continue;
         }
 
-        safe->SendPacketToConnection(response, guarantee);
+        if(!serialized)
+            serialized = WireData::SerializeResponseData(*response);
+
+        safe->SendPacketToConnection(response, serialized, guarantee);
     }
 }
 // ------------------------------------ //
 DLLEXPORT void GameWorld::Tick(int currenttick)
 {
+    const auto tickStart = Time::GetTimeMicro64();
+
     TickNumber = currenttick;
 
     // Apply queued packets //
@@ -513,11 +476,12 @@ DLLEXPORT void GameWorld::Tick(int currenttick)
 
     // Remove closed player connections //
 
-    for(auto iter = ReceivingPlayers.begin(); iter != ReceivingPlayers.end(); ++iter) {
+    for(auto iter = ReceivingPlayers.begin(); iter != ReceivingPlayers.end();) {
 
         if(!(*iter)->GetConnection()->IsValidForSend()) {
 
-            DEBUG_BREAK;
+            Interest.RemoveViewer((*iter)->GetConnection().get());
+            iter = ReceivingPlayers.erase(iter);
 
         } else {
 
@@ -532,8 +496,20 @@ DLLEXPORT void GameWorld::Tick(int currenttick)
         // if(IsOnServer) {
 
         _ApplyEntityUpdatePackets();
-        if(_PhysicalWorld)
-            _PhysicalWorld->SimulateWorldFixed(TICKSPEED, 2);
+
+        if(_PhysicalWorld) {
+
+            if(OverlapPhysicsUpdate) {
+
+                // Tick systems wait for this before touching physics data //
+                _PhysicalWorld->BeginSimulateWorldFixed(TICKSPEED, 2);
+                PlayerPositionsUpdatePending = IsOnServer;
+
+            } else {
+
+                _PhysicalWorld->SimulateWorldFixed(TICKSPEED, 2);
+            }
+        }
 
         // } else {
 
@@ -541,29 +517,55 @@ DLLEXPORT void GameWorld::Tick(int currenttick)
         // }
     }
 
+    // Players may have moved //
+    if(IsOnServer && !PlayerPositionsUpdatePending) {
+
+        for(auto& player : ReceivingPlayers)
+            UpdatePlayersPositionData(*player);
+    }
+
     TickInProgress = true;
 
     _RunTickSystems();
 
+    // In case no system needed the physics results //
+    _WaitForPhysicsUpdate();
+
     TickInProgress = false;
 
-    // Sendable objects may need something to be done //
+    // Sendable objects are sent by SendableSystem as one of the tick systems //
 
-    if(IsOnServer) {
+    if(!IsOnServer) {
 
-        // Notify new entities //
-        // DEBUG_BREAK;
+        // TODO: direct control objects
+        // _ReceivedSystem.Run(ComponentReceived.GetIndex(), *this);
+    }
 
-        // Skip if not tick that will be stored //
-        // if(TickNumber % WORLD_OBJECT_UPDATE_CLIENTS_INTERVAL == 0){
+    _RecordTickDuration(Time::GetTimeMicro64() - tickStart);
+}
 
-        //     _SendableSystem.Run(ComponentSendable.GetIndex(), *this);
-        // }
+void GameWorld::_RecordTickDuration(int64_t microseconds)
+{
+    TickStatistics.LastTickMicroseconds = microseconds;
 
-    } else {
+    if(microseconds > TickStatistics.MaxTickMicroseconds)
+        TickStatistics.MaxTickMicroseconds = microseconds;
 
-        // TODO: direct control objects
-        // _ReceivedSystem.Run(ComponentReceived.GetIndex(), *this);
+    if(microseconds <= TICKSPEED * 1000) {
+
+        TickStatistics.ConsecutiveMissedDeadlines = 0;
+        return;
+    }
+
+    ++TickStatistics.MissedDeadlines;
+
+    // Only the start of a slow period is reported to not flood the log //
+    if(++TickStatistics.ConsecutiveMissedDeadlines == 1) {
+
+        LOG_WARNING("GameWorld(" + std::to_string(ID) + "): tick " +
+                    std::to_string(TickNumber) + " took " +
+                    std::to_string(microseconds / 1000) + "ms which is over the " +
+                    std::to_string(TICKSPEED) + "ms deadline");
     }
 }
 // ------------------------------------ //
@@ -604,6 +606,8 @@ DLLEXPORT void GameWorld::_ResetSystems()
 
 DLLEXPORT void GameWorld::_ResetOrReleaseComponents()
 {
+    EntityComponentSignatures.clear();
+
     // Skip double Release
     if(!pimpl)
         return;
@@ -615,6 +619,10 @@ DLLEXPORT void GameWorld::_ResetOrReleaseComponents()
         iter->second->ReleaseAllComponents();
     }
 }
+
+DLLEXPORT void GameWorld::_OnComponentCreated(ObjectID id, COMPONENT_TYPE type) {}
+
+DLLEXPORT void GameWorld::_OnComponentDestroyed(ObjectID id, COMPONENT_TYPE type) {}
 // ------------------------------------ //
 DLLEXPORT void GameWorld::RunFrameRenderSystems(int tick, int timeintick)
 {
@@ -627,6 +635,10 @@ DLLEXPORT void GameWorld::RunFrameRenderSystems(int tick, int timeintick)
 
 DLLEXPORT void GameWorld::_RunTickSystems()
 {
+    // Script systems can access anything //
+    if(!pimpl->RegisteredScriptSystems.empty())
+        _WaitForPhysicsUpdate();
+
     // We are responsible for script systems //
     for(auto iter = pimpl->RegisteredScriptSystems.begin();
         iter != pimpl->RegisteredScriptSystems.end(); ++iter) {
@@ -634,6 +646,25 @@ DLLEXPORT void GameWorld::_RunTickSystems()
         iter->second->Run();
     }
 }
+
+DLLEXPORT void GameWorld::_WaitForPhysicsUpdate()
+{
+    if(_PhysicalWorld)
+        _PhysicalWorld->WaitForSimulation();
+
+    if(PlayerPositionsUpdatePending) {
+
+        PlayerPositionsUpdatePending = false;
+
+        for(auto& player : ReceivingPlayers)
+            UpdatePlayersPositionData(*player);
+    }
+}
+
+DLLEXPORT std::string GameWorld::GetTickSystemTimingReport() const
+{
+    return TickSystemScheduler.GetTimingReport();
+}
 // ------------------------------------ //
 DLLEXPORT int GameWorld::GetTickNumber() const
 {
@@ -669,7 +700,7 @@ DLLEXPORT ObjectID GameWorld::CreateEntity()
 {
     auto id = static_cast<ObjectID>(IDFactory::GetID());
 
-    Entities.push_back(id);
+    _AddEntity(id);
 
     return id;
 }
@@ -692,6 +723,10 @@ DLLEXPORT void GameWorld::NotifyEntityCreate(ObjectID id)
 
         LEVIATHAN_ASSERT(issendable, "GetComponent didn't throw");
 
+        // Entities without a position are sent to everyone //
+        auto* position =
+            static_cast<Position*>(std::get<0>(GetComponent(id, Position::TYPE)));
+
         auto end = ReceivingPlayers.end();
         for(auto iter = ReceivingPlayers.begin(); iter != end; ++iter) {
 
@@ -702,6 +737,9 @@ DLLEXPORT void GameWorld::NotifyEntityCreate(ObjectID id)
                 continue;
             }
 
+            if(position && !ShouldPlayerReceiveEntity(*position, *safe))
+                continue;
+
             // TODO: pass issendable here to avoid an extra lookup
             if(!SendEntityToConnection(id, safe)) {
 
@@ -716,7 +754,7 @@ DLLEXPORT void GameWorld::NotifyEntityCreate(ObjectID id)
     } else {
 
         // Clients register received objects here //
-        Entities.push_back(id);
+        _AddEntity(id);
     }
 }
 // ------------------------------------ //
@@ -724,7 +762,10 @@ DLLEXPORT void GameWorld::ClearEntities()
 {
     // Release objects //
     Entities.clear();
+    EntityIndices.clear();
     Parents.clear();
+    ChildRelations.clear();
+    EntityChildren.clear();
     // This shouldn't be used all that much so release the memory
     Parents.shrink_to_fit();
 
@@ -735,6 +776,8 @@ DLLEXPORT void GameWorld::ClearEntities()
     // Runs Release on components that need it
     _ResetOrReleaseComponents();
 
+    Interest.ClearEntities();
+
     // Notify everybody that all entities are discarded //
     for(auto iter = ReceivingPlayers.begin(); iter != ReceivingPlayers.end(); ++iter) {
 
@@ -770,16 +813,8 @@ DLLEXPORT void GameWorld::DestroyEntity(ObjectID id)
         throw InvalidState(
             "Cannot DestroyEntity while ticking. Use QueueDestroyEntity instead");
 
-    auto end = Entities.end();
-    for(auto iter = Entities.begin(); iter != end; ++iter) {
-
-        if(*iter == id) {
-
-            Entities.erase(iter);
-            _DoDestroy(id);
-            return;
-        }
-    }
+    if(_RemoveEntity(id))
+        _DoDestroy(id);
 }
 
 DLLEXPORT void GameWorld::QueueDestroyEntity(ObjectID id)
@@ -806,93 +841,162 @@ void GameWorld::_HandleDelayedDelete()
         return;
     }
 
-    Lock lock(DeleteMutex);
+    std::vector<ObjectID> destroyed;
 
-    // Return right away if no objects to delete //
-    if(DelayedDeleteIDS.empty())
-        return;
+    {
+        Lock lock(DeleteMutex);
 
-    // Search all objects and find the ones that need to be deleted //
-    for(auto iter = Entities.begin(); iter != Entities.end();) {
+        // Return right away if no objects to delete //
+        if(DelayedDeleteIDS.empty())
+            return;
 
-        // Check does id match any //
-        auto curid = *iter;
-        bool delthis = false;
+        // Not locked while destroying so that destroy callbacks can queue more //
+        destroyed.swap(DelayedDeleteIDS);
+    }
 
-        for(auto iterids = DelayedDeleteIDS.begin(); iterids != DelayedDeleteIDS.end();) {
+    // Ids that are queued multiple times or were already destroyed as children are skipped
+    for(auto id : destroyed) {
 
-            if(*iterids == curid) {
-                // Remove this as it will get deleted //
-                delthis = true;
-                DelayedDeleteIDS.erase(iterids);
-                break;
+        if(_RemoveEntity(id))
+            _DoDestroy(id);
+    }
+}
 
-            } else {
-                ++iterids;
-            }
-        }
+void GameWorld::_DoDestroy(ObjectID id)
+{
+    // The parent no longer has this as a child //
+    _RemoveChildRelation(id);
 
-        if(delthis) {
+    // Descendants are destroyed without recursion as hierarchies can be deep //
+    std::vector<ObjectID> pending;
+    ObjectID current = id;
 
-            _DoDestroy(curid);
-            iter = Entities.erase(iter);
+    while(true) {
 
-            // Check for end //
-            if(DelayedDeleteIDS.empty())
-                return;
+        LOG_INFO("GameWorld destroying object " + Convert::ToString(current));
 
-        } else {
-            ++iter;
+        if(IsOnServer)
+            _ReportEntityDestruction(current);
+
+        // TODO: find a better way to do this
+        DestroyAllIn(current);
+
+        Interest.RemoveEntity(current);
+
+        // Parent destroy children //
+        auto children = EntityChildren.find(current);
+
+        if(children != EntityChildren.end()) {
+
+            // Reversed so that the first child is destroyed first //
+            const auto& childIds = children->second;
+
+            for(auto iter = childIds.rbegin(); iter != childIds.rend(); ++iter) {
+
+                const auto relation = ChildRelations.find(*iter);
+
+                _RemoveParentsEntry(relation->second.ParentsIndex);
+                ChildRelations.erase(relation);
+
+                // Loops in the hierarchy end once they reach an already removed entity //
+                if(_RemoveEntity(*iter))
+                    pending.push_back(*iter);
+            }
+
+            EntityChildren.erase(children);
         }
+
+        if(pending.empty())
+            return;
+
+        current = pending.back();
+        pending.pop_back();
     }
 }
 
-void GameWorld::_DoDestroy(ObjectID id)
+void GameWorld::_AddEntity(ObjectID id)
+{
+    if(EntityIndices.emplace(id, Entities.size()).second)
+        Entities.push_back(id);
+}
+
+bool GameWorld::_RemoveEntity(ObjectID id)
 {
+    const auto iter = EntityIndices.find(id);
+
+    if(iter == EntityIndices.end())
+        return false;
 
-    Logger::Get()->Info("GameWorld destroying object " + Convert::ToString(id));
+    const auto index = iter->second;
+    EntityIndices.erase(iter);
 
-    if(IsOnServer)
-        _ReportEntityDestruction(id);
+    if(index + 1 != Entities.size()) {
 
-    // TODO: find a better way to do this
-    DestroyAllIn(id);
+        Entities[index] = Entities.back();
+        EntityIndices[Entities[index]] = index;
+    }
 
-    // Parent destroy children //
-    // We need to support recursively parented entities
-    for(size_t i = 0; i < Parents.size();) {
+    Entities.pop_back();
+    return true;
+}
 
-        if(std::get<0>(Parents[i]) == id) {
+void GameWorld::_RemoveChildRelation(ObjectID child)
+{
+    const auto iter = ChildRelations.find(child);
 
-            const auto childId = std::get<1>(Parents[i]);
+    if(iter == ChildRelations.end())
+        return;
 
-            // Remove it //
-            std::swap(Parents[i], Parents[Parents.size() - 1]);
-            Parents.pop_back();
+    const auto relation = iter->second;
+    const auto parent = std::get<0>(Parents[relation.ParentsIndex]);
 
-            // And then destroy //
-            DestroyEntity(childId);
+    _RemoveParentsEntry(relation.ParentsIndex);
+    ChildRelations.erase(iter);
 
-            // To support recursively parented we go back to the start to scan again
-            i = 0;
+    auto children = EntityChildren.find(parent);
+    auto& siblings = children->second;
 
-        } else if(std::get<1>(Parents[i]) == id) {
-            // Child has been destroyed //
-            // Remove it //
-            std::swap(Parents[i], Parents[Parents.size() - 1]);
-            Parents.pop_back();
+    if(relation.SiblingIndex + 1 != siblings.size()) {
 
-        } else {
-            ++i;
-        }
+        siblings[relation.SiblingIndex] = siblings.back();
+        ChildRelations[siblings[relation.SiblingIndex]].SiblingIndex = relation.SiblingIndex;
     }
+
+    siblings.pop_back();
+
+    if(siblings.empty())
+        EntityChildren.erase(children);
+}
+
+void GameWorld::_RemoveParentsEntry(size_t index)
+{
+    if(index + 1 != Parents.size()) {
+
+        Parents[index] = Parents.back();
+        ChildRelations[std::get<1>(Parents[index])].ParentsIndex = index;
+    }
+
+    Parents.pop_back();
 }
 // ------------------------------------ //
 DLLEXPORT void GameWorld::SetEntitysParent(ObjectID child, ObjectID parent)
 {
+    _RemoveChildRelation(child);
 
+    auto& siblings = EntityChildren[parent];
+
+    ChildRelations[child] = ChildRelation{Parents.size(), siblings.size()};
+
+    siblings.push_back(child);
     Parents.push_back(std::make_tuple(parent, child));
 }
+
+DLLEXPORT void GameWorld::AddEntityWithID(ObjectID id)
+{
+    IDFactory::Get()->SkipIDsUpTo(id);
+
+    _AddEntity(id);
+}
 // ------------------------------------ //
 DLLEXPORT std::tuple<void*, bool> GameWorld::GetComponent(ObjectID id, COMPONENT_TYPE type)
 {
@@ -959,6 +1063,23 @@ DLLEXPORT bool GameWorld::GetAddedForScriptDefined(const std::string& name,
     return true;
 }
 
+DLLEXPORT const std::vector<COMPONENT_TYPE>& GameWorld::GetSerializableComponentTypes() const
+{
+    static const std::vector<COMPONENT_TYPE> empty;
+    return empty;
+}
+
+DLLEXPORT bool GameWorld::SerializeComponent(
+    ObjectID id, COMPONENT_TYPE type, sf::Packet& packet)
+{
+    return false;
+}
+
+DLLEXPORT bool GameWorld::DeserializeComponent(
+    ObjectID id, COMPONENT_TYPE type, sf::Packet& packet)
+{
+    return false;
+}
 // ------------------------------------ //
 DLLEXPORT void GameWorld::_DoSystemsInit()
 {
@@ -1021,6 +1142,11 @@ DLLEXPORT void GameWorld::SetWorldPhysicsFrozenState(bool frozen)
         RECEIVE_GUARANTEE::Critical);
 }
 
+DLLEXPORT void GameWorld::SetOverlapPhysicsUpdate(bool overlap)
+{
+    OverlapPhysicsUpdate = overlap;
+}
+
 DLLEXPORT RayCastHitEntity* GameWorld::CastRayGetFirstHit(const Float3& from, const Float3& to)
 {
     // Create a data object for the ray cast //
@@ -1079,22 +1205,144 @@ void GameWorld::UpdatePlayersPositionData(ConnectedPlayer& ply)
     // Get the position for this player in this world //
     ObjectID id = ply.GetPositionInWorld(this);
 
-    // Player is using a static position at (0, 0, 0) //
-    if(id == 0)
+    // Player has no position and receives everything //
+    if(id == 0) {
+
+        if(Interest.HasViewer(ply.GetConnection().get())) {
+
+            Interest.RemoveViewer(ply.GetConnection().get());
+            _SendMissingEntitiesToConnection(ply.GetConnection());
+        }
+
         return;
+    }
 
     try {
 
         auto& position = GetComponent<Position>(id);
 
-        (void)position.Members._Position;
+        if(Interest.HasViewer(ply.GetConnection().get())) {
+
+            Interest.SetViewer(ply.GetConnection().get(), position.Members._Position);
+            return;
+        }
+
+        // The player has received everything so far. The entities that are out of range
+        // are destroyed on the client once they are reported as left //
+        std::vector<ObjectID> received;
+
+        for(auto entity : Entities) {
+
+            auto* sendable =
+                static_cast<Sendable*>(std::get<0>(GetComponent(entity, Sendable::TYPE)));
+
+            if(sendable && sendable->IsReceiver(ply.GetConnection()))
+                received.push_back(entity);
+        }
+
+        Interest.SetViewer(ply.GetConnection().get(), position.Members._Position, &received);
 
     } catch(const NotFound&) {
 
         // Player has invalid position //
         Logger::Get()->Warning("Player position entity has no Position component");
+
+        if(Interest.HasViewer(ply.GetConnection().get())) {
+
+            Interest.RemoveViewer(ply.GetConnection().get());
+            _SendMissingEntitiesToConnection(ply.GetConnection());
+        }
     }
 }
+
+void GameWorld::_SendMissingEntitiesToConnection(const std::shared_ptr<Connection>& connection)
+{
+    std::vector<ObjectID> missing;
+
+    for(auto id : Entities) {
+
+        auto* sendable = static_cast<Sendable*>(std::get<0>(GetComponent(id, Sendable::TYPE)));
+
+        if(!sendable || sendable->IsReceiver(connection))
+            continue;
+
+        auto* position = static_cast<Position*>(std::get<0>(GetComponent(id, Position::TYPE)));
+
+        if(position && !ShouldPlayerReceiveEntity(*position, *connection))
+            continue;
+
+        missing.push_back(id);
+    }
+
+    // All of the entities are sent in as few messages as possible //
+    auto serializer = Engine::Get()->GetEntitySerializer();
+
+    for(size_t first = 0; first < missing.size();) {
+
+        sf::Packet packet;
+
+        const auto written =
+            serializer->SaveEntities(*this, missing, first, packet, MAX_ENTITY_SNAPSHOT_SIZE);
+
+        if(written == 0) {
+
+            Logger::Get()->Error("GameWorld: failed to serialize entity " +
+                                 Convert::ToString(missing[first]) + " for a player");
+            return;
+        }
+
+        for(size_t i = first; i < first + written; ++i)
+            GetComponent<Sendable>(missing[i]).AddConnectionToReceivers(connection);
+
+        connection->SendPacketToConnection(
+            std::make_shared<ResponseEntityCreation>(0, ID, std::move(packet)),
+            RECEIVE_GUARANTEE::Critical);
+
+        first += written;
+    }
+}
+
+DLLEXPORT void GameWorld::HandleEntityRelevanceChange(
+    const InterestManager::RelevanceChange& change, Sendable& sendable)
+{
+    std::shared_ptr<Connection> connection;
+
+    for(const auto& player : ReceivingPlayers) {
+
+        if(player->GetConnection().get() == change.ViewerConnection) {
+
+            connection = player->GetConnection();
+            break;
+        }
+    }
+
+    if(!connection || !connection->IsValidForSend())
+        return;
+
+    const auto received = std::find_if(sendable.UpdateReceivers.begin(),
+        sendable.UpdateReceivers.end(), [&](const auto& receiver) {
+            return receiver->CorrespondingConnection == connection;
+        });
+
+    if(change.Entered) {
+
+        // Players that had no position when this was created already have it //
+        if(received == sendable.UpdateReceivers.end())
+            SendEntityToConnection(change.Entity, connection);
+
+        return;
+    }
+
+    if(received == sendable.UpdateReceivers.end())
+        return;
+
+    // Left the range, this is created again when it becomes relevant again //
+    sendable.UpdateReceivers.erase(received);
+
+    connection->SendPacketToConnection(
+        std::make_shared<ResponseEntityDestruction>(0, ID, change.Entity),
+        RECEIVE_GUARANTEE::Critical);
+}
 // ------------------------------------ //
 DLLEXPORT bool GameWorld::SendEntityToConnection(
     ObjectID id, std::shared_ptr<Connection> connection)
@@ -1103,22 +1351,19 @@ DLLEXPORT bool GameWorld::SendEntityToConnection(
 
     sf::Packet packet;
 
-    DEBUG_BREAK;
-    // try {
-    //     if (!Engine::Get()->GetEntitySerializer()->CreatePacketForConnection(this, id,
-    //         GetComponent<Sendable>(id), packet, *connection))
-    //     {
-    //         return false;
-    //     }
-    // }
-    // catch (const NotFound&) {
-    //     return false;
-    // }
+    try {
+        if(!Engine::Get()->GetEntitySerializer()->CreatePacketForConnection(
+               this, id, GetComponent<Sendable>(id), packet, connection)) {
+            return false;
+        }
+    } catch(const NotFound&) {
+        return false;
+    }
 
     // Then gather all sorts of other stuff to make an response //
     return connection
                    ->SendPacketToConnection(
-                       std::make_shared<ResponseEntityCreation>(0, id, std::move(packet)),
+                       std::make_shared<ResponseEntityCreation>(0, ID, std::move(packet)),
                        RECEIVE_GUARANTEE::Critical)
                    .get() ?
                true :
@@ -1139,21 +1384,25 @@ void GameWorld::_ApplyInitialEntityPackets()
 
     auto serializer = Engine::Get()->GetEntitySerializer();
 
+    std::vector<ObjectID> created;
+
     for(auto& response : InitialEntityPackets) {
 
         LEVIATHAN_ASSERT(response->GetType() == NETWORK_RESPONSE_TYPE::EntityCreation,
             "invalid type in InitialEntityPackets");
 
-        ObjectID id = 0;
-
-        DEBUG_BREAK;
-        // serializer->DeserializeWholeEntityFromPacket(this, id,
-        //     static_cast<ResponseEntityCreation*>(response.get())->InitialEntity);
-
-        if(id < 1) {
+        // A single message can contain many entities when we started receiving the world //
+        if(!serializer->LoadWorld(*this,
+               static_cast<ResponseEntityCreation*>(response.get())->InitialEntity,
+               &created)) {
 
             Logger::Get()->Error("GameWorld: handle initial packet: failed to create entity");
         }
+
+        for(auto id : created)
+            NotifyEntityCreate(id);
+
+        created.clear();
     }
 
     InitialEntityPackets.clear();
@@ -1161,7 +1410,7 @@ void GameWorld::_ApplyInitialEntityPackets()
 
 DLLEXPORT void GameWorld::HandleEntityUpdatePacket(std::shared_ptr<NetworkResponse> message)
 {
-    if(message->GetType() == NETWORK_RESPONSE_TYPE::EntityUpdate)
+    if(message->GetType() != NETWORK_RESPONSE_TYPE::EntityUpdate)
         return;
 
     EntityUpdatePackets.push_back(message);
@@ -1169,42 +1418,74 @@ DLLEXPORT void GameWorld::HandleEntityUpdatePacket(std::shared_ptr<NetworkRespon
 
 void GameWorld::_ApplyEntityUpdatePackets()
 {
-
-    auto serializer = Engine::Get()->GetEntitySerializer();
-
     for(auto& response : EntityUpdatePackets) {
 
         // Data cannot be NULL here //
         ResponseEntityUpdate* data = static_cast<ResponseEntityUpdate*>(response.get());
 
-        bool found = false;
+        Received* received;
+
+        try {
+            received = &GetComponent<Received>(data->EntityID);
+
+        } catch(const NotFound&) {
 
-        // Just check if the entity is created/exists //
-        for(auto iter = Entities.begin(); iter != Entities.end(); ++iter) {
+            // It hasn't been created yet //
+            Logger::Get()->Warning("GameWorld(" + Convert::ToString(ID) + "): has no entity " +
+                                   Convert::ToString(data->EntityID) +
+                                   " with Received, ignoring an update packet");
+            continue;
+        }
 
-            if((*iter) == data->EntityID) {
+        uint16_t type;
+        data->UpdateData >> type;
 
-                found = true;
+        if(!data->UpdateData || static_cast<COMPONENT_TYPE>(type) != Position::TYPE) {
 
-                // Apply the update //
-                DEBUG_BREAK;
-                // if(!serializer->ApplyUpdateFromPacket(this, guard, data->EntityID,
-                //         data->TickNumber, data->ReferenceTick, data->UpdateData))
-                // {
-                //     Logger::Get()->Warning("GameWorld("+Convert::ToString(ID)+"): "
-                //         "applying update to entity " +
-                //         Convert::ToString(data->EntityID) + " failed");
-                // }
+            Logger::Get()->Warning("GameWorld(" + Convert::ToString(ID) +
+                                   "): update packet has an unknown component type");
+            continue;
+        }
 
-                break;
+        // Find the state the server used as the delta reference //
+        const PositionComponentState* reference = nullptr;
+
+        if(data->ReferenceTick != -1) {
+
+            for(const auto& stored : received->ClientStateBuffer) {
+
+                if(stored.Tick == data->ReferenceTick &&
+                    stored.DeltaData->ComponentType == Position::TYPE) {
+
+                    reference = static_cast<const PositionComponentState*>(stored.DirectData);
+                    break;
+                }
+            }
+
+            if(!reference) {
+
+                Logger::Get()->Warning("GameWorld(" + Convert::ToString(ID) +
+                                       "): no reference state for tick " +
+                                       Convert::ToString(data->ReferenceTick) +
+                                       ", ignoring an update packet");
+                continue;
             }
         }
 
-        if(!found) {
-            // It hasn't been created yet //
-            Logger::Get()->Warning("GameWorld(" + Convert::ToString(ID) + "): has no entity " +
-                                   Convert::ToString(data->EntityID) +
-                                   ", ignoring an update packet");
+        try {
+            auto state = std::make_shared<PositionComponentState>(
+                data->TickNumber, data->UpdateData, reference);
+
+            received->ClientStateBuffer.push_back(
+                Received::StoredState(state, data->TickNumber, state.get()));
+            received->Marked = true;
+
+        } catch(const InvalidArgument& e) {
+
+            Logger::Get()->Warning("GameWorld(" + Convert::ToString(ID) +
+                                   "): applying update to entity " +
+                                   Convert::ToString(data->EntityID) + " failed: ");
+            e.PrintToLog();
         }
     }
 
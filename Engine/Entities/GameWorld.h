@@ -6,9 +6,12 @@
 #include "Common/ReferenceCounted.h"
 #include "Common/ThreadSafe.h"
 #include "Component.h"
+#include "InterestManager.h"
 #include "Networking/CommonNetwork.h"
+#include "SystemScheduler.h"
 
 #include <type_traits>
+#include <unordered_map>
 
 #define PHYSICS_BASE_GRAVITY -9.81f
 
@@ -18,6 +21,10 @@ class CScriptArray;
 class asIScriptObject;
 class asIScriptFunction;
 
+namespace sf {
+class Packet;
+}
+
 namespace Ogre {
 
 class CompositorWorkspace;
@@ -44,6 +51,21 @@ struct ComponentTypeInfo {
     int AngelScriptType;
 };
 
+//! \brief How long the ticks of a GameWorld have taken
+struct WorldTickStatistics {
+
+    //! Duration of the latest tick in microseconds
+    int64_t LastTickMicroseconds = 0;
+
+    int64_t MaxTickMicroseconds = 0;
+
+    //! Number of ticks that have taken longer than TICKSPEED
+    uint64_t MissedDeadlines = 0;
+
+    //! Number of the latest ticks in a row that have taken longer than TICKSPEED
+    uint32_t ConsecutiveMissedDeadlines = 0;
+};
+
 
 #define WORLD_CLOCK_SYNC_PACKETS 12
 #define WORLD_CLOCK_SYNC_ALLOW_FAILS 2
@@ -168,17 +190,41 @@ public:
     //! \brief Destroys an entity and all of its components
     //! \warning This destroyes the entity immediately. If called during a system update this
     //! will cause issues as required components may be destroyed and cached components will
-    //! only be updated at the start of next tick. So use QueueDestroyEntity instead. \todo
-    //! Make this less expensive
+    //! only be updated at the start of next tick. So use QueueDestroyEntity instead.
     DLLEXPORT void DestroyEntity(ObjectID id);
 
     //! \brief Deletes an entity during the next tick
     DLLEXPORT void QueueDestroyEntity(ObjectID id);
 
     //! \brief Makes child entity be deleted when parent is deleted
+    //!
+    //! An entity can only have one parent, calling this again replaces the parent
     //! \note Doesn't check that the entitiy ids exist
     DLLEXPORT void SetEntitysParent(ObjectID child, ObjectID parent);
 
+    //! \brief Adds an entity with an id that was created elsewhere, for example in a save
+    //! \post CreateEntity won't return id
+    DLLEXPORT void AddEntityWithID(ObjectID id);
+
+    //! \brief Returns all the entities this world keeps track of
+    //! \note The order changes when entities are destroyed
+    inline const std::vector<ObjectID>& GetEntities() const
+    {
+        return Entities;
+    }
+
+    //! \returns True if this world keeps track of id and it hasn't been destroyed
+    inline bool IsEntityAlive(ObjectID id) const
+    {
+        return EntityIndices.find(id) != EntityIndices.end();
+    }
+
+    //! \brief Returns the parent and child pairs set with SetEntitysParent
+    inline const std::vector<std::tuple<ObjectID, ObjectID>>& GetEntityParents() const
+    {
+        return Parents;
+    }
+
     //! \brief Notifies others that we have created a new entity
     //! \note This is called after all components are set up and it is ready to be sent to
     //! other players
@@ -268,6 +314,23 @@ public:
     DLLEXPORT bool GetAddedForScriptDefined(const std::string& name,
         std::vector<std::tuple<asIScriptObject*, ObjectID, ScriptComponentHolder*>>& result);
 
+    //! \brief Returns the component types that SerializeComponent can write
+    //!
+    //! EntitySerializer saves entities by trying all of these in order
+    DLLEXPORT virtual const std::vector<COMPONENT_TYPE>& GetSerializableComponentTypes() const;
+
+    //! \brief Writes the data of an entity's component of type to packet
+    //! \returns False if the entity doesn't have the component or the type can't be
+    //! serialized
+    DLLEXPORT virtual bool SerializeComponent(
+        ObjectID id, COMPONENT_TYPE type, sf::Packet& packet);
+
+    //! \brief Creates a component for an entity from data written by SerializeComponent
+    //! \returns False if the type is unknown and nothing was read
+    //! \exception InvalidArgument if the packet doesn't have all the data
+    DLLEXPORT virtual bool DeserializeComponent(
+        ObjectID id, COMPONENT_TYPE type, sf::Packet& packet);
+
     //! \brief Sets the entity that acts as a camera.
     //!
     //! The entity needs atleast Position and Camera components
@@ -295,25 +358,67 @@ public:
         return _PhysicalWorld.get();
     }
 
+    //! \returns True if this is a master world on a server
+    inline bool IsServerWorld() const
+    {
+        return IsOnServer;
+    }
+
     //! \todo Synchronize this over the network
     DLLEXPORT void SetWorldPhysicsFrozenState(bool frozen);
 
+    //! \brief Sets whether physics is simulated while tick systems run
+    //!
+    //! When enabled the physics update is started on a worker thread and systems that don't
+    //! access physics data run at the same time. Tick systems that access Physics, Position
+    //! or Sendable wait for the simulation to finish first
+    //! \note Physics callbacks can then run at the same time as tick systems
+    //! \note Every tick system of StandardWorld accesses Position or Sendable so this only
+    //! helps worlds that add systems which don't. Received entity updates are still applied
+    //! before the simulation is started
+    DLLEXPORT void SetOverlapPhysicsUpdate(bool overlap);
+
+    inline bool IsOverlappingPhysicsUpdate() const
+    {
+        return OverlapPhysicsUpdate;
+    }
+
     // Script proxies //
     DLLEXPORT RayCastHitEntity* CastRayGetFirstHitProxy(const Float3& from, const Float3& to);
 
     //! \brief Returns true when the player matching the connection should receive updates
     //! about an entity
-    //! \todo Implement this
+    //!
+    //! Players that have a position in this world receive entities that are close to them
+    //! \see InterestManager
     DLLEXPORT bool ShouldPlayerReceiveEntity(Position& atposition, Connection& connection);
 
+    //! \brief Sends an entity to a player it became relevant to or destroys it on a player
+    //! it stopped being relevant to
+    //!
+    //! The entity is only created if the player hasn't already received it. Once destroyed
+    //! updates are no longer sent to that player until it is relevant again
+    //! \note Called by SendableSystem
+    DLLEXPORT void HandleEntityRelevanceChange(
+        const InterestManager::RelevanceChange& change, Sendable& sendable);
+
+    //! \brief Returns the object that decides which entities are sent to which players
+    inline InterestManager& GetInterestManager()
+    {
+        return Interest;
+    }
+
     //! \brief Returns true if a player with the given connection is receiving updates for
     //! this world
     DLLEXPORT bool IsConnectionInWorld(Connection& connection) const;
 
     //! \brief Verifies that player is receiving this world
+    //!
+    //! New players are sent all the Sendable entities that are in their range
     DLLEXPORT void SetPlayerReceiveWorld(std::shared_ptr<ConnectedPlayer> ply);
 
     //! \brief Sends a packet to all connected players
+    //! \note The response is serialized only once and the data is shared by all the players
     DLLEXPORT void SendToAllPlayers(
         const std::shared_ptr<NetworkResponse>& response, RECEIVE_GUARANTEE guarantee) const;
 
@@ -323,7 +428,10 @@ public:
     DLLEXPORT bool SendEntityToConnection(
         ObjectID obj, std::shared_ptr<Connection> connection);
 
-    //! \brief Creates a new entity from initial entity response
+    //! \brief Creates the new entities from an initial entity response
+    //!
+    //! The response has the EntitySerializer::SaveEntities layout so a single one can
+    //! contain all the entities of the world when starting to receive it
     //! \note This should only be called on the client
     DLLEXPORT void HandleEntityInitialPacket(
         std::shared_ptr<NetworkResponse> message, ResponseEntityCreation* data);
@@ -384,7 +492,20 @@ public:
     //! \note Increases refcount on returned object
     DLLEXPORT asIScriptObject* GetScriptSystem(const std::string& name);
 
+    //! \brief Returns how long each tick system has taken to run
+    inline const SystemScheduler& GetTickSystemScheduler() const
+    {
+        return TickSystemScheduler;
+    }
 
+    //! \brief Formats the timings of tick systems for printing
+    DLLEXPORT std::string GetTickSystemTimingReport() const;
+
+    //! \brief Returns how long the ticks of this world have taken
+    inline const WorldTickStatistics& GetTickStatistics() const
+    {
+        return TickStatistics;
+    }
 
     REFERENCE_HANDLE_UNCOUNTED_TYPE(GameWorld);
 
@@ -401,6 +522,12 @@ protected:
     //! class' systems (if any)
     DLLEXPORT virtual void _RunTickSystems();
 
+    //! \brief Waits for an overlapped physics update to finish
+    //!
+    //! Also updates the player positions that were skipped when the physics update was
+    //! started. Does nothing if the physics update isn't running
+    DLLEXPORT void _WaitForPhysicsUpdate();
+
     //! \brief Handles added entities and components
     //!
     //! Construct new nodes based on components values. This is split
@@ -423,10 +550,65 @@ protected:
     //! \brief Called in Release when systems should run their shutdown logic
     DLLEXPORT virtual void _DoSystemsRelease();
 
+    //! \brief Called by generated worlds after a component is created
+    //!
+    //! Derived worlds override this to create nodes for their systems that contain
+    //! component types of the parent world
+    DLLEXPORT virtual void _OnComponentCreated(ObjectID id, COMPONENT_TYPE type);
+
+    //! \brief Called by generated worlds before a component is destroyed with
+    //! RemoveComponent_
+    //! \note Not called by DestroyAllIn, which destroys all the nodes of the entity
+    DLLEXPORT virtual void _OnComponentDestroyed(ObjectID id, COMPONENT_TYPE type);
+
+    //! \brief Adds component bits to the signature of an entity
+    //! \returns The new signature of the entity
+    //! \note Derived worlds call this when a component that is part of a system node is
+    //! created and create nodes for the systems whose signatures match
+    inline ComponentSignature _AddToEntityComponentSignature(
+        ObjectID id, ComponentSignature bits)
+    {
+        return EntityComponentSignatures[id] |= bits;
+    }
+
+    //! \brief Removes component bits from the signature of an entity
+    inline void _RemoveFromEntityComponentSignature(ObjectID id, ComponentSignature bits)
+    {
+        auto iter = EntityComponentSignatures.find(id);
+
+        if(iter == EntityComponentSignatures.end())
+            return;
+
+        iter->second &= ~bits;
+
+        if(iter->second == 0)
+            EntityComponentSignatures.erase(iter);
+    }
+
+    inline void _ClearEntityComponentSignature(ObjectID id)
+    {
+        EntityComponentSignatures.erase(id);
+    }
+
+    //! Generated worlds use ComponentSignature bits after the ones their parent uses
+    static constexpr int USED_COMPONENT_SIGNATURE_BITS = 0;
+
 private:
     //! \brief Updates a players position info in this world
+    //!
+    //! Players that no longer have a position are sent the entities they haven't received.
+    //! Players that get a position lose the received entities that are out of range
     void UpdatePlayersPositionData(ConnectedPlayer& ply);
 
+    //! \brief Sends the Sendable entities that connection should receive but hasn't yet
+    //!
+    //! The entities are sent as a snapshot that is split only when it wouldn't fit in
+    //! MAX_ENTITY_SNAPSHOT_SIZE bytes
+    void _SendMissingEntitiesToConnection(const std::shared_ptr<Connection>& connection);
+
+    //! \brief Updates TickStatistics and warns when this world starts missing its deadline
+    void _RecordTickDuration(int64_t microseconds);
+
     void _CreateOgreResources(Ogre::Root* ogre, GraphicalInputEntity* rendertarget);
     void _HandleDelayedDelete();
 
@@ -435,9 +617,24 @@ private:
     void _ReportEntityDestruction(ObjectID id);
 
     //! \brief Implementation of doing actual destroy part of removing an entity
+    //!
+    //! Also destroys all the descendants of id
     //! \note The caller has to remove the id from Entities
     void _DoDestroy(ObjectID id);
 
+    //! \brief Adds id to Entities unless it is already there
+    void _AddEntity(ObjectID id);
+
+    //! \brief Removes id from Entities by swapping the last entity in its place
+    //! \returns False if id wasn't in Entities
+    bool _RemoveEntity(ObjectID id);
+
+    //! \brief Removes the relation between child and its parent, if any
+    void _RemoveChildRelation(ObjectID child);
+
+    //! \brief Removes a relation from Parents by swapping the last relation in its place
+    void _RemoveParentsEntry(size_t index);
+
     //! \brief Sends sendable updates to all clients
     void _SendEntityUpdates(ObjectID id, Sendable& sendable, int tick);
 
@@ -458,6 +655,17 @@ protected:
     //! a mirroring world (client)
     bool IsOnServer = false;
 
+    //! The components each entity has that are used in system nodes. Each derived world
+    //! assigns bits to its component types
+    std::unordered_map<ObjectID, ComponentSignature> EntityComponentSignatures;
+
+    //! Runs the tick systems of derived worlds on multiple threads based on the data they
+    //! declare to access
+    SystemScheduler TickSystemScheduler;
+
+    //! Positions of sendable entities and players, updated by SendableSystem
+    InterestManager Interest;
+
 private:
     // pimpl to reduce need of including tons of headers (this causes
     // a double pointer dereference so don't put performance critical
@@ -481,6 +689,12 @@ private:
     //! The world can be frozen to stop physics
     bool WorldFrozen = false;
 
+    //! \see SetOverlapPhysicsUpdate
+    bool OverlapPhysicsUpdate = false;
+
+    //! True when player positions need to be updated once the physics update finishes
+    bool PlayerPositionsUpdatePending = false;
+
 
     //! Marks all entities to be released
     bool ClearAllEntities = false;
@@ -493,10 +707,32 @@ private:
     // Entities //
     std::vector<ObjectID> Entities;
 
+    //! Index of each entity in Entities
+    //!
+    //! ObjectIDs are never reused so finding the id here is enough to know that the entity
+    //! is still alive
+    std::unordered_map<ObjectID, size_t> EntityIndices;
+
     // Parented entities, used to destroy children
     // First is the parent, second is child
     std::vector<std::tuple<ObjectID, ObjectID>> Parents;
 
+    //! \brief Where the relation of a child entity is stored
+    struct ChildRelation {
+
+        //! Index in Parents
+        size_t ParentsIndex;
+
+        //! Index in the parent's list in EntityChildren
+        size_t SiblingIndex;
+    };
+
+    //! The relations in Parents keyed by the child
+    std::unordered_map<ObjectID, ChildRelation> ChildRelations;
+
+    //! The children of each parent
+    std::unordered_map<ObjectID, std::vector<ObjectID>> EntityChildren;
+
     //! The unique ID
     int ID;
 
@@ -515,6 +751,9 @@ private:
     //! these properties are set on WorldSceneCamera
     Camera* AppliedCameraPropertiesPtr = nullptr;
 
+    //! Updated at the end of each tick
+    WorldTickStatistics TickStatistics;
+
     //! True while in a tick. Used to prevent destroying entities or components
     //! \todo This check needs to be added to component removal
     bool TickInProgress = false;
@@ -23,14 +23,19 @@ worldClass = GameWorldClass.new(
                              Variable.new("position", "Float3"),
                              Variable.new("orientation", "Float4")
                            ], usedatastruct: true)
-                        ], statetype: true),
+                        ], statetype: true,
+                        serialize: ["Members._Position", "Members._Orientation"]),
     EntityComponent.new("RenderNode", [ConstructorInfo.new(
                                          [
                                            Variable.new("GetScene()", "",
                                                         nonMethodParam: true),
-                                         ])], releaseparams: ["GetScene()"]),
-    EntityComponent.new("Sendable", [ConstructorInfo.new([])]),
-    EntityComponent.new("Received", [ConstructorInfo.new([])]),
+                                         ])], releaseparams: ["GetScene()"],
+                        serialize: [Variable.new("Hidden", "bool"),
+                                    Variable.new("Scale", "Float3")],
+                        graphical: true),
+    EntityComponent.new("Sendable", [ConstructorInfo.new([])], serialize: [],
+                        clientreplacement: "Received"),
+    EntityComponent.new("Received", [ConstructorInfo.new([])], dense: true),
     EntityComponent.new("Model", [ConstructorInfo.new(
                                     [
                                       Variable.new("GetScene()", "",
@@ -60,7 +65,8 @@ worldClass = GameWorldClass.new(
                            [
                              Variable.new("size", "Float3"),
                              Variable.new("material", "std::string")
-                           ], usedatastruct: false)]),
+                           ], usedatastruct: false)],
+                        serialize: ["Sizes", "Material"]),
     EntityComponent.new("ManualObject", [ConstructorInfo.new(
                                            [
                                              Variable.new("GetScene()", "",
@@ -74,7 +80,7 @@ worldClass = GameWorldClass.new(
                              Variable.new("soundperceiver", "bool", default:
                                                                       "true")
                            ])
-                        ]),
+                        ], serialize: ["FOVY", "SoundPerceiver"]),
     EntityComponent.new("Plane",
                         [ConstructorInfo.new(
                            [
@@ -106,12 +112,17 @@ worldClass = GameWorldClass.new(
                      runrender: {group: 60, parameters: ["ComponentAnimated.GetIndex()",
                                                          "calculatedTick", "progressInTick"]}),
     EntitySystem.new("ReceivedSystem", []), 
-    EntitySystem.new("SendableSystem", []), 
+    EntitySystem.new("SendableSystem", [], runtick: {
+                       group: 100,
+                       parameters: ["ComponentSendable.GetIndex()"]},
+                     reads: ["Position"], writes: ["Sendable"]),
     EntitySystem.new("PositionStateSystem", [], runtick: {
                        group: 50,
                        parameters: ["ComponentPosition.GetIndex()", "PositionStates",
-                                    "tick"]}),
+                                    "tick"]},
+                     writes: ["Position", "PositionStates"]),
   ],
+  physicsaccess: ["Physics", "Position", "Sendable"],
   systemspreticksetup: (<<-END
   const auto timeAndTickTuple = GetTickAndTime();
   const auto calculatedTick = std::get<0>(timeAndTickTuple);
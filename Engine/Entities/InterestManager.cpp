@@ -0,0 +1,276 @@
+// ------------------------------------ //
+#include "InterestManager.h"
+
+#include <algorithm>
+#include <cmath>
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT InterestManager::InterestManager() : InterestManager(Settings()) {}
+
+DLLEXPORT InterestManager::InterestManager(const Settings& settings) :
+    CurrentSettings(settings)
+{
+    LEVIATHAN_ASSERT(CurrentSettings.CellSize > 0, "InterestManager: CellSize must be > 0");
+    LEVIATHAN_ASSERT(CurrentSettings.LeaveRadius >= CurrentSettings.EnterRadius,
+        "InterestManager: LeaveRadius must be at least EnterRadius");
+}
+// ------------------------------------ //
+InterestManager::CellKey InterestManager::_MakeCellKey(int64_t x, int64_t y, int64_t z)
+{
+    // 21 bits per axis is plenty for any sensible world size and cell size //
+    constexpr uint64_t mask = (1 << 21) - 1;
+
+    return (static_cast<uint64_t>(x) & mask) | ((static_cast<uint64_t>(y) & mask) << 21) |
+           ((static_cast<uint64_t>(z) & mask) << 42);
+}
+
+InterestManager::CellKey InterestManager::_CellOf(const Float3& position) const
+{
+    return _MakeCellKey(static_cast<int64_t>(std::floor(position.X / CurrentSettings.CellSize)),
+        static_cast<int64_t>(std::floor(position.Y / CurrentSettings.CellSize)),
+        static_cast<int64_t>(std::floor(position.Z / CurrentSettings.CellSize)));
+}
+
+void InterestManager::_RemoveFromCell(CellKey cell, ObjectID id)
+{
+    auto found = Cells.find(cell);
+
+    if(found == Cells.end())
+        return;
+
+    auto& ids = found->second;
+
+    for(size_t i = 0; i < ids.size(); ++i) {
+
+        if(ids[i] == id) {
+
+            ids[i] = ids.back();
+            ids.pop_back();
+            break;
+        }
+    }
+
+    if(ids.empty())
+        Cells.erase(found);
+}
+// ------------------------------------ //
+DLLEXPORT void InterestManager::UpdateEntity(ObjectID id, const Float3& position)
+{
+    const auto cell = _CellOf(position);
+
+    auto found = Entities.find(id);
+
+    if(found == Entities.end()) {
+
+        Entities.emplace(id, TrackedEntity{position, cell});
+        Cells[cell].push_back(id);
+        return;
+    }
+
+    found->second.EntityPosition = position;
+
+    if(found->second.Cell == cell)
+        return;
+
+    _RemoveFromCell(found->second.Cell, id);
+    Cells[cell].push_back(id);
+    found->second.Cell = cell;
+}
+
+DLLEXPORT void InterestManager::RemoveEntity(ObjectID id)
+{
+    auto found = Entities.find(id);
+
+    if(found == Entities.end())
+        return;
+
+    _RemoveFromCell(found->second.Cell, id);
+    Entities.erase(found);
+
+    for(auto& viewer : Viewers)
+        viewer.second.Relevant.erase(id);
+}
+
+DLLEXPORT void InterestManager::ClearEntities()
+{
+    Cells.clear();
+    Entities.clear();
+
+    for(auto& viewer : Viewers)
+        viewer.second.Relevant.clear();
+}
+
+DLLEXPORT void InterestManager::GetEntitiesInRadius(
+    const Float3& center, float radius, std::vector<ObjectID>& result) const
+{
+    const float cellSize = CurrentSettings.CellSize;
+    const float radiusSquared = radius * radius;
+
+    const auto minX = static_cast<int64_t>(std::floor((center.X - radius) / cellSize));
+    const auto maxX = static_cast<int64_t>(std::floor((center.X + radius) / cellSize));
+    const auto minY = static_cast<int64_t>(std::floor((center.Y - radius) / cellSize));
+    const auto maxY = static_cast<int64_t>(std::floor((center.Y + radius) / cellSize));
+    const auto minZ = static_cast<int64_t>(std::floor((center.Z - radius) / cellSize));
+    const auto maxZ = static_cast<int64_t>(std::floor((center.Z + radius) / cellSize));
+
+    for(auto x = minX; x <= maxX; ++x) {
+        for(auto y = minY; y <= maxY; ++y) {
+            for(auto z = minZ; z <= maxZ; ++z) {
+
+                const auto found = Cells.find(_MakeCellKey(x, y, z));
+
+                if(found == Cells.end())
+                    continue;
+
+                for(ObjectID id : found->second) {
+
+                    const auto& entity = Entities.at(id);
+
+                    if((entity.EntityPosition - center).LengthSquared() <= radiusSquared)
+                        result.push_back(id);
+                }
+            }
+        }
+    }
+}
+// ------------------------------------ //
+DLLEXPORT void InterestManager::SetViewer(
+    const Connection* connection, const Float3& position, const std::vector<ObjectID>* received)
+{
+    const auto inserted = Viewers.emplace(connection, Viewer{position, {}});
+
+    if(!inserted.second) {
+
+        inserted.first->second.ViewPosition = position;
+        return;
+    }
+
+    if(!received)
+        return;
+
+    // Entities that aren't in the grid are always sent so they can't leave //
+    for(ObjectID id : *received) {
+
+        if(Entities.find(id) != Entities.end())
+            inserted.first->second.Relevant.emplace(id, RelevantEntity{1});
+    }
+}
+
+DLLEXPORT void InterestManager::RemoveViewer(const Connection* connection)
+{
+    Viewers.erase(connection);
+}
+
+DLLEXPORT bool InterestManager::HasViewer(const Connection* connection) const
+{
+    return Viewers.find(connection) != Viewers.end();
+}
+
+DLLEXPORT void InterestManager::UpdateRelevance(std::vector<RelevanceChange>* changes)
+{
+    const float enterSquared = CurrentSettings.EnterRadius * CurrentSettings.EnterRadius;
+
+    for(auto& pair : Viewers) {
+
+        auto& viewer = pair.second;
+
+        FoundEntities.clear();
+        GetEntitiesInRadius(viewer.ViewPosition, CurrentSettings.LeaveRadius, FoundEntities);
+
+        std::unordered_map<ObjectID, RelevantEntity> relevant;
+        relevant.reserve(FoundEntities.size());
+
+        for(ObjectID id : FoundEntities) {
+
+            const auto distanceSquared =
+                (Entities.at(id).EntityPosition - viewer.ViewPosition).LengthSquared();
+
+            // Between the radiuses only already relevant entities are kept //
+            if(distanceSquared > enterSquared &&
+                viewer.Relevant.find(id) == viewer.Relevant.end())
+                continue;
+
+            relevant.emplace(
+                id, RelevantEntity{_UpdateIntervalFor(std::sqrt(distanceSquared))});
+        }
+
+        if(changes) {
+
+            for(const auto& entity : relevant) {
+
+                if(viewer.Relevant.find(entity.first) == viewer.Relevant.end())
+                    changes->push_back(RelevanceChange{pair.first, entity.first, true});
+            }
+
+            for(const auto& entity : viewer.Relevant) {
+
+                if(relevant.find(entity.first) == relevant.end())
+                    changes->push_back(RelevanceChange{pair.first, entity.first, false});
+            }
+        }
+
+        viewer.Relevant = std::move(relevant);
+    }
+}
+
+int InterestManager::_UpdateIntervalFor(float distance) const
+{
+    if(distance <= CurrentSettings.FullRateRadius || CurrentSettings.RateFalloffDistance <= 0)
+        return 1;
+
+    const auto extra = static_cast<int>(
+        (distance - CurrentSettings.FullRateRadius) / CurrentSettings.RateFalloffDistance);
+
+    return std::min(1 + extra, std::max(1, CurrentSettings.MaxUpdateInterval));
+}
+
+DLLEXPORT bool InterestManager::IsRelevant(const Connection* connection, ObjectID id) const
+{
+    const auto viewer = Viewers.find(connection);
+
+    if(viewer == Viewers.end())
+        return true;
+
+    return viewer->second.Relevant.find(id) != viewer->second.Relevant.end();
+}
+
+DLLEXPORT bool InterestManager::ShouldSendUpdate(
+    const Connection* connection, ObjectID id, int tick) const
+{
+    const auto viewer = Viewers.find(connection);
+
+    if(viewer == Viewers.end())
+        return true;
+
+    const auto entity = viewer->second.Relevant.find(id);
+
+    if(entity == viewer->second.Relevant.end())
+        return false;
+
+    const int interval = entity->second.UpdateInterval;
+
+    // The id spreads entities with the same interval over different ticks //
+    return (tick + id) % interval == 0;
+}
+
+DLLEXPORT bool InterestManager::IsPositionInRange(
+    const Connection* connection, const Float3& position) const
+{
+    const auto viewer = Viewers.find(connection);
+
+    if(viewer == Viewers.end())
+        return true;
+
+    return (position - viewer->second.ViewPosition).LengthSquared() <=
+           CurrentSettings.EnterRadius * CurrentSettings.EnterRadius;
+}
+
+DLLEXPORT int InterestManager::GetRelevantCount(const Connection* connection) const
+{
+    const auto viewer = Viewers.find(connection);
+
+    if(viewer == Viewers.end())
+        return -1;
+
+    return static_cast<int>(viewer->second.Relevant.size());
+}
@@ -0,0 +1,171 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Common/Types.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace Leviathan {
+
+//! \brief Decides which entities are relevant to which connections
+//!
+//! Entity positions are kept in a uniform grid that is updated incrementally so finding the
+//! entities around a player only looks at the nearby cells. Each connection that has a
+//! viewer position gets a set of relevant entities which is recalculated by UpdateRelevance.
+//! Entities become relevant when they come within EnterRadius and stop being relevant once
+//! they are further than LeaveRadius to avoid them flapping in and out at the border.
+//! Connections without a viewer position receive everything
+//! \note This is not thread safe, GameWorld uses this only from SendableSystem and while
+//! not ticking
+class InterestManager {
+public:
+    struct Settings {
+
+        //! Entities closer than this become relevant
+        float EnterRadius = 200.f;
+
+        //! Relevant entities stay relevant until they are further than this
+        float LeaveRadius = 240.f;
+
+        //! Entities closer than this are updated every tick
+        float FullRateRadius = 60.f;
+
+        //! Every this much distance past FullRateRadius adds one tick between updates
+        float RateFalloffDistance = 40.f;
+
+        //! The most ticks between updates for relevant entities
+        int MaxUpdateInterval = 4;
+
+        //! Size of a grid cell along each axis
+        float CellSize = 64.f;
+    };
+
+    //! \brief Relevance info for one entity and connection
+    struct RelevantEntity {
+
+        //! Number of ticks between updates
+        int UpdateInterval;
+    };
+
+    //! \brief An entity that became or stopped being relevant to a connection
+    struct RelevanceChange {
+
+        const Connection* ViewerConnection;
+        ObjectID Entity;
+
+        //! True if the entity became relevant, false if it stopped being relevant
+        bool Entered;
+    };
+
+private:
+    using CellKey = uint64_t;
+
+    struct TrackedEntity {
+
+        Float3 EntityPosition;
+        CellKey Cell;
+    };
+
+    struct Viewer {
+
+        Float3 ViewPosition;
+        std::unordered_map<ObjectID, RelevantEntity> Relevant;
+    };
+
+public:
+    DLLEXPORT InterestManager();
+    DLLEXPORT InterestManager(const Settings& settings);
+
+    inline const Settings& GetSettings() const
+    {
+        return CurrentSettings;
+    }
+
+    // ------------------------------------ //
+    // Entities
+
+    //! \brief Adds or moves an entity in the grid
+    //!
+    //! Only touches the grid cells if the entity moved to a different cell
+    DLLEXPORT void UpdateEntity(ObjectID id, const Float3& position);
+
+    DLLEXPORT void RemoveEntity(ObjectID id);
+
+    //! \brief Removes all entities, viewers are kept
+    DLLEXPORT void ClearEntities();
+
+    inline size_t GetEntityCount() const
+    {
+        return Entities.size();
+    }
+
+    //! \brief Adds all entities within radius of center to result
+    DLLEXPORT void GetEntitiesInRadius(
+        const Float3& center, float radius, std::vector<ObjectID>& result) const;
+
+    // ------------------------------------ //
+    // Viewers
+
+    //! \brief Sets the point a connection is viewing the world from
+    //! \param received Used when the viewer is created. The entities the connection has
+    //! already received while it had no viewer. The next UpdateRelevance reports the ones
+    //! that are out of range as left so that they are removed from the receiver
+    DLLEXPORT void SetViewer(const Connection* connection, const Float3& position,
+        const std::vector<ObjectID>* received = nullptr);
+
+    //! \brief Makes a connection receive all entities again
+    DLLEXPORT void RemoveViewer(const Connection* connection);
+
+    DLLEXPORT bool HasViewer(const Connection* connection) const;
+
+    //! \brief Recalculates the relevant entities for all viewers
+    //!
+    //! Costs the number of entities around each viewer, not the total number of entities
+    //! \param changes If not null the entities that entered or left the relevant set of a
+    //! viewer are added to this. Entities removed with RemoveEntity aren't reported
+    DLLEXPORT void UpdateRelevance(std::vector<RelevanceChange>* changes = nullptr);
+
+    //! \returns True if the entity was relevant to the connection in the last
+    //! UpdateRelevance call or the connection has no viewer
+    DLLEXPORT bool IsRelevant(const Connection* connection, ObjectID id) const;
+
+    //! \returns True if the entity is relevant and it is its turn to be updated on tick
+    //!
+    //! Entities with the same update interval are spread over different ticks
+    DLLEXPORT bool ShouldSendUpdate(const Connection* connection, ObjectID id, int tick) const;
+
+    //! \returns True if an entity at position would become relevant to connection
+    DLLEXPORT bool IsPositionInRange(const Connection* connection, const Float3& position) const;
+
+    //! \returns The number of entities relevant to connection or -1 if it has no viewer
+    DLLEXPORT int GetRelevantCount(const Connection* connection) const;
+
+private:
+    CellKey _CellOf(const Float3& position) const;
+    static CellKey _MakeCellKey(int64_t x, int64_t y, int64_t z);
+
+    void _RemoveFromCell(CellKey cell, ObjectID id);
+
+    //! \returns The ticks between updates for an entity at distance
+    int _UpdateIntervalFor(float distance) const;
+
+private:
+    const Settings CurrentSettings;
+
+    std::unordered_map<CellKey, std::vector<ObjectID>> Cells;
+    std::unordered_map<ObjectID, TrackedEntity> Entities;
+
+    std::unordered_map<const Connection*, Viewer> Viewers;
+
+    //! Reused by UpdateRelevance
+    std::vector<ObjectID> FoundEntities;
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::InterestManager;
+#endif
@@ -510,7 +510,7 @@ DLLEXPORT void Leviathan::ScriptSystemNodeHelper(
     // Only do more checks if something has changed //
     if(!addedCpp.empty() || !addedScript.empty()) {
 
-        // Handle added like in TupleCachedComponentCollectionHelper //
+        // Handle added by finding the other components for each added id //
 
         // Find the first factory that has the right number of arguments //
         asIScriptFunction* factoryFunc = nullptr;
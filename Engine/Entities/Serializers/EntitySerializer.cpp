@@ -3,30 +3,286 @@
 
 #include "Utility/Convert.h"
 #include "Entities/GameWorld.h"
+#include "FileSystem.h"
+#include "Networking/Connection.h"
+
+#include <limits>
+#include <unordered_set>
 
 using namespace Leviathan;
 // ------------------------------------ //
+DLLEXPORT bool EntitySerializer::SerializeEntity(GameWorld& world, ObjectID id,
+    sf::Packet &packet)
+{
+    const auto& types = world.GetSerializableComponentTypes();
+
+    LEVIATHAN_ASSERT(types.size() <= std::numeric_limits<uint8_t>::max(),
+        "too many serializable component types");
+
+    // Components are written to a separate packet first to know their lengths //
+    sf::Packet componentdata;
+    std::vector<std::tuple<uint16_t, uint16_t>> components;
+
+    for(auto type : types){
+
+        const auto start = componentdata.getDataSize();
+
+        if(!world.SerializeComponent(id, type, componentdata))
+            continue;
+
+        const auto length = componentdata.getDataSize() - start;
+
+        if(length > std::numeric_limits<uint16_t>::max()){
+
+            Logger::Get()->Error("EntitySerializer: component " +
+                Convert::ToString(static_cast<uint16_t>(type)) + " of entity " +
+                Convert::ToString(id) + " is too large to serialize");
+            return false;
+        }
+
+        components.push_back(std::make_tuple(static_cast<uint16_t>(type),
+                static_cast<uint16_t>(length)));
+    }
+
+    packet << static_cast<uint8_t>(components.size());
+
+    const char* data = static_cast<const char*>(componentdata.getData());
+
+    for(const auto& component : components){
+
+        packet << std::get<0>(component) << std::get<1>(component);
+        packet.append(data, std::get<1>(component));
+        data += std::get<1>(component);
+    }
+
+    return true;
+}
+
+DLLEXPORT bool EntitySerializer::DeserializeEntity(GameWorld& world, ObjectID id,
+    sf::Packet &packet)
+{
+    uint8_t count;
+    packet >> count;
+
+    if(!packet)
+        return false;
+
+    for(uint8_t i = 0; i < count; ++i){
+
+        uint16_t type;
+        uint16_t length;
+        packet >> type >> length;
+
+        if(!packet)
+            return false;
+
+        // The component is read from its own packet so that a component reading a wrong
+        // amount of data can't misalign the following ones //
+        sf::Packet componentdata;
+        uint8_t byte;
+
+        for(uint16_t read = 0; read < length; ++read){
+
+            packet >> byte;
+            componentdata << byte;
+        }
+
+        if(!packet)
+            return false;
+
+        try{
+            // Components that this world doesn't know are skipped //
+            if(!world.DeserializeComponent(id, static_cast<COMPONENT_TYPE>(type),
+                    componentdata))
+                continue;
+
+        } catch(const InvalidArgument &e){
+
+            Logger::Get()->Error("EntitySerializer: invalid data for component " +
+                Convert::ToString(type) + " of entity " + Convert::ToString(id) + ":");
+            e.PrintToLog();
+            return false;
+        }
+
+        if(!componentdata.endOfPacket()){
+
+            Logger::Get()->Error("EntitySerializer: component " + Convert::ToString(type) +
+                " of entity " + Convert::ToString(id) + " didn't use all of its " +
+                Convert::ToString(length) + " bytes");
+            return false;
+        }
+    }
+
+    return true;
+}
+// ------------------------------------ //
 DLLEXPORT bool EntitySerializer::CreatePacketForConnection(GameWorld* world,
-    Lock &worldlock, ObjectID id, Sendable &sendable, sf::Packet &packet,
-    Connection &connection)
+    ObjectID id, Sendable &sendable, sf::Packet &packet,
+    const std::shared_ptr<Connection> &connection)
 {
-    DEBUG_BREAK;
+    if(SaveEntities(*world, {id}, 0, packet) != 1)
+        return false;
+
+    if(!sendable.IsReceiver(connection))
+        sendable.AddConnectionToReceivers(connection);
 
-    // TODO: send all the components 
-    
     return true;
 }
 // ------------------------------------ //
 DLLEXPORT bool EntitySerializer::DeserializeWholeEntityFromPacket(GameWorld* world,
-    Lock &worldlock, ObjectID id, sf::Packet &packet)
+    ObjectID &id, sf::Packet &packet)
 {
-    DEBUG_BREAK;
+    std::vector<ObjectID> loaded;
+
+    if(!LoadWorld(*world, packet, &loaded) || loaded.size() != 1)
+        return false;
+
+    id = loaded.front();
+    return true;
+}
+// ------------------------------------ //
+DLLEXPORT bool EntitySerializer::SaveWorld(GameWorld& world, sf::Packet &packet)
+{
+    const auto& entities = world.GetEntities();
+    return SaveEntities(world, entities, 0, packet) == entities.size();
+}
+
+DLLEXPORT size_t EntitySerializer::SaveEntities(GameWorld& world,
+    const std::vector<ObjectID>& entities, size_t first, sf::Packet& packet, size_t maxsize)
+{
+    // Magic, version and the entity and parent counts
+    constexpr size_t headerSize = sizeof(uint32_t) * 3 + sizeof(uint8_t);
+
+    sf::Packet body;
+    size_t written = 0;
+
+    for(size_t i = first; i < entities.size(); ++i){
+
+        sf::Packet entity;
+        entity << entities[i];
+
+        if(!SerializeEntity(world, entities[i], entity))
+            return 0;
+
+        if(written > 0 && headerSize + body.getDataSize() + entity.getDataSize() > maxsize)
+            break;
+
+        body.append(entity.getData(), entity.getDataSize());
+        ++written;
+    }
+
+    packet << WORLD_SAVE_MAGIC << ENTITY_SERIALIZE_VERSION << static_cast<uint32_t>(written);
+    packet.append(body.getData(), body.getDataSize());
+
+    const std::unordered_set<ObjectID> included(entities.begin() + first,
+        entities.begin() + first + written);
+
+    std::vector<std::tuple<ObjectID, ObjectID>> parents;
+
+    for(const auto& relation : world.GetEntityParents()){
+
+        if(included.count(std::get<0>(relation)) && included.count(std::get<1>(relation)))
+            parents.push_back(relation);
+    }
+
+    packet << static_cast<uint32_t>(parents.size());
+
+    for(const auto& relation : parents)
+        packet << std::get<0>(relation) << std::get<1>(relation);
+
+    return written;
+}
+
+DLLEXPORT bool EntitySerializer::LoadWorld(GameWorld& world, sf::Packet &packet,
+    std::vector<ObjectID>* loaded)
+{
+    uint32_t magic;
+    uint8_t version;
+    uint32_t count;
+
+    packet >> magic >> version >> count;
+
+    if(!packet || magic != WORLD_SAVE_MAGIC){
+
+        Logger::Get()->Error("EntitySerializer: data is not a saved world");
+        return false;
+    }
+
+    if(version != ENTITY_SERIALIZE_VERSION){
+
+        Logger::Get()->Error("EntitySerializer: saved world has serialize version " +
+            Convert::ToString(static_cast<int>(version)) + ", ours is " +
+            Convert::ToString(static_cast<int>(ENTITY_SERIALIZE_VERSION)));
+        return false;
+    }
+
+    for(uint32_t i = 0; i < count; ++i){
+
+        ObjectID id;
+        packet >> id;
+
+        if(!packet)
+            return false;
+
+        world.AddEntityWithID(id);
+
+        if(loaded)
+            loaded->push_back(id);
+
+        if(!DeserializeEntity(world, id, packet)){
+
+            Logger::Get()->Error("EntitySerializer: failed to load saved entity " +
+                Convert::ToString(id));
+            return false;
+        }
+    }
+
+    packet >> count;
+
+    if(!packet)
+        return false;
+
+    for(uint32_t i = 0; i < count; ++i){
+
+        ObjectID parent;
+        ObjectID child;
+        packet >> parent >> child;
+
+        if(!packet)
+            return false;
+
+        world.SetEntitysParent(child, parent);
+    }
 
-    // TODO: load all components
-    
-    
     return true;
 }
+
+DLLEXPORT bool EntitySerializer::SaveWorldToFile(GameWorld& world, const std::string &file)
+{
+    sf::Packet packet;
+
+    if(!SaveWorld(world, packet))
+        return false;
+
+    return FileSystem::WriteToFile(std::string(static_cast<const char*>(packet.getData()),
+            packet.getDataSize()), file);
+}
+
+DLLEXPORT bool EntitySerializer::LoadWorldFromFile(GameWorld& world, const std::string &file)
+{
+    std::string data;
+
+    if(!FileSystem::ReadFileEntirely(file, data)){
+
+        Logger::Get()->Error("EntitySerializer: failed to read saved world: " + file);
+        return false;
+    }
+
+    sf::Packet packet;
+    packet.append(data.data(), data.size());
+
+    return LoadWorld(world, packet);
+}
 // ------------------------------------ //
 DLLEXPORT bool EntitySerializer::VerifyAndFillReceivedState(Received* received,
     int ticknumber, int referencetick, std::shared_ptr<ComponentState> receivedstate)
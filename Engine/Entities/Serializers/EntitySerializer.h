@@ -8,10 +8,24 @@
 #include "Entities/Components.h"
 #include "../../Common/ThreadSafe.h"
 
+#include <limits>
+
 namespace Leviathan{
 
+//! Version of the layout EntitySerializer writes. Needs to be increased when the layout or
+//! the serialized data of any component changes
+constexpr uint8_t ENTITY_SERIALIZE_VERSION = 1;
+
+//! First bytes of saved world files ("LVWD")
+constexpr uint32_t WORLD_SAVE_MAGIC = 0x4C565744;
+
 //! \brief Base class for all entity serializer classes
 //! \note All possible types should be defined in this file here
+//!
+//! An entity is written as the number of components followed by the type, data length and
+//! data of each component. The data is written by GameWorld::SerializeComponent so the
+//! components that are saved are the ones that have serialize set in the generator of
+//! the world class. The length allows skipping components that the reader doesn't know
 class EntitySerializer{
 public:
 
@@ -21,32 +35,65 @@ public:
 
     virtual ~EntitySerializer(){ }
 
+    //! \brief Writes all serializable components of an entity to packet
+    //! \returns False if a component was too large to be written
+    DLLEXPORT bool SerializeEntity(GameWorld& world, ObjectID id, sf::Packet& packet);
+
+    //! \brief Creates components for id from data written by SerializeEntity
+    //! \returns False if the data is invalid or a component doesn't use exactly the number
+    //! of bytes written for it, some components may have been created
+    DLLEXPORT bool DeserializeEntity(GameWorld& world, ObjectID id, sf::Packet& packet);
+
     //! \brief Serializes an entity entirely into a packet
     //! \note This will also link the entity to the connection so that it will
     //! automatically send updates
-    //! \param connectionptr Pointer to the connection to be used
-    //! (doesn't have to be verified to be valid)
-    //! \return Returns true when the type of object is correct.
-    //! Which should be when IsObjectTypeCorrect returns true
-    //! \note The caller will have added the ID to the packet so that needs to be skipped
-    //! (or rather should be) But the Type variable should be included by
-    //! this object (as an int32_t)
-    DLLEXPORT virtual bool CreatePacketForConnection(GameWorld* world, Lock &worldlock,
+    //! \param connection The connection that will receive the packet
+    //! \return False if the entity couldn't be serialized
+    //! \note The packet has the SaveEntities layout with just this entity so clients
+    //! handle it the same way as world snapshots
+    DLLEXPORT virtual bool CreatePacketForConnection(GameWorld* world,
         ObjectID id, Sendable &sendable, sf::Packet &packet,
-        Connection &connection);
+        const std::shared_ptr<Connection> &connection);
 
 
-    //! \brief Deserializes a whole object from a packet if the Type in the packet is
-    //! the same as Type of this
+    //! \brief Deserializes a whole object from a packet created by CreatePacketForConnection
     //! \note This should do the exact opposite of CreatePacketForConnection
-    //! \return True when the type of packet is correct even if the data is invalid
-    //! \todo Allow reporting invalid data
-    //! \param serializetype The type that was included in the packet by
-    //! a CreatePacketForConnection
-    //! \param world The world into which the object is created.
-    //! Has to be locked before this call
+    //! \param id Set to the id of the entity in the packet
+    //! \param world The world into which the object is created
+    //! \return False if the data is invalid or doesn't contain exactly one entity
+    //! \note The caller needs to call GameWorld::NotifyEntityCreate for the new entity
     DLLEXPORT virtual bool DeserializeWholeEntityFromPacket(GameWorld* world,
-        Lock &worldlock, ObjectID id, sf::Packet &packet);
+        ObjectID &id, sf::Packet &packet);
+
+    //! \brief Writes all entities of world and the parent relations between them
+    //!
+    //! The layout is WORLD_SAVE_MAGIC, ENTITY_SERIALIZE_VERSION, entity count, the id and
+    //! components of each entity, parent count and the parent and child ids of each
+    DLLEXPORT bool SaveWorld(GameWorld& world, sf::Packet& packet);
+
+    //! \brief Writes entities starting from first in the SaveWorld layout
+    //!
+    //! Only the parent relations where both entities are written are included. This is
+    //! used to send many entities in a single message
+    //! \param maxsize Entities are no longer added once the packet would become larger
+    //! than this. At least one entity is always written
+    //! \returns The number of entities written, 0 if serializing an entity failed
+    DLLEXPORT size_t SaveEntities(GameWorld& world, const std::vector<ObjectID>& entities,
+        size_t first, sf::Packet& packet,
+        size_t maxsize = std::numeric_limits<size_t>::max());
+
+    //! \brief Creates the entities written by SaveWorld or SaveEntities to world
+    //! \note The entities keep their saved ids so world should be empty
+    //! \param loaded If not null the ids of the created entities are added to this
+    //! \return False if the data is invalid or has the wrong version
+    DLLEXPORT bool LoadWorld(GameWorld& world, sf::Packet& packet,
+        std::vector<ObjectID>* loaded = nullptr);
+
+    //! \brief SaveWorld variant that writes to a file
+    DLLEXPORT bool SaveWorldToFile(GameWorld& world, const std::string& file);
+
+    //! \brief LoadWorld variant that reads from a file
+    DLLEXPORT bool LoadWorldFromFile(GameWorld& world, const std::string& file);
 
 
     //! \brief Deserializes and applies an update from a packet
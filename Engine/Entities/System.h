@@ -37,125 +37,29 @@ public:
         return CachedComponents.GetObjectCount();
     }
 
-    // TODO: do something about the amount of copy pasting done here
-
-
-    //! \brief Helper function for creating nodes based on std::tuple
-    //! \todo Also figure out if "CachedComponentCollections.Find(id) != nullptr" should
-    //! be before _TupleHelperGetIfComponentExists
-    template<class FirstType, class SecondType>
-    static void TupleCachedComponentCollectionHelper(
-        ObjectPool<std::tuple<FirstType&, SecondType&>, ObjectID> &CachedComponentCollections,
-        const std::vector<std::tuple<FirstType*, ObjectID>> &firstdata,
-        const std::vector<std::tuple<SecondType*, ObjectID>> &seconddata,
-        const ComponentHolder<FirstType> &firstholder,
-        const ComponentHolder<SecondType> &secondholder) 
+    //! \brief Creates a node for an entity that has all the components this system needs
+    //!
+    //! Called by the world when an entity's component signature starts matching the
+    //! signature of this system. Does nothing if the entity already has a node
+    //! \param components The components in the same order as in the node type
+    template<class... ComponentTypes>
+    void CreateNode(ObjectID id, ComponentTypes&... components)
     {
-        // First way around //
-        for(auto iter = firstdata.begin(); iter != firstdata.end(); ++iter){
+        if(CachedComponents.Find(id) != nullptr)
+            return;
 
-            const auto id = std::get<1>(*iter);
-            SecondType* other = _TupleHelperGetIfComponentExists(id, seconddata, secondholder);
-            
-            // Create node if required components where found and it doesn't exist already //
-            if(!other || CachedComponentCollections.Find(id) != nullptr)
-                continue;
-
-            CachedComponentCollections.ConstructNew(id, *std::get<0>(*iter), *other);
-        }
-
-        // And the other way around //
-        for(auto iter = seconddata.begin(); iter != seconddata.end(); ++iter){
-
-            const auto id = std::get<1>(*iter);
-            FirstType* other = _TupleHelperGetIfComponentExists(id, firstdata, firstholder);
-
-            // Create node if required components where found and it doesn't exist already //
-            if(!other || CachedComponentCollections.Find(id) != nullptr)
-                continue;
-
-            CachedComponentCollections.ConstructNew(id, *other, *std::get<0>(*iter));
-        }
+        CachedComponents.ConstructNew(id, components...);
     }
 
-    //! \brief Tree part component TupleCachedComponentCollectionHelper
-    template<class FirstType, class SecondType, class ThirdType>
-    static void TupleCachedComponentCollectionHelper(
-        ObjectPool<std::tuple<FirstType&, SecondType&, ThirdType&>, ObjectID>
-        &CachedComponentCollections,
-        const std::vector<std::tuple<FirstType*, ObjectID>> &firstdata,
-        const std::vector<std::tuple<SecondType*, ObjectID>> &seconddata,
-        const std::vector<std::tuple<ThirdType*, ObjectID>> &thirddata,
-        const ComponentHolder<FirstType> &firstholder,
-        const ComponentHolder<SecondType> &secondholder,
-        const ComponentHolder<ThirdType> &thirdholder)
+    //! \brief Destroys the node of an entity if it has one
+    //!
+    //! Called by the world before a component that is part of the node is destroyed
+    //! \returns True if a node was destroyed
+    bool DestroyNode(ObjectID id)
     {
-        // First way around //
-        for(auto iter = firstdata.begin(); iter != firstdata.end(); ++iter){
-
-            const auto id = std::get<1>(*iter);
-            SecondType* other2 = _TupleHelperGetIfComponentExists(id, seconddata,
-                secondholder);
-            ThirdType* other3 = _TupleHelperGetIfComponentExists(id, thirddata, thirdholder);
-            
-            // Create node if required components where found and it doesn't exist already //
-            if(!other2 || !other3 || CachedComponentCollections.Find(id) != nullptr)
-                continue;
-
-            CachedComponentCollections.ConstructNew(id, *std::get<0>(*iter), *other2, *other3);
-        }
-
-        // And the other way around //
-        for(auto iter = seconddata.begin(); iter != seconddata.end(); ++iter){
-
-            const auto id = std::get<1>(*iter);
-            FirstType* other1 = _TupleHelperGetIfComponentExists(id, firstdata, firstholder);
-            ThirdType* other3 = _TupleHelperGetIfComponentExists(id, thirddata, thirdholder);
-
-            // Create node if required components where found and it doesn't exist already //
-            if(!other1 || !other3 || CachedComponentCollections.Find(id) != nullptr)
-                continue;
-
-            CachedComponentCollections.ConstructNew(id, *other1, *std::get<0>(*iter), *other3);
-        }
-        
-        // Third way around //
-        for(auto iter = thirddata.begin(); iter != thirddata.end(); ++iter){
-
-            const auto id = std::get<1>(*iter);
-            FirstType* other1 = _TupleHelperGetIfComponentExists(id, firstdata, firstholder);
-            SecondType* other2 = _TupleHelperGetIfComponentExists(id, seconddata,
-                secondholder);
-
-            // Create node if required components where found and it doesn't exist already //
-            if(!other1 || !other2 || CachedComponentCollections.Find(id) != nullptr)
-                continue;
-
-            CachedComponentCollections.ConstructNew(id, *other1, *other2, *std::get<0>(*iter));
-        }        
+        return CachedComponents.DestroyIfExists(id);
     }
 
-protected:
-
-    // Helpers for TupleCachedComponentCollectionHelper //
-    template<class T>
-    static inline T* _TupleHelperGetIfComponentExists(ObjectID id,
-        const std::vector<std::tuple<T*, ObjectID>> &addedlist,
-        const ComponentHolder<T> &holder)
-    {
-        // First search added //
-        for(auto iter = addedlist.begin(); iter != addedlist.end(); ++iter){
-
-            if(std::get<1>(*iter) == id){
-
-                return std::get<0>(*iter);
-            }
-        }
-
-        // This full search returns a nullptr if not found //
-        return holder.Find(id);
-    }
-    
 public:
     
     HolderType CachedComponents;
@@ -163,9 +67,9 @@ public:
 
 //! \brief Base for all entity component related systems
 //!
-//! For ones that use nodes. Not for ones that directly use a single component type
-//! \todo It would bemore efficient to directly create nodes as entities are created instead
-//! of running CreateCachedComponentCollections (implemented in subclasses of this)
+//! For ones that use nodes. Not for ones that directly use a single component type.
+//! Nodes are created and destroyed by the world as components are created and destroyed
+//! (see EntityComponentSignatures in GameWorld)
 template<class UsedCachedComponentCollection>
 class System : public SystemCachedComponentCollectionStorage<UsedCachedComponentCollection>{
 public:
@@ -0,0 +1,274 @@
+// ------------------------------------ //
+#include "SystemScheduler.h"
+
+#include "Threading/ThreadingManager.h"
+#include "TimeIncludes.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+using namespace Leviathan;
+// ------------------------------------ //
+//! \brief Shared between the thread calling Run and the queued worker tasks
+//!
+//! Worker tasks may start after Run has returned so this is kept alive by them
+struct SystemScheduler::RunState {
+
+    std::mutex Mutex;
+    std::condition_variable Notify;
+
+    std::vector<ScheduledSystem>* Systems;
+    std::vector<SystemTiming>* Timings;
+
+    //! Number of unfinished systems each system still waits for
+    std::vector<size_t> RemainingDependencies;
+
+    //! Systems that can be started right now
+    std::vector<size_t> Ready;
+
+    size_t Finished = 0;
+
+    std::exception_ptr Error;
+};
+// ------------------------------------ //
+DLLEXPORT SystemScheduler::SystemScheduler() {}
+
+DLLEXPORT SystemScheduler::~SystemScheduler() {}
+// ------------------------------------ //
+DLLEXPORT void SystemScheduler::BeginSystems()
+{
+    Systems.clear();
+}
+
+DLLEXPORT void SystemScheduler::AddSystem(
+    const std::string& name, AccessMask reads, AccessMask writes, std::function<void()> run)
+{
+    const auto index = Systems.size();
+
+    Systems.push_back(ScheduledSystem{std::move(run), reads, writes, false, {}, {}});
+
+    // Keep the timings if the same system is at this position as last time //
+    if(index >= Timings.size()) {
+
+        Timings.emplace_back(name);
+
+    } else if(Timings[index].Name != name) {
+
+        Timings[index] = SystemTiming(name);
+    }
+}
+
+DLLEXPORT void SystemScheduler::AddExclusiveSystem(
+    const std::string& name, std::function<void()> run)
+{
+    AddSystem(name, 0, 0, std::move(run));
+    Systems.back().Exclusive = true;
+}
+// ------------------------------------ //
+void SystemScheduler::_BuildDependencies()
+{
+    // Later systems wait for all earlier systems they conflict with. Each conflicting pair
+    // is added even if it is already implied by another dependency, this is fine as there
+    // are only a few systems
+    for(size_t i = 0; i < Systems.size(); ++i) {
+
+        auto& current = Systems[i];
+
+        for(size_t previous = 0; previous < i; ++previous) {
+
+            auto& other = Systems[previous];
+
+            if(current.Exclusive || other.Exclusive ||
+                Conflicts(other.Reads, other.Writes, current.Reads, current.Writes)) {
+
+                current.Dependencies.push_back(previous);
+                other.Dependents.push_back(i);
+            }
+        }
+    }
+}
+
+DLLEXPORT std::vector<size_t> SystemScheduler::GetDependencies(size_t index) const
+{
+    if(index >= Systems.size())
+        return {};
+
+    return Systems[index].Dependencies;
+}
+// ------------------------------------ //
+DLLEXPORT void SystemScheduler::Run()
+{
+    if(Systems.empty())
+        return;
+
+    _BuildDependencies();
+
+    auto state = std::make_shared<RunState>();
+    state->Systems = &Systems;
+    state->Timings = &Timings;
+    state->RemainingDependencies.reserve(Systems.size());
+
+    // Reversed so that the earliest added system is popped first //
+    for(size_t i = Systems.size(); i > 0; --i) {
+
+        if(Systems[i - 1].Dependencies.empty())
+            state->Ready.push_back(i - 1);
+    }
+
+    for(const auto& system : Systems)
+        state->RemainingDependencies.push_back(system.Dependencies.size());
+
+    // The calling thread runs one of the ready systems //
+    auto threads = ThreadingManager::Get();
+
+    const auto initiallyReady = state->Ready.size();
+
+    if(threads) {
+        for(size_t i = 1; i < initiallyReady; ++i) {
+
+            threads->QueueTask(
+                std::make_shared<QueuedTask>([state]() { _RunAvailable(state); }));
+        }
+    }
+
+    while(true) {
+
+        _RunAvailable(state);
+
+        std::unique_lock<std::mutex> lock(state->Mutex);
+
+        state->Notify.wait(lock, [&]() {
+            return state->Finished == Systems.size() || !state->Ready.empty();
+        });
+
+        if(state->Finished == Systems.size())
+            break;
+    }
+
+    // Dependencies are rebuilt on the next run //
+    for(auto& system : Systems) {
+        system.Dependencies.clear();
+        system.Dependents.clear();
+    }
+
+    if(state->Error)
+        std::rethrow_exception(state->Error);
+}
+
+void SystemScheduler::_RunAvailable(const std::shared_ptr<RunState>& state)
+{
+    std::unique_lock<std::mutex> lock(state->Mutex);
+
+    while(!state->Ready.empty()) {
+
+        const auto index = state->Ready.back();
+        state->Ready.pop_back();
+
+        auto& system = (*state->Systems)[index];
+        auto& timing = (*state->Timings)[index];
+
+        lock.unlock();
+
+        const auto start = Time::GetTimeMicro64();
+
+        std::exception_ptr error;
+
+        try {
+            system.RunFunction();
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        const auto elapsed = Time::GetTimeMicro64() - start;
+
+        // Only this thread touches this system's timing //
+        ++timing.RunCount;
+        timing.TotalMicroseconds += elapsed;
+        timing.LastMicroseconds = elapsed;
+        timing.LongestMicroseconds = std::max(timing.LongestMicroseconds, elapsed);
+
+        lock.lock();
+
+        if(error && !state->Error)
+            state->Error = error;
+
+        ++state->Finished;
+
+        const auto readyBefore = state->Ready.size();
+
+        for(auto dependent : system.Dependents) {
+
+            if(--state->RemainingDependencies[dependent] == 0)
+                state->Ready.push_back(dependent);
+        }
+
+        // This thread continues with one of the newly ready systems and others are given to
+        // the workers
+        const auto newlyReady = state->Ready.size() - readyBefore;
+
+        state->Notify.notify_all();
+
+        if(newlyReady > 1) {
+
+            auto threads = ThreadingManager::Get();
+
+            if(threads) {
+
+                lock.unlock();
+
+                for(size_t i = 1; i < newlyReady; ++i) {
+                    threads->QueueTask(
+                        std::make_shared<QueuedTask>([state]() { _RunAvailable(state); }));
+                }
+
+                lock.lock();
+            }
+        }
+    }
+}
+// ------------------------------------ //
+DLLEXPORT std::string SystemScheduler::GetTimingReport() const
+{
+    std::stringstream stream;
+
+    stream << std::left << std::setw(32) << "System" << std::right << std::setw(10)
+           << "Runs" << std::setw(12) << "Average us" << std::setw(12) << "Longest us"
+           << std::setw(12) << "Last us" << "\n";
+
+    for(const auto& timing : Timings) {
+
+        const auto average =
+            timing.RunCount > 0 ? timing.TotalMicroseconds / timing.RunCount : 0;
+
+        stream << std::left << std::setw(32) << timing.Name << std::right << std::setw(10)
+               << timing.RunCount << std::setw(12) << average << std::setw(12)
+               << timing.LongestMicroseconds << std::setw(12) << timing.LastMicroseconds
+               << "\n";
+    }
+
+    return stream.str();
+}
+
+DLLEXPORT void SystemScheduler::ResetTimings()
+{
+    for(auto& timing : Timings)
+        timing = SystemTiming(timing.Name);
+}
+// ------------------------------------ //
+DLLEXPORT void SystemScheduler::ParallelFor(
+    size_t count, size_t chunksize, const std::function<void(size_t, size_t)>& func)
+{
+    auto threads = ThreadingManager::Get();
+
+    if(!threads) {
+
+        if(count > 0)
+            func(0, count);
+        return;
+    }
+
+    threads->ParallelFor(0, count, chunksize, func);
+}
@@ -0,0 +1,143 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Leviathan {
+
+class ThreadingManager;
+
+//! \brief Runs systems that don't access the same data at the same time on multiple threads
+//!
+//! Each system declares the data (component types, state holders etc.) it reads and writes
+//! as bits in an AccessMask. Systems are added in the order they would run sequentially and
+//! a system only waits for the earlier systems it conflicts with. Two systems conflict if
+//! either one writes something the other one reads or writes. Systems added with
+//! AddExclusiveSystem conflict with everything so they keep the sequential order
+//! \note The systems are added again each tick by the generated world so that they can
+//! capture the per tick values. Timings are kept as long as the same system is added at
+//! the same position
+class SystemScheduler {
+public:
+    //! Bit for each data that the systems can access
+    using AccessMask = uint64_t;
+
+    //! \brief Timing statistics of a single system
+    struct SystemTiming {
+
+        inline SystemTiming(const std::string& name) : Name(name) {}
+
+        std::string Name;
+
+        //! Number of times the system has been ran since the last reset
+        int64_t RunCount = 0;
+        int64_t TotalMicroseconds = 0;
+        int64_t LongestMicroseconds = 0;
+        int64_t LastMicroseconds = 0;
+    };
+
+public:
+    DLLEXPORT SystemScheduler();
+    DLLEXPORT ~SystemScheduler();
+
+    SystemScheduler(const SystemScheduler& other) = delete;
+    SystemScheduler& operator=(const SystemScheduler& other) = delete;
+
+    //! \brief Clears the systems added for the previous run. Timings are kept
+    DLLEXPORT void BeginSystems();
+
+    //! \brief Adds a system that accesses only the data in reads and writes
+    DLLEXPORT void AddSystem(
+        const std::string& name, AccessMask reads, AccessMask writes, std::function<void()> run);
+
+    //! \brief Adds a system that doesn't declare what it accesses and needs to run alone
+    DLLEXPORT void AddExclusiveSystem(const std::string& name, std::function<void()> run);
+
+    //! \brief Runs all the added systems and blocks until they are done
+    //!
+    //! The calling thread also runs systems. If ThreadingManager doesn't exist everything is
+    //! ran on the calling thread
+    //! \exception The first exception thrown by a system is rethrown here after all the
+    //! other systems are finished
+    DLLEXPORT void Run();
+
+    //! \returns The number of systems added since BeginSystems
+    inline size_t GetSystemCount() const
+    {
+        return Systems.size();
+    }
+
+    //! \returns The indexes of the systems that system at index waits for
+    //! \note Only valid after Run has been called
+    DLLEXPORT std::vector<size_t> GetDependencies(size_t index) const;
+
+    // ------------------------------------ //
+    // Timing
+
+    inline const std::vector<SystemTiming>& GetTimings() const
+    {
+        return Timings;
+    }
+
+    //! \brief Formats the system timings into a table that can be printed
+    DLLEXPORT std::string GetTimingReport() const;
+
+    DLLEXPORT void ResetTimings();
+
+    // ------------------------------------ //
+    //! \brief Splits range [0, count) into chunks and runs them in parallel
+    //!
+    //! Systems can use this to split iterating a large number of components. The calling
+    //! thread keeps processing chunks until none are left so this is safe to call from a
+    //! system that is already running on a worker thread
+    //! \param chunksize The number of items in each chunk, the last chunk may be smaller
+    //! \param func Called with [begin, end) of each chunk. Needs to be thread safe
+    //! \exception The first exception thrown by func is rethrown after all chunks are done
+    DLLEXPORT static void ParallelFor(
+        size_t count, size_t chunksize, const std::function<void(size_t, size_t)>& func);
+
+    //! \brief Returns true if systems with these access masks can't run at the same time
+    static constexpr bool Conflicts(
+        AccessMask firstreads, AccessMask firstwrites, AccessMask secondreads,
+        AccessMask secondwrites)
+    {
+        return (firstwrites & (secondreads | secondwrites)) != 0 ||
+               (secondwrites & firstreads) != 0;
+    }
+
+protected:
+    struct ScheduledSystem {
+
+        std::function<void()> RunFunction;
+        AccessMask Reads;
+        AccessMask Writes;
+        bool Exclusive;
+
+        //! Indexes of later systems that wait for this
+        std::vector<size_t> Dependents;
+        std::vector<size_t> Dependencies;
+    };
+
+    struct RunState;
+
+    void _BuildDependencies();
+
+    static void _RunAvailable(const std::shared_ptr<RunState>& state);
+
+protected:
+    std::vector<ScheduledSystem> Systems;
+
+    //! Same indexes as Systems
+    std::vector<SystemTiming> Timings;
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::SystemScheduler;
+#endif
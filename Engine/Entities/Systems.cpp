@@ -15,22 +15,66 @@
 using namespace Leviathan;
 
 // ------------------ SendableSystem ------------------ //
-DLLEXPORT void HandleNode(ObjectID id, Sendable& obj, GameWorld& world)
+DLLEXPORT void SendableSystem::Run(
+    GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index)
 {
+    // Clients don't send entities //
+    if(!world.IsServerWorld())
+        return;
+
+    auto& interest = world.GetInterestManager();
+
+    // Grid cells only change when entities cross cell borders //
+    for(auto iter = index.begin(); iter != index.end(); ++iter) {
+
+        const auto* position = static_cast<Position*>(
+            std::get<0>(world.GetComponent(iter->first, Position::TYPE)));
+
+        if(position)
+            interest.UpdateEntity(iter->first, position->Members._Position);
+    }
+
+    RelevanceChanges.clear();
+    interest.UpdateRelevance(&RelevanceChanges);
+
+    // Entities that came into range are created on the player and ones that went out of
+    // range are destroyed //
+    for(const auto& change : RelevanceChanges) {
+
+        const auto sendable = index.find(change.Entity);
+
+        if(sendable != index.end())
+            world.HandleEntityRelevanceChange(change, *sendable->second);
+    }
+
+    for(auto iter = index.begin(); iter != index.end(); ++iter) {
+
+        auto& node = *iter->second;
+
+        // Unmarked entities are also checked as their last sent state may not have arrived
+        HandleNode(iter->first, node, world);
+
+        node.Marked = false;
+    }
+}
+
+DLLEXPORT void SendableSystem::HandleNode(ObjectID id, Sendable& obj, GameWorld& world)
+{
+    if(obj.UpdateReceivers.empty())
+        return;
 
     const auto ticknumber = world.GetTickNumber();
 
     // Create current state here as one or more connections should require it //
-    std::shared_ptr<ComponentState> curstate;
-
-    DEBUG_BREAK;
+    std::shared_ptr<PositionComponentState> curstate;
 
-    if(!curstate) {
+    try {
+        curstate = std::make_shared<PositionComponentState>(
+            ticknumber, world.GetComponent<Position>(id));
 
-        Logger::Get()->Error(
-            "SendableSystem: created invalid state for entity, id: " + Convert::ToString(id));
+    } catch(const NotFound&) {
 
-        obj.Marked = false;
+        // Only Position has network states //
         return;
     }
 
@@ -47,35 +91,36 @@ DLLEXPORT void HandleNode(ObjectID id, Sendable& obj, GameWorld& world)
             continue;
         }
 
+        // Far away players get fewer updates //
+        if(!world.GetInterestManager().ShouldSendUpdate(connection.get(), id, ticknumber)) {
+            ++iter;
+            continue;
+        }
+
         // Check has some of the packets been received //
         (*iter)->CheckReceivedPackets();
 
-        // Prepare the packet //
-        sf::Packet updatedata;
-
-        // Count the components that have states //
-        DEBUG_BREAK;
+        // Nothing to send if the client has confirmed the current state and there are no
+        // newer states that could still arrive
+        const auto& confirmed = (*iter)->LastConfirmedData;
 
-        // Do not use last confirmed if it is too old
-        int referencetick = -1;
+        if((*iter)->SentPackets.empty() && confirmed &&
+            confirmed->ComponentType == curstate->ComponentType &&
+            curstate->Matches(static_cast<const PositionComponentState&>(*confirmed))) {
+            ++iter;
+            continue;
+        }
 
-        if(ticknumber <
-            (*iter)->LastConfirmedTickNumber + BASESENDABLE_STORED_RECEIVED_STATES - 1) {
-            referencetick = (*iter)->LastConfirmedTickNumber;
+        // Prepare the packet //
+        sf::Packet updatedata;
 
-            // Now calculate a delta update from curstate to the last confirmed state //
-            DEBUG_BREAK;
-            // curstate->CreateUpdatePacket((*iter)->LastConfirmedData.get(), *packet.get());
+        updatedata << static_cast<uint16_t>(curstate->ComponentType);
 
-        } else {
+        // Old confirmed states are no longer stored by the client //
+        const auto reference = (*iter)->GetDeltaReference(ticknumber);
+        const int referencetick = reference ? reference->Tick : -1;
 
-            // Data is too old and cannot be used //
-            DEBUG_BREAK;
-            // curstate->CreateUpdatePacket(nullptr, *packet.get());
-
-            (*iter)->LastConfirmedTickNumber = -1;
-            (*iter)->LastConfirmedData.reset();
-        }
+        curstate->CreateUpdatePacket(reference.get(), updatedata);
 
         // Create the final update packet //
         auto sentthing = connection->SendPacketToConnection(
@@ -91,7 +136,7 @@ DLLEXPORT void HandleNode(ObjectID id, Sendable& obj, GameWorld& world)
 }
 // ------------------------------------ //
 DLLEXPORT void ReceivedSystem::Run(
-    std::unordered_map<ObjectID, Received*>& Index, GameWorld& world)
+    DenseComponentHolder<Received>::IndexView& Index, GameWorld& world)
 {
     const float progress = world.GetTickProgress();
     const auto tick = world.GetTickNumber();
@@ -102,7 +147,7 @@ DLLEXPORT void ReceivedSystem::Run(
 
         // Unmarked nodes should have invalid interpolation status
         if(!node.Marked)
-            return;
+            continue;
 
         if(!node.LocallyControlled) {
 
@@ -120,8 +165,21 @@ DLLEXPORT void ReceivedSystem::Run(
                 continue;
             }
 
-            DEBUG_BREAK;
-            // first->Interpolate(second, adjustedprogress);
+            // Only Position has network states //
+            if(first->DeltaData->ComponentType != Position::TYPE ||
+                second->DeltaData->ComponentType != Position::TYPE)
+                continue;
+
+            try {
+                static_cast<PositionComponentState*>(first->DirectData)
+                    ->Interpolate(world.GetComponent<Position>(iter->first),
+                        *static_cast<PositionComponentState*>(second->DirectData),
+                        adjustedprogress);
+
+            } catch(const NotFound&) {
+
+                node.Marked = false;
+            }
 
         } else {
 
@@ -129,10 +187,6 @@ DLLEXPORT void ReceivedSystem::Run(
         }
     }
 }
-// ------------------------------------ //
-DLLEXPORT void Leviathan::SendableSystem::HandleNode(
-    ObjectID id, Sendable& obj, GameWorld& world){DEBUG_BREAK}
-
 // ------------------------------------ //
 // AnimationTimeAdder
 DLLEXPORT void AnimationTimeAdder::Run(
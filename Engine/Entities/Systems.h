@@ -9,6 +9,7 @@
 #include "Include.h"
 
 #include "Components.h"
+#include "InterestManager.h"
 #include "StateInterpolator.h"
 #include "System.h"
 
@@ -67,27 +68,6 @@ public:
             this->ProcessNode(*iter->second, iter->first, heldstates, tick, timeintick);
         }
     }
-
-    //! \brief Creates nodes if matching ids are found in all data vectors or
-    //! already existing component holders
-    //!
-    //! \todo This should probably not be templated
-    void CreateNodes(const std::vector<std::tuple<RenderNode*, ObjectID>>& firstdata,
-        const std::vector<std::tuple<Position*, ObjectID>>& seconddata,
-        const ComponentHolder<RenderNode>& firstholder,
-        const ComponentHolder<Position>& secondholder)
-    {
-        TupleCachedComponentCollectionHelper(
-            CachedComponents, firstdata, seconddata, firstholder, secondholder);
-    }
-
-    //! \brief Destroys nodes if matching ids are found in the removed data data vectors
-    void DestroyNodes(const std::vector<std::tuple<RenderNode*, ObjectID>>& firstdata,
-        const std::vector<std::tuple<Position*, ObjectID>>& seconddata)
-    {
-        CachedComponents.RemoveBasedOnKeyTupleList(firstdata);
-        CachedComponents.RemoveBasedOnKeyTupleList(seconddata);
-    }
 };
 
 //! \brief Handles properties of Ogre nodes that have a changed RenderNode
@@ -126,34 +106,27 @@ private:
 
 
 //! \brief Sends updated entities from server to clients
+//!
+//! Each connection gets a delta against the last state it has confirmed receiving and
+//! nothing if it already has the current state
 //! \todo Change this to take distance into account
 //! don't send as many updates to clients far away
 class SendableSystem {
 public:
     //! \pre Final states for entities have been created for current tick
-    void Run(std::unordered_map<ObjectID, Sendable*>& index, GameWorld& world)
-    {
-
-        for(auto iter = index.begin(); iter != index.end(); ++iter) {
-
-            auto& node = *iter->second;
-
-            if(!node.Marked)
-                continue;
-
-            HandleNode(iter->first, node, world);
-
-            node.Marked = false;
-        }
-    }
+    DLLEXPORT void Run(GameWorld& world, std::unordered_map<ObjectID, Sendable*>& index);
 
 protected:
     DLLEXPORT void HandleNode(ObjectID id, Sendable& obj, GameWorld& world);
+
+private:
+    //! Reused by Run to collect the entities that entered or left player ranges
+    std::vector<InterestManager::RelevanceChange> RelevanceChanges;
 };
 
 //! \brief Interpolates states for received objects and handles locally controlled entities
 class ReceivedSystem {
 public:
-    DLLEXPORT void Run(std::unordered_map<ObjectID, Received*>& index, GameWorld& world);
+    DLLEXPORT void Run(DenseComponentHolder<Received>::IndexView& index, GameWorld& world);
 };
 } // namespace Leviathan
@@ -3,6 +3,9 @@
 
 #include "Exceptions.h"
 #include <boost/assign/list_of.hpp>
+
+#include <mutex>
+#include <unordered_map>
 using namespace Leviathan;
 using namespace std;
 // ------------------------------------ //
@@ -99,19 +102,19 @@ DLLEXPORT IntegerEventData* Leviathan::Event::GetIntegerDataForEvent() const
 DLLEXPORT Leviathan::GenericEvent::GenericEvent(
     const std::string& type, const NamedVars& copyvals) :
     TypeStr(new std::string(type)),
-    Variables(new NamedVars(copyvals))
+    TypeId(InternType(type)), Variables(new NamedVars(copyvals))
 {
 }
 
 DLLEXPORT Leviathan::GenericEvent::GenericEvent(
     std::string* takeownershipstr, NamedVars* takeownershipvars) :
     TypeStr(takeownershipstr),
-    Variables(takeownershipvars)
+    TypeId(InternType(*takeownershipstr)), Variables(takeownershipvars)
 {
 }
 
 DLLEXPORT Leviathan::GenericEvent::GenericEvent(const std::string& type) :
-    TypeStr(new std::string(type)), Variables(new NamedVars())
+    TypeStr(new std::string(type)), TypeId(InternType(type)), Variables(new NamedVars())
 {
 }
 
@@ -134,6 +137,8 @@ DLLEXPORT Leviathan::GenericEvent::GenericEvent(sf::Packet& packet)
     // Try to get the named variables //
     unique_ptr<NamedVars> tmpvars(new NamedVars(packet));
 
+    TypeId = InternType(*tmpstr);
+
     // Take the string away from the smart pointer //
     TypeStr = tmpstr.release();
 
@@ -159,6 +164,23 @@ DLLEXPORT std::string Leviathan::GenericEvent::GetType() const
     return *TypeStr;
 }
 
+DLLEXPORT uint32_t GenericEvent::InternType(const std::string& type)
+{
+    static std::mutex internlock;
+    static std::unordered_map<std::string, uint32_t> internedtypes;
+
+    std::lock_guard<std::mutex> lock(internlock);
+
+    const auto iter = internedtypes.find(type);
+
+    if(iter != internedtypes.end())
+        return iter->second;
+
+    const auto id = static_cast<uint32_t>(internedtypes.size());
+    internedtypes.emplace(type, id);
+    return id;
+}
+
 DLLEXPORT const NamedVars Leviathan::GenericEvent::GetVariablesConst() const
 {
     return *Variables;
@@ -149,6 +149,9 @@ public:
 
     REFERENCE_COUNTED_PTR_TYPE(Event);
 
+    template<class DataType>
+    friend class ReusableEvent;
+
 protected:
     //! Events type
     EVENT_TYPE Type;
@@ -187,24 +190,82 @@ public:
     DLLEXPORT NamedVars* GetNamedVarsRefCounted();
 
     //! Returns the TypeStr ptr
+    //! \warning The type shouldn't be changed through this as the interned type id isn't
+    //! updated
     DLLEXPORT std::string* GetTypePtr();
     //! \brief Returns the name of the event
     //! \see GetTypePtr
     DLLEXPORT std::string GetType() const;
 
+    //! \returns The interned id of the type
+    //! \see InternType
+    inline uint32_t GetTypeId() const
+    {
+        return TypeId;
+    }
+
+    //! \returns A small id that is the same for all generic events with the type
+    //!
+    //! The ids are shared by all EventHandlers and are never removed. EventHandler uses these
+    //! to find the listeners without comparing strings
+    DLLEXPORT static uint32_t InternType(const std::string& type);
+
     REFERENCE_COUNTED_PTR_TYPE(GenericEvent);
 
 protected:
     //! String that defines this event's type
     std::string* TypeStr;
 
+    //! Interned id of TypeStr
+    uint32_t TypeId;
+
     //! Pointer to this event's variables
     NamedVars* Variables;
 };
 
+//! \brief Keeps an Event around so that it can be sent again without allocating
+//!
+//! Get returns the same Event with new data as long as no listener has kept a reference to
+//! the previous one. If one has a new Event is created so listeners holding on to events
+//! still work. Use with EventHandler::CallEvent(Event&)
+//! \warning Not thread safe, each thread should use its own ReusableEvent
+template<class DataType>
+class ReusableEvent {
+public:
+    ReusableEvent(EVENT_TYPE type) : Type(type) {}
+
+    ~ReusableEvent()
+    {
+        SAFE_RELEASE(Current);
+    }
+
+    ReusableEvent(const ReusableEvent& other) = delete;
+    ReusableEvent& operator=(const ReusableEvent& other) = delete;
+
+    //! \returns An Event that only this references with data constructed from args
+    template<class... Args>
+    Event& Get(Args&&... args)
+    {
+        if(Current && Current->GetRefCount() == 1) {
+
+            *static_cast<DataType*>(Current->Data) = DataType(std::forward<Args>(args)...);
+            return *Current;
+        }
+
+        SAFE_RELEASE(Current);
+        Current = new Event(Type, new DataType(std::forward<Args>(args)...));
+        return *Current;
+    }
+
+private:
+    const EVENT_TYPE Type;
+    Event* Current = nullptr;
+};
+
 } // namespace Leviathan
 
 #ifdef LEAK_INTO_GLOBAL
 using Leviathan::Event;
 using Leviathan::GenericEvent;
+using Leviathan::ReusableEvent;
 #endif
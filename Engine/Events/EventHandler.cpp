@@ -1,138 +1,299 @@
 // ------------------------------------ //
 #include "EventHandler.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
 using namespace Leviathan;
 using namespace std;
 // ------------------------------------ //
-EventHandler::EventHandler(){
+namespace {
+//! Number of events being called by this thread. Retired tables can't be waited for while a
+//! listener is running as that would wait for itself
+thread_local int EventsCalledByThisThread = 0;
+} // namespace
 
-}
+//! \brief Marks an event as running while it reads the listener table
+class EventHandler::DispatchScope {
+public:
+    DispatchScope(const EventHandler& handler) : Handler(handler)
+    {
+        ++EventsCalledByThisThread;
 
-EventHandler::~EventHandler(){
+        Counter = Handler.DispatchEpoch.load() & 1;
+        Handler.ActiveDispatches[Counter].fetch_add(1);
 
-}
+        // Loaded after the counter is incremented so that the table can't be retired and
+        // deleted without waiting for this //
+        Table = Handler.Listeners.load();
+    }
+
+    ~DispatchScope()
+    {
+        Handler.ActiveDispatches[Counter].fetch_sub(1, std::memory_order_release);
+
+        --EventsCalledByThisThread;
+    }
+
+    const EventHandler& Handler;
+    uint32_t Counter;
+    const ListenerTable* Table;
+};
 // ------------------------------------ //
-bool EventHandler::Init(){
-	return true;
+EventHandler::EventHandler() : Listeners(new ListenerTable())
+{
+    ActiveDispatches[0].store(0);
+    ActiveDispatches[1].store(0);
 }
 
-void EventHandler::Release(){
-	GUARD_LOCK();
+EventHandler::~EventHandler()
+{
+    // No events can be running anymore //
+    delete Listeners.load();
 
-    
-    
-	// Release listeners //
-	EventListeners.clear();
-	GenericEventListeners.clear();
+    for(auto table : RetiredTables)
+        delete table;
 }
 // ------------------------------------ //
-void EventHandler::CallEvent(Event* event){
-
-    const auto type = event->GetType();
+bool EventHandler::Init()
+{
+    return true;
+}
 
-    GUARD_LOCK();
+void EventHandler::Release()
+{
+    // Release listeners //
+    _ChangeListeners(
+        [](ListenerTable& table) {
+            table = ListenerTable();
+            return true;
+        },
+        true);
+}
+// ------------------------------------ //
+void EventHandler::CallEvent(Event* event)
+{
+    CallEvent(*event);
+    event->Release();
+}
 
-	for(auto iter = EventListeners.begin(); iter != EventListeners.end(); ){
+DLLEXPORT void EventHandler::CallEvent(Event& event)
+{
+    const auto type = event.GetType();
 
-		if(std::get<1>(*iter) == type){
+    if(type < 0 || type >= EVENT_TYPE_ALL)
+        return;
 
-			const auto result = std::get<0>(*iter)->OnEvent(event);
+    std::vector<CallableObject*> unregister;
 
-            if(result == -1){
+    {
+        DispatchScope scope(*this);
 
-                // Unregister requested //
-                iter = EventListeners.erase(iter);
-                continue;
-            }
-		}
+        for(CallableObject* listener : scope.Table->EventListeners[type]) {
 
-        ++iter;
-	}
+            // -1 means that unregister is requested //
+            if(listener->OnEvent(&event) == -1)
+                unregister.push_back(listener);
+        }
+    }
 
-    event->Release();
+    // Waiting here could deadlock with whatever the caller has locked //
+    for(CallableObject* listener : unregister)
+        _RemoveListener(listener, type, false, false);
 }
 
-DLLEXPORT void Leviathan::EventHandler::CallEvent(GenericEvent* event){
+DLLEXPORT void Leviathan::EventHandler::CallEvent(GenericEvent* event)
+{
+    const auto type = event->GetTypeId();
 
-    const auto type = event->GetType();
-    
-	GUARD_LOCK();
-    
-	// Loop generic listeners //
-	for(auto iter = GenericEventListeners.begin(); iter != GenericEventListeners.end(); ){
+    std::vector<CallableObject*> unregister;
 
-		if(std::get<1>(*iter) == type){
+    {
+        DispatchScope scope(*this);
 
-			const auto result = std::get<0>(*iter)->OnGenericEvent(event);
+        if(type < scope.Table->GenericEventListeners.size()) {
 
-            if(result == -1){
+            for(CallableObject* listener : scope.Table->GenericEventListeners[type]) {
 
-                // Unregister requested //
-                iter = GenericEventListeners.erase(iter);
-                continue;
+                if(listener->OnGenericEvent(event) == -1)
+                    unregister.push_back(listener);
             }
-		}
+        }
+    }
 
-        ++iter;
-	}
+    for(CallableObject* listener : unregister)
+        _RemoveGenericListener(listener, type, false, false);
 
     event->Release();
 }
 // ------------------------------------ //
-bool EventHandler::RegisterForEvent(CallableObject* toregister, EVENT_TYPE totype){
-	GUARD_LOCK();
-	EventListeners.push_back(std::make_tuple(toregister, totype));
-	return true;
+bool EventHandler::RegisterForEvent(CallableObject* toregister, EVENT_TYPE totype)
+{
+    if(totype < 0 || totype >= EVENT_TYPE_ALL)
+        return false;
+
+    _ChangeListeners(
+        [&](ListenerTable& table) {
+            table.EventListeners[totype].push_back(toregister);
+            return true;
+        },
+        true);
+
+    return true;
 }
 
 DLLEXPORT bool Leviathan::EventHandler::RegisterForEvent(CallableObject* toregister,
     const std::string &genericname)
 {
-	GUARD_LOCK();
-	GenericEventListeners.push_back(std::make_tuple(toregister, genericname));
-	return true;
-}
+    const auto type = GenericEvent::InternType(genericname);
+
+    _ChangeListeners(
+        [&](ListenerTable& table) {
+            if(table.GenericEventListeners.size() <= type)
+                table.GenericEventListeners.resize(type + 1);
 
-void EventHandler::Unregister(CallableObject* caller, EVENT_TYPE type, bool all){
-	GUARD_LOCK();
-    
-	// Loop and remove wanted objects //
-	for(auto iter = EventListeners.begin(); iter != EventListeners.end(); ){
+            table.GenericEventListeners[type].push_back(toregister);
+            return true;
+        },
+        true);
 
-		if(std::get<0>(*iter) == caller){
-    
-			// check type or if all is specified delete //
-			if(all || type == std::get<1>(*iter)){
-                
-				iter = EventListeners.erase(iter);
-                continue;
-			}
-		}
+    return true;
+}
 
-        ++iter;
-	}
+void EventHandler::Unregister(CallableObject* caller, EVENT_TYPE type, bool all)
+{
+    _RemoveListener(caller, type, all, true);
 }
 
 DLLEXPORT void Leviathan::EventHandler::Unregister(CallableObject* caller,
     const std::string &genericname,
     bool all /*= false*/)
 {
-	GUARD_LOCK();
-    
-	// Loop and remove wanted objects //
-	for(auto iter = GenericEventListeners.begin(); iter != GenericEventListeners.end(); ){
+    _RemoveGenericListener(
+        caller, all ? 0 : GenericEvent::InternType(genericname), all, true);
+}
+// ------------------------------------ //
+DLLEXPORT size_t EventHandler::GetListenerCount(EVENT_TYPE type) const
+{
+    if(type < 0 || type >= EVENT_TYPE_ALL)
+        return 0;
 
-		if(std::get<0>(*iter) == caller){
-    
-			// check type or if all is specified delete //
-			if(all || genericname == std::get<1>(*iter)){
-                
-				iter = GenericEventListeners.erase(iter);
-                continue;
-			}
-		}
+    DispatchScope scope(*this);
+    return scope.Table->EventListeners[type].size();
+}
 
-        ++iter;
-	}
+DLLEXPORT size_t EventHandler::GetListenerCount(const std::string &genericname) const
+{
+    const auto type = GenericEvent::InternType(genericname);
+
+    DispatchScope scope(*this);
+
+    if(type >= scope.Table->GenericEventListeners.size())
+        return 0;
+
+    return scope.Table->GenericEventListeners[type].size();
 }
 // ------------------------------------ //
+template<class Changer>
+void EventHandler::_ChangeListeners(Changer changer, bool waitforevents)
+{
+    {
+        GUARD_LOCK();
 
+        const ListenerTable* current = Listeners.load();
+
+        std::unique_ptr<ListenerTable> changed(new ListenerTable(*current));
+
+        if(!changer(*changed))
+            return;
+
+        Listeners.store(changed.release());
+        RetiredTables.push_back(current);
+    }
+
+    if(waitforevents)
+        _DeleteRetiredTables();
+}
+
+void EventHandler::_RemoveListener(CallableObject* caller, EVENT_TYPE type, bool all,
+    bool waitforevents)
+{
+    _ChangeListeners(
+        [&](ListenerTable& table) {
+            bool removed = false;
+
+            for(size_t i = 0; i < table.EventListeners.size(); ++i) {
+
+                // check type or if all is specified delete //
+                if(!all && i != static_cast<size_t>(type))
+                    continue;
+
+                auto& listeners = table.EventListeners[i];
+
+                const auto end = std::remove(listeners.begin(), listeners.end(), caller);
+
+                removed = removed || end != listeners.end();
+                listeners.erase(end, listeners.end());
+            }
+
+            return removed;
+        },
+        waitforevents);
+}
+
+void EventHandler::_RemoveGenericListener(CallableObject* caller, uint32_t genericid,
+    bool all, bool waitforevents)
+{
+    _ChangeListeners(
+        [&](ListenerTable& table) {
+            bool removed = false;
+
+            for(size_t i = 0; i < table.GenericEventListeners.size(); ++i) {
+
+                if(!all && i != genericid)
+                    continue;
+
+                auto& listeners = table.GenericEventListeners[i];
+
+                const auto end = std::remove(listeners.begin(), listeners.end(), caller);
+
+                removed = removed || end != listeners.end();
+                listeners.erase(end, listeners.end());
+            }
+
+            return removed;
+        },
+        waitforevents);
+}
+
+void EventHandler::_DeleteRetiredTables()
+{
+    if(EventsCalledByThisThread > 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(RetireMutex);
+
+    std::vector<const ListenerTable*> retired;
+
+    {
+        GUARD_LOCK();
+        retired.swap(RetiredTables);
+    }
+
+    if(retired.empty())
+        return;
+
+    // An event that read the epoch before it was flipped can increment the old counter after
+    // the first wait, that is why this is done twice //
+    for(int i = 0; i < 2; ++i) {
+
+        const auto counter = DispatchEpoch.fetch_add(1) & 1;
+
+        while(ActiveDispatches[counter].load() != 0)
+            std::this_thread::yield();
+    }
+
+    for(auto table : retired)
+        delete table;
+}
+// ------------------------------------ //
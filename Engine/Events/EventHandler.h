@@ -6,10 +6,20 @@
 #include "Event.h"
 #include "CallableObject.h"
 
+#include <array>
+#include <atomic>
+#include <mutex>
+
 namespace Leviathan{
 
 //! \brief Allows object to register for events that can be fired from anywhere
+//!
+//! The listeners are kept in an immutable table with a list for each event type and generic
+//! event type id. Registering creates a new table so that calling events doesn't need to
+//! lock. Old tables are deleted once no event that could be using them is running
 class EventHandler : public ThreadSafe{
+    class DispatchScope;
+
 public:
     DLLEXPORT EventHandler();
     DLLEXPORT ~EventHandler();
@@ -20,20 +30,68 @@ public:
     //! \param event The event to send. Reference count will be decremented by this
     DLLEXPORT void CallEvent(Event* event);
 
+    //! \brief Sends an event without touching its reference count
+    //!
+    //! Use with ReusableEvent to send events without allocating
+    DLLEXPORT void CallEvent(Event& event);
+
     //! \param event The event to send. Reference count will be decremented by this
     DLLEXPORT void CallEvent(GenericEvent* event);
 
     DLLEXPORT bool RegisterForEvent(CallableObject* toregister, EVENT_TYPE totype);
     DLLEXPORT bool RegisterForEvent(CallableObject* toregister,
         const std::string &genericname);
-    
+
+    //! \note Unless called from a listener this waits for events that are running in other
+    //! threads to finish so that caller won't be called after this returns
     DLLEXPORT void Unregister(CallableObject* caller, EVENT_TYPE type, bool all = false);
     DLLEXPORT void Unregister(CallableObject* caller, const std::string &genericname,
         bool all = false);
 
+    //! \returns The number of listeners for type
+    DLLEXPORT size_t GetListenerCount(EVENT_TYPE type) const;
+    DLLEXPORT size_t GetListenerCount(const std::string &genericname) const;
+
+private:
+    using ListenerList = std::vector<CallableObject*>;
+
+    struct ListenerTable{
+
+        std::array<ListenerList, EVENT_TYPE_ALL> EventListeners;
+
+        //! Indexed by GenericEvent::GetTypeId
+        std::vector<ListenerList> GenericEventListeners;
+    };
+
+    //! \brief Replaces Listeners with a changed copy
+    //! \param changer Called with the copy, return false to keep the old table
+    //! \param waitforevents If true retired tables are deleted before returning
+    template<class Changer>
+    void _ChangeListeners(Changer changer, bool waitforevents);
+
+    void _RemoveListener(CallableObject* caller, EVENT_TYPE type, bool all,
+        bool waitforevents);
+    void _RemoveGenericListener(CallableObject* caller, uint32_t genericid, bool all,
+        bool waitforevents);
+
+    //! \brief Waits until no running event can use the retired tables and deletes them
+    //! \note Does nothing if called from a listener
+    void _DeleteRetiredTables();
+
 private:
-    std::vector<std::tuple<CallableObject*, EVENT_TYPE>> EventListeners;
-    std::vector<std::tuple<CallableObject*, std::string>> GenericEventListeners;
+    //! The current listeners. Read without locking by CallEvent
+    std::atomic<const ListenerTable*> Listeners;
+
+    //! Tables that have been replaced but may still be in use
+    std::vector<const ListenerTable*> RetiredTables;
+
+    //! Events increment the counter selected by the lowest bit of DispatchEpoch. Deleting
+    //! tables flips the epoch and waits for the previous counter to become 0, twice
+    std::atomic<uint32_t> DispatchEpoch = {0};
+    mutable std::array<std::atomic<int32_t>, 2> ActiveDispatches;
+
+    //! Only one thread waits for the events to finish at once
+    std::mutex RetireMutex;
 };
 
 }
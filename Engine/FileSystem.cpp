@@ -2,6 +2,9 @@
 // ------------------------------------ //
 #include "FileSystem.h"
 
+#include "AssetArchive.h"
+#include "Handlers/ResourceRefreshHandler.h"
+
 #ifdef LEVIATHAN_USING_OGRE
 #include "OgreResourceGroupManager.h"
 #endif
@@ -12,6 +15,9 @@
 #endif
 #include "TimeIncludes.h"
 
+#include <algorithm>
+#include <cctype>
+#include <ctime>
 #include <fstream>
 #include <ostream>
 
@@ -31,6 +37,16 @@
 using namespace Leviathan;
 using namespace std;
 // ------------------------------------ //
+//! The folder that Init searches
+#ifdef _WIN32
+static const string DataSearchFolder = "./Data/";
+#else
+static const string DataSearchFolder = "./Data";
+#endif
+
+//! First line of the index cache file, changed when the format changes
+static const string IndexCacheHeader = "LeviathanFileIndex 1";
+// ------------------------------------ //
 Leviathan::FileSystem::FileSystem()
 {
     // set static access //
@@ -50,30 +66,13 @@ Leviathan::FileSystem::~FileSystem()
     if(Staticaccess == this)
         Staticaccess = nullptr;
 
-    SAFE_DELETE_VECTOR(FileTypes);
-
-    AllFiles.clear();
-
-    TextureFiles.clear();
-    ModelFiles.clear();
-    SoundFiles.clear();
-    ScriptFiles.clear();
-
-    // Clear indexes //
-    IsAllIndexed = false;
-    SAFE_DELETE_VECTOR(AllIndexes);
+    // The handler may have already been released, which stops all the listeners //
+    if(DataFolderListenerID != -1 && ResourceRefreshHandler::Get())
+        ResourceRefreshHandler::Get()->StopListeningForFileChanges(DataFolderListenerID);
 
-    IsTextureIndexed = false;
-    SAFE_DELETE_VECTOR(TextureIndexes);
+    _ClearFiles();
 
-    IsModelIndexed = false;
-    SAFE_DELETE_VECTOR(ModelIndexes);
-
-    IsSoundIndexed = false;
-    SAFE_DELETE_VECTOR(SoundIndexes);
-
-    IsScriptIndexed = false;
-    SAFE_DELETE_VECTOR(ScriptIndexes);
+    SAFE_DELETE_VECTOR(FileTypes);
 }
 
 DLLEXPORT FileSystem* FileSystem::Get()
@@ -90,6 +89,8 @@ string Leviathan::FileSystem::TextureFolder = "Textures/";
 string Leviathan::FileSystem::MaterialFolder = "Materials/";
 string Leviathan::FileSystem::FontFolder = "Fonts/";
 string Leviathan::FileSystem::SoundFolder = "Sound/";
+string Leviathan::FileSystem::DataArchive = "./Data.lvpk";
+string Leviathan::FileSystem::IndexCacheFile = "./FileIndex.cache";
 
 FileSystem* Leviathan::FileSystem::Staticaccess = NULL;
 // ------------------------------------ //
@@ -100,13 +101,33 @@ DLLEXPORT bool Leviathan::FileSystem::Init(LErrorReporter* errorreport)
 
     IsSorted = false;
 
+    // The archive replaces searching the data folder //
+    if(boost::filesystem::exists(DataArchive)) {
+
+        auto starttime = Time::GetTimeMicro64();
+
+        if(!MountArchive(DataArchive))
+            return false;
+
+        ErrorReporter->Info("FileSystem: mounted " + DataArchive + " with " +
+                            Convert::ToString(AllFiles.size()) + " files, took " +
+                            Convert::ToString(Time::GetTimeMicro64() - starttime) +
+                            " micro seconds");
+        return true;
+    }
+
     // use find files function on data folder and then save results to appropriate vectors //
     vector<string> files;
-#ifdef _WIN32
-    GetFilesInDirectory(files, "./Data/");
-#else
-    GetFilesInDirectory(files, "./Data");
-#endif
+
+    IndexLoadedFromCache = _LoadIndexCache(files);
+
+    if(!IndexLoadedFromCache) {
+
+        vector<string> directories;
+        GetFilesInDirectory(files, DataSearchFolder, "*.*", true, &directories);
+
+        _SaveIndexCache(files, directories);
+    }
 
     if(files.size() < 1) {
 
@@ -119,37 +140,13 @@ DLLEXPORT bool Leviathan::FileSystem::Init(LErrorReporter* errorreport)
     // save to appropriate places //
     for(size_t i = 0; i < files.size(); i++) {
 
-        // create new object for storing this //
-        auto tmpptr = make_shared<FileDefinitionType>(this, files[i]);
-
-        if(files[i].find("./Data/Textures/") == 0) {
-
-            // add to texture files //
-            TextureFiles.push_back((tmpptr));
-
-        } else if(files[i].find("./Data/Models/") == 0) {
-
-            // add to texture files //
-            ModelFiles.push_back(tmpptr);
-
-        } else if(files[i].find("./Data/Sound/") == 0) {
-
-            // add to texture files //
-            SoundFiles.push_back(tmpptr);
-
-        } else if(files[i].find("./Data/Scripts/") == 0) {
-
-            // add to texture files //
-            ScriptFiles.push_back(tmpptr);
-        }
-
-        // everything should be in AllFiles vector //
-        AllFiles.push_back(tmpptr);
+        _AddFile(files[i]);
     }
     // print some info //
     ErrorReporter->Info("FileSystem: found " + Convert::ToString(AllFiles.size()) +
                         " files in Data folder with " + Convert::ToString(FileTypes.size()) +
-                        " different types of extensions");
+                        " different types of extensions" +
+                        (IndexLoadedFromCache ? " (from the index cache)" : ""));
 
     // sort for quick finding //
     auto starttime = Time::GetTimeMicro64();
@@ -171,33 +168,361 @@ DLLEXPORT bool Leviathan::FileSystem::ReSearchFiles()
     CurrentFileExtID = 25;
     IsSorted = false;
 
+    _ClearFiles();
+
     SAFE_DELETE_VECTOR(FileTypes);
 
-    AllFiles.clear();
+    MountedArchives.clear();
 
-    TextureFiles.clear();
-    ModelFiles.clear();
-    SoundFiles.clear();
-    ScriptFiles.clear();
+    // Search again //
+    return Init(ErrorReporter);
+}
+
+DLLEXPORT bool FileSystem::MountArchive(const string& file)
+{
+    unique_ptr<AssetArchive> archive;
+
+    try {
+        archive = std::make_unique<AssetArchive>(file);
+    } catch(const InvalidArgument& e) {
+
+        ErrorReporter->Error("FileSystem: MountArchive: " + string(e.what()));
+        return false;
+    }
+
+    for(size_t i = 0; i < archive->GetEntryCount(); ++i) {
+
+        _AddFile(string(archive->GetPath(archive->GetEntry(i))));
+    }
+
+    MountedArchives.push_back(std::move(archive));
+
+    // The new files need to be sorted //
+    IsSorted = false;
+    CreateIndexesForVecs(true);
+    return true;
+}
+
+void FileSystem::_AddFile(const string& path)
+{
+    // create new object for storing this //
+    auto tmpptr = make_shared<FileDefinitionType>(this, path);
+
+    FileIndex* index;
+    bool* indexed;
+
+    auto* group = _GetGroupVector(path, &index, &indexed);
+
+    if(group)
+        group->push_back(tmpptr);
+
+    // everything should be in AllFiles vector //
+    AllFiles.push_back(tmpptr);
+}
+
+vector<shared_ptr<FileDefinitionType>>* FileSystem::_GetGroupVector(
+    const string& path, FileIndex** index, bool** indexed)
+{
+    if(path.find("./Data/Textures/") == 0) {
+
+        *index = &TextureIndex;
+        *indexed = &IsTextureIndexed;
+        return &TextureFiles;
+
+    } else if(path.find("./Data/Models/") == 0) {
+
+        *index = &ModelIndex;
+        *indexed = &IsModelIndexed;
+        return &ModelFiles;
+
+    } else if(path.find("./Data/Sound/") == 0) {
+
+        *index = &SoundIndex;
+        *indexed = &IsSoundIndexed;
+        return &SoundFiles;
+
+    } else if(path.find("./Data/Scripts/") == 0) {
 
-    // Clear indexes //
+        *index = &ScriptIndex;
+        *indexed = &IsScriptIndexed;
+        return &ScriptFiles;
+    }
+
+    return nullptr;
+}
+
+void FileSystem::_ClearFiles()
+{
+    // The indexes point to the files so they are cleared first //
     IsAllIndexed = false;
-    SAFE_DELETE_VECTOR(AllIndexes);
+    AllIndex.Clear();
 
     IsTextureIndexed = false;
-    SAFE_DELETE_VECTOR(TextureIndexes);
+    TextureIndex.Clear();
 
     IsModelIndexed = false;
-    SAFE_DELETE_VECTOR(ModelIndexes);
+    ModelIndex.Clear();
 
     IsSoundIndexed = false;
-    SAFE_DELETE_VECTOR(SoundIndexes);
+    SoundIndex.Clear();
 
     IsScriptIndexed = false;
-    SAFE_DELETE_VECTOR(ScriptIndexes);
+    ScriptIndex.Clear();
 
-    // Search again //
-    return Init(ErrorReporter);
+    AllFiles.clear();
+
+    TextureFiles.clear();
+    ModelFiles.clear();
+    SoundFiles.clear();
+    ScriptFiles.clear();
+}
+// ------------------------------------ //
+DLLEXPORT void FileSystem::AddToIndex(const string& path)
+{
+    if(boost::filesystem::is_directory(path)) {
+
+        vector<string> files;
+        GetFilesInDirectory(files, path);
+
+        for(const auto& file : files)
+            AddToIndex(file);
+
+        return;
+    }
+
+    // Hidden files aren't indexed by Init either //
+    const auto name = StringOperations::RemovePath<std::string>(path);
+
+    if(name.empty() || name[0] == '.')
+        return;
+
+    auto file = make_shared<FileDefinitionType>(this, path);
+
+    // Files can be reported again when a folder is created with files in it //
+    if(IsAllIndexed) {
+
+        if(AllIndex.FindPath(*file))
+            return;
+
+    } else {
+
+        for(const auto& existing : AllFiles) {
+            if(existing->RelativePath == path)
+                return;
+        }
+    }
+
+    FileIndex* groupindex = nullptr;
+    bool* groupindexed = nullptr;
+    auto* group = _GetGroupVector(path, &groupindex, &groupindexed);
+
+    // The vectors are kept sorted //
+    const auto insertfile = [&](vector<shared_ptr<FileDefinitionType>>& vec, FileIndex& index,
+                                bool indexed) {
+        if(IsSorted) {
+            vec.insert(upper_bound(vec.begin(), vec.end(), file, FileDefSorter()), file);
+        } else {
+            vec.push_back(file);
+        }
+
+        if(indexed)
+            index.Add(file.get());
+    };
+
+    insertfile(AllFiles, AllIndex, IsAllIndexed);
+
+    if(group)
+        insertfile(*group, *groupindex, *groupindexed);
+}
+
+DLLEXPORT void FileSystem::RemoveFromIndex(const string& path)
+{
+    // A folder removes all the files in it //
+    const string folderprefix = path + "/";
+
+    const auto removefiles = [&](vector<shared_ptr<FileDefinitionType>>& vec,
+                                 FileIndex& index, bool indexed) {
+        const auto newend =
+            remove_if(vec.begin(), vec.end(), [&](const shared_ptr<FileDefinitionType>& file) {
+                if(file->RelativePath != path &&
+                    file->RelativePath.compare(0, folderprefix.size(), folderprefix) != 0)
+                    return false;
+
+                if(indexed)
+                    index.Remove(file.get());
+
+                return true;
+            });
+
+        vec.erase(newend, vec.end());
+    };
+
+    removefiles(TextureFiles, TextureIndex, IsTextureIndexed);
+    removefiles(ModelFiles, ModelIndex, IsModelIndexed);
+    removefiles(SoundFiles, SoundIndex, IsSoundIndexed);
+    removefiles(ScriptFiles, ScriptIndex, IsScriptIndexed);
+    removefiles(AllFiles, AllIndex, IsAllIndexed);
+}
+
+DLLEXPORT bool FileSystem::ListenForDataFolderChanges(ResourceRefreshHandler* handler)
+{
+    // Archives don't change //
+    if(DataFolderListenerID != -1 || !MountedArchives.empty())
+        return true;
+
+    int id = -1;
+
+    if(!handler->ListenForFolderChanges(DataSearchFolder,
+           [this](const string& path, bool created) {
+               if(created) {
+                   AddToIndex(path);
+               } else {
+                   RemoveFromIndex(path);
+               }
+           },
+           id))
+        return false;
+
+    DataFolderListenerID = id;
+    return true;
+}
+// ------------------------------------ //
+bool FileSystem::_LoadIndexCache(vector<string>& files) const
+{
+    if(IndexCacheFile.empty())
+        return false;
+
+    ifstream reader(IndexCacheFile, ios::in | ios::binary);
+
+    if(!reader)
+        return false;
+
+    string line;
+
+    if(!getline(reader, line) || line != IndexCacheHeader)
+        return false;
+
+    vector<string> cachedfiles;
+    bool foundroot = false;
+
+    while(getline(reader, line)) {
+
+        if(line.size() < 3 || line[1] != ' ')
+            return false;
+
+        if(line[0] == 'F') {
+
+            cachedfiles.push_back(line.substr(2));
+
+        } else if(line[0] == 'D') {
+
+            // Adding or removing files in a folder changes its modification time //
+            const auto separator = line.find(' ', 2);
+
+            if(separator == string::npos)
+                return false;
+
+            const auto folder = line.substr(separator + 1);
+
+            boost::system::error_code error;
+            const auto modified = boost::filesystem::last_write_time(folder, error);
+
+            if(error || to_string(modified) != line.substr(2, separator - 2))
+                return false;
+
+            if(folder == DataSearchFolder)
+                foundroot = true;
+
+        } else {
+
+            return false;
+        }
+    }
+
+    if(!foundroot)
+        return false;
+
+    files.insert(files.end(), cachedfiles.begin(), cachedfiles.end());
+    return true;
+}
+
+void FileSystem::_SaveIndexCache(
+    const vector<string>& files, const vector<string>& directories) const
+{
+    if(IndexCacheFile.empty())
+        return;
+
+    // A change in the same second that the cache is saved in wouldn't change the
+    // modification time so the cache isn't saved if a folder was just modified
+    const auto now = time(nullptr);
+
+    string data = IndexCacheHeader + "\n";
+
+    const auto adddirectory = [&](const string& folder) {
+        boost::system::error_code error;
+        const auto modified = boost::filesystem::last_write_time(folder, error);
+
+        if(error || modified + 1 >= now || folder.find('\n') != string::npos)
+            return false;
+
+        data += "D " + to_string(modified) + " " + folder + "\n";
+        return true;
+    };
+
+    if(!adddirectory(DataSearchFolder))
+        return;
+
+    for(const auto& directory : directories) {
+        if(!adddirectory(directory))
+            return;
+    }
+
+    for(const auto& file : files) {
+
+        if(file.find('\n') != string::npos)
+            return;
+
+        data += "F " + file + "\n";
+    }
+
+    // Written to a temporary file first so that a partially written cache isn't used //
+    const auto temporary = IndexCacheFile + ".tmp";
+
+    if(!WriteToFile(data, temporary))
+        return;
+
+    boost::system::error_code error;
+    boost::filesystem::rename(temporary, IndexCacheFile, error);
+}
+
+//! \returns The entry of a file in the first archive that has it or null
+static const AssetArchive::Entry* FindInArchives(
+    const vector<unique_ptr<AssetArchive>>& archives, const string& file,
+    const AssetArchive*& foundarchive)
+{
+    for(const auto& archive : archives) {
+
+        const auto* entry = archive->Find(file);
+
+        if(entry) {
+
+            foundarchive = archive.get();
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+DLLEXPORT std::string_view FileSystem::GetArchivedFileData(const string& file) const
+{
+    const AssetArchive* archive = nullptr;
+    const auto* entry = FindInArchives(MountedArchives, file, archive);
+
+    if(!entry)
+        return std::string_view();
+
+    return archive->GetUncompressedData(*entry);
 }
 // ------------------------------------ //
 string Leviathan::FileSystem::GetDataFolder()
@@ -305,6 +630,30 @@ void Leviathan::FileSystem::SetTextureFolder(const string& folder)
 
     TextureFolder = folder;
 }
+
+DLLEXPORT void FileSystem::SetDataArchive(const string& file)
+{
+
+    DataArchive = file;
+}
+
+DLLEXPORT string FileSystem::GetDataArchive()
+{
+
+    return DataArchive;
+}
+
+DLLEXPORT void FileSystem::SetIndexCacheFile(const string& file)
+{
+
+    IndexCacheFile = file;
+}
+
+DLLEXPORT string FileSystem::GetIndexCacheFile()
+{
+
+    return IndexCacheFile;
+}
 // ------------------ File handling ------------------ //
 DLLEXPORT bool FileSystem::LoadDataDump(const string& file,
     vector<shared_ptr<NamedVariableList>>& vec, LErrorReporter* errorreport)
@@ -347,7 +696,8 @@ DLLEXPORT bool FileSystem::LoadDataDump(const string& file,
 
 #ifdef _WIN32
 DLLEXPORT bool Leviathan::FileSystem::GetFilesInDirectory(vector<string>& files,
-    const string& dirpath, const string& pattern, bool recursive /*= true*/)
+    const string& dirpath, const string& pattern, bool recursive /*= true*/,
+    vector<string>* directories /*= nullptr*/)
 {
     string FilePath;
     string Pattern;
@@ -366,9 +716,13 @@ DLLEXPORT bool Leviathan::FileSystem::GetFilesInDirectory(vector<string>& files,
 
                 if(FileInfo.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
 
+                    if(directories)
+                        directories->push_back(dirpath + FileInfo.cFileName);
+
                     if(recursive) {
                         // call self to search subdirectory
-                        int retr = GetFilesInDirectory(files, FilePath, pattern, recursive);
+                        int retr = GetFilesInDirectory(
+                            files, FilePath, pattern, recursive, directories);
                         if(!retr)
                             break; // failed //
                     }
@@ -387,7 +741,8 @@ DLLEXPORT bool Leviathan::FileSystem::GetFilesInDirectory(vector<string>& files,
 }
 #else
 DLLEXPORT bool Leviathan::FileSystem::GetFilesInDirectory(vector<string>& files,
-    const string& dirpath, const string& pattern /*= "*.*"*/, bool recursive /*= true*/)
+    const string& dirpath, const string& pattern /*= "*.*"*/, bool recursive /*= true*/,
+    vector<string>* directories /*= nullptr*/)
 {
     dirent* ent;
     struct stat st;
@@ -416,10 +771,14 @@ DLLEXPORT bool Leviathan::FileSystem::GetFilesInDirectory(vector<string>& files,
 
         // Check if it is a dirpath //
         if((st.st_mode & S_IFDIR) != 0) {
+
+            if(directories)
+                directories->push_back(full_file_name);
+
             // Go into dirpath if recursive search //
             if(recursive) {
                 // \todo fix performance //
-                GetFilesInDirectory(files, full_file_name, pattern, recursive);
+                GetFilesInDirectory(files, full_file_name, pattern, recursive, directories);
             }
             continue;
         }
@@ -435,6 +794,14 @@ DLLEXPORT bool Leviathan::FileSystem::GetFilesInDirectory(vector<string>& files,
 // ------------------ File operations ------------------ //
 size_t Leviathan::FileSystem::GetFileLength(const string& name)
 {
+    if(Staticaccess) {
+
+        const AssetArchive* archive = nullptr;
+        const auto* entry = FindInArchives(Staticaccess->MountedArchives, name, archive);
+
+        if(entry)
+            return entry->OriginalSize;
+    }
 
     ifstream file(name, ios::binary);
 
@@ -455,6 +822,13 @@ size_t Leviathan::FileSystem::GetFileLength(const string& name)
 
 DLLEXPORT bool Leviathan::FileSystem::FileExists(const string& name)
 {
+    if(Staticaccess) {
+
+        const AssetArchive* archive = nullptr;
+
+        if(FindInArchives(Staticaccess->MountedArchives, name, archive))
+            return true;
+    }
 
     return boost::filesystem::exists(name);
 }
@@ -544,6 +918,15 @@ DLLEXPORT bool Leviathan::FileSystem::ReadFileEntirely(
 DLLEXPORT bool Leviathan::FileSystem::ReadFileEntirely(
     const string& file, string& resultreceiver)
 {
+    // Mounted archives take priority over the files on disk //
+    if(Staticaccess) {
+
+        const AssetArchive* archive = nullptr;
+        const auto* entry = FindInArchives(Staticaccess->MountedArchives, file, archive);
+
+        if(entry)
+            return archive->ReadEntry(*entry, resultreceiver);
+    }
 
     ifstream reader(file, ios::in | ios::binary);
 
@@ -614,11 +997,11 @@ DLLEXPORT void Leviathan::FileSystem::CreateIndexesForVecs(bool forcerecreation
         SortFileVectors();
     }
 
-    _CreateIndexesIfMissing(AllFiles, AllIndexes, IsAllIndexed, forcerecreation);
-    _CreateIndexesIfMissing(TextureFiles, TextureIndexes, IsTextureIndexed, forcerecreation);
-    _CreateIndexesIfMissing(ModelFiles, ModelIndexes, IsModelIndexed, forcerecreation);
-    _CreateIndexesIfMissing(SoundFiles, SoundIndexes, IsSoundIndexed, forcerecreation);
-    _CreateIndexesIfMissing(ScriptFiles, ScriptIndexes, IsScriptIndexed, forcerecreation);
+    _CreateIndexesIfMissing(AllFiles, AllIndex, IsAllIndexed, forcerecreation);
+    _CreateIndexesIfMissing(TextureFiles, TextureIndex, IsTextureIndexed, forcerecreation);
+    _CreateIndexesIfMissing(ModelFiles, ModelIndex, IsModelIndexed, forcerecreation);
+    _CreateIndexesIfMissing(SoundFiles, SoundIndex, IsSoundIndexed, forcerecreation);
+    _CreateIndexesIfMissing(ScriptFiles, ScriptIndex, IsScriptIndexed, forcerecreation);
 }
 // ------------------------------------ //
 DLLEXPORT int Leviathan::FileSystem::RegisterExtension(const string& extension)
@@ -682,7 +1065,7 @@ DLLEXPORT string Leviathan::FileSystem::SearchForFile(
     switch(which) {
     case FILEGROUP_MODEL: {
         shared_ptr<FileDefinitionType> result =
-            _SearchForFileInVec(ModelFiles, ExtensionIDS, name, IsModelIndexed, &ModelIndexes);
+            _SearchForFileInVec(ModelFiles, ExtensionIDS, name, IsModelIndexed, ModelIndex);
         if(result.get() != NULL) {
             // found //
             return result.get()->RelativePath;
@@ -690,7 +1073,7 @@ DLLEXPORT string Leviathan::FileSystem::SearchForFile(
     } break;
     case FILEGROUP_TEXTURE: {
         shared_ptr<FileDefinitionType> result = _SearchForFileInVec(
-            TextureFiles, ExtensionIDS, name, IsTextureIndexed, &TextureIndexes);
+            TextureFiles, ExtensionIDS, name, IsTextureIndexed, TextureIndex);
 
         if(result.get() != NULL) {
             // found //
@@ -699,7 +1082,7 @@ DLLEXPORT string Leviathan::FileSystem::SearchForFile(
     } break;
     case FILEGROUP_SOUND: {
         shared_ptr<FileDefinitionType> result =
-            _SearchForFileInVec(SoundFiles, ExtensionIDS, name, IsSoundIndexed, &SoundIndexes);
+            _SearchForFileInVec(SoundFiles, ExtensionIDS, name, IsSoundIndexed, SoundIndex);
         if(result.get() != NULL) {
             // found //
             return result.get()->RelativePath;
@@ -707,7 +1090,7 @@ DLLEXPORT string Leviathan::FileSystem::SearchForFile(
     } break;
     case FILEGROUP_SCRIPT: {
         shared_ptr<FileDefinitionType> result = _SearchForFileInVec(
-            ScriptFiles, ExtensionIDS, name, IsScriptIndexed, &ScriptIndexes);
+            ScriptFiles, ExtensionIDS, name, IsScriptIndexed, ScriptIndex);
         if(result.get() != NULL) {
             // found //
             return result.get()->RelativePath;
@@ -715,7 +1098,7 @@ DLLEXPORT string Leviathan::FileSystem::SearchForFile(
     } break;
     case FILEGROUP_OTHER: {
         shared_ptr<FileDefinitionType> result =
-            _SearchForFileInVec(AllFiles, ExtensionIDS, name, IsAllIndexed, &AllIndexes);
+            _SearchForFileInVec(AllFiles, ExtensionIDS, name, IsAllIndexed, AllIndex);
         if(result.get() != NULL) {
             // found //
             return result.get()->RelativePath;
@@ -727,7 +1110,7 @@ DLLEXPORT string Leviathan::FileSystem::SearchForFile(
     // still not found, if searchall specified search all files vector //
     if(searchall) {
         shared_ptr<FileDefinitionType> result =
-            _SearchForFileInVec(AllFiles, ExtensionIDS, name, IsAllIndexed, &AllIndexes);
+            _SearchForFileInVec(AllFiles, ExtensionIDS, name, IsAllIndexed, AllIndex);
         if(result.get() != NULL) {
             // found //
             return result.get()->RelativePath;
@@ -751,35 +1134,53 @@ DLLEXPORT vector<shared_ptr<FileDefinitionType>> Leviathan::FileSystem::FindAllM
     // create regex //
     regex usedregex(regexname, regex_constants::ECMAScript | regex_constants::icase);
 
+    // Only the files with these are checked against the regex //
+    vector<uint32_t> trigrams;
+    FileIndex::GetRequiredTrigrams(regexname, trigrams);
+
     vector<shared_ptr<FileDefinitionType>> foundfiles;
 
     if(searchall) {
 
-        _SearchForFilesInVec(AllFiles, foundfiles, ExtensionIDS, usedregex);
+        _SearchForFilesInVec(
+            AllFiles, foundfiles, ExtensionIDS, usedregex, IsAllIndexed, AllIndex, trigrams);
 
     } else {
         // specific vector //
         vector<shared_ptr<FileDefinitionType>>* targetvector = NULL;
+        const FileIndex* targetindex = NULL;
+        bool indexed = false;
 
         switch(which) {
         case FILEGROUP_MODEL: {
             targetvector = &ModelFiles;
+            targetindex = &ModelIndex;
+            indexed = IsModelIndexed;
         } break;
         case FILEGROUP_TEXTURE: {
             targetvector = &TextureFiles;
+            targetindex = &TextureIndex;
+            indexed = IsTextureIndexed;
         } break;
         case FILEGROUP_SOUND: {
             targetvector = &SoundFiles;
+            targetindex = &SoundIndex;
+            indexed = IsSoundIndexed;
         } break;
         case FILEGROUP_SCRIPT: {
             targetvector = &ScriptFiles;
+            targetindex = &ScriptIndex;
+            indexed = IsScriptIndexed;
         } break;
         case FILEGROUP_OTHER: {
             targetvector = &AllFiles;
+            targetindex = &AllIndex;
+            indexed = IsAllIndexed;
         } break;
         }
 
-        _SearchForFilesInVec(*targetvector, foundfiles, ExtensionIDS, usedregex);
+        _SearchForFilesInVec(*targetvector, foundfiles, ExtensionIDS, usedregex, indexed,
+            *targetindex, trigrams);
     }
 
     // return what we found //
@@ -810,50 +1211,77 @@ vector<shared_ptr<FileDefinitionType>>& Leviathan::FileSystem::GetScriptFiles()
 // ------------------------------------ //
 shared_ptr<FileDefinitionType> Leviathan::FileSystem::_SearchForFileInVec(
     vector<shared_ptr<FileDefinitionType>>& vec, vector<int>& extensions, const string& name,
-    bool UseIndexVector, vector<CharWithIndex*>* Index)
+    bool UseIndexVector, const FileIndex& index)
 {
-    size_t StartSpot = 0;
+    // use the index to find the file without going through the vector //
+    if(UseIndexVector && !extensions.empty()) {
 
-    // use index to get start spot for faster searching //
-    if(UseIndexVector) {
-        char startchar = name[0];
-        bool Found = false;
+        FileDefinitionType* found = index.Find(name, extensions);
 
-        // find matching char //
-        for(unsigned int i = 0; i < Index->size(); i++) {
-            if(Index->at(i)->Char == startchar) {
-                Found = true;
-                StartSpot = Index->at(i)->Index;
-                break;
-            }
-        }
-        // if character that starts the word wasn't found it can't be there, exit function //
-        if(!Found)
+        if(!found)
             return NULL;
+
+        return found->shared_from_this();
     }
 
-    for(size_t i = StartSpot; i < vec.size(); i++) {
-        // if no extension specified skip checking them //
-        if(extensions.size() > 0) {
-            // check does extension(s) match //
-            if(!DoesExtensionMatch(vec[i].get(), extensions))
-                continue;
-        }
+    // Like the index this prefers the extensions that are first in the list //
+    shared_ptr<FileDefinitionType> best;
+    auto bestextension = extensions.end();
+
+    for(size_t i = 0; i < vec.size(); i++) {
         // extensions match check name //
         if((vec[i]->Name != name))
             continue;
 
-        // match //
-        return vec[i];
+        // if no extension specified skip checking them //
+        if(extensions.empty())
+            return vec[i];
+
+        const auto extension = find(extensions.begin(), extensions.end(), vec[i]->ExtensionID);
+
+        if(extension == extensions.begin())
+            return vec[i];
+
+        if(extension < bestextension) {
+            best = vec[i];
+            bestextension = extension;
+        }
     }
-    // nothing //
-    return NULL;
+
+    return best;
 }
 
 void Leviathan::FileSystem::_SearchForFilesInVec(vector<shared_ptr<FileDefinitionType>>& vec,
     vector<shared_ptr<FileDefinitionType>>& results, vector<int>& extensions,
-    const regex& regex)
+    const regex& regex, bool UseIndexVector, const FileIndex& index,
+    const vector<uint32_t>& trigrams)
 {
+    // Only the files that have the trigrams of the regex can match it //
+    if(UseIndexVector && !trigrams.empty()) {
+
+        vector<FileDefinitionType*> candidates;
+        index.FindCandidates(trigrams, candidates);
+
+        // Results are in the same order as the vector //
+        sort(candidates.begin(), candidates.end(),
+            [](const FileDefinitionType* first, const FileDefinitionType* second) {
+                return *first < *second;
+            });
+
+        for(FileDefinitionType* file : candidates) {
+
+            if(extensions.size() > 0 && !DoesExtensionMatch(file, extensions))
+                continue;
+
+            if(!regex_match(file->Name, regex))
+                continue;
+
+            results.push_back(file->shared_from_this());
+        }
+
+        return;
+    }
+
     for(size_t i = 0; i < vec.size(); i++) {
         // if no extension specified skip checking them //
         if(extensions.size() > 0) {
@@ -873,28 +1301,21 @@ void Leviathan::FileSystem::_SearchForFilesInVec(vector<shared_ptr<FileDefinitio
 }
 
 void Leviathan::FileSystem::_CreateIndexesIfMissing(
-    vector<shared_ptr<FileDefinitionType>>& vec, vector<CharWithIndex*>& resultvec,
-    bool& indexed, const bool& force /*= false*/)
+    vector<shared_ptr<FileDefinitionType>>& vec, FileIndex& index, bool& indexed,
+    const bool& force /*= false*/)
 {
     // we'll need to delete old ones if index creation is forced //
     if(force) {
         indexed = false;
-        SAFE_DELETE_VECTOR(resultvec);
+        index.Clear();
     }
     // if they are valid we can just return //
     if(indexed)
         return;
 
-    // now that the file vector is sorted we can loop through it and every time first character
-    // changes add it to index
-    char curchar = '!';
-
     for(size_t i = 0; i < vec.size(); i++) {
-        if(vec[i]->Name[0] != curchar) {
-            // beginning character changed, push to indexes //
-            curchar = vec[i]->Name[0];
-            resultvec.push_back(new CharWithIndex(curchar, i));
-        }
+
+        index.Add(vec[i].get());
     }
 
     // done //
@@ -1052,13 +1473,220 @@ bool Leviathan::FileDefSorter::operator()(const std::shared_ptr<FileDefinitionTy
 {
     return (*first.get()) < *(second).get();
 }
-// ------------------ CharWithIndex ------------------ //
-CharWithIndex::CharWithIndex()
+// ------------------ FileIndex ------------------ //
+DLLEXPORT void FileIndex::Clear()
+{
+    ByName.clear();
+    ByTrigram.clear();
+}
+
+DLLEXPORT void FileIndex::Add(FileDefinitionType* file)
+{
+    ByName.emplace(Key{file->Name, file->ExtensionID}, file);
+
+    vector<uint32_t> trigrams;
+    GetTrigrams(file->Name, trigrams);
+
+    for(const auto trigram : trigrams)
+        ByTrigram[trigram].push_back(file);
+}
+
+DLLEXPORT void FileIndex::Remove(FileDefinitionType* file)
+{
+    const auto range = ByName.equal_range(Key{file->Name, file->ExtensionID});
+
+    for(auto iter = range.first; iter != range.second; ++iter) {
+        if(iter->second == file) {
+            ByName.erase(iter);
+            break;
+        }
+    }
+
+    vector<uint32_t> trigrams;
+    GetTrigrams(file->Name, trigrams);
+
+    for(const auto trigram : trigrams) {
+
+        const auto found = ByTrigram.find(trigram);
+
+        if(found == ByTrigram.end())
+            continue;
+
+        auto& files = found->second;
+        files.erase(std::remove(files.begin(), files.end(), file), files.end());
+
+        if(files.empty())
+            ByTrigram.erase(found);
+    }
+}
+
+DLLEXPORT FileDefinitionType* FileIndex::Find(
+    const string& name, const vector<int>& extensions) const
+{
+    // The extensions are in the order of preference //
+    for(const int extension : extensions) {
+
+        const auto found = ByName.find(Key{name, extension});
+
+        if(found != ByName.end())
+            return found->second;
+    }
+
+    return nullptr;
+}
+
+DLLEXPORT FileDefinitionType* FileIndex::FindPath(const FileDefinitionType& file) const
+{
+    const auto range = ByName.equal_range(Key{file.Name, file.ExtensionID});
+
+    for(auto iter = range.first; iter != range.second; ++iter) {
+        if(iter->second->RelativePath == file.RelativePath)
+            return iter->second;
+    }
+
+    return nullptr;
+}
+
+DLLEXPORT void FileIndex::FindCandidates(
+    const vector<uint32_t>& trigrams, vector<FileDefinitionType*>& candidates) const
+{
+    // The files with the least common trigram are enough as the regex is checked anyway //
+    const vector<FileDefinitionType*>* smallest = nullptr;
+
+    for(const auto trigram : trigrams) {
+
+        const auto found = ByTrigram.find(trigram);
+
+        // No file can match //
+        if(found == ByTrigram.end())
+            return;
+
+        if(!smallest || found->second.size() < smallest->size())
+            smallest = &found->second;
+    }
+
+    if(smallest)
+        candidates.insert(candidates.end(), smallest->begin(), smallest->end());
+}
+
+DLLEXPORT bool FileIndex::GetRequiredTrigrams(const string& regex, vector<uint32_t>& trigrams)
+{
+    // Literal parts of the regex that every match contains //
+    vector<string> literals;
+    string current;
+    bool lastliteral = false;
+
+    const auto endliteral = [&]() {
+        if(current.size() >= 3)
+            literals.push_back(current);
+
+        current.clear();
+        lastliteral = false;
+    };
+
+    for(size_t i = 0; i < regex.size(); ++i) {
+
+        const char character = regex[i];
+
+        switch(character) {
+        case '|':
+        case '(':
+        case ')':
+            // Alternatives and groups can make anything optional //
+            return false;
+        case '\\':
+            if(i + 1 < regex.size() && !isalnum(static_cast<unsigned char>(regex[i + 1]))) {
+
+                // Escaped special character //
+                current += regex[++i];
+                lastliteral = true;
+
+            } else {
+
+                // Character classes like \d and escaped characters like \x41 //
+                ++i;
+                endliteral();
+
+                // The hex digits and the control letter aren't literals //
+                if(i < regex.size()) {
+                    if(regex[i] == 'x') {
+                        i += 2;
+                    } else if(regex[i] == 'u') {
+                        i += 4;
+                    } else if(regex[i] == 'c') {
+                        i += 1;
+                    }
+                }
+            }
+            break;
+        case '[':
+            endliteral();
+
+            for(++i; i < regex.size() && regex[i] != ']'; ++i) {
+                if(regex[i] == '\\')
+                    ++i;
+            }
+
+            if(i >= regex.size())
+                return false;
+
+            break;
+        case '*':
+        case '?':
+        case '{':
+            // The previous character is optional //
+            if(lastliteral)
+                current.pop_back();
+
+            endliteral();
+
+            if(character == '{') {
+
+                i = regex.find('}', i);
+
+                if(i == string::npos)
+                    return false;
+            }
+            break;
+        case '+':
+        case '.':
+        case '^':
+        case '$': endliteral(); break;
+        default:
+            current += character;
+            lastliteral = true;
+        }
+    }
+
+    endliteral();
+
+    for(const auto& literal : literals)
+        GetTrigrams(literal, trigrams);
+
+    return !trigrams.empty();
+}
+
+//! \brief Lower cases ASCII, like the case insensitive regexes in the "C" locale
+static inline uint32_t TrigramCharacter(char character)
 {
-    Char = L' ';
-    Index = -1;
+    const auto value = static_cast<unsigned char>(character);
+
+    if(value >= 'A' && value <= 'Z')
+        return value - 'A' + 'a';
+
+    return value;
 }
 
-CharWithIndex::CharWithIndex(char character, size_t index) : Char(character), Index(index) {}
+DLLEXPORT void FileIndex::GetTrigrams(std::string_view text, vector<uint32_t>& trigrams)
+{
+    for(size_t i = 0; i + 2 < text.size(); ++i) {
+
+        trigrams.push_back(TrigramCharacter(text[i]) | (TrigramCharacter(text[i + 1]) << 8) |
+                           (TrigramCharacter(text[i + 2]) << 16));
+    }
+
+    sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
 // ------------------ FileTypeHolder ------------------ //
 FileTypeHolder::FileTypeHolder(int id, const std::string& name) : ID(id), Name(name) {}
@@ -6,12 +6,17 @@
 #include "Common/DataStoring/NamedVars.h"
 #include "Common/ThreadSafe.h"
 
+#include <memory>
 #include <regex>
+#include <string_view>
+#include <unordered_map>
 #include "ErrorReporter.h"
 
 
 namespace Leviathan{
 
+    class AssetArchive;
+
 	enum FILEGROUP{
         FILEGROUP_MODEL,
         FILEGROUP_TEXTURE,
@@ -20,16 +25,6 @@ namespace Leviathan{
         FILEGROUP_OTHER
     };
 
-    //! \brief Helper class for indexing
-	class CharWithIndex{
-	public:
-		CharWithIndex();
-		CharWithIndex(char character, size_t index);
-
-		char Char;
-		size_t Index;
-	};
-
     //! \brief File type
     class FileTypeHolder{
     public:
@@ -41,7 +36,7 @@ namespace Leviathan{
     };
 
 
-	struct FileDefinitionType{
+	struct FileDefinitionType : public std::enable_shared_from_this<FileDefinitionType>{
         // just the path, everything else is worked out by the constructor //
 		FileDefinitionType(FileSystem* instance, const std::string &path); 
 		~FileDefinitionType();
@@ -62,6 +57,67 @@ namespace Leviathan{
             const std::shared_ptr<FileDefinitionType>& second);
 	};
 
+    //! \brief Hash and trigram index of a file vector
+    //!
+    //! Files are found by name and extension with a single hash lookup for each extension.
+    //! The trigrams of the lower case names find the files that can match a search pattern
+    //! so that the regex only needs to be ran on those
+    class FileIndex{
+        struct Key{
+
+            bool operator ==(const Key &other) const{
+                return ExtensionID == other.ExtensionID && Name == other.Name;
+            }
+
+            //! Points to FileDefinitionType::Name of the indexed file
+            std::string_view Name;
+            int ExtensionID;
+        };
+
+        struct KeyHasher{
+
+            size_t operator()(const Key &key) const{
+                return std::hash<std::string_view>()(key.Name) ^
+                    (static_cast<size_t>(key.ExtensionID) * 0x9E3779B97F4A7C15ULL);
+            }
+        };
+
+    public:
+        DLLEXPORT void Clear();
+
+        DLLEXPORT void Add(FileDefinitionType* file);
+        DLLEXPORT void Remove(FileDefinitionType* file);
+
+        //! \returns The file with the name and the first matching extension or null
+        DLLEXPORT FileDefinitionType* Find(const std::string &name,
+            const std::vector<int> &extensions) const;
+
+        //! \returns The indexed file with the same path as file or null
+        DLLEXPORT FileDefinitionType* FindPath(const FileDefinitionType &file) const;
+
+        //! \brief Finds the files whose names contain all of the trigrams
+        //!
+        //! The result may contain files that don't have all the trigrams so the names still
+        //! need to be checked
+        DLLEXPORT void FindCandidates(const std::vector<uint32_t> &trigrams,
+            std::vector<FileDefinitionType*> &candidates) const;
+
+        //! \brief Gets the trigrams that all lower case names matching the regex must have
+        //! \returns False if the regex is too complex to know any. For example alternatives
+        //! and groups aren't handled
+        DLLEXPORT static bool GetRequiredTrigrams(const std::string &regex,
+            std::vector<uint32_t> &trigrams);
+
+        //! \brief Adds the trigrams of the lower case version of text to trigrams
+        DLLEXPORT static void GetTrigrams(std::string_view text,
+            std::vector<uint32_t> &trigrams);
+
+    private:
+        std::unordered_multimap<Key, FileDefinitionType*, KeyHasher> ByName;
+
+        std::unordered_map<uint32_t, std::vector<FileDefinitionType*>> ByTrigram;
+    };
+
     //! \brief Class for indexing and searching game data directory
 	class FileSystem{
 	public:
@@ -69,11 +125,51 @@ namespace Leviathan{
 		DLLEXPORT ~FileSystem();
 
         //! \brief Runs the indexing and sorting
+        //!
+        //! If the data archive exists it is mounted instead of searching the data folder.
+        //! Otherwise the list of files is loaded from the index cache if none of the
+        //! folders have been modified since it was saved
+        //! \see SetDataArchive SetIndexCacheFile
 		DLLEXPORT bool Init(LErrorReporter* errorreport);
 
         //! \brief Destroys the current index and recreates it
+        //! \note This also unmounts all archives
 		DLLEXPORT bool ReSearchFiles();
 
+        //! \brief Adds the files in an archive to the index
+        //!
+        //! The files in the archive are then found by SearchForFile and FindAllMatchingFiles
+        //! and read from the archive by ReadFileEntirely, FileExists and GetFileLength.
+        //! Each path in the archive is added to the index so this is linear in the number of
+        //! files
+        //! \returns False if the archive is invalid
+        //! \see AssetArchive
+        DLLEXPORT bool MountArchive(const std::string &file);
+
+        //! \brief Returns the data of a file that is stored uncompressed in a mounted archive
+        //!
+        //! This doesn't copy the data, so prefer this over ReadFileEntirely for large files
+        //! \returns An empty view if the file isn't in an archive or is compressed
+        //! \note The view is valid until ReSearchFiles is called or this is destroyed
+        DLLEXPORT std::string_view GetArchivedFileData(const std::string &file) const;
+
+        //! \brief Adds a new file, or all the files in a new folder, to the index
+        //! \note Files that are already indexed are skipped
+        DLLEXPORT void AddToIndex(const std::string &path);
+
+        //! \brief Removes a file, or all the files in a folder, from the index
+        DLLEXPORT void RemoveFromIndex(const std::string &path);
+
+        //! \brief Keeps the index up to date with the files in the data folder
+        //! \returns False if listening couldn't be started
+        //! \see ResourceRefreshHandler::ListenForFolderChanges
+        DLLEXPORT bool ListenForDataFolderChanges(ResourceRefreshHandler* handler);
+
+        //! \returns True if Init got the list of files from the index cache
+        inline bool WasIndexLoadedFromCache() const{
+            return IndexLoadedFromCache;
+        }
+
 		DLLEXPORT void SortFileVectors();
 		DLLEXPORT void CreateIndexesForVecs(bool forcerecreation = false);
 
@@ -90,6 +186,8 @@ namespace Leviathan{
 
 
         //! \brief Searches for a file
+        //! \param extensions Extensions separated by '|'. If there are files with multiple
+        //! of the extensions the one that is first in the list is returned
         //! \return Full path to the file or an empty string if not found
 		DLLEXPORT std::string SearchForFile(FILEGROUP which, const std::string& name,
             const std::string &extensions, bool searchall = true);
@@ -134,14 +232,24 @@ namespace Leviathan{
 		DLLEXPORT static void SetShaderFolder(const std::string &folder);
 		DLLEXPORT static void SetTextureFolder(const std::string &folder);
 
+        //! \brief Sets the archive that Init mounts instead of searching the data folder
+        DLLEXPORT static void SetDataArchive(const std::string &file);
+        DLLEXPORT static std::string GetDataArchive();
+
+        //! \brief Sets where Init saves the list of files in the data folder
+        //! \param file The cache file or empty to not use a cache
+        DLLEXPORT static void SetIndexCacheFile(const std::string &file);
+        DLLEXPORT static std::string GetIndexCacheFile();
+
 		// file handling //
 		DLLEXPORT static bool LoadDataDump(const std::string &file,
             std::vector<std::shared_ptr<NamedVariableList>> &vec, LErrorReporter* errorreport);
         
 		// Warning: \todo linux version ignores the defined pattern //
+        //! \param directories If not null the found sub directories are added to this
 		DLLEXPORT static bool GetFilesInDirectory(std::vector<std::string> &files,
             const std::string &dirpath, const std::string &pattern = "*.*",
-            bool recursive = true);
+            bool recursive = true, std::vector<std::string>* directories = nullptr);
 
 		// file operations //
 		DLLEXPORT static size_t GetFileLength(const std::string &name);
@@ -160,17 +268,36 @@ namespace Leviathan{
         DLLEXPORT static FileSystem* Get();
 
 	private:
+        //! \brief Adds a file to AllFiles and the vector of its group
+        void _AddFile(const std::string &path);
+
+        //! \brief Destroys all the files and indexes
+        void _ClearFiles();
+
+        //! \brief Loads the list of files from IndexCacheFile
+        //! \returns False if there is no cache or a folder has changed since it was saved
+        bool _LoadIndexCache(std::vector<std::string> &files) const;
+
+        void _SaveIndexCache(const std::vector<std::string> &files,
+            const std::vector<std::string> &directories) const;
+
 		// file search functions //
         std::shared_ptr<FileDefinitionType> _SearchForFileInVec(
             std::vector<std::shared_ptr<FileDefinitionType>> &vec, std::vector<int> &extensions,
-			const std::string &name, bool UseIndexVector, std::vector<CharWithIndex*>* Index);
+			const std::string &name, bool UseIndexVector, const FileIndex &index);
         
 		void _SearchForFilesInVec(std::vector<std::shared_ptr<FileDefinitionType>>& vec,
             std::vector<std::shared_ptr<FileDefinitionType>>& results,
-			std::vector<int>& extensions, const std::regex &regex);
+			std::vector<int>& extensions, const std::regex &regex, bool UseIndexVector,
+            const FileIndex &index, const std::vector<uint32_t> &trigrams);
         
 		void _CreateIndexesIfMissing(std::vector<std::shared_ptr<FileDefinitionType>> &vec,
-            std::vector<CharWithIndex*> &resultvec, bool &indexed, const bool &force /*= false*/);
+            FileIndex &index, bool &indexed, const bool &force /*= false*/);
+
+        //! \brief Returns the vector a file belongs to in addition to AllFiles
+        //! \returns Null if the file is only in AllFiles
+        std::vector<std::shared_ptr<FileDefinitionType>>* _GetGroupVector(
+            const std::string &path, FileIndex** index, bool** indexed);
         
 		// ------------------------------------ //
 		// vector that holds string value of file extension and it's id code //
@@ -187,19 +314,19 @@ namespace Leviathan{
 
 		// index vectors //
 		bool IsAllIndexed;
-		std::vector<CharWithIndex*> AllIndexes;
+		FileIndex AllIndex;
 
 		bool IsTextureIndexed;
-		std::vector<CharWithIndex*> TextureIndexes;
+		FileIndex TextureIndex;
 
 		bool IsModelIndexed;
-		std::vector<CharWithIndex*> ModelIndexes;
+		FileIndex ModelIndex;
 
 		bool IsSoundIndexed;
-		std::vector<CharWithIndex*> SoundIndexes;
+		FileIndex SoundIndex;
 
 		bool IsScriptIndexed;
-		std::vector<CharWithIndex*> ScriptIndexes;
+		FileIndex ScriptIndex;
 
 		// vector sorting //
 		bool IsSorted;
@@ -208,6 +335,14 @@ namespace Leviathan{
 
         LErrorReporter* ErrorReporter = nullptr;
 
+        //! Searched in the order they were mounted
+        std::vector<std::unique_ptr<AssetArchive>> MountedArchives;
+
+        bool IndexLoadedFromCache = false;
+
+        //! ID of the ResourceRefreshHandler listener or -1
+        int DataFolderListenerID = -1;
+
 		// ------------------------------------ //
 		static std::string DataFolder;
 		static std::string ModelsFolder;
@@ -217,6 +352,8 @@ namespace Leviathan{
         static std::string MaterialFolder;
 		static std::string FontFolder;
 		static std::string SoundFolder;
+		static std::string DataArchive;
+		static std::string IndexCacheFile;
 
 		static FileSystem* Staticaccess;
 	};
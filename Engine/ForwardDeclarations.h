@@ -184,6 +184,9 @@ class ScriptModule;
 class ScriptScript;
 class Event;
 class GenericEvent;
+class IntegerEventData;
+class PhysicsStartEventData;
+template<class DataType> class ReusableEvent;
 struct Int1;
 struct Int2;
 struct Int3;
@@ -28,6 +28,16 @@ DLLEXPORT int IDFactory::ProduceID(){
     return result;
 }
 
+DLLEXPORT void IDFactory::SkipIDsUpTo(int id){
+
+    int current = GlobalID.load(std::memory_order_relaxed);
+
+    while(current <= id && !GlobalID.compare_exchange_weak(current, id + 1,
+            std::memory_order_relaxed))
+    {
+    }
+}
+
 DLLEXPORT int IDFactory::ProduceSystemID(){
 
     const auto result = SystemID.fetch_add(1, std::memory_order_relaxed);
@@ -28,6 +28,10 @@ namespace Leviathan{
         
 		DLLEXPORT int ProduceSystemID();
 
+		//! \brief Makes sure that ProduceID won't return id or anything below it
+		//! \note Used when loading things that keep their old ids
+		DLLEXPORT void SkipIDsUpTo(int id);
+
 		DLLEXPORT static IDFactory* Get();
 
 	private:
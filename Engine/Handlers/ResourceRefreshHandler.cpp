@@ -2,11 +2,18 @@
 #include "ResourceRefreshHandler.h"
 
 #include "Common/StringOperations.h"
+#include "../FileSystem.h"
 #include "../TimeIncludes.h"
 #include "IDFactory.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
 #ifdef __linux__
 #include <sys/types.h>
 #include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
 #endif
 using namespace Leviathan;
 using namespace std;
@@ -54,8 +61,11 @@ DLLEXPORT void Leviathan::ResourceRefreshHandler::Release(){
 		(*iter)->StopThread();
 	}
 
+	for(auto& listener : ActiveTreeListeners)
+		listener->StopThread();
     
 	ActiveFileListeners.clear();
+	ActiveTreeListeners.clear();
 }
 // ------------------------------------ //
 DLLEXPORT bool Leviathan::ResourceRefreshHandler::ListenForFileChanges(
@@ -80,12 +90,39 @@ DLLEXPORT bool Leviathan::ResourceRefreshHandler::ListenForFileChanges(
 	return true;
 }
 
+DLLEXPORT bool ResourceRefreshHandler::ListenForFolderChanges(const std::string &folder,
+	std::function<void (const std::string &, bool)> notifyfunction, int &createdid)
+{
+	auto listener = std::make_unique<ResourceTreeListener>(folder, notifyfunction);
+
+	createdid = listener->GetID();
+
+	if(!listener->StartListening())
+		return false;
+
+	GUARD_LOCK();
+
+	ActiveTreeListeners.push_back(std::move(listener));
+
+	return true;
+}
+
 DLLEXPORT void Leviathan::ResourceRefreshHandler::StopListeningForFileChanges(
     int idoflistener)
 {
 
 	GUARD_LOCK();
 
+	for(auto iter = ActiveTreeListeners.begin(); iter != ActiveTreeListeners.end(); ++iter){
+
+		if((*iter)->GetID() == idoflistener){
+
+			(*iter)->StopThread();
+			ActiveTreeListeners.erase(iter);
+			return;
+		}
+	}
+
 	// Find the specific listener //
 	auto end = ActiveFileListeners.end();
 	for(auto iter = ActiveFileListeners.begin(); iter != end; ++iter){
@@ -109,6 +146,9 @@ DLLEXPORT void Leviathan::ResourceRefreshHandler::CheckFileStatus(){
 			ActiveFileListeners[i]->CheckUpdatesEnded();
 		}
 
+		for(auto& listener : ActiveTreeListeners)
+			listener->ReportChanges();
+
 		// Set new update time //
 		NextUpdateTime = Time::GetThreadSafeSteadyTimePoint()+MillisecondDuration(1000);
 	}
@@ -558,3 +598,333 @@ DLLEXPORT bool Leviathan::ResourceFolderListener::IsAFileStillUpdated() const{
 	// No file is marked as updated //
 	return false;
 }
+// ------------------ ResourceTreeListener ------------------ //
+ResourceTreeListener::ResourceTreeListener(const std::string &folder,
+	std::function<void (const std::string &, bool)> notifyfunction) :
+	TargetFolder(folder), ID(IDFactory::GetID()), CallbackFunction(notifyfunction)
+{
+	// Paths are reported as folder + "/" + the relative path //
+	if(!TargetFolder.empty() && (TargetFolder.back() == '/' || TargetFolder.back() == '\\'))
+		TargetFolder.pop_back();
+}
+
+ResourceTreeListener::~ResourceTreeListener(){
+
+	StopThread();
+}
+// ------------------------------------ //
+DLLEXPORT int ResourceTreeListener::GetID() const{
+	return ID;
+}
+// ------------------------------------ //
+bool ResourceTreeListener::StartListening(){
+
+	ShouldQuit = false;
+
+#ifdef _WIN32
+
+	StopEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	ReadCompleteEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+	if(!StopEvent || !ReadCompleteEvent){
+
+		Logger::Get()->Error("ResourceTreeListener: StartListening: CreateEvent failed");
+		return false;
+	}
+
+	TargetFolderHandle = CreateFileA(TargetFolder.c_str(), FILE_LIST_DIRECTORY,
+		FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+
+	if(TargetFolderHandle == INVALID_HANDLE_VALUE){
+
+		Logger::Get()->Error("ResourceTreeListener: StartListening: failed to open folder: " +
+			TargetFolder + ", error: " + Convert::ToHexadecimalString(GetLastError()));
+		return false;
+	}
+
+	ReadBuffer.resize(16 * 1024);
+
+	if(!_StartReadingChanges())
+		return false;
+
+#else
+
+	InotifyID = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if(InotifyID < 0){
+
+		Logger::Get()->Error("ResourceTreeListener: StartListening: failed to create inotify "
+			"instance");
+		return false;
+	}
+
+	_WatchFolder(TargetFolder);
+
+	if(WatchedFolders.empty()){
+
+		Logger::Get()->Error("ResourceTreeListener: StartListening: failed to watch folder: " +
+			TargetFolder);
+		close(InotifyID);
+		InotifyID = -1;
+		return false;
+	}
+
+	ReadBuffer.resize(64 * (sizeof(inotify_event) + NAME_MAX + 1));
+
+#endif //_WIN32
+
+	ListenerThread = std::thread(&ResourceTreeListener::_RunListeningThread, this);
+
+	return true;
+}
+
+void ResourceTreeListener::StopThread(){
+
+	ShouldQuit = true;
+
+#ifdef _WIN32
+	if(StopEvent)
+		SetEvent(StopEvent);
+#endif //_WIN32
+
+	if(ListenerThread.joinable())
+		ListenerThread.join();
+
+#ifdef _WIN32
+	if(TargetFolderHandle != INVALID_HANDLE_VALUE){
+
+		CancelIo(TargetFolderHandle);
+		CloseHandle(TargetFolderHandle);
+		TargetFolderHandle = INVALID_HANDLE_VALUE;
+	}
+
+	if(StopEvent){
+		CloseHandle(StopEvent);
+		StopEvent = nullptr;
+	}
+
+	if(ReadCompleteEvent){
+		CloseHandle(ReadCompleteEvent);
+		ReadCompleteEvent = nullptr;
+	}
+#else
+	if(InotifyID >= 0){
+
+		// Closing removes all the watches //
+		close(InotifyID);
+		InotifyID = -1;
+	}
+
+	WatchedFolders.clear();
+#endif //_WIN32
+}
+// ------------------------------------ //
+void ResourceTreeListener::ReportChanges(){
+
+	std::vector<std::pair<std::string, bool>> changes;
+
+	{
+		std::lock_guard<std::mutex> lock(QueuedChangesMutex);
+		changes.swap(QueuedChanges);
+	}
+
+	for(const auto& change : changes)
+		CallbackFunction(change.first, change.second);
+}
+
+void ResourceTreeListener::_QueueChange(const std::string &path, bool created){
+
+	std::lock_guard<std::mutex> lock(QueuedChangesMutex);
+	QueuedChanges.emplace_back(path, created);
+}
+// ------------------------------------ //
+#ifdef _WIN32
+bool ResourceTreeListener::_StartReadingChanges(){
+
+	ZeroMemory(&OverlappedInfo, sizeof(OVERLAPPED));
+	OverlappedInfo.hEvent = ReadCompleteEvent;
+
+	if(!ReadDirectoryChangesW(TargetFolderHandle, ReadBuffer.data(),
+			static_cast<DWORD>(ReadBuffer.size() * sizeof(DWORD)),
+			// Sub folders are watched too
+			TRUE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME, NULL,
+			&OverlappedInfo, NULL))
+	{
+		Logger::Get()->Error("ResourceTreeListener: failed to start reading folder changes, "
+			"error: " + Convert::ToHexadecimalString(GetLastError()));
+		return false;
+	}
+
+	return true;
+}
+
+void ResourceTreeListener::_RunListeningThread(){
+
+	HANDLE handles[] = {StopEvent, ReadCompleteEvent};
+
+	while(!ShouldQuit){
+
+		const DWORD waitstatus = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+
+		if(waitstatus == WAIT_OBJECT_0)
+			return;
+
+		if(waitstatus != WAIT_OBJECT_0 + 1){
+
+			Logger::Get()->Error("ResourceTreeListener: _RunListeningThread: invalid wait "
+				"result: " + Convert::ToString(waitstatus));
+			return;
+		}
+
+		DWORD numread = 0;
+		GetOverlappedResult(TargetFolderHandle, &OverlappedInfo, &numread, FALSE);
+
+		if(numread == 0){
+
+			Logger::Get()->Warning("ResourceTreeListener: too many changes at once, some "
+				"were missed in: " + TargetFolder);
+		} else {
+
+			const char* data = reinterpret_cast<const char*>(ReadBuffer.data());
+
+			while(true){
+
+				const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(data);
+
+				std::string path = Convert::Utf16ToUtf8(std::wstring(info->FileName,
+					info->FileNameLength / sizeof(wchar_t)));
+
+				std::replace(path.begin(), path.end(), '\\', '/');
+				path = TargetFolder + "/" + path;
+
+				switch(info->Action){
+				case FILE_ACTION_ADDED:
+				case FILE_ACTION_RENAMED_NEW_NAME:
+					_QueueChange(path, true);
+					break;
+				case FILE_ACTION_REMOVED:
+				case FILE_ACTION_RENAMED_OLD_NAME:
+					_QueueChange(path, false);
+					break;
+				}
+
+				if(!info->NextEntryOffset)
+					break;
+
+				data += info->NextEntryOffset;
+			}
+		}
+
+		if(!_StartReadingChanges())
+			return;
+	}
+}
+#else
+void ResourceTreeListener::_WatchFolder(const std::string &folder){
+
+	const int watch = inotify_add_watch(InotifyID, folder.c_str(), IN_CREATE | IN_DELETE |
+		IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+
+	if(watch < 0){
+
+		Logger::Get()->Warning("ResourceTreeListener: failed to watch folder: " + folder);
+		return;
+	}
+
+	WatchedFolders[watch] = folder;
+
+	std::vector<std::string> files;
+	std::vector<std::string> folders;
+	FileSystem::GetFilesInDirectory(files, folder, "*.*", false, &folders);
+
+	for(const auto& subfolder : folders)
+		_WatchFolder(subfolder);
+}
+
+void ResourceTreeListener::_RunListeningThread(){
+
+	while(!ShouldQuit){
+
+		// Timeout so that quitting is noticed //
+		pollfd pollinfo = {InotifyID, POLLIN, 0};
+
+		const int ready = poll(&pollinfo, 1, 100);
+
+		if(ready == 0 || (ready < 0 && errno == EINTR))
+			continue;
+
+		const auto readcount = ready > 0 ?
+			read(InotifyID, ReadBuffer.data(), ReadBuffer.size()) : -1;
+
+		if(readcount < 0){
+
+			if(errno == EAGAIN || errno == EINTR)
+				continue;
+
+			Logger::Get()->Warning("ResourceTreeListener: read failed, quitting thread");
+			return;
+		}
+
+		for(ssize_t i = 0; i < readcount; ){
+
+			const auto* event = reinterpret_cast<const inotify_event*>(&ReadBuffer[i]);
+			i += sizeof(inotify_event) + event->len;
+
+			if(event->mask & IN_Q_OVERFLOW){
+
+				Logger::Get()->Warning("ResourceTreeListener: too many changes at once, some "
+					"were missed in: " + TargetFolder);
+				continue;
+			}
+
+			// Removed folders lose their watches automatically //
+			if(event->mask & IN_IGNORED){
+
+				WatchedFolders.erase(event->wd);
+				continue;
+			}
+
+			const auto folder = WatchedFolders.find(event->wd);
+
+			if(!event->len || folder == WatchedFolders.end())
+				continue;
+
+			// The name is padded with nulls //
+			const std::string path = folder->second + "/" + std::string(event->name);
+
+			if(event->mask & (IN_CREATE | IN_MOVED_TO)){
+
+				// Files created in a new folder before it was watched are found by the
+				// receiver checking the folder
+				if(event->mask & IN_ISDIR)
+					_WatchFolder(path);
+
+				_QueueChange(path, true);
+
+			} else if(event->mask & (IN_DELETE | IN_MOVED_FROM)){
+
+				// A folder moved away keeps its watches, which would report wrong paths //
+				if((event->mask & (IN_MOVED_FROM | IN_ISDIR)) == (IN_MOVED_FROM | IN_ISDIR)){
+
+					const std::string prefix = path + "/";
+
+					for(auto iter = WatchedFolders.begin(); iter != WatchedFolders.end(); ){
+
+						if(iter->second == path ||
+							iter->second.compare(0, prefix.size(), prefix) == 0)
+						{
+							inotify_rm_watch(InotifyID, iter->first);
+							iter = WatchedFolders.erase(iter);
+						} else {
+							++iter;
+						}
+					}
+				}
+
+				_QueueChange(path, false);
+			}
+		}
+	}
+}
+#endif //_WIN32
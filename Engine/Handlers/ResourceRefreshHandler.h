@@ -3,9 +3,12 @@
 #include "Define.h"
 // ------------------------------------ //
 #include "Common/ThreadSafe.h"
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <thread>
 #include "../TimeIncludes.h"
+#include <unordered_map>
 #include <vector>
 
 #ifdef _WIN32
@@ -108,6 +111,86 @@ protected:
 
 
 
+//! \brief Listens for files and folders being created and removed in a folder and all of its
+//! sub folders
+//!
+//! The changes are queued by the listening thread and reported on the main thread by
+//! ResourceRefreshHandler::CheckFileStatus
+class ResourceTreeListener{
+public:
+    //! \see ResourceRefreshHandler::ListenForFolderChanges
+    ResourceTreeListener(const std::string &folder,
+        std::function<void (const std::string &, bool)> notifyfunction);
+    ~ResourceTreeListener();
+
+    DLLEXPORT int GetID() const;
+
+    //! \brief Starts a listening thread
+    bool StartListening();
+
+    //! \brief Stops and waits for the listening thread
+    void StopThread();
+
+    //! \brief Calls the callback for all the changes found since the last call
+    void ReportChanges();
+
+protected:
+
+    void _RunListeningThread();
+
+    void _QueueChange(const std::string &path, bool created);
+
+#ifdef _WIN32
+    bool _StartReadingChanges();
+#else
+    //! \brief Adds watches for a folder and all its sub folders
+    void _WatchFolder(const std::string &folder);
+#endif //_WIN32
+    // ------------------------------------ //
+
+    std::thread ListenerThread;
+
+    std::string TargetFolder;
+
+    std::atomic<bool> ShouldQuit = {false};
+
+    int ID;
+
+    //! Called with the path of the created or removed file or folder and true if it was
+    //! created
+    std::function<void (const std::string &, bool)> CallbackFunction;
+
+    //! Changes that the listening thread has found
+    std::mutex QueuedChangesMutex;
+    std::vector<std::pair<std::string, bool>> QueuedChanges;
+
+#ifdef _WIN32
+
+    HANDLE StopEvent = nullptr;
+
+    HANDLE ReadCompleteEvent = nullptr;
+
+    HANDLE TargetFolderHandle = INVALID_HANDLE_VALUE;
+
+    OVERLAPPED OverlappedInfo;
+
+    //! DWORD aligned as ReadDirectoryChangesW requires
+    std::vector<DWORD> ReadBuffer;
+
+#else
+
+    int InotifyID = -1;
+
+    //! The watched folders by their inotify watch ids
+    std::unordered_map<int, std::string> WatchedFolders;
+
+    std::vector<char> ReadBuffer;
+
+#endif // _WIN32
+};
+
+
+
 //! \brief Allows various resource loaders to get notified when the file on disk changes
 //!
 //! Mainly used for quickly reloading GUI files after minor changes
@@ -138,10 +221,21 @@ public:
         std::function<void (const std::string &, ResourceFolderListener&)> notifyfunction,
         int &createdid);
 
+    //! \brief Starts listening for files being created and removed in a folder and its sub
+    //! folders
+    //! \param notifyfunction Called on the main thread with the path of the created or
+    //! removed file or folder, and true if it was created. The path starts with folder
+    //! \param createdid Will contain the ID of the created listener
+    //! \return True when properly started, false otherwise
+    //! \note When a folder is removed or moved away only the folder is reported, not the
+    //! files in it
+    DLLEXPORT bool ListenForFolderChanges(const std::string &folder,
+        std::function<void (const std::string &, bool)> notifyfunction, int &createdid);
+
     //! \brief Stops a listener with a specific id
-    //! \todo Implement this
-    //! \param idoflistener The ID returned by WatchForFileChanges in createdid variable
-    //! \see WatchForFileChanges
+    //! \param idoflistener The ID returned by ListenForFileChanges or ListenForFolderChanges
+    //! in createdid variable
+    //! \see ListenForFileChanges
     DLLEXPORT void StopListeningForFileChanges(int idoflistener);
 
 
@@ -160,6 +254,8 @@ protected:
     //! Holds all the active listeners
     std::vector<std::unique_ptr<ResourceFolderListener>> ActiveFileListeners;
 
+    std::vector<std::unique_ptr<ResourceTreeListener>> ActiveTreeListeners;
+
         
     WantedClockType::time_point NextUpdateTime;
 
@@ -0,0 +1,216 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#define LEVIATHAN_ASCII_SCANNER_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEVIATHAN_ASCII_SCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace Leviathan {
+
+//! \brief Finds runs of bytes that StringIterator can skip over without looking at each
+//! character
+//!
+//! Uses SSE2 or AVX2 when the compiler targets them. Bytes that aren't ASCII, line
+//! terminators and the characters that change StringIterator flags ('\\', '"', '\'' and '/')
+//! always end a run so that StringIterator can handle them one at a time
+class ASCIIScanner {
+public:
+    //! \returns True if c can be part of a run
+    static constexpr bool IsPlainCharacter(int c)
+    {
+        return c >= 0 && c < 0x80 && !(c >= '\n' && c <= '\r') && c != '\\' && c != '"' &&
+               c != '\'' && c != '/';
+    }
+
+    //! \brief Counts the plain characters at the start of the data
+    //! \param stopcharacter Also ends the run. Use -1 for none
+    static inline size_t CountPlainCharacters(
+        const char* begin, const char* end, int stopcharacter)
+    {
+        const char* current = begin;
+
+        // Non-plain characters end the run anyway //
+        const char stop = IsPlainCharacter(stopcharacter) ? static_cast<char>(stopcharacter) :
+                                                            '\\';
+
+#if defined(LEVIATHAN_ASCII_SCANNER_AVX2)
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i doublequote = _mm256_set1_epi8('"');
+        const __m256i singlequote = _mm256_set1_epi8('\'');
+        const __m256i slash = _mm256_set1_epi8('/');
+        const __m256i stopvector = _mm256_set1_epi8(stop);
+        const __m256i beforelineend = _mm256_set1_epi8('\n' - 1);
+        const __m256i afterlineend = _mm256_set1_epi8('\r' + 1);
+
+        for(; end - current >= 32; current += 32) {
+
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current));
+
+            const __m256i lineend = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, beforelineend),
+                _mm256_cmpgt_epi8(afterlineend, bytes));
+
+            const __m256i special = _mm256_or_si256(
+                _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, backslash),
+                                    _mm256_cmpeq_epi8(bytes, doublequote)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(bytes, singlequote),
+                        _mm256_cmpeq_epi8(bytes, slash))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(bytes, stopvector), lineend));
+
+            // The sign bit is set for bytes that aren't ASCII //
+            const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(special)) |
+                                  static_cast<uint32_t>(_mm256_movemask_epi8(bytes));
+
+            if(mask != 0)
+                return (current - begin) + _FirstSetBit(mask);
+        }
+#elif defined(LEVIATHAN_ASCII_SCANNER_SSE2)
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i doublequote = _mm_set1_epi8('"');
+        const __m128i singlequote = _mm_set1_epi8('\'');
+        const __m128i slash = _mm_set1_epi8('/');
+        const __m128i stopvector = _mm_set1_epi8(stop);
+        const __m128i beforelineend = _mm_set1_epi8('\n' - 1);
+        const __m128i afterlineend = _mm_set1_epi8('\r' + 1);
+
+        for(; end - current >= 16; current += 16) {
+
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+
+            const __m128i lineend = _mm_and_si128(
+                _mm_cmpgt_epi8(bytes, beforelineend), _mm_cmplt_epi8(bytes, afterlineend));
+
+            const __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, backslash),
+                                 _mm_cmpeq_epi8(bytes, doublequote)),
+                    _mm_or_si128(
+                        _mm_cmpeq_epi8(bytes, singlequote), _mm_cmpeq_epi8(bytes, slash))),
+                _mm_or_si128(_mm_cmpeq_epi8(bytes, stopvector), lineend));
+
+            // The sign bit is set for bytes that aren't ASCII //
+            const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special)) |
+                                  static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+
+            if(mask != 0)
+                return (current - begin) + _FirstSetBit(mask);
+        }
+#endif
+
+        for(; current != end; ++current) {
+
+            const int c = static_cast<unsigned char>(*current);
+
+            if(!IsPlainCharacter(c) || c == stop)
+                return current - begin;
+        }
+
+        return current - begin;
+    }
+
+    //! \brief Counts the plain characters at the start of the data that are whitespace or
+    //! other characters with codes up to 32, or skipcharacter
+    //! \param skipcharacter Also counted if it is plain. Use -1 for none
+    static inline size_t CountWhitespace(const char* begin, const char* end, int skipcharacter)
+    {
+        const char* current = begin;
+
+        // Space is always counted so it can be used when nothing else is //
+        const char skip = IsPlainCharacter(skipcharacter) ? static_cast<char>(skipcharacter) :
+                                                            ' ';
+
+#if defined(LEVIATHAN_ASCII_SCANNER_AVX2)
+        const __m256i skipvector = _mm256_set1_epi8(skip);
+        const __m256i negative = _mm256_set1_epi8(-1);
+        const __m256i afterspace = _mm256_set1_epi8(' ' + 1);
+        const __m256i beforelineend = _mm256_set1_epi8('\n' - 1);
+        const __m256i afterlineend = _mm256_set1_epi8('\r' + 1);
+
+        for(; end - current >= 32; current += 32) {
+
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current));
+
+            const __m256i lowcode = _mm256_and_si256(
+                _mm256_cmpgt_epi8(bytes, negative), _mm256_cmpgt_epi8(afterspace, bytes));
+
+            const __m256i lineend = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, beforelineend),
+                _mm256_cmpgt_epi8(afterlineend, bytes));
+
+            const __m256i skipped = _mm256_or_si256(
+                _mm256_andnot_si256(lineend, lowcode), _mm256_cmpeq_epi8(bytes, skipvector));
+
+            const uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(skipped));
+
+            if(mask != 0)
+                return (current - begin) + _FirstSetBit(mask);
+        }
+#elif defined(LEVIATHAN_ASCII_SCANNER_SSE2)
+        const __m128i skipvector = _mm_set1_epi8(skip);
+        const __m128i negative = _mm_set1_epi8(-1);
+        const __m128i afterspace = _mm_set1_epi8(' ' + 1);
+        const __m128i beforelineend = _mm_set1_epi8('\n' - 1);
+        const __m128i afterlineend = _mm_set1_epi8('\r' + 1);
+
+        for(; end - current >= 16; current += 16) {
+
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+
+            const __m128i lowcode =
+                _mm_and_si128(_mm_cmpgt_epi8(bytes, negative), _mm_cmplt_epi8(bytes, afterspace));
+
+            const __m128i lineend = _mm_and_si128(
+                _mm_cmpgt_epi8(bytes, beforelineend), _mm_cmplt_epi8(bytes, afterlineend));
+
+            const __m128i skipped = _mm_or_si128(
+                _mm_andnot_si128(lineend, lowcode), _mm_cmpeq_epi8(bytes, skipvector));
+
+            const uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(skipped)) & 0xFFFF;
+
+            if(mask != 0)
+                return (current - begin) + _FirstSetBit(mask);
+        }
+#endif
+
+        for(; current != end; ++current) {
+
+            const int c = static_cast<unsigned char>(*current);
+
+            if(c != skip && !(c <= ' ' && IsPlainCharacter(c)))
+                return current - begin;
+        }
+
+        return current - begin;
+    }
+
+private:
+    //! \pre mask isn't 0
+    static inline size_t _FirstSetBit(uint32_t mask)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    ASCIIScanner() = delete;
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::ASCIIScanner;
+#endif
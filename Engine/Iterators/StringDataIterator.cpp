@@ -39,6 +39,17 @@ DLLEXPORT bool Leviathan::StringDataIterator::ReturnSubString(size_t startpos, s
     return false;
 }
 // ------------------------------------ //
+DLLEXPORT bool StringDataIterator::GetRemainingBytes(const char* &current,
+    const char* &end) const
+{
+    return false;
+}
+
+DLLEXPORT void StringDataIterator::SkipASCIIBytes(size_t count){
+
+    LEVIATHAN_ASSERT(0, "StringDataIterator doesn't support skipping bytes");
+}
+// ------------------------------------ //
 DLLEXPORT size_t Leviathan::StringDataIterator::GetCurrentCharacterNumber() const{
     return CurrentCharacterNumber;
 }
@@ -87,6 +98,27 @@ DLLEXPORT bool UTF8PointerDataIterator::GetNextCharCode(int &codepointreceiver,
     if(Current + forward >= End)
         return false;
 
+    // ASCII characters don't need decoding //
+    if(static_cast<unsigned char>(*Current) < 0x80){
+
+        if(!forward){
+
+            codepointreceiver = *Current;
+            return true;
+        }
+
+        // Characters before the wanted one need to be ASCII for it to be at the offset //
+        size_t ascii = 1;
+        while(ascii <= forward && static_cast<unsigned char>(Current[ascii]) < 0x80)
+            ++ascii;
+
+        if(ascii > forward){
+
+            codepointreceiver = static_cast<unsigned char>(Current[forward]);
+            return true;
+        }
+    }
+
     // We can just peek the next character if forward is 0 //
     if(!forward){
 
@@ -164,14 +196,18 @@ DLLEXPORT void UTF8PointerDataIterator::MoveToNextCharacter(){
         return;
 
     // We need to move whole code points //
-#if !defined(ALTERNATIVE_EXCEPTIONS_FATAL) || defined(ALLOW_INTERNAL_EXCEPTIONS)
+    if(static_cast<unsigned char>(*Current) < 0x80){
 
-    utf8::advance(Current, 1, End);
+        ++Current;
 
-#else
-    utf8::unchecked::advance(Current, 1);
+    } else {
 
-#endif //ALTERNATIVE_EXCEPTIONS_FATAL
+    #if !defined(ALTERNATIVE_EXCEPTIONS_FATAL) || defined(ALLOW_INTERNAL_EXCEPTIONS)
+        utf8::advance(Current, 1, End);
+    #else
+        utf8::unchecked::advance(Current, 1);
+    #endif //ALTERNATIVE_EXCEPTIONS_FATAL
+    }
 
     // Don't forget to increment these //
     ++CurrentCharacterNumber;
@@ -208,6 +244,26 @@ DLLEXPORT bool UTF8PointerDataIterator::ReturnSubString(size_t startpos, size_t
     receiver = std::string(BeginPos + startpos, (endpos - startpos) + 1);
     return true;
 }
+// ------------------------------------ //
+DLLEXPORT bool UTF8PointerDataIterator::GetRemainingBytes(const char* &current,
+    const char* &end) const
+{
+    if(!Current)
+        return false;
+
+    current = Current;
+    end = End;
+    return true;
+}
+
+DLLEXPORT void UTF8PointerDataIterator::SkipASCIIBytes(size_t count){
+
+    Current += count;
+    CurrentCharacterNumber += count;
+
+    if(IsPositionValid())
+        CheckLineChange();
+}
 
     
 
@@ -2,6 +2,8 @@
 // ------------------------------------ //
 #include "Define.h"
 // ------------------------------------ //
+#include <string>
+#include <type_traits>
 
 
 namespace Leviathan{
@@ -56,6 +58,18 @@ public:
     //! \brief Returns true when the iterator is still valid
     virtual bool IsPositionValid() const = 0;
 
+    //! \brief Gets the bytes from the current position to the end
+    //!
+    //! Only data that is stored as bytes where each ASCII byte is one character can
+    //! support this. StringIterator uses this to skip runs of characters at once
+    //! \returns False if not supported
+    DLLEXPORT virtual bool GetRemainingBytes(const char* &current, const char* &end) const;
+
+    //! \brief Moves forward over ASCII bytes that aren't line terminators
+    //! \pre GetRemainingBytes returned true and count is at most the number of bytes it
+    //! returned
+    DLLEXPORT virtual void SkipASCIIBytes(size_t count);
+
 
     // Basic functions that should all be the same //
 
@@ -149,6 +163,26 @@ public:
         return End-1;
     }
 
+    virtual bool GetRemainingBytes(const char* &current, const char* &end) const{
+
+        if constexpr(std::is_same<STRType, std::string>::value){
+
+            current = OurString.data() + Current;
+            end = OurString.data() + End;
+            return true;
+
+        } else {
+
+            return false;
+        }
+    }
+
+    virtual void SkipASCIIBytes(size_t count){
+        Current += count;
+        CurrentCharacterNumber += count;
+        CheckLineChange();
+    }
+
 
 
 protected:
@@ -228,6 +262,29 @@ public:
         return End-1;
     }
 
+    virtual bool GetRemainingBytes(const char* &current, const char* &end) const{
+
+        if constexpr(std::is_same<STRType, std::string>::value){
+
+            if(!OurString)
+                return false;
+
+            current = OurString->data() + Current;
+            end = OurString->data() + End;
+            return true;
+
+        } else {
+
+            return false;
+        }
+    }
+
+    virtual void SkipASCIIBytes(size_t count){
+        Current += count;
+        CurrentCharacterNumber += count;
+        CheckLineChange();
+    }
+
 protected:
 
     const STRType* OurString;
@@ -269,6 +326,10 @@ public:
     DLLEXPORT virtual bool ReturnSubString(size_t startpos, size_t endpos, 
         std::string &receiver);
 
+    DLLEXPORT virtual bool GetRemainingBytes(const char* &current, const char* &end) const;
+
+    DLLEXPORT virtual void SkipASCIIBytes(size_t count);
+
 protected:
 
     //! The current position of the iterator
@@ -3,6 +3,7 @@
 #include "Define.h"
 // ------------------------------------ //
 #include "StringDataIterator.h"
+#include "ASCIIScanner.h"
 #include "IteratorData.h"
 #include "../Common/StringOperations.h"
 
@@ -122,6 +123,13 @@ enum ITERATORFLAG_SET{
     ITERATORFLAG_SET_CCOMMENT_END = 0x2000
 };
 
+//! Flags that change on the next character. Characters aren't skipped in bulk while any of
+//! these are set
+constexpr int ITERATORFLAG_SET_CHANGING = ITERATORFLAG_SET_IGNORE_SPECIAL |
+    ITERATORFLAG_SET_STOP | ITERATORFLAG_SET_INSIDE_STRING_SINGLE_END |
+    ITERATORFLAG_SET_INSIDE_STRING_DOUBLE_END | ITERATORFLAG_SET_IGNORE_SPECIAL_END |
+    ITERATORFLAG_SET_CPPCOMMENT_END | ITERATORFLAG_SET_CCOMMENT_END;
+
 
 
 
@@ -180,7 +188,7 @@ public:
 
         // Iterate with our getting function //
         StartIterating(specialflags, &StringIterator::FindFirstQuotedString,
-            &data, quotes, specialflags);
+            &StringIterator::SkipInQuotedString, &data, quotes, specialflags);
 
         // Create the substring from the result //
         std::unique_ptr<RStrType> resultstr;
@@ -314,7 +322,8 @@ public:
         IteratorFindUntilData data;
 
         // Iterate with our getting function //
-        StartIterating(0, &StringIterator::FindUntilNewLine, &data);
+        StartIterating(0, &StringIterator::FindUntilNewLine,
+            &StringIterator::SkipUntilNewLine, &data);
 
         // Check for validity //
         if(!data.Positions.Start){
@@ -472,7 +481,7 @@ public:
         // Iterate over the string skipping until hit something that doesn't need to be
         // skipped
         StartIterating(specialflags, &StringIterator::SkipSomething,
-            stufftoskip, additionalflag, specialflags);
+            &StringIterator::SkipSomethingInBulk, stufftoskip, additionalflag, specialflags);
     }
 
     // Utility functions //
@@ -627,7 +636,7 @@ public:
 
         // Iterate with our getting function //
         StartIterating(specialflags, &StringIterator::FindUntilSpecificCharacter,
-            &data, character, specialflags);
+            &StringIterator::SkipUntilSpecificCharacter, &data, character, specialflags);
 
     #ifdef ITERATOR_ALLOW_DEBUG
         if(DebugMode){
@@ -963,6 +972,21 @@ private:
         template <typename... Params, typename... Args>
         void StartIterating(int specialflagcopy, 
             ITERATORCALLBACK_RETURNTYPE(StringIterator::*mf)(Params...), Args&&... args)
+        {
+            StartIterating(specialflagcopy, mf,
+                static_cast<size_t(StringIterator::*)(const char*, const char*, Params...)>(
+                    nullptr), std::forward<Args>(args)...);
+        }
+
+        //! \brief Version of StartIterating that can skip many characters at once
+        //! \param bulkskip Gets the remaining bytes when the data supports that and returns
+        //! how many characters from the current one mf would continue on without changing
+        //! anything. Only plain characters (see ASCIIScanner) may be skipped
+        template <typename... Params, typename... Args>
+        void StartIterating(int specialflagcopy, 
+            ITERATORCALLBACK_RETURNTYPE(StringIterator::*mf)(Params...),
+            size_t(StringIterator::*bulkskip)(const char*, const char*, Params...),
+            Args&&... args)
         {
         #ifdef ITERATOR_ALLOW_DEBUG
             if (DebugMode) {
@@ -979,6 +1003,28 @@ private:
                 firstiter = false;
 
             for (; DataIterator->IsPositionValid(); DataIterator->MoveToNextCharacter()) {
+
+                // Plain characters don't change the flags so while the flags aren't about to
+                // change only mf needs to be asked which of them can be skipped
+                if (bulkskip && !firstiter && !(CurrentFlags & ITERATORFLAG_SET_CHANGING)) {
+
+                    const char* current;
+                    const char* end;
+
+                    if (DataIterator->GetRemainingBytes(current, end)) {
+
+                        const size_t count = (this->*bulkskip)(current, end, args...);
+
+                        if (count > 0) {
+
+                            DataIterator->SkipASCIIBytes(count);
+                            CurrentStored = false;
+
+                            if (!DataIterator->IsPositionValid())
+                                break;
+                        }
+                    }
+                }
                 
                 // The GetCharacter call will cache the result
                 // but there might be iterators that don't want to get the current character
@@ -1616,6 +1662,66 @@ private:
             return ITERATORCALLBACK_RETURNTYPE_CONTINUE;
         }
 
+        // Bulk skipping functions for the above //
+
+        inline size_t SkipInQuotedString(const char* current, const char* end,
+            IteratorPositionData* data, QUOTETYPE quotes, int specialflags)
+        {
+            int stringflag = ITERATORFLAG_SET_INSIDE_STRING;
+
+            if(quotes == QUOTETYPE_SINGLEQUOTES){
+                stringflag = ITERATORFLAG_SET_INSIDE_STRING_SINGLE;
+            } else if(quotes == QUOTETYPE_DOUBLEQUOTES){
+                stringflag = ITERATORFLAG_SET_INSIDE_STRING_DOUBLE;
+            }
+
+            // Characters before the string and inside it are skipped, but the first
+            // character in the string sets the start and the first one after it ends it
+            const bool started = data->Positions.Start ? true : false;
+
+            if(started != ((CurrentFlags & stringflag) != 0))
+                return 0;
+
+            return ASCIIScanner::CountPlainCharacters(current, end, -1);
+        }
+
+        inline size_t SkipSomethingInBulk(const char* current, const char* end,
+            IteratorCharacterData &data, const int additionalskip, const int specialflags)
+        {
+            if((specialflags & SPECIAL_ITERATOR_HANDLECOMMENTS_ASSTRING) &&
+                (CurrentFlags & ITERATORFLAG_SET_INSIDE_COMMENT))
+            {
+                return ASCIIScanner::CountPlainCharacters(current, end, -1);
+            }
+
+            if(CurrentFlags & ITERATORFLAG_SET_INSIDE_STRING)
+                return 0;
+
+            if(additionalskip & UNNORMALCHARACTER_TYPE_LOWCODES)
+                return ASCIIScanner::CountWhitespace(current, end, data.CharacterToUse);
+
+            return 0;
+        }
+
+        inline size_t SkipUntilSpecificCharacter(const char* current, const char* end,
+            IteratorFindUntilData* data, int character, int specialflags)
+        {
+            // The first character sets the start //
+            if(!data->Positions.Start)
+                return 0;
+
+            return ASCIIScanner::CountPlainCharacters(current, end, character);
+        }
+
+        inline size_t SkipUntilNewLine(const char* current, const char* end,
+            IteratorFindUntilData* data)
+        {
+            if(!data->Positions.Start)
+                return 0;
+
+            return ASCIIScanner::CountPlainCharacters(current, end, -1);
+        }
+
         inline ITERATORCALLBACK_RETURNTYPE FindInMatchingParentheses(
             IteratorNestingLevelData* data, int left, int right, int specialflags)
         {
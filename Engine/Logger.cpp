@@ -14,6 +14,7 @@
 #endif //_WIN32
 
 #include <chrono>
+#include <csignal>
 #include <fstream>
 #include <ctime>
 #include <iomanip>
@@ -66,9 +67,9 @@ DLLEXPORT Logger::Logger(const std::string &file):
         }
     }
 
-    std::ofstream writer(Path);
+    File.open(Path, std::ofstream::out | std::ofstream::trunc);
 
-    if (!writer.is_open()) {
+    if (!File.is_open()) {
 
     #ifndef ALTERNATIVE_EXCEPTIONS_FATAL
         throw Exception("Cannot open log file");
@@ -78,29 +79,46 @@ DLLEXPORT Logger::Logger(const std::string &file):
     #endif //ALTERNATIVE_EXCEPTIONS_FATAL
     }
 
-    writer << write;
+    File << write;
+    File.flush();
 
-    writer.close();
+    WriterThread = std::thread(&Logger::_RunWriterThread, this);
+
+    // Save the log if the process crashes. Handlers set by the application are kept
+    static std::once_flag crashhandlers;
+
+    std::call_once(crashhandlers, [](){
+            for(const auto signal : {SIGSEGV, SIGABRT, SIGFPE, SIGILL}){
+
+                const auto previous = std::signal(signal, &Logger::_SaveOnCrash);
+
+                if(previous != SIG_DFL && previous != SIG_ERR)
+                    std::signal(signal, previous);
+            }
+        });
 
-    
-    PendingLog = "";
     LatestLogger = this;
 }
 
-//! \brief Lock when using the logger singleton
-static Mutex LoggerWriteMutex;
-
 Logger::~Logger(){
-    // Save if unsaved //
-    Lock lock(LoggerWriteMutex);
-    
-    _Save();
-    
+
     // Reset latest logger (this allows to create new logger,
     // which is quite bad, but won't crash
     // There is also probably a race condition here
     if(LatestLogger == this)
         LatestLogger = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(WriterMutex);
+        QuitWriter = true;
+    }
+
+    WriterNotify.notify_one();
+    WriterThread.join();
+
+    // Save if unsaved //
+    std::lock_guard<std::mutex> lock(FileMutex);
+    _WritePending();
 }
 
 DLLEXPORT Logger* Logger::Get(){
@@ -112,26 +130,24 @@ Logger* Logger::LatestLogger = NULL;
 // ------------------------------------ //
 DLLEXPORT void Logger::Write(const std::string &data){
 
-    const auto message = data+"\n";
+    if(!IsEnabled(LOG_LEVEL::Info))
+        return;
 
-    Lock lock(LoggerWriteMutex);
+    auto message = data+"\n";
 
     SendDebugMessage(message);
-    
-    PendingLog += message;
 
-    _LogUpdateEndPart();
+    _Queue(std::move(message));
 }
 
 DLLEXPORT void Logger::WriteRaw(const std::string &data){
 
-    Lock lock(LoggerWriteMutex);
+    if(!IsEnabled(LOG_LEVEL::Info))
+        return;
 
     SendDebugMessage(data);
-    
-    PendingLog += data;
 
-    _LogUpdateEndPart();
+    _Queue(std::string(data));
 }
 
 void Logger::WriteLine(const std::string &Text) {
@@ -141,83 +157,160 @@ void Logger::WriteLine(const std::string &Text) {
 
 void Logger::Fatal(const std::string &data) {
 
-    const auto message = "[FATAL] " + data + "\n";
+    auto message = "[FATAL] " + data + "\n";
 
-    {
-        Lock lock(LoggerWriteMutex);
-
-        SendDebugMessage(message);
-
-        PendingLog += message;
+    SendDebugMessage(message);
 
-        _LogUpdateEndPart();
+    _Queue(std::move(message));
 
-        // This might call Save for the second time, but better call
-        // it twice than miss saving the log before aborting
-        _Save();
-    }
+    // Make sure the log is saved before aborting
+    Save();
 
     // Exit process //
     abort();
 }
 // ------------------------------------ //
 DLLEXPORT void Logger::Info(const std::string &data){
-    
-    const auto message = "[INFO] " + data + "\n";
 
-    Lock lock(LoggerWriteMutex);
+    if(!IsEnabled(LOG_LEVEL::Info))
+        return;
+
+    auto message = "[INFO] " + data + "\n";
 
     SendDebugMessage(message);
-    
-    PendingLog += message;
 
-    _LogUpdateEndPart();
+    _Queue(std::move(message));
 }
 // ------------------------------------ //
 DLLEXPORT void Logger::Error(const std::string &data){
 
-    const auto message = "[ERROR] " + data + "\n";
+    if(!IsEnabled(LOG_LEVEL::Error))
+        return;
 
-    Lock lock(LoggerWriteMutex);
+    auto message = "[ERROR] " + data + "\n";
 
     SendDebugMessage(message);
-    
-    PendingLog += message;
 
-    _LogUpdateEndPart();
+    _Queue(std::move(message));
 }
 // ------------------------------------ //
 DLLEXPORT void Logger::Warning(const std::string &data){
 
-    const auto message = "[WARNING] " + data + "\n";
+    if(!IsEnabled(LOG_LEVEL::Warning))
+        return;
+
+    auto message = "[WARNING] " + data + "\n";
 
-    Lock lock(LoggerWriteMutex);
-    
     SendDebugMessage(message);
-    
-    PendingLog += message;
 
-    _LogUpdateEndPart();
+    _Queue(std::move(message));
 }
 // ------------------------------------ //
 void Logger::Save(){
 
-    Lock lock(LoggerWriteMutex);
+    std::lock_guard<std::mutex> lock(FileMutex);
+
+    _WritePending();
+}
+
+DLLEXPORT void Logger::SetLevel(LOG_LEVEL level){
+
+    // Fatal messages can't be disabled
+    if(level > LOG_LEVEL::Fatal)
+        level = LOG_LEVEL::Fatal;
+
+    Level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+// ------------------------------------ //
+void Logger::_Queue(std::string&& message){
+
+    const auto size = message.size();
+
+    PendingMessages.Push(std::move(message));
+
+    // Wake up the writer early if a lot of text is waiting
+    const auto pending = PendingBytes.fetch_add(size, std::memory_order_relaxed) + size;
 
-    _Save();
+    if(pending >= WRITE_THRESHOLD && pending - size < WRITE_THRESHOLD){
+
+        {
+            std::lock_guard<std::mutex> lock(WriterMutex);
+            WakeWriter = true;
+        }
+
+        WriterNotify.notify_one();
+    }
 }
 
-void Logger::_Save(){
+void Logger::_WritePending(){
+
+    std::string batch;
+    std::string message;
 
-    if(PendingLog.empty())
+    // A Push from another thread can be half way done which makes the queue look empty
+    // while it isn't. This waits for those so that they aren't left until the next write
+    for(int retries = 0; retries < 100; ){
+
+        if(PendingMessages.Pop(message)){
+
+            batch += message;
+            continue;
+        }
+
+        if(PendingMessages.IsEmpty())
+            break;
+
+        ++retries;
+        std::this_thread::yield();
+    }
+
+    if(batch.empty())
         return;
 
-    std::ofstream file(Path, std::ofstream::out | std::ofstream::app);
+    PendingBytes.fetch_sub(batch.size(), std::memory_order_relaxed);
 
-    file << PendingLog;
-    file.close();
-    
-    PendingLog.clear();
+    File.write(batch.data(), batch.size());
+    File.flush();
+}
+
+void Logger::_RunWriterThread(){
+
+    std::unique_lock<std::mutex> lock(WriterMutex);
+
+    while(!QuitWriter){
+
+        WriterNotify.wait_for(lock, WRITE_INTERVAL, [this](){
+                return WakeWriter || QuitWriter;
+            });
+
+        WakeWriter = false;
+
+        lock.unlock();
+
+        {
+            std::lock_guard<std::mutex> filelock(FileMutex);
+            _WritePending();
+        }
+
+        lock.lock();
+    }
+}
+
+void Logger::_SaveOnCrash(int signal){
+
+    // This isn't safe to do in a signal handler but the process is going down anyway and
+    // having the log is more important
+    Logger* logger = LatestLogger;
+
+    // Can't wait for the writer thread as it may be the one that crashed
+    if(logger && logger->FileMutex.try_lock()){
+
+        logger->_WritePending();
+        logger->FileMutex.unlock();
+    }
+
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
 }
 // -------------------------------- //
 void Logger::Print(const string &message){
@@ -236,9 +329,7 @@ DLLEXPORT void Logger::SendDebugMessage(const string &str){
 // ------------------------------------ //
 DLLEXPORT void Logger::DirectWriteBuffer(const std::string &data){
 
-    Lock guard(LoggerWriteMutex);
-
-    PendingLog += data;
+    _Queue(std::string(data));
 }
 // ------------------------------------ //
 DLLEXPORT std::string Logger::GetLogFile() const{
@@ -246,10 +337,5 @@ DLLEXPORT std::string Logger::GetLogFile() const{
     return Path;
 }
 // ------------------------------------ //
-void Logger::_LogUpdateEndPart(){
-
-    _Save();
-}
-// ------------------------------------ //
 
 
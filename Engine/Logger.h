@@ -2,10 +2,34 @@
 // ------------------------------------ //
 #include "Include.h"
 #include "ErrorReporter.h"
+#include "Threading/MPSCQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
 namespace Leviathan{
 
+//! \brief Importance of a log message
+enum class LOG_LEVEL : int {
+
+    //! Info, Write and other plain messages
+    Info,
+    Warning,
+    Error,
+
+    //! Fatal messages are always logged
+    Fatal
+};
+
 //! \brief Logger class for all text output
+//!
+//! Messages are printed right away but a background thread writes them to the file in
+//! batches. Save forces everything to be written and it is also done on Fatal and when the
+//! process crashes
 //! \todo Allow logs that don't save to a file
 class Logger : public LErrorReporter{
 public:
@@ -32,8 +56,25 @@ public:
     //! \brief Script wrapper
     DLLEXPORT static void Print(const std::string &message);
 
+    //! \brief Writes all queued messages to the file before returning
     DLLEXPORT void Save();
 
+    //! \brief Sets the lowest level of messages that are logged
+    DLLEXPORT void SetLevel(LOG_LEVEL level);
+
+    inline LOG_LEVEL GetLevel() const
+    {
+        return static_cast<LOG_LEVEL>(Level.load(std::memory_order_relaxed));
+    }
+
+    //! \returns True if messages of level are logged
+    //!
+    //! The LOG_ macros check this before building the message
+    inline bool IsEnabled(LOG_LEVEL level) const
+    {
+        return static_cast<int>(level) >= Level.load(std::memory_order_relaxed);
+    }
+
     //! \brief Adds raw data to the queue unmodified
     //! \note You will need to add new lines '\n' manually
     DLLEXPORT void DirectWriteBuffer(const std::string &data);
@@ -44,24 +85,53 @@ public:
 
     DLLEXPORT static Logger* Get();
         
+    //! How often the writer thread writes queued messages
+    static constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(100);
+
+    //! Queuing more than this many bytes wakes up the writer thread right away
+    static constexpr size_t WRITE_THRESHOLD = 256 * 1024;
+
 private:
 
-    //! Call only after locking
-    void _Save();
+    //! \brief Adds a message for the writer thread
+    void _Queue(std::string&& message);
+
+    //! \brief Writes everything in PendingMessages to the file
+    //! \pre FileMutex is locked
+    void _WritePending();
+
+    void _RunWriterThread();
 
-    //! \note The global logger mutex needs to be locked before this call
-    void _LogUpdateEndPart();
+    //! \brief Signal handler that saves the latest logger before crashing
+    static void _SaveOnCrash(int signal);
 
 private:
-    
-    std::string PendingLog;
+
     std::string Path;
 
+    //! Kept open for the lifetime of the logger. Only used with FileMutex locked
+    std::ofstream File;
+
+    //! Messages waiting to be written. Any thread can add to this, but only the thread that
+    //! has locked FileMutex can take from it
+    MPSCQueue<std::string> PendingMessages;
+    std::mutex FileMutex;
+
+    std::atomic<size_t> PendingBytes = {0};
+    std::atomic<int> Level = {static_cast<int>(LOG_LEVEL::Info)};
+
+    std::thread WriterThread;
+    std::mutex WriterMutex;
+    std::condition_variable WriterNotify;
+    bool WakeWriter = false;
+    bool QuitWriter = false;
+
     static Logger* LatestLogger;
 };
 }
 
 #ifdef LEAK_INTO_GLOBAL
+using Leviathan::LOG_LEVEL;
 using Leviathan::Logger;
 #endif
 
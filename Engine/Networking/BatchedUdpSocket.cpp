@@ -0,0 +1,120 @@
+// ------------------------------------ //
+#include "BatchedUdpSocket.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <cerrno>
+#endif //__linux__
+
+using namespace Leviathan;
+// ------------------------------------ //
+#ifdef __linux__
+
+void BatchedUdpSocket::_PrepareBatchBuffers(size_t batchsize)
+{
+    if(Headers.size() == batchsize)
+        return;
+
+    // Datagrams up to the maximum size need to fit so that they aren't truncated //
+    Buffers.resize(batchsize * sf::UdpSocket::MaxDatagramSize);
+    BufferVectors.resize(batchsize);
+    SenderAddresses.resize(batchsize);
+    Headers.resize(batchsize);
+
+    for(size_t i = 0; i < batchsize; ++i) {
+
+        BufferVectors[i].iov_base = &Buffers[i * sf::UdpSocket::MaxDatagramSize];
+        BufferVectors[i].iov_len = sf::UdpSocket::MaxDatagramSize;
+    }
+}
+
+DLLEXPORT sf::Socket::Status BatchedUdpSocket::ReceiveBatch(
+    std::vector<ReceivedDatagram>& received, size_t& count)
+{
+    count = 0;
+
+    if(received.empty())
+        return sf::Socket::NotReady;
+
+    _PrepareBatchBuffers(received.size());
+
+    for(size_t i = 0; i < Headers.size(); ++i) {
+
+        auto& header = Headers[i].msg_hdr;
+
+        header = msghdr{};
+        header.msg_name = &SenderAddresses[i];
+        header.msg_namelen = sizeof(sockaddr_in);
+        header.msg_iov = &BufferVectors[i];
+        header.msg_iovlen = 1;
+        Headers[i].msg_len = 0;
+    }
+
+    // Blocks only until the first datagram if the socket is blocking //
+    const int result = recvmmsg(getHandle(), Headers.data(),
+        static_cast<unsigned int>(Headers.size()), MSG_WAITFORONE, nullptr);
+
+    if(result < 0) {
+
+        switch(errno) {
+        case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+        case EWOULDBLOCK:
+#endif
+        case EINTR:
+            return sf::Socket::NotReady;
+        case ECONNRESET:
+        case ECONNREFUSED:
+            return sf::Socket::Disconnected;
+        default:
+            return sf::Socket::Error;
+        }
+    }
+
+    for(int i = 0; i < result; ++i) {
+
+        auto& datagram = received[i];
+
+        datagram.Data.clear();
+        datagram.Data.append(BufferVectors[i].iov_base, Headers[i].msg_len);
+
+        datagram.Sender = sf::IpAddress(ntohl(SenderAddresses[i].sin_addr.s_addr));
+        datagram.SenderPort = ntohs(SenderAddresses[i].sin_port);
+    }
+
+    count = static_cast<size_t>(result);
+    return count > 0 ? sf::Socket::Done : sf::Socket::NotReady;
+}
+
+#else
+
+DLLEXPORT sf::Socket::Status BatchedUdpSocket::ReceiveBatch(
+    std::vector<ReceivedDatagram>& received, size_t& count)
+{
+    count = 0;
+
+    while(count < received.size()) {
+
+        auto& datagram = received[count];
+
+        const auto status = receive(datagram.Data, datagram.Sender, datagram.SenderPort);
+
+        if(status != sf::Socket::Done) {
+
+            if(count > 0)
+                break;
+
+            return status;
+        }
+
+        ++count;
+
+        // Only the first receive is allowed to block //
+        if(isBlocking())
+            break;
+    }
+
+    return count > 0 ? sf::Socket::Done : sf::Socket::NotReady;
+}
+
+#endif //__linux__
@@ -0,0 +1,64 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "SFML/Network/IpAddress.hpp"
+#include "SFML/Network/Packet.hpp"
+#include "SFML/Network/UdpSocket.hpp"
+
+#include <vector>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif //__linux__
+
+namespace Leviathan {
+
+//! Maximum number of datagrams BatchedUdpSocket::ReceiveBatch reads at once
+constexpr auto NETWORK_RECEIVE_BATCH_SIZE = 16;
+
+//! \brief UDP socket that can receive multiple datagrams with a single call
+//!
+//! On Linux this uses recvmmsg to drain the socket with one system call. On other platforms
+//! this falls back to calling receive in a loop
+class BatchedUdpSocket : public sf::UdpSocket {
+public:
+    //! \brief A datagram and who sent it
+    struct ReceivedDatagram {
+
+        sf::Packet Data;
+        sf::IpAddress Sender;
+        unsigned short SenderPort = 0;
+    };
+
+public:
+    //! \brief Receives up to received.size() datagrams
+    //!
+    //! In blocking mode this waits for the first datagram and then takes the ones that are
+    //! already waiting
+    //! \param received The datagrams are stored here. The packets are reused so size this
+    //! once and pass the same vector each time
+    //! \param count Set to the number of datagrams that were received
+    //! \returns sf::Socket::Done if at least one datagram was received
+    DLLEXPORT sf::Socket::Status ReceiveBatch(
+        std::vector<ReceivedDatagram>& received, size_t& count);
+
+private:
+#ifdef __linux__
+    void _PrepareBatchBuffers(size_t batchsize);
+
+    //! Receive buffer for each datagram in a batch
+    std::vector<char> Buffers;
+    std::vector<iovec> BufferVectors;
+    std::vector<sockaddr_in> SenderAddresses;
+    std::vector<mmsghdr> Headers;
+#endif //__linux__
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::BatchedUdpSocket;
+#endif
@@ -17,6 +17,9 @@ constexpr uint8_t NORMAL_RESPONSE_TYPE = 0x12;
 
 constexpr uint8_t NORMAL_REQUEST_TYPE = 0x28;
 
+//! Request or response message whose data is LZ4 compressed
+constexpr uint8_t COMPRESSED_MESSAGE_TYPE = 0x3C;
+
 
 //! Type of networked application
 enum class NETWORKED_TYPE {
@@ -59,6 +62,16 @@ enum class RECEIVE_GUARANTEE {
     Critical
  };
 
+//! \brief Compression agreed on during the security handshake
+enum class CONNECTION_COMPRESSION {
+
+    //! Messages are sent as is
+    None,
+
+    //! Large messages are LZ4 compressed
+    LZ4
+};
+
 //! \brief State of a connection's encryption
 enum class CONNECTION_ENCRYPTION {
 
@@ -19,6 +19,7 @@
 #include "SFML/Network/IpAddress.hpp"
 #include "SFML/Network/Packet.hpp"
 
+#include "boost/pool/pool_alloc.hpp"
 
 using namespace Leviathan;
 // ------------------------------------ //
@@ -104,6 +105,9 @@ DLLEXPORT bool Connection::Init(NetworkHandler* owninghandler){
     {
         LEVIATHAN_ASSERT(0, "Connection Init cannot send packet");
     }
+
+    // No need to wait for a tick to start connecting //
+    FlushPendingMessages();
     
     return true;
 }
@@ -142,15 +146,19 @@ DLLEXPORT std::shared_ptr<SentRequest> Connection::SendPacketToConnection(
     if(!IsValidForSend() || !request)
         return nullptr;
 
-    // Find acks to send //
-    const auto fullpacketid = ++LastUsedLocalID;
-    auto acks = _GetAcksToSend(fullpacketid);
-    
-    // Generate a packet from the request //
-    auto sentthing = WireData::FormatRequestBytes(request, guarantee,
-        ++LastUsedMessageNumber, fullpacketid, acks.get(), StoredWireData);
+    std::lock_guard<std::mutex> lock(SendMutex);
 
-    _SendPacketToSocket(StoredWireData);
+    const auto messagenumber = ++LastUsedMessageNumber;
+
+    StoredMessageData.clear();
+    WireData::FormatRequestMessage(*request, messagenumber, StoredMessageData);
+
+    const auto fullpacketid = _QueueMessage(messagenumber, StoredMessageData);
+
+    // These are pooled as one is created for every sent request //
+    auto sentthing = std::allocate_shared<SentRequest>(
+        boost::fast_pool_allocator<SentRequest>(), fullpacketid, messagenumber, guarantee,
+        request);
 
     // Add to the sent packets //
     PendingRequests.push_back(sentthing);
@@ -162,16 +170,14 @@ DLLEXPORT bool Connection::SendPacketToConnection(const NetworkResponse &respons
     if(!IsValidForSend())
         return false;
 
-    // Find acks to send //
-    const auto fullpacketid = ++LastUsedLocalID;
-    auto acks = _GetAcksToSend(fullpacketid);
-    
-    // Generate a packet from the request //
-    WireData::FormatResponseBytes(response, ++LastUsedMessageNumber,
-        fullpacketid, acks.get(), StoredWireData);
+    std::lock_guard<std::mutex> lock(SendMutex);
 
-    _SendPacketToSocket(StoredWireData);
+    const auto messagenumber = ++LastUsedMessageNumber;
+
+    StoredMessageData.clear();
+    WireData::FormatResponseMessage(response, messagenumber, StoredMessageData);
 
+    _QueueMessage(messagenumber, StoredMessageData);
     return true;
 }
 
@@ -190,20 +196,52 @@ DLLEXPORT std::shared_ptr<SentResponse> Connection::SendPacketToConnection(
         return nullptr;
     }
 
-    // Find acks to send //
-    const auto fullpacketid = ++LastUsedLocalID;
-    auto acks = _GetAcksToSend(fullpacketid);
-    
-    // Generate a packet from the request //
-    auto sentthing = WireData::FormatResponseBytes(response, guarantee,
-        ++LastUsedMessageNumber, fullpacketid, acks.get(), StoredWireData);
+    std::lock_guard<std::mutex> lock(SendMutex);
 
-    _SendPacketToSocket(StoredWireData);
+    const auto messagenumber = ++LastUsedMessageNumber;
+
+    StoredMessageData.clear();
+    WireData::FormatResponseMessage(*response, messagenumber, StoredMessageData);
+
+    const auto fullpacketid = _QueueMessage(messagenumber, StoredMessageData);
+
+    auto sentthing = std::allocate_shared<SentResponse>(
+        boost::fast_pool_allocator<SentResponse>(), fullpacketid, messagenumber, guarantee,
+        response);
 
     // Add to the sent packets //
     ResponsesNeedingConfirmation.push_back(sentthing);
     return sentthing;
 }
+
+DLLEXPORT std::shared_ptr<SentResponse> Connection::SendPacketToConnection(
+    const std::shared_ptr<NetworkResponse> &response,
+    const std::shared_ptr<const sf::Packet> &serialized, RECEIVE_GUARANTEE guarantee)
+{
+    if(!IsValidForSend() || !response || !serialized)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(SendMutex);
+
+    const auto messagenumber = ++LastUsedMessageNumber;
+
+    StoredMessageData.clear();
+    WireData::FormatResponseMessage(*serialized, messagenumber, StoredMessageData);
+
+    const auto fullpacketid = _QueueMessage(messagenumber, StoredMessageData);
+
+    if(guarantee == RECEIVE_GUARANTEE::None)
+        return nullptr;
+
+    auto sentthing = std::allocate_shared<SentResponse>(
+        boost::fast_pool_allocator<SentResponse>(), fullpacketid, messagenumber, guarantee,
+        response);
+
+    sentthing->SerializedData = serialized;
+
+    ResponsesNeedingConfirmation.push_back(sentthing);
+    return sentthing;
+}
 // ------------------------------------ //
 DLLEXPORT void Connection::SendKeepAlivePacket(){
     
@@ -212,6 +250,9 @@ DLLEXPORT void Connection::SendKeepAlivePacket(){
 
 DLLEXPORT void Connection::SendCloseConnectionPacket(){
 
+    // Messages that are already queued would otherwise be lost //
+    FlushPendingMessages();
+
     State = CONNECTION_STATE::Closed;
 
     SendPacketToConnection(ResponseNone(NETWORK_RESPONSE_TYPE::CloseConnection));
@@ -219,15 +260,12 @@ DLLEXPORT void Connection::SendCloseConnectionPacket(){
 // ------------------------------------ //
 void Connection::_Resend(SentRequest &toresend){
 
-    // Find acks to send //
-    const auto fullpacketid = ++LastUsedLocalID;
-    auto acks = _GetAcksToSend(fullpacketid);
+    StoredMessageData.clear();
+    WireData::FormatRequestMessage(*toresend.SentRequestData, toresend.MessageNumber,
+        StoredMessageData);
 
     // Resend it
-    WireData::FormatRequestBytes(*toresend.SentRequestData, toresend.MessageNumber,
-        fullpacketid, acks.get(), StoredWireData);
-
-    _SendPacketToSocket(StoredWireData);
+    toresend.PacketNumber = _QueueMessage(toresend.MessageNumber, StoredMessageData);
     
     toresend.ResetStartTime();
 
@@ -237,15 +275,21 @@ void Connection::_Resend(SentRequest &toresend){
 
 void Connection::_Resend(SentResponse &toresend){
 
-    // Find acks to send //
-    const auto fullpacketid = ++LastUsedLocalID;
-    auto acks = _GetAcksToSend(fullpacketid);
+    StoredMessageData.clear();
 
-    // Resend it
-    WireData::FormatResponseBytes(*toresend.SentResponseData, toresend.MessageNumber,
-        fullpacketid, acks.get(), StoredWireData);
+    if(toresend.SerializedData){
 
-    _SendPacketToSocket(StoredWireData);
+        WireData::FormatResponseMessage(*toresend.SerializedData, toresend.MessageNumber,
+            StoredMessageData);
+
+    } else {
+
+        WireData::FormatResponseMessage(*toresend.SentResponseData, toresend.MessageNumber,
+            StoredMessageData);
+    }
+
+    // Resend it
+    toresend.PacketNumber = _QueueMessage(toresend.MessageNumber, StoredMessageData);
     
     toresend.ResetStartTime();
 
@@ -259,28 +303,32 @@ DLLEXPORT inline void Connection::HandleRemoteAck(
     if(localidconfirmedassent > LastConfirmedSent)
         LastConfirmedSent = localidconfirmedassent;
 
+    // Multiple responses can be in the same packet //
     for(auto iter = ResponsesNeedingConfirmation.begin();
-        iter != ResponsesNeedingConfirmation.end(); ++iter)
+        iter != ResponsesNeedingConfirmation.end(); )
     {
         if(localidconfirmedassent == (*iter)->PacketNumber){
 
             (*iter)->OnFinalized(true);
 
-            ResponsesNeedingConfirmation.erase(iter);
-            break;
+            iter = ResponsesNeedingConfirmation.erase(iter);
+            
+        } else {
+
+            ++iter;
         }
     }
 
     // Check which ack packets have been received //
     for (auto iter = SentAckPackets.begin(); iter != SentAckPackets.end(); ++iter){
 
-        if(localidconfirmedassent == (*iter)->InsidePacket){
+        if(localidconfirmedassent == iter->InsidePacket){
 
             // Mark as properly sent //
-            (*iter)->Received = true;
+            iter->Received = true;
 
             //! Mark acks as received
-            RemoveSucceededAcks(*(*iter)->AcksInThePacket);
+            RemoveSucceededAcks(iter->AcksInThePacket);
 
             SentAckPackets.erase(iter);
             break;
@@ -362,6 +410,8 @@ DLLEXPORT void Connection::UpdateListening(){
 
     _HandleTimeouts(timems, ResponsesNeedingConfirmation);
 
+    // Send everything queued during this tick, including the resends //
+    FlushPendingMessages();
 
     // Send keep alive packet if it has been a while //
     if(timems > LastSentPacketTime+KEEPALIVE_TIME){
@@ -371,6 +421,7 @@ DLLEXPORT void Connection::UpdateListening(){
         auto response = std::make_shared<ResponseNone>(NETWORK_RESPONSE_TYPE::Keepalive);
         
         SendPacketToConnection(response, RECEIVE_GUARANTEE::Critical);
+        FlushPendingMessages();
         return;
     }
 
@@ -433,12 +484,23 @@ DLLEXPORT void Connection::UpdateListening(){
 
             // Send some acks //
             SendKeepAlivePacket();
+            FlushPendingMessages();
         }
     }
 }
 // ------------------------------------ //
 DLLEXPORT void Connection::HandlePacket(sf::Packet &packet){
 
+    DecodePacket(packet, ReceivedPacketData);
+
+    HandleDecodedPacket(ReceivedPacketData);
+
+    // Don't keep the messages alive until the next packet //
+    ReceivedPacketData.Messages.clear();
+}
+
+DLLEXPORT void Connection::DecodePacket(sf::Packet &packet, DecodedPacket &result){
+
 #ifdef OUTPUT_PACKET_BITS
 
     LOG_WRITE("Received bits: \n" +
@@ -447,95 +509,127 @@ DLLEXPORT void Connection::HandlePacket(sf::Packet &packet){
 
 #endif // OUTPUT_PACKET_BITS    
 
-    // Handle incoming packet //
+    result.Clear();
+
     WireData::DecodeIncomingData(packet,
         [&](NetworkAckField& acks) -> WireData::DECODE_CALLBACK_RESULT
         {
-            SetPacketsReceivedIfNotSet(acks);
+            result.Acks = acks;
             return WireData::DECODE_CALLBACK_RESULT::Continue;
         },
         [&](uint32_t ack) -> void
         {
-            HandleRemoteAck(ack);
+            result.SingleAcks.push_back(ack);
         },
         [&](uint32_t packetnumber) -> WireData::DECODE_CALLBACK_RESULT
         {
-            // Report the packet as received //
-            ReceivedRemotePackets[packetnumber] = RECEIVED_STATE::StateReceived;
-
-            // Update receive time
-            LastReceivedPacketTime = Time::GetTimeMs64();
-
-            // And the state
-            if(State == CONNECTION_STATE::NothingReceived){
-    
-                State = CONNECTION_STATE::Initial;
-            }
-            
+            result.HasPacketNumber = true;
+            result.PacketNumber = packetnumber;
             return WireData::DECODE_CALLBACK_RESULT::Continue;
         },
         [&](uint8_t messagetype, uint32_t messagenumber, sf::Packet &packet)
         -> WireData::DECODE_CALLBACK_RESULT
         {
-            // We can discard this here if this is message is already received //
-            bool alreadyReceived = false;
-            
-            if(_IsAlreadyReceived(messagenumber)){
-                
-                alreadyReceived = true;
-            }
-            
-            switch(messagetype){
-            case NORMAL_RESPONSE_TYPE:
-            {
-                _HandleResponsePacket(packet, 
-                    alreadyReceived);
-                
-                break;
-            }
-            case NORMAL_REQUEST_TYPE:
-            {
-                _HandleRequestPacket(packet, messagenumber, alreadyReceived);
-                break;
-            }
-            default:
-            {
-                LOG_ERROR("Connection: received packet has unknown message type (" +
-                    Convert::ToString(messagetype) + "(some may have been processed already)");
+            DecodedPacket::Message message;
+            message.MessageNumber = messagenumber;
+
+            try{
+                // The original message is decoded from the decompressed data //
+                thread_local sf::Packet decompressed;
+                sf::Packet* messagedata = &packet;
+
+                if(messagetype == COMPRESSED_MESSAGE_TYPE){
+
+                    MessageCompressor::DecompressMessage(packet, messagetype, decompressed);
+                    messagedata = &decompressed;
+                }
+
+                switch(messagetype){
+                case NORMAL_RESPONSE_TYPE:
+                {
+                    message.Response = NetworkResponse::LoadFromPacket(*messagedata);
+
+                    if(!message.Response)
+                        throw InvalidArgument("response is null");
+                    
+                    break;
+                }
+                case NORMAL_REQUEST_TYPE:
+                {
+                    message.Request = NetworkRequest::LoadFromPacket(*messagedata,
+                        messagenumber);
+
+                    if(!message.Request)
+                        throw InvalidArgument("request is null");
+                    
+                    break;
+                }
+                default:
+                {
+                    LOG_ERROR("Connection: received packet has unknown message type (" +
+                        Convert::ToString(messagetype) +
+                        "(some may have been processed already)");
+                    return WireData::DECODE_CALLBACK_RESULT::Error;
+                }
+                }
+            } catch (const InvalidArgument& e){
+
+                LOG_ERROR("Connection: received an invalid message, exception: ");
+                e.PrintToLog();
+
+                // The rest of the packet can't be read after this //
                 return WireData::DECODE_CALLBACK_RESULT::Error;
             }
-            }
 
+            result.Messages.push_back(std::move(message));
             return WireData::DECODE_CALLBACK_RESULT::Continue;
         }
     );
 }
 
-DLLEXPORT void Leviathan::Connection::_HandleResponsePacket(sf::Packet &packet, 
-    bool alreadyreceived) 
-{
-    // Generate a response and pass to the interface //
-    std::shared_ptr<NetworkResponse> response;
-    try {
+DLLEXPORT void Connection::HandleDecodedPacket(DecodedPacket &packet){
 
-        response = NetworkResponse::LoadFromPacket(packet);
+    // Marks things as successfully sent //
+    SetPacketsReceivedIfNotSet(packet.Acks);
 
-        if(!response)
-            throw InvalidArgument("response is null");
+    for(auto ack : packet.SingleAcks)
+        HandleRemoteAck(ack);
 
-    }
-    catch (const InvalidArgument& e){
+    if(packet.HasPacketNumber){
 
-        LOG_ERROR("Connection: received an invalid response packet, exception: ");
-        e.PrintToLog();
-        return;
+        // Report the packet as received //
+        ReceivedRemotePackets[packet.PacketNumber] = RECEIVED_STATE::StateReceived;
+
+        // Update receive time
+        LastReceivedPacketTime = Time::GetTimeMs64();
+
+        // And the state
+        if(State == CONNECTION_STATE::NothingReceived){
+    
+            State = CONNECTION_STATE::Initial;
+        }
     }
 
-    if(alreadyreceived){
+    for(auto& message : packet.Messages){
 
-        return;
+        // We can discard this here if this is message is already received //
+        if(_IsAlreadyReceived(message.MessageNumber))
+            continue;
+
+        if(message.Request){
+
+            _HandleRequest(message.Request);
+            
+        } else {
+
+            _HandleResponse(message.Response);
+        }
     }
+}
 
+DLLEXPORT void Connection::_HandleResponse(
+    const std::shared_ptr<NetworkResponse> &response) 
+{
     // The response might have a corresponding request //
     auto possiblerequest = _GetPossibleRequestForResponse(response);
 
@@ -588,31 +682,9 @@ DLLEXPORT void Leviathan::Connection::_HandleResponsePacket(sf::Packet &packet,
     }
 }
 
-DLLEXPORT void Leviathan::Connection::_HandleRequestPacket(sf::Packet &packet,
-    uint32_t packetnumber, bool alreadyreceived) 
+DLLEXPORT void Connection::_HandleRequest(const std::shared_ptr<NetworkRequest> &request) 
 {
-    // Generate a request object and make the interface handle it //
-    std::shared_ptr<NetworkRequest> request;
-    try {
-
-        request = NetworkRequest::LoadFromPacket(packet, packetnumber);
-
-        if(!request)
-            throw InvalidArgument("request is null");
-
-    }
-    catch (const InvalidArgument& e){
-
-        LOG_ERROR("Connection: received an invalid request packet, exception: ");
-        e.PrintToLog();
-        return;
-    }
-
-    if(alreadyreceived){
-
-        return;
-    }
-
+    // Make the interface handle the request //
     if(_HandleInternalRequest(request))
         return;
 
@@ -680,10 +752,21 @@ DLLEXPORT bool Leviathan::Connection::_HandleInternalRequest(
             return true;
         }
 
+        auto* securityrequest = static_cast<RequestSecurity*>(request.get());
+
+        // Compression is used if both sides allow it //
+        const auto compression = securityrequest->Compression ==
+            CONNECTION_COMPRESSION::LZ4 && Owner->IsMessageCompressionAllowed() ?
+            CONNECTION_COMPRESSION::LZ4 : CONNECTION_COMPRESSION::None;
+
         // Security has been set up for this connection //
         SendPacketToConnection(std::make_shared<ResponseSecurity>(
-                request->GetIDForResponse(), CONNECTION_ENCRYPTION::None),
+                request->GetIDForResponse(), CONNECTION_ENCRYPTION::None, "", "",
+                compression),
             RECEIVE_GUARANTEE::Critical);
+
+        // Compressed messages can be decoded even if they arrive before the response //
+        _SetCompression(compression);
         
         return true;
     }
@@ -752,7 +835,9 @@ DLLEXPORT bool Leviathan::Connection::_HandleInternalResponse(
             if(Owner->GetNetworkType() == NETWORKED_TYPE::Client){
 
                 SendPacketToConnection(std::make_shared<RequestSecurity>(
-                        CONNECTION_ENCRYPTION::None),
+                        CONNECTION_ENCRYPTION::None, "", "",
+                        Owner->IsMessageCompressionAllowed() ?
+                        CONNECTION_COMPRESSION::LZ4 : CONNECTION_COMPRESSION::None),
                     RECEIVE_GUARANTEE::Critical);
             }
         }
@@ -775,6 +860,17 @@ DLLEXPORT bool Leviathan::Connection::_HandleInternalResponse(
             return true;
         }
 
+        if(securityresponse->Compression != CONNECTION_COMPRESSION::None &&
+            !Owner->IsMessageCompressionAllowed())
+        {
+            LOG_ERROR("Connection: server wants to use compression that we didn't ask for, "
+                "disconnecting");
+            SendCloseConnectionPacket();
+            return true;
+        }
+
+        _SetCompression(securityresponse->Compression);
+
         State = CONNECTION_STATE::Secured;
 
         // TODO: send an empty authentication request if this is a master server connection
@@ -817,12 +913,12 @@ DLLEXPORT bool Leviathan::Connection::_HandleInternalResponse(
     return false;
 }
 // ------------------------------------ //
-DLLEXPORT std::shared_ptr<Leviathan::NetworkAckField> Leviathan::Connection::_GetAcksToSend(
-    uint32_t localpacketid, bool autoaddtosent /*= true*/)
+DLLEXPORT bool Leviathan::Connection::_GetAcksToSend(uint32_t localpacketid,
+    NetworkAckField &acks, bool autoaddtosent /*= true*/)
 {
     if(ReceivedRemotePackets.empty()){
 
-        return nullptr;
+        return false;
 
     } else {
 
@@ -870,27 +966,25 @@ DLLEXPORT std::shared_ptr<Leviathan::NetworkAckField> Leviathan::Connection::_Ge
         if(firstselected != 0 && count != 0){
 
             // Create the ack field //
-            auto tmpacks = std::make_shared<SentAcks>(localpacketid,
-                std::make_shared<NetworkAckField>(firstselected, count, 
-                    ReceivedRemotePackets));
+            acks = NetworkAckField(firstselected, count, ReceivedRemotePackets);
 
             // Still skip if there is nothing in it //
-            if(tmpacks->AcksInThePacket->Acks.size() < 1){
+            if(acks.Acks.size() < 1){
                 // It was still empty
                 LOG_WARNING("Generated NetworkAckField was empty even though "
                     "count wasn't zero");
-                return nullptr;
+                return false;
             }
 
             if(autoaddtosent)
-                SentAckPackets.push_back(tmpacks);
+                SentAckPackets.emplace_back(localpacketid, acks);
 
-            return tmpacks->AcksInThePacket;
+            return true;
             
         } else {
 
             // None were found //
-            return nullptr;
+            return false;
         }
     }    
 }
@@ -1102,7 +1196,7 @@ DLLEXPORT std::vector<uint32_t> Connection::GetCurrentlySentAcks(){
 
     for(const auto& acks : SentAckPackets){
 
-        acks->AcksInThePacket->InvokeForEachAck([&](uint32_t id){
+        acks.AcksInThePacket.InvokeForEachAck([&](uint32_t id){
 
                 ids.push_back(id);
             });
@@ -1112,6 +1206,70 @@ DLLEXPORT std::vector<uint32_t> Connection::GetCurrentlySentAcks(){
 }
 
 // ------------------------------------ //
+DLLEXPORT uint32_t Connection::_QueueMessage(uint32_t messagenumber,
+    const sf::Packet &originalmessage)
+{
+    // Large messages are compressed if the other side agreed to it //
+    const bool compressed = Compressor &&
+        Compressor->CompressMessage(originalmessage, CompressedMessageData);
+
+    const sf::Packet &message = compressed ? CompressedMessageData : originalmessage;
+
+    // Send the current packet if this doesn't fit in it //
+    if(!PendingMessageNumbers.empty() &&
+        (PendingMessageNumbers.size() >= MAX_MESSAGES_PER_PACKET ||
+            PendingMessages.getDataSize() + message.getDataSize() >
+            DEFAULT_PACKET_FILL_AMOUNT))
+    {
+        FlushPendingMessages();
+    }
+
+    if(PendingMessageNumbers.empty())
+        PendingPacketID = ++LastUsedLocalID;
+
+    PendingMessageNumbers.push_back(messagenumber);
+    PendingMessages.append(message.getData(), message.getDataSize());
+
+    return PendingPacketID;
+}
+
+void Connection::_SetCompression(CONNECTION_COMPRESSION compression){
+
+    if(compression == CONNECTION_COMPRESSION::None){
+
+        Compressor.reset();
+        return;
+    }
+
+    if(!Compressor)
+        Compressor = std::make_unique<MessageCompressor>();
+}
+
+DLLEXPORT const MessageCompressionStats& Connection::GetCompressionStats() const{
+
+    static const MessageCompressionStats noCompression;
+
+    return Compressor ? Compressor->GetStats() : noCompression;
+}
+
+DLLEXPORT void Connection::FlushPendingMessages(){
+
+    if(PendingMessageNumbers.empty())
+        return;
+
+    // Acks are only generated now so that they are as up to date as possible //
+    NetworkAckField acks;
+    const bool hasAcks = _GetAcksToSend(PendingPacketID, acks);
+
+    WireData::FormatMultiMessagePacket(PendingPacketID, PendingMessageNumbers,
+        hasAcks ? &acks : nullptr, PendingMessages, StoredWireData);
+
+    PendingMessageNumbers.clear();
+    PendingMessages.clear();
+
+    _SendPacketToSocket(StoredWireData);
+}
+
 DLLEXPORT void Leviathan::Connection::_SendPacketToSocket(
     sf::Packet &actualpackettosend)
 {
@@ -1158,7 +1316,7 @@ DLLEXPORT void Leviathan::Connection::_FailPacketAcks(uint32_t packetid){
 
     for (auto iter = SentAckPackets.begin(); iter != SentAckPackets.end(); ++iter){
 
-        if((*iter)->InsidePacket == packetid){
+        if(iter->InsidePacket == packetid){
 
             SentAckPackets.erase(iter);
             return;
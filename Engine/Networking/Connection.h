@@ -5,6 +5,7 @@
 // ------------------------------------ //
 #include "CommonNetwork.h"
 
+#include "MessageCompressor.h"
 #include "NetworkAckField.h"
 
 #include "SFML/Network/IpAddress.hpp"
@@ -13,8 +14,9 @@
 #include "boost/circular_buffer.hpp"
 
 #include <map>
-#include <vector>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace sf{
 class Packet;
@@ -41,6 +43,9 @@ constexpr auto DOUBLE_SEND_FOR_ACK_ONLY = true;
 //! But ipv4 promises that at least 512 byte payload should work
 constexpr auto DEFAULT_PACKET_FILL_AMOUNT = 512;
 
+//! Maximum number of messages in a single packet, limited by the message count field
+constexpr auto MAX_MESSAGES_PER_PACKET = 255;
+
 //! \brief The amount of received message numbers to keep in memory,
 //! these numbers are used to discard duplicates
 //!
@@ -48,6 +53,45 @@ constexpr auto DEFAULT_PACKET_FILL_AMOUNT = 512;
 //! rely on getting a resend if the acks are lost)
 constexpr auto KEEP_IDS_FOR_DISCARD	= 50;
 
+//! \brief The contents of a received packet
+//!
+//! Created by Connection::DecodePacket and applied by Connection::HandleDecodedPacket
+struct DecodedPacket {
+
+    struct Message {
+
+        uint32_t MessageNumber = 0;
+
+        //! Only one of these is set
+        std::shared_ptr<NetworkRequest> Request;
+        std::shared_ptr<NetworkResponse> Response;
+    };
+
+    //! \brief Resets this for decoding another packet
+    //!
+    //! The vectors keep their memory so reusing the same object doesn't allocate
+    void Clear(){
+
+        HasPacketNumber = false;
+        PacketNumber = 0;
+        Acks = NetworkAckField();
+        SingleAcks.clear();
+        Messages.clear();
+    }
+
+    //! False for ack only packets
+    bool HasPacketNumber = false;
+    uint32_t PacketNumber = 0;
+
+    //! The acks in the header of a normal packet. Empty if there were none
+    NetworkAckField Acks;
+
+    //! The acks in an ack only packet
+    std::vector<uint32_t> SingleAcks;
+
+    std::vector<Message> Messages;
+};
+
 //! \brief Fail reason for ConnectionInfo::CalculateNetworkPing
 enum class PING_FAIL_REASON {
     
@@ -100,6 +144,10 @@ enum class CONNECTION_STATE {
 //!
 //! This is not thread safe so only one thread at a time may handle this connection.
 //! this means that all worker threads must use Engine::Invoke to send packets
+//!
+//! Sent messages are queued and packed together into a single packet with one set of
+//! acks. The packet is sent once it is full or when UpdateListening is called, so that all
+//! the messages sent during a tick share as few packets as possible
 //! \note this class does not use reference counting 
 class Connection{
 public:
@@ -137,8 +185,20 @@ public:
     }
 
     //! \brief Handles a packet
+    //!
+    //! Same as calling DecodePacket and HandleDecodedPacket
     DLLEXPORT void HandlePacket(sf::Packet &packet);
 
+    //! \brief Reads the acks and messages from a packet
+    //!
+    //! This doesn't touch any connection so this can be called from any thread.
+    //! Invalid data is logged and the messages before it are kept
+    //! \param result Is cleared before decoding. Reusing the same object avoids allocations
+    DLLEXPORT static void DecodePacket(sf::Packet &packet, DecodedPacket &result);
+
+    //! \brief Applies the acks from a packet and handles its messages
+    DLLEXPORT void HandleDecodedPacket(DecodedPacket &packet);
+
     //! \returns True if this is a connection to a port on localhost
     DLLEXPORT bool IsTargetHostLocalhost();
 
@@ -158,6 +218,36 @@ public:
     DLLEXPORT std::shared_ptr<SentResponse> SendPacketToConnection( 
         const std::shared_ptr<NetworkResponse> &response, RECEIVE_GUARANTEE guarantee);
 
+    //! \brief Sends a response that has already been serialized
+    //!
+    //! Used to send the same response to many connections. Only the message header is
+    //! written for this connection and resends reuse serialized
+    //! \param serialized The data of response from WireData::SerializeResponseData
+    //! \returns nullptr If this connection is closed or guarantee is None
+    DLLEXPORT std::shared_ptr<SentResponse> SendPacketToConnection(
+        const std::shared_ptr<NetworkResponse> &response,
+        const std::shared_ptr<const sf::Packet> &serialized, RECEIVE_GUARANTEE guarantee);
+
+    //! \brief Sends the messages that are waiting for their packet to fill up
+    //!
+    //! This is automatically called by UpdateListening
+    DLLEXPORT void FlushPendingMessages();
+
+    //! \returns The number of messages waiting to be sent
+    inline size_t GetPendingMessageCount() const {
+        return PendingMessageNumbers.size();
+    }
+
+    //! \returns True if large messages sent to this connection are LZ4 compressed
+    //! \see NetworkHandler::SetAllowMessageCompression
+    inline bool IsCompressingMessages() const {
+        return Compressor != nullptr;
+    }
+
+    //! \returns The compression ratio and time spent compressing messages sent to this
+    //! connection. All zeroes if compression isn't used
+    DLLEXPORT const MessageCompressionStats& GetCompressionStats() const;
+
     //! \brief Sends a keep alive packet if enough time has passed
     DLLEXPORT void SendKeepAlivePacket();
 
@@ -199,6 +289,14 @@ public:
         return RawAddress;
     }
 
+    inline const sf::IpAddress& GetTargetHost() const {
+        return TargetHost;
+    }
+
+    inline uint16_t GetTargetPortNumber() const {
+        return TargetPortNumber;
+    }
+
     //! \brief Returns a reference to a list of received packets that haven't been
     //! acknowledged successfully to the other side
     const auto& GetReceivedPackets() const{
@@ -207,12 +305,9 @@ public:
 
 protected:
 
-    //! \param alreadyreceived If true only the message is unpacked and discarded
-    DLLEXPORT void _HandleRequestPacket(sf::Packet &packet, uint32_t messagenumber,
-        bool alreadyreceived);
+    DLLEXPORT void _HandleRequest(const std::shared_ptr<NetworkRequest> &request);
 
-    //! \param alreadyreceived If true only the message is unpacked and discarded
-    DLLEXPORT void _HandleResponsePacket(sf::Packet &packet, bool alreadyreceived);
+    DLLEXPORT void _HandleResponse(const std::shared_ptr<NetworkResponse> &response);
 
     
     //! \brief Sets acks in a packet as properly sent in this
@@ -229,6 +324,19 @@ protected:
     //! \brief Sends actualpackettosend to our Owner's socket
     DLLEXPORT void _SendPacketToSocket(sf::Packet &actualpackettosend);
 
+    //! \brief Adds a message to the packet that is being filled
+    //!
+    //! If the message doesn't fit the previous messages are sent first
+    //! \param originalmessage The message formatted by WireData::FormatRequestMessage or
+    //! WireData::FormatResponseMessage. This is compressed if compression is on and the
+    //! message is large enough
+    //! \returns The id of the packet the message is going to be sent in
+    DLLEXPORT uint32_t _QueueMessage(uint32_t messagenumber,
+        const sf::Packet &originalmessage);
+
+    //! \brief Starts or stops compressing sent messages
+    void _SetCompression(CONNECTION_COMPRESSION compression);
+
 
     //! Marks acks depending on packet to be lost
     DLLEXPORT void _FailPacketAcks(uint32_t packetid);
@@ -247,7 +355,8 @@ protected:
     DLLEXPORT bool _HandleInternalResponse(const std::shared_ptr<NetworkResponse> &response);
 
     //! \brief Sends a message again. Preserves message number but changes packet id
-    //! \todo Create Resend method that pools together many failed messages
+    //!
+    //! The resent messages are packed together with other queued messages
     void _Resend(SentRequest &toresend);
 
     void _Resend(SentResponse &toresend);
@@ -261,9 +370,10 @@ protected:
     std::shared_ptr<SentRequest> _GetPossibleRequestForResponse(
         const std::shared_ptr<NetworkResponse> &response);
 
-    //! \brief Returns acks to be sent with a normal packet, or null if no acks to send
+    //! \brief Fills acks to be sent with a normal packet
     //! \param autoaddtosent If true the generated ack field is added to SentAckPackets
-    DLLEXPORT std::shared_ptr<NetworkAckField> _GetAcksToSend(uint32_t localpacketid,
+    //! \returns False if there are no acks to send
+    DLLEXPORT bool _GetAcksToSend(uint32_t localpacketid, NetworkAckField &acks,
         bool autoaddtosent = true);
 
     //! \brief Marks a remote id as received
@@ -324,7 +434,7 @@ protected:
     //! Holds sent ack groups until they are considered lost or
     //! received and then is used to mark the packets received by the
     //! other side as successfully sent
-    std::vector<std::shared_ptr<SentAcks>> SentAckPackets;
+    std::vector<SentAcks> SentAckPackets;
 
     //! Numbers of messages that have been received before, used to skip processing duplicates
     //! \todo Implement a lower bound (under which everything is dropped) and make this smaller
@@ -354,6 +464,31 @@ private:
     //! around to not need to allocate memory again for each sent
     //! packet
     sf::Packet StoredWireData;
+
+    //! Used to format a single message before it is queued
+    sf::Packet StoredMessageData;
+
+    //! Locked by SendPacketToConnection so that GameWorlds ticking in parallel can send to
+    //! the same connection. Everything else is only used by the main thread which doesn't
+    //! run at the same time as the world ticks
+    std::mutex SendMutex;
+
+    //! The messages waiting to be sent in the packet with PendingPacketID
+    sf::Packet PendingMessages;
+    std::vector<uint32_t> PendingMessageNumbers;
+
+    //! Id of the packet that is being filled, only valid if PendingMessageNumbers isn't
+    //! empty
+    uint32_t PendingPacketID = 0;
+
+    //! Reused by HandlePacket so that the decoded data doesn't need new memory each time
+    DecodedPacket ReceivedPacketData;
+
+    //! Compresses queued messages, created when both sides agree to use compression
+    std::unique_ptr<MessageCompressor> Compressor;
+
+    //! Holds a message compressed by Compressor before it is queued
+    sf::Packet CompressedMessageData;
 };
 
 }
@@ -20,6 +20,8 @@ thingsToGenerate = [
      Variable.new("SecureType", "CONNECTION_ENCRYPTION", serializeas: "int32_t", ),
      Variable.new("PublicKey", "std::string", default: ""),
      Variable.new("AdditionalSettings", "std::string", default: ""),
+     Variable.new("Compression", "CONNECTION_COMPRESSION", serializeas: "int32_t",
+                  default: "CONNECTION_COMPRESSION::None"),
    ]],
   
   ["Authenticate",
@@ -0,0 +1,102 @@
+// ------------------------------------ //
+#include "MessageCompressor.h"
+
+#include "CommonNetwork.h"
+#include "Exceptions.h"
+#include "TimeIncludes.h"
+
+#include "lz4/lz4.h"
+
+using namespace Leviathan;
+// ------------------------------------ //
+//! Type and number at the start of every message
+constexpr size_t MESSAGE_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+
+//! Original type, data size and compressed size that compressed messages have in addition
+constexpr size_t COMPRESSED_HEADER_EXTRA = sizeof(uint8_t) + 2 * sizeof(uint32_t);
+
+DLLEXPORT MessageCompressor::MessageCompressor(size_t threshold) :
+    Threshold(threshold),
+    CompressionState((LZ4_sizeofState() + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+{
+}
+// ------------------------------------ //
+DLLEXPORT bool MessageCompressor::CompressMessage(
+    const sf::Packet& message, sf::Packet& result)
+{
+    if(message.getDataSize() < MESSAGE_HEADER_SIZE + Threshold)
+        return false;
+
+    const auto datasize = message.getDataSize() - MESSAGE_HEADER_SIZE;
+
+    // The other side would refuse to decompress this //
+    if(datasize > MAX_DECOMPRESSED_MESSAGE_SIZE || datasize <= COMPRESSED_HEADER_EXTRA)
+        return false;
+
+    const auto* bytes = static_cast<const char*>(message.getData());
+
+    const auto start = Time::GetTimeMicro64();
+
+    // Compression stops if the result wouldn't be smaller than the original message //
+    const auto maxsize = datasize - COMPRESSED_HEADER_EXTRA - 1;
+    CompressedData.resize(maxsize);
+
+    const int compressedsize = LZ4_compress_limitedOutput_withState(CompressionState.data(),
+        bytes + MESSAGE_HEADER_SIZE, CompressedData.data(), static_cast<int>(datasize),
+        static_cast<int>(maxsize));
+
+    Stats.CompressionMicroseconds += Time::GetTimeMicro64() - start;
+
+    if(compressedsize <= 0) {
+
+        ++Stats.IncompressibleMessages;
+        return false;
+    }
+
+    ++Stats.CompressedMessages;
+    Stats.UncompressedBytes += datasize;
+    Stats.CompressedBytes += compressedsize;
+
+    result.clear();
+    result << COMPRESSED_MESSAGE_TYPE;
+
+    // The message number is copied as is //
+    result.append(bytes + sizeof(uint8_t), sizeof(uint32_t));
+
+    result << static_cast<uint8_t>(bytes[0]) << static_cast<uint32_t>(datasize)
+           << static_cast<uint32_t>(compressedsize);
+
+    result.append(CompressedData.data(), compressedsize);
+    return true;
+}
+// ------------------------------------ //
+DLLEXPORT void MessageCompressor::DecompressMessage(
+    sf::Packet& packet, uint8_t& originaltype, sf::Packet& decompressed)
+{
+    thread_local std::string compressed;
+    thread_local std::vector<char> buffer;
+
+    uint32_t datasize = 0;
+    packet >> originaltype >> datasize;
+
+    // The compressed size and data are laid out like a string so they can be read without
+    // knowing where the packet is being read
+    packet >> compressed;
+
+    if(!packet)
+        throw InvalidArgument("compressed message ended before its data");
+
+    if(datasize > MAX_DECOMPRESSED_MESSAGE_SIZE)
+        throw InvalidArgument("compressed message is too large");
+
+    buffer.resize(datasize);
+
+    const int result = LZ4_decompress_safe(compressed.data(), buffer.data(),
+        static_cast<int>(compressed.size()), static_cast<int>(datasize));
+
+    if(result < 0 || static_cast<uint32_t>(result) != datasize)
+        throw InvalidArgument("compressed message has invalid data");
+
+    decompressed.clear();
+    decompressed.append(buffer.data(), datasize);
+}
@@ -0,0 +1,107 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "SFML/Network/Packet.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Leviathan {
+
+//! Messages with less data than this aren't worth compressing
+constexpr auto DEFAULT_MESSAGE_COMPRESSION_THRESHOLD = 256;
+
+//! Decompressed messages can't be larger than this. Protects against packets that claim a
+//! huge size
+constexpr auto MAX_DECOMPRESSED_MESSAGE_SIZE = 1024 * 1024;
+
+//! \brief How much compression has helped on a connection
+struct MessageCompressionStats {
+
+    //! \returns Original size divided by compressed size of the compressed messages
+    inline float GetCompressionRatio() const
+    {
+        if(CompressedBytes == 0)
+            return 1.f;
+
+        return static_cast<float>(UncompressedBytes) / CompressedBytes;
+    }
+
+    //! \returns Average time spent compressing a message, including the ones that didn't
+    //! get smaller
+    inline float GetMicrosecondsPerMessage() const
+    {
+        const auto attempts = CompressedMessages + IncompressibleMessages;
+
+        if(attempts == 0)
+            return 0.f;
+
+        return static_cast<float>(CompressionMicroseconds) / attempts;
+    }
+
+    uint64_t CompressedMessages = 0;
+
+    //! Messages over the threshold that compression didn't make smaller
+    uint64_t IncompressibleMessages = 0;
+
+    //! Size of the data of the compressed messages before and after compression
+    uint64_t UncompressedBytes = 0;
+    uint64_t CompressedBytes = 0;
+
+    int64_t CompressionMicroseconds = 0;
+};
+
+//! \brief LZ4 compresses large messages of a connection
+//!
+//! Each message is compressed as its own block so that messages can be decompressed in
+//! any order and on any thread. Lost and reordered UDP packets would break a dictionary
+//! shared between messages. The compression tables and the output buffer are kept here to
+//! not allocate them for each message
+//! \see \ref message_compressed_packet_table "Compressed Message Format"
+class MessageCompressor {
+public:
+    DLLEXPORT MessageCompressor(size_t threshold = DEFAULT_MESSAGE_COMPRESSION_THRESHOLD);
+
+    //! \brief Compresses a message formatted with WireData::FormatRequestMessage or
+    //! WireData::FormatResponseMessage
+    //! \param result Filled with the compressed message. Cleared first
+    //! \returns False if the message is too small or didn't get smaller. message should be
+    //! sent as is in that case
+    DLLEXPORT bool CompressMessage(const sf::Packet& message, sf::Packet& result);
+
+    //! \brief Decompresses a message after its type and number have been read
+    //! \param originaltype Set to the type of the message before it was compressed
+    //! \param decompressed Filled with the data of the original message. Cleared first
+    //! \exception InvalidArgument if the data is invalid
+    //! \note Uses thread local buffers so this can be called from any thread
+    DLLEXPORT static void DecompressMessage(
+        sf::Packet& packet, uint8_t& originaltype, sf::Packet& decompressed);
+
+    inline const MessageCompressionStats& GetStats() const
+    {
+        return Stats;
+    }
+
+    inline size_t GetThreshold() const
+    {
+        return Threshold;
+    }
+
+private:
+    const size_t Threshold;
+
+    //! LZ4 needs the compression tables to be 4 byte aligned
+    std::vector<uint32_t> CompressionState;
+
+    std::vector<char> CompressedData;
+
+    MessageCompressionStats Stats;
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::MessageCompressor;
+#endif
@@ -92,10 +92,14 @@ DLLEXPORT NetworkAckField::NetworkAckField(sf::Packet &packet){
         return;
     
     // Fill in the acks from the packet //
-    Acks.resize(tmpsize);
-    
-    for(char i = 0; i < tmpsize; i++){
-        packet >> Acks[i];
+    for(uint8_t i = 0; i < tmpsize; i++){
+
+        uint8_t ackbyte = 0;
+        packet >> ackbyte;
+
+        // We never send this many, so the extra ones can be ignored //
+        if(Acks.size() < Acks.capacity())
+            Acks.push_back(ackbyte);
     }
 }
 // ------------------------------------ //
@@ -115,18 +119,3 @@ DLLEXPORT void NetworkAckField::AddDataToPacket(sf::Packet &packet) const{
         packet << Acks[i];
     }
 }
-
-DLLEXPORT void NetworkAckField::InvokeForEachAck(std::function<void (uint32_t)> func) const{
-
-    for(size_t i = 0; i < Acks.size(); ++i){
-
-        for(uint8_t bit = 0; bit < 8; ++bit){
-        
-            const auto id = (i * 8) + bit + FirstPacketID;
-
-            if(Acks[i] & (1 << bit))
-                func(id);
-        }
-    }
-}
-
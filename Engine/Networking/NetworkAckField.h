@@ -4,10 +4,10 @@
 #include "Define.h"
 // ------------------------------------ //
 
+#include "boost/container/static_vector.hpp"
+#include "boost/pool/pool_alloc.hpp"
+
 #include <map>
-#include <vector>
-#include <functional>
-#include <memory>
 
 namespace sf{
 class Packet;
@@ -36,10 +36,23 @@ enum class RECEIVED_STATE{
     ReceivedAckSucceeded
 };
 
+//! \brief Maximum number of bytes in a NetworkAckField
+//!
+//! The field is created with at most 255 acks so this is enough to hold all of them
+constexpr auto MAX_ACK_FIELD_BYTES = 32;
+
+//! \brief A group of acks starting from FirstPacketID
+//!
+//! The acks are stored inline so creating and decoding these doesn't allocate memory
 class NetworkAckField{
 public:
 
-    using PacketReceiveStatus = std::map<uint32_t, RECEIVED_STATE>;
+    //! The nodes are allocated from a pool as one is inserted for every received packet
+    using PacketReceiveStatus = std::map<uint32_t, RECEIVED_STATE, std::less<uint32_t>,
+        boost::fast_pool_allocator<std::pair<const uint32_t, RECEIVED_STATE>>>;
+
+    //! \brief Creates an empty field
+    NetworkAckField() = default;
 
     //! \brief Copies acts from copyfrom starting with the number firstpacketid
     //!
@@ -47,6 +60,8 @@ public:
     DLLEXPORT NetworkAckField(uint32_t firstpacketid, uint8_t maxacks,
         PacketReceiveStatus &copyfrom);
 
+    //! \brief Loads a field from a packet
+    //! \note Bytes past MAX_ACK_FIELD_BYTES are skipped
     DLLEXPORT NetworkAckField(sf::Packet &packet);
 
     
@@ -65,25 +80,36 @@ public:
     }
 
     //! \brief Calls func with each set ack
-    DLLEXPORT void InvokeForEachAck(std::function<void (uint32_t)> func) const;
+    template<class CallbackT>
+    void InvokeForEachAck(const CallbackT &func) const{
+
+        for(size_t i = 0; i < Acks.size(); ++i){
+
+            for(uint8_t bit = 0; bit < 8; ++bit){
+
+                if(Acks[i] & (1 << bit))
+                    func(static_cast<uint32_t>((i * 8) + bit + FirstPacketID));
+            }
+        }
+    }
 
     // Data //
-    uint32_t FirstPacketID;
-    std::vector<uint8_t> Acks;
+    uint32_t FirstPacketID = 0;
+    boost::container::static_vector<uint8_t, MAX_ACK_FIELD_BYTES> Acks;
 };
 
 
 //! \brief Holds sent ack packets in order to mark the acks as properly sent
 struct SentAcks{
 
-    SentAcks(uint32_t localpacketid, std::shared_ptr<NetworkAckField> acks) :
+    SentAcks(uint32_t localpacketid, const NetworkAckField &acks) :
         InsidePacket(localpacketid), AcksInThePacket(acks)
     {}
 
     //! The packet (SentNetworkThing) in which these acks were sent //
     uint32_t InsidePacket;
 
-    std::shared_ptr<NetworkAckField> AcksInThePacket;
+    NetworkAckField AcksInThePacket;
         
     //! Marks when the remote host tells us that any packet in which
     //! bunch is in is received
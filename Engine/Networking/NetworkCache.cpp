@@ -5,6 +5,7 @@
 #include "Networking/NetworkResponse.h"
 #include "Threading/ThreadingManager.h"
 #include "Networking/Connection.h"
+#include "Networking/WireData.h"
 using namespace Leviathan;
 // ------------------------------------ //
 DLLEXPORT NetworkCache::NetworkCache(NETWORKED_TYPE serverside) : 
@@ -174,10 +175,16 @@ void Leviathan::NetworkCache::_OnVariableUpdated(Lock &guard,
 {
     auto& connections = Owner->GetInterface()->GetClientConnections();
 
+    if(connections.empty())
+        return;
+
+    // All the connections share the same serialized data //
+    const auto response = std::make_shared<ResponseCacheUpdated>(0, variable);
+    const auto serialized = WireData::SerializeResponseData(*response);
+
     for (auto& connection : connections) {
 
-        connection->SendPacketToConnection(std::make_shared<ResponseCacheUpdated>(0, variable),
-            RECEIVE_GUARANTEE::Critical);
+        connection->SendPacketToConnection(response, serialized, RECEIVE_GUARANTEE::Critical);
     }
 }
 // ------------------------------------ //
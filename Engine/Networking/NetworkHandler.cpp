@@ -103,6 +103,23 @@ DLLEXPORT bool Leviathan::NetworkHandler::Init(const MasterServerInformation &in
         PortNumber = (unsigned short)tmpport;
     }
 
+    {
+        GAMECONFIGURATION_GET_VARIABLEACCESS(vars);
+
+        int decodethreads = 0;
+
+        if(vars->GetValueAndConvertTo<int>("PacketDecodeThreads", decodethreads) &&
+            decodethreads > 0)
+        {
+            SetPacketDecodeThreads(static_cast<size_t>(decodethreads));
+        }
+
+        bool compress = false;
+
+        if(vars->GetValueAndConvertTo<bool>("CompressNetworkMessages", compress))
+            SetAllowMessageCompression(compress);
+    }
+
     // We want to receive responses //
     if(_Socket.bind(PortNumber) != sf::Socket::Done){
 
@@ -155,6 +172,9 @@ DLLEXPORT void Leviathan::NetworkHandler::Release() {
 
         CloseMasterServerConnection = true;
 
+        // Stop decoding before the connections are closed //
+        PacketDecoder.reset();
+
         // Kill master server connection //
 
         // Notify master server connection kill //
@@ -170,6 +190,7 @@ DLLEXPORT void Leviathan::NetworkHandler::Release() {
         }
 
         OpenConnections.clear();
+        ConnectionsByAddress.clear();
         
 
     }
@@ -219,22 +240,20 @@ void Leviathan::NetworkHandler::_ReleaseSocket(){
 
 bool Leviathan::NetworkHandler::_RunUpdateOnce(Lock &guard)
 {
-    sf::Packet receivedpacket;
-
-    sf::IpAddress sender;
-    unsigned short sentport;
-
-    RemoteConsole* rcon = Engine::Get()->GetRemoteConsole();
+    if(ReceivedDatagrams.empty())
+        ReceivedDatagrams.resize(NETWORK_RECEIVE_BATCH_SIZE);
 
     sf::Socket::Status status;
 
     while (true) {
 
+        size_t count = 0;
+
         guard.unlock();
 
         {
             auto lock = LockSocketForUse();
-            status = _Socket.receive(receivedpacket, sender, sentport);
+            status = _Socket.ReceiveBatch(ReceivedDatagrams, count);
         }
 
         guard.lock();
@@ -242,85 +261,118 @@ bool Leviathan::NetworkHandler::_RunUpdateOnce(Lock &guard)
         if(status != sf::Socket::Done)
             break;
 
-        // Process packet //
+        // Find the connections while locked //
+        ReceivedDatagramTargets.clear();
+
+        for(size_t i = 0; i < count; ++i){
 
-        // Pass to a connection //
-        bool Passed = false;
+            const auto& datagram = ReceivedDatagrams[i];
 
+            ReceivedDatagramTargets.push_back(_GetConnectionForPacket(guard, datagram.Sender,
+                    datagram.SenderPort));
+        }
+
+        const auto decoder = PacketDecoder;
 
-        for (size_t i = 0; i < OpenConnections.size(); i++) {
-            // Keep passing until somebody handles it //
-            if(OpenConnections[i]->IsThisYours(sender, sentport)) {
+        // And handle the packets without the lock to prevent deadlocks
+        // TODO: make NetworkHandler only usable by the main thread
+        guard.unlock();
 
-                auto curconnection = OpenConnections[i];
+        for(size_t i = 0; i < count; ++i){
+
+            if(!ReceivedDatagramTargets[i])
+                continue;
 
-                // Prevent deaclocks, TODO: make NetworkHandler only usable by the main thread
-                guard.unlock();
-                curconnection->HandlePacket(receivedpacket);
-                guard.lock();                
+            if(decoder){
 
-                Passed = true;
-                break;
+                decoder->QueuePacket(ReceivedDatagramTargets[i],
+                    ReceivedDatagrams[i].Data);
+                
+            } else {
+                
+                ReceivedDatagramTargets[i]->HandlePacket(ReceivedDatagrams[i].Data);
             }
         }
 
-        if(Passed)
-            continue;
+        guard.lock();
 
-        shared_ptr<Connection> tmpconnect;
+        // Don't keep closed connections alive //
+        ReceivedDatagramTargets.clear();
+    }
 
-        // TODO: Check is it a close or a keep alive packet //
+    return (status != sf::Socket::Error) && (status != sf::Socket::Disconnected);
+}
 
-        // We might want to open a new connection to this client //
-        Logger::Get()->Info("Received a new connection from " + sender.toString() + ":" +
-            Convert::ToString(sentport));
+std::shared_ptr<Connection> NetworkHandler::_GetConnectionForPacket(Lock &guard,
+    const sf::IpAddress &sender, unsigned short sentport)
+{
+    const auto found = ConnectionsByAddress.find(_GetAddressKey(sender, sentport));
 
-        // \todo Make sure that the console won't be deleted between this and the actual check
+    if(found != ConnectionsByAddress.end())
+        return found->second;
 
-        if(AppType != NETWORKED_TYPE::Client) {
-            // Accept the connection //
-            LOG_WRITE("\t> Connection accepted");
+    shared_ptr<Connection> tmpconnect;
 
-            tmpconnect = OpenConnectionTo(guard, sender, sentport);
+    // TODO: Check is it a close or a keep alive packet //
 
-        } else if(rcon && rcon->IsAwaitingConnections()) {
+    // We might want to open a new connection to this client //
+    Logger::Get()->Info("Received a new connection from " + sender.toString() + ":" +
+        Convert::ToString(sentport));
 
-            // We might allow a remote start remote console session //
-            LOG_WRITE("\t> Connection accepted for remote console receive");
+    // \todo Make sure that the console won't be deleted between this and the actual check
+    RemoteConsole* rcon = Engine::Get()->GetRemoteConsole();
 
-            tmpconnect = OpenConnectionTo(guard, sender, sentport);
+    if(AppType != NETWORKED_TYPE::Client) {
+        // Accept the connection //
+        LOG_WRITE("\t> Connection accepted");
 
-            // We need a special restriction for this connection //
-            if(tmpconnect)
-                tmpconnect->SetRestrictionMode(CONNECTION_RESTRICTION::ReceiveRemoteConsole);
+        tmpconnect = OpenConnectionTo(guard, sender, sentport);
 
-        } else {
-            // Deny the connection //
-            LOG_WRITE("\t> Dropping connection due to not being a server "
-                "(and not expecting anything)");
-            continue;
-        }
+    } else if(rcon && rcon->IsAwaitingConnections()) {
 
-        if(!tmpconnect) {
+        // We might allow a remote start remote console session //
+        LOG_WRITE("\t> Connection accepted for remote console receive");
 
-            LOG_WRITE("\t> Failed to create connection object");
-            continue;
-        }
+        tmpconnect = OpenConnectionTo(guard, sender, sentport);
 
-        // Try to handle the packet //
-        if(!tmpconnect->IsThisYours(sender, sentport)) {
-            // That's an error //
-            Logger::Get()->Error("NetworkHandler: UpdateAllConnections: new connection "
-                "refused to process its packet from " + sender.toString() + ":" +
-                Convert::ToString(sentport));
-            CloseConnection(*tmpconnect);
-        } else {
+        // We need a special restriction for this connection //
+        if(tmpconnect)
+            tmpconnect->SetRestrictionMode(CONNECTION_RESTRICTION::ReceiveRemoteConsole);
 
-            tmpconnect->HandlePacket(receivedpacket);
-        }
+    } else {
+        // Deny the connection //
+        LOG_WRITE("\t> Dropping connection due to not being a server "
+            "(and not expecting anything)");
+        return nullptr;
     }
 
-    return (status != sf::Socket::Error) && (status != sf::Socket::Disconnected);
+    if(!tmpconnect) {
+
+        LOG_WRITE("\t> Failed to create connection object");
+        return nullptr;
+    }
+
+    // Try to handle the packet //
+    if(!tmpconnect->IsThisYours(sender, sentport)) {
+        // That's an error //
+        Logger::Get()->Error("NetworkHandler: UpdateAllConnections: new connection "
+            "refused to process its packet from " + sender.toString() + ":" +
+            Convert::ToString(sentport));
+        CloseConnection(*tmpconnect);
+        return nullptr;
+    }
+
+    return tmpconnect;
+}
+
+void NetworkHandler::_AddOpenConnection(Lock &guard,
+    const std::shared_ptr<Connection> &connection)
+{
+    OpenConnections.push_back(connection);
+
+    // The first connection to an address receives the packets //
+    ConnectionsByAddress.emplace(_GetAddressKey(connection->GetTargetHost(),
+            connection->GetTargetPortNumber()), connection);
 }
 // ------------------------------------ //
 DLLEXPORT std::shared_ptr<std::promise<string>> Leviathan::NetworkHandler::QueryMasterServer(
@@ -452,7 +504,7 @@ DLLEXPORT void Leviathan::NetworkHandler::_RegisterConnection(
 
     GUARD_LOCK();
 
-    OpenConnections.push_back(connection);
+    _AddOpenConnection(guard, connection);
 }
 
 // ------------------------------------ //
@@ -474,6 +526,16 @@ DLLEXPORT void Leviathan::NetworkHandler::UpdateAllConnections(){
             _RunUpdateOnce(guard);
         }
 
+        // Handle the packets decoded by the decode threads //
+        if(PacketDecoder){
+
+            const auto decoder = PacketDecoder;
+
+            guard.unlock();
+            decoder->HandleDecodedPackets();
+            guard.lock();
+        }
+
         // Time-out requests //
         for (auto& connection : OpenConnections) {
 
@@ -485,6 +547,22 @@ DLLEXPORT void Leviathan::NetworkHandler::UpdateAllConnections(){
     GetInterface()->TickIt();
 }
 // ------------------------------------ //
+DLLEXPORT void NetworkHandler::SetPacketDecodeThreads(size_t threadcount){
+
+    GUARD_LOCK();
+
+    if(threadcount == 0){
+
+        PacketDecoder.reset();
+        return;
+    }
+
+    if(PacketDecoder && PacketDecoder->GetShardCount() == threadcount)
+        return;
+
+    PacketDecoder = std::make_shared<ShardedPacketDecoder>(threadcount);
+}
+// ------------------------------------ //
 Lock Leviathan::NetworkHandler::LockSocketForUse(){
     
     return Lock((SocketMutex));
@@ -532,6 +610,28 @@ DLLEXPORT void Leviathan::NetworkHandler::RemoveClosedConnections(Lock &guard)
 
             auto& connection = OpenConnections[a];
 
+            // Release clears the address so this needs to be done first //
+            const auto key = _GetAddressKey(connection->GetTargetHost(),
+                connection->GetTargetPortNumber());
+
+            const auto mapped = ConnectionsByAddress.find(key);
+
+            if(mapped != ConnectionsByAddress.end() && mapped->second == connection){
+
+                ConnectionsByAddress.erase(mapped);
+
+                // Another connection to the same address takes over //
+                for(const auto& other : OpenConnections){
+
+                    if(other != connection && other->IsThisYours(
+                            connection->GetTargetHost(), connection->GetTargetPortNumber()))
+                    {
+                        ConnectionsByAddress.emplace(key, other);
+                        break;
+                    }
+                }
+            }
+
             // Send a close packet //
             connection->SendCloseConnectionPacket();
 
@@ -589,7 +689,7 @@ DLLEXPORT std::shared_ptr<Connection> Leviathan::NetworkHandler::OpenConnectionT
         return nullptr;
     }
 
-    OpenConnections.push_back(newconnection);
+    _AddOpenConnection(guard, newconnection);
 
     return newconnection;
 }
@@ -598,11 +698,10 @@ DLLEXPORT std::shared_ptr<Leviathan::Connection> Leviathan::NetworkHandler::Open
     Lock &guard, const sf::IpAddress &targetaddress, unsigned short port) 
 {
     // Find existing one //
-    for (auto& connection : OpenConnections) {
+    const auto found = ConnectionsByAddress.find(_GetAddressKey(targetaddress, port));
 
-        if(connection->IsThisYours(targetaddress, port))
-            return connection;
-    }
+    if(found != ConnectionsByAddress.end())
+        return found->second;
 
     // Create new //
     auto newconnection = std::make_shared<Connection>(targetaddress, port);
@@ -613,7 +712,7 @@ DLLEXPORT std::shared_ptr<Leviathan::Connection> Leviathan::NetworkHandler::Open
         return nullptr;
     }
 
-    OpenConnections.push_back(newconnection);
+    _AddOpenConnection(guard, newconnection);
 
     return newconnection;
 }
@@ -10,7 +10,9 @@
 #include "MasterServerInfo.h"
 #include "CommonNetwork.h"
 
+#include "BatchedUdpSocket.h"
 #include "Connection.h"
+#include "ShardedPacketDecoder.h"
 
 
 #include "Common/ThreadSafe.h"
@@ -18,8 +20,9 @@
 #include "SFML/Network/UdpSocket.hpp"
 
 #include <future>
-#include <thread>
 #include <memory>
+#include <thread>
+#include <unordered_map>
 
 namespace Leviathan{
 
@@ -53,6 +56,30 @@ public:
 
     DLLEXPORT virtual void RemoveClosedConnections(Lock &guard);
 
+    //! \brief Makes received packets be decoded on threadcount worker threads
+    //!
+    //! The decoded messages are still handled on the thread that calls
+    //! UpdateAllConnections. 0 disables the threads and packets are handled as soon as they
+    //! are received. This is also set from the PacketDecodeThreads configuration variable
+    //! \note Packets that are being decoded while this is changed are lost
+    DLLEXPORT void SetPacketDecodeThreads(size_t threadcount);
+
+    //! \brief Allows connections to LZ4 compress large messages
+    //!
+    //! A connection uses compression only if both sides allow it. It is agreed on in the
+    //! security handshake so this needs to be set before connections are opened. This is
+    //! also set from the CompressNetworkMessages configuration variable
+    //! \see Connection::GetCompressionStats
+    inline void SetAllowMessageCompression(bool allow){
+
+        AllowMessageCompression = allow;
+    }
+
+    inline bool IsMessageCompressionAllowed() const{
+
+        return AllowMessageCompression;
+    }
+
     DLLEXPORT std::shared_ptr<std::promise<std::string>> QueryMasterServer(
         const MasterServerInformation &info);
 
@@ -170,8 +197,26 @@ protected:
     // Closes the socket //
     void _ReleaseSocket();
 
-    //! \brief Returns false if the socket has been closed
+    //! \brief Receives a batch of packets and passes them to the connections
+    //!
+    //! The lock is only held while finding the connections, the packets are handled
+    //! without it
+    //! \returns False if the socket has been closed
     bool _RunUpdateOnce(Lock &guard);
+
+    //! \brief Finds the connection for a received packet or opens a new one
+    //! \returns Null if the packet should be dropped
+    std::shared_ptr<Connection> _GetConnectionForPacket(Lock &guard,
+        const sf::IpAddress &sender, unsigned short sentport);
+
+    //! \brief Adds a connection to OpenConnections and ConnectionsByAddress
+    void _AddOpenConnection(Lock &guard, const std::shared_ptr<Connection> &connection);
+
+    //! \returns The key a connection to address and port has in ConnectionsByAddress
+    static inline uint64_t _GetAddressKey(const sf::IpAddress &address, unsigned short port){
+
+        return (static_cast<uint64_t>(address.toInteger()) << 16) | port;
+    }
     
     //! \brief Constantly listens for packets in a blocked state
     void _RunListenerThread();
@@ -189,6 +234,9 @@ protected:
     
     std::vector<std::shared_ptr<Connection>> OpenConnections;
 
+    //! Used to find the connection a received packet belongs to
+    std::unordered_map<uint64_t, std::shared_ptr<Connection>> ConnectionsByAddress;
+
     //! Type of application
     NETWORKED_TYPE AppType;
 
@@ -196,7 +244,18 @@ protected:
     NetworkClientInterface* ClientInterface = nullptr;
 
     //! Main socket for listening for incoming packets and sending
-    sf::UdpSocket _Socket;
+    BatchedUdpSocket _Socket;
+
+    //! Decodes the received packets if multithreaded decoding is enabled. This is shared
+    //! so that it can't be destroyed while the receive thread is using it
+    std::shared_ptr<ShardedPacketDecoder> PacketDecoder;
+
+    //! Reused by _RunUpdateOnce for receiving
+    std::vector<BatchedUdpSocket::ReceivedDatagram> ReceivedDatagrams;
+
+    //! Offered to connections in the security handshake
+    bool AllowMessageCompression = false;
+    std::vector<std::shared_ptr<Connection>> ReceivedDatagramTargets;
     //! Used to control the locking of the socket
     Mutex SocketMutex;
 
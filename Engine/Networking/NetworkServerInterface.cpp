@@ -10,6 +10,7 @@
 #include "../TimeIncludes.h"
 #include "NetworkInterface.h"
 #include "NetworkHandler.h"
+#include "WireData.h"
 using namespace Leviathan;
 // ------------------------------------ //
 DLLEXPORT NetworkServerInterface::NetworkServerInterface(
@@ -373,14 +374,20 @@ DLLEXPORT void NetworkServerInterface::SendToAllButOnePlayer(
     const std::shared_ptr<NetworkResponse> &response,
     Connection* skipme, RECEIVE_GUARANTEE guarantee)
 {
- // Loop the players and send to their connections //
+    // The response is only serialized once for all the players //
+    std::shared_ptr<const sf::Packet> serialized;
+
+    // Loop the players and send to their connections //
     for(auto iter = ServerPlayers.begin(); iter != ServerPlayers.end(); ++iter){
 
         Connection* curconnection = (*iter)->GetConnection().get();
 
         if(curconnection != skipme){
 
-            curconnection->SendPacketToConnection(response, guarantee);
+            if(!serialized)
+                serialized = WireData::SerializeResponseData(*response);
+
+            curconnection->SendPacketToConnection(response, serialized, guarantee);
         }
     }
 }
@@ -388,10 +395,16 @@ DLLEXPORT void NetworkServerInterface::SendToAllButOnePlayer(
 DLLEXPORT void NetworkServerInterface::SendToAllPlayers(
     const std::shared_ptr<NetworkResponse> &response, RECEIVE_GUARANTEE guarantee)
 {
+    if(ServerPlayers.empty())
+        return;
+
+    // The response is only serialized once for all the players //
+    const auto serialized = WireData::SerializeResponseData(*response);
+
     // Loop the players and send to their connections //
     for(auto iter = ServerPlayers.begin(); iter != ServerPlayers.end(); ++iter){
 
-        (*iter)->GetConnection()->SendPacketToConnection(response, guarantee);
+        (*iter)->GetConnection()->SendPacketToConnection(response, serialized, guarantee);
     }
 }
 // ------------------------------------ //
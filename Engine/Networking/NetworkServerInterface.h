@@ -80,6 +80,7 @@ public:
         Connection* skipme, RECEIVE_GUARANTEE guarantee);
 
     //! \brief Sends a response packet to all of the players
+    //! \note The response is serialized only once and the data is shared by all the players
     DLLEXPORT void SendToAllPlayers(const std::shared_ptr<NetworkResponse> &response,
         RECEIVE_GUARANTEE guarantee);
 
@@ -8,6 +8,10 @@
 #include <memory>
 #include <future>
 
+namespace sf{
+class Packet;
+}
+
 namespace Leviathan{
 
 //! Represents a sent packet and holds all kinds of data for it
@@ -126,6 +130,13 @@ public:
         RECEIVE_GUARANTEE guarantee, const std::shared_ptr<NetworkResponse> response);
 
     std::shared_ptr<NetworkResponse> SentResponseData;
+
+    //! \brief Data of SentResponseData that is shared with other connections
+    //!
+    //! Set when the response was broadcast, resends use this instead of serializing
+    //! SentResponseData again
+    //! \see WireData::SerializeResponseData
+    std::shared_ptr<const sf::Packet> SerializedData;
 };
 
 
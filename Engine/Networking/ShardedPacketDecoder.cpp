@@ -0,0 +1,119 @@
+// ------------------------------------ //
+#include "ShardedPacketDecoder.h"
+
+#include <functional>
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT ShardedPacketDecoder::ShardedPacketDecoder(size_t threadcount)
+{
+    LEVIATHAN_ASSERT(threadcount > 0, "ShardedPacketDecoder needs at least one thread");
+
+    Shards.reserve(threadcount);
+
+    for(size_t i = 0; i < threadcount; ++i) {
+
+        Shards.push_back(std::make_unique<Shard>());
+    }
+
+    // Threads are started once all the shards exist //
+    for(auto& shard : Shards) {
+
+        shard->Thread = std::thread(&ShardedPacketDecoder::_RunShard, this, std::ref(*shard));
+    }
+}
+
+DLLEXPORT ShardedPacketDecoder::~ShardedPacketDecoder()
+{
+    Stop.store(true);
+
+    for(auto& shard : Shards) {
+
+        {
+            std::lock_guard<std::mutex> lock(shard->WakeMutex);
+        }
+
+        shard->Wake.notify_all();
+    }
+
+    for(auto& shard : Shards) {
+
+        if(shard->Thread.joinable())
+            shard->Thread.join();
+    }
+}
+// ------------------------------------ //
+DLLEXPORT size_t ShardedPacketDecoder::GetShardForConnection(const Connection* connection) const
+{
+    return std::hash<const Connection*>()(connection) % Shards.size();
+}
+
+DLLEXPORT void ShardedPacketDecoder::QueuePacket(
+    const std::shared_ptr<Connection>& connection, const sf::Packet& packet)
+{
+    auto& shard = *Shards[GetShardForConnection(connection.get())];
+
+    shard.Input.Push(PacketToDecode{connection, packet});
+
+    // Pairs with the fence in _RunShard so that either the shard sees the packet or this
+    // sees that the shard is going to sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if(shard.Sleeping.load(std::memory_order_relaxed)) {
+
+        {
+            std::lock_guard<std::mutex> lock(shard.WakeMutex);
+        }
+
+        shard.Wake.notify_one();
+    }
+}
+
+DLLEXPORT size_t ShardedPacketDecoder::HandleDecodedPackets()
+{
+    size_t count = 0;
+
+    DecodedPacketForConnection packet;
+
+    while(Decoded.Pop(packet)) {
+
+        packet.Target->HandleDecodedPacket(*packet.Decoded);
+
+        // Don't keep the connection alive until the next packet //
+        packet.Target.reset();
+        ++count;
+    }
+
+    return count;
+}
+// ------------------------------------ //
+void ShardedPacketDecoder::_RunShard(Shard& shard)
+{
+    PacketToDecode packet;
+
+    while(!Stop.load(std::memory_order_relaxed)) {
+
+        if(shard.Input.Pop(packet)) {
+
+            auto decoded = std::make_unique<DecodedPacket>();
+
+            Connection::DecodePacket(packet.Data, *decoded);
+
+            Decoded.Push(DecodedPacketForConnection{std::move(packet.Target), std::move(decoded)});
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(shard.WakeMutex);
+
+        shard.Sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if(!shard.Input.IsEmpty() || Stop.load()) {
+
+            shard.Sleeping.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        shard.Wake.wait(lock);
+        shard.Sleeping.store(false, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,94 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "Connection.h"
+#include "Threading/MPSCQueue.h"
+
+#include "SFML/Network/Packet.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Leviathan {
+
+//! \brief Decodes received packets on a fixed set of worker threads
+//!
+//! Each connection always goes to the same shard (thread) so its packets are decoded in the
+//! order they were received. The decoded packets are passed back through a lock-free queue
+//! and applied to the connections on the main thread by HandleDecodedPackets. This keeps
+//! Connection single threaded while moving the parsing and allocation of the messages off
+//! the main thread
+//! \see NetworkHandler::SetPacketDecodeThreads
+class ShardedPacketDecoder {
+    struct PacketToDecode {
+
+        std::shared_ptr<Connection> Target;
+        sf::Packet Data;
+    };
+
+    struct DecodedPacketForConnection {
+
+        std::shared_ptr<Connection> Target;
+        std::unique_ptr<DecodedPacket> Decoded;
+    };
+
+    struct Shard {
+
+        MPSCQueue<PacketToDecode> Input;
+
+        std::mutex WakeMutex;
+        std::condition_variable Wake;
+        std::atomic<bool> Sleeping = {false};
+
+        std::thread Thread;
+    };
+
+public:
+    //! \brief Starts threadcount worker threads
+    DLLEXPORT ShardedPacketDecoder(size_t threadcount);
+
+    //! \brief Stops the threads, packets that haven't been handled are discarded
+    DLLEXPORT ~ShardedPacketDecoder();
+
+    //! \brief Queues a packet to be decoded by the connection's shard
+    //!
+    //! Must always be called from the same thread to keep the packets in order
+    DLLEXPORT void QueuePacket(
+        const std::shared_ptr<Connection>& connection, const sf::Packet& packet);
+
+    //! \brief Passes the decoded packets to their connections
+    //! \note Must only be called from the main thread
+    //! \returns The number of packets handled
+    DLLEXPORT size_t HandleDecodedPackets();
+
+    inline size_t GetShardCount() const
+    {
+        return Shards.size();
+    }
+
+    //! \returns The shard that decodes the packets of connection
+    DLLEXPORT size_t GetShardForConnection(const Connection* connection) const;
+
+private:
+    void _RunShard(Shard& shard);
+
+private:
+    std::vector<std::unique_ptr<Shard>> Shards;
+
+    //! Filled by the shards and emptied by HandleDecodedPackets
+    MPSCQueue<DecodedPacketForConnection> Decoded;
+
+    std::atomic<bool> Stop = {false};
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::ShardedPacketDecoder;
+#endif
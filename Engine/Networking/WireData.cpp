@@ -32,14 +32,7 @@ DLLEXPORT std::shared_ptr<SentRequest> WireData::FormatRequestBytes(
     PrepareHeaderForPacket(localpacketid, &messages[0], 1,
         acks, bytesreceiver);
 
-    // Request type //
-    bytesreceiver << NORMAL_REQUEST_TYPE;
-    
-    // Message number //
-    bytesreceiver << messagenumber;
-
-    // Pack the message data in //
-    request->AddDataToPacket(bytesreceiver);
+    FormatRequestMessage(*request, messagenumber, bytesreceiver);
 
     return std::make_shared<SentRequest>(localpacketid, messagenumber,
         guarantee, request);
@@ -59,14 +52,7 @@ DLLEXPORT void WireData::FormatRequestBytes(const NetworkRequest &request,
     PrepareHeaderForPacket(localpacketid, &messages[0], 1,
         acks, bytesreceiver);
 
-    // Request type //
-    bytesreceiver << NORMAL_REQUEST_TYPE;
-    
-    // Message number //
-    bytesreceiver << messagenumber;
-
-    // Pack the message data in //
-    request.AddDataToPacket(bytesreceiver);    
+    FormatRequestMessage(request, messagenumber, bytesreceiver);
 }
 // ------------------------------------ //
 DLLEXPORT std::shared_ptr<SentResponse> WireData::FormatResponseBytes(
@@ -86,14 +72,7 @@ DLLEXPORT std::shared_ptr<SentResponse> WireData::FormatResponseBytes(
     PrepareHeaderForPacket(localpacketid, &messages[0], 1,
         acks, bytesreceiver);
 
-    // Request type //
-    bytesreceiver << NORMAL_RESPONSE_TYPE;
-    
-    // Message number //
-    bytesreceiver << messagenumber;
-
-    // Pack the message data in //
-    response->AddDataToPacket(bytesreceiver);
+    FormatResponseMessage(*response, messagenumber, bytesreceiver);
 
     return std::make_shared<SentResponse>(localpacketid, messagenumber,
         guarantee, response);
@@ -113,169 +92,92 @@ DLLEXPORT void WireData::FormatResponseBytes(const NetworkResponse &response,
     PrepareHeaderForPacket(localpacketid, &messages[0], 1,
         acks, bytesreceiver);
 
+    FormatResponseMessage(response, messagenumber, bytesreceiver);
+}
+// ------------------------------------ //
+DLLEXPORT void WireData::FormatRequestMessage(const NetworkRequest &request,
+    uint32_t messagenumber, sf::Packet &bytesreceiver)
+{
     // Request type //
-    bytesreceiver << NORMAL_RESPONSE_TYPE;
+    bytesreceiver << NORMAL_REQUEST_TYPE;
     
     // Message number //
     bytesreceiver << messagenumber;
 
     // Pack the message data in //
-    response.AddDataToPacket(bytesreceiver);
+    request.AddDataToPacket(bytesreceiver);
 }
-// ------------------------------------ //
-DLLEXPORT void WireData::FormatAckOnlyPacket(const std::vector<uint32_t> &packetstoack,
-    sf::Packet &bytesreceiver)
-{
-    bytesreceiver << LEVIATHAN_ACK_PACKET;
-
-    LEVIATHAN_ASSERT(packetstoack.size() < std::numeric_limits<uint8_t>::max(),
-        "CreateAckOnlyPacket too many packetstoack provided, can't fit in uint8");
-
-    const uint8_t count = static_cast<uint8_t>(packetstoack.size());
 
-    bytesreceiver << count;
-
-    for(uint8_t i = 0; i < count; ++i){
-
-        bytesreceiver << packetstoack[i];
-    }
-}
-// ------------------------------------ //
-DLLEXPORT void WireData::DecodeIncomingData(sf::Packet &packet,
-    const std::function<DECODE_CALLBACK_RESULT (NetworkAckField&)> &ackcallback,
-    const std::function<void (uint32_t)> &singleack,
-    const std::function<DECODE_CALLBACK_RESULT (uint32_t)> &packetnumberreceived,
-    const std::function<DECODE_CALLBACK_RESULT (uint8_t, uint32_t,
-        sf::Packet&)> &messagereceived)
+DLLEXPORT void WireData::FormatResponseMessage(const NetworkResponse &response,
+    uint32_t messagenumber, sf::Packet &bytesreceiver)
 {
-
-    // Header //
-    uint16_t leviathanMagic = 0;
-    packet >> leviathanMagic;
+    // Response type //
+    bytesreceiver << NORMAL_RESPONSE_TYPE;
     
-    if(!packet){
-
-        Logger::Get()->Error("Received packet has invalid (header) format");
-        return;
-    }
-
-    switch(leviathanMagic){
-    case LEVIATHAN_NORMAL_PACKET:
-    {
-        uint32_t packetNumber = 0;
-        packet >> packetNumber;
-
-        if(!packet){
-
-            Logger::Get()->Error("Received packet has invalid (packet number) format");
-            return;
-        }
+    // Message number //
+    bytesreceiver << messagenumber;
 
-        NetworkAckField otherreceivedpackages(packet);
+    // Pack the message data in //
+    response.AddDataToPacket(bytesreceiver);
+}
 
-        if(!packet){
+DLLEXPORT std::shared_ptr<const sf::Packet> WireData::SerializeResponseData(
+    const NetworkResponse &response)
+{
+    auto data = std::make_shared<sf::Packet>();
+    response.AddDataToPacket(*data);
 
-            Logger::Get()->Error("Received packet has invalid format");
-        }
+    return data;
+}
 
-        // Messages //
-        uint8_t messageCount = 0;
+DLLEXPORT void WireData::FormatResponseMessage(const sf::Packet &serializedresponse,
+    uint32_t messagenumber, sf::Packet &bytesreceiver)
+{
+    // Response type //
+    bytesreceiver << NORMAL_RESPONSE_TYPE;
     
-        if(!(packet >> messageCount)){
-
-            Logger::Get()->Error("Received packet has invalid format, missing Message Count");
-        }
-
-        // Marks things as successfully sent //
-        if(ackcallback){
-            
-            auto callbackResult = ackcallback(otherreceivedpackages);
-
-            if(callbackResult != DECODE_CALLBACK_RESULT::Continue){
-
-                LOG_ERROR("Packet decode callback signaled error");
-                return;
-            }
-        }
-        
-        // Report the packet as received //
-        if(packetnumberreceived){
-            
-            auto callbackResult = packetnumberreceived(packetNumber);
-
-            if(callbackResult != DECODE_CALLBACK_RESULT::Continue){
-
-                LOG_ERROR("Packet decode callback signaled error");
-                return;
-            }
-        }
-
-        for(int i = 0; i < messageCount; ++i){
-
-            uint8_t messageType = 0;
-            packet >> messageType;
-
-            uint32_t messageNumber = 0;
-            packet >> messageNumber;
-        
-            if(!packet){
+    // Message number //
+    bytesreceiver << messagenumber;
 
-                LOG_ERROR("Connection: received packet has an invalid message "
-                    "(some may have been processed already)");
-                return;
-            }
+    // The data is already serialized //
+    bytesreceiver.append(serializedresponse.getData(), serializedresponse.getDataSize());
+}
 
-            auto callbackResult = messagereceived(messageType, messageNumber, packet);
-            
-            if(callbackResult != DECODE_CALLBACK_RESULT::Continue){
+DLLEXPORT void WireData::FormatMultiMessagePacket(uint32_t localpacketid,
+    const std::vector<uint32_t> &messagenumbers, const NetworkAckField* acks,
+    const sf::Packet &messages, sf::Packet &bytesreceiver)
+{
+    LEVIATHAN_ASSERT(!messagenumbers.empty(), "trying to generate packet without messages");
 
-                LOG_ERROR("Packet decode callback signaled error");
-                return;
-            }
-        }
-        
-        return;
-    }
-    case LEVIATHAN_ACK_PACKET:
-    {
-        uint8_t ackCount = 0;
+    bytesreceiver.clear();
 
-        if(!(packet >> ackCount)){
+    // The messages share the header and the acks //
+    PrepareHeaderForPacket(localpacketid, messagenumbers.data(),
+        messagenumbers.size(), acks, bytesreceiver);
 
-            LOG_ERROR("Received packet has invalid (ack number) format");
-            return;
-        }
+    bytesreceiver.append(messages.getData(), messages.getDataSize());
+}
+// ------------------------------------ //
+DLLEXPORT void WireData::FormatAckOnlyPacket(const std::vector<uint32_t> &packetstoack,
+    sf::Packet &bytesreceiver)
+{
+    bytesreceiver << LEVIATHAN_ACK_PACKET;
 
-        for(uint8_t i = 0; i < ackCount; ++i){
+    LEVIATHAN_ASSERT(packetstoack.size() < std::numeric_limits<uint8_t>::max(),
+        "CreateAckOnlyPacket too many packetstoack provided, can't fit in uint8");
 
-            uint32_t ack = 0;
+    const uint8_t count = static_cast<uint8_t>(packetstoack.size());
 
-            if(!(packet >> ack)){
+    bytesreceiver << count;
 
-                LOG_ERROR("Received packet ended while acks were being unpacked, "
-                    "some were applied");
-                return;
-            }
+    for(uint8_t i = 0; i < count; ++i){
 
-            if(singleack)
-                singleack(ack);
-        }
-        
-        return;
-    }
-    default:
-    {
-        LOG_ERROR("Received packet has an unknown type: " + Convert::ToString(leviathanMagic));
-        return;
-    }
+        bytesreceiver << packetstoack[i];
     }
 }
-
-
-
 // ------------------------------------ //
 DLLEXPORT void WireData::PrepareHeaderForPacket(uint32_t localpacketid,
-    uint32_t* firstmessagenumber, size_t messagenumbercount,
+    const uint32_t* firstmessagenumber, size_t messagenumbercount,
     const Leviathan::NetworkAckField* acks, sf::Packet &tofill)
 {
     LEVIATHAN_ASSERT(localpacketid > 0, "Trying to fill packet with packetid == 0");
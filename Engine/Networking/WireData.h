@@ -5,13 +5,14 @@
 // ------------------------------------ //
 
 #include "CommonNetwork.h"
+#include "NetworkAckField.h"
+
+#include "SFML/Network/Packet.hpp"
+
 #include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
-#include <functional>
-
-namespace sf{
-class Packet;
-}
 
 namespace Leviathan{
 
@@ -21,8 +22,6 @@ class NetworkRequest;
 class NetworkResponse;
 class SentNetworkThing;
 
-class NetworkAckField;
-
 //! Class for serializing and deserializing the final bytes that are
 //! sent over the network
 //!
@@ -73,6 +72,39 @@ public:
         const NetworkAckField* acks, sf::Packet &bytesreceiver);
 
 
+    //! \brief Appends a request message without a packet header to bytesreceiver
+    //!
+    //! Used to pack multiple messages into a single packet with FormatMultiMessagePacket
+    DLLEXPORT static void FormatRequestMessage(const NetworkRequest &request,
+        uint32_t messagenumber, sf::Packet &bytesreceiver);
+
+    //! \brief Appends a response message without a packet header to bytesreceiver
+    //! \see FormatRequestMessage
+    DLLEXPORT static void FormatResponseMessage(const NetworkResponse &response,
+        uint32_t messagenumber, sf::Packet &bytesreceiver);
+
+    //! \brief Serializes only the data of a response
+    //!
+    //! The result can be formatted into messages for any number of connections with the
+    //! other FormatResponseMessage overload. This is used to broadcast a response without
+    //! serializing it separately for each receiver
+    DLLEXPORT static std::shared_ptr<const sf::Packet> SerializeResponseData(
+        const NetworkResponse &response);
+
+    //! \brief Appends a response message whose data was created by SerializeResponseData
+    //! \see FormatRequestMessage
+    DLLEXPORT static void FormatResponseMessage(const sf::Packet &serializedresponse,
+        uint32_t messagenumber, sf::Packet &bytesreceiver);
+
+    //! \brief Constructs a packet containing multiple messages
+    //! \param messagenumbers The numbers of the messages in messages
+    //! \param messages Messages formatted with FormatRequestMessage and
+    //! FormatResponseMessage
+    //! \see FormatRequestBytes
+    DLLEXPORT static void FormatMultiMessagePacket(uint32_t localpacketid,
+        const std::vector<uint32_t> &messagenumbers, const NetworkAckField* acks,
+        const sf::Packet &messages, sf::Packet &bytesreceiver);
+
     //! \brief Constructs an ack only packet with the specified acks
     DLLEXPORT static void FormatAckOnlyPacket(const std::vector<uint32_t> &packetstoack,
         sf::Packet &bytesreceiver);
@@ -82,25 +114,26 @@ public:
     //! \brief Decodes a packet to the right objects and invokes the callbacks
     //!
     //! This does the opposito of the various Format methods in this class.
+    //! The callbacks are template parameters so that calling them doesn't need a
+    //! std::function and decoding the header doesn't allocate any memory.
     //! \note In case of errors they will be logged and this will silently return
     //! without invoking the callbacks
-    //! \param ackcallback Called when a NetworkAckField is decoded from the packet
-    //! \param singleack Called when a a single whole ack number is loaded
-    //! \param packetnumberreceived Called when a packet id is decoded
-    //! \param handlemessage This is the most important callback as it is called
-    //! once for every message decoded from the packet. This may not be null
+    //! \param ackcallback Called when a NetworkAckField is decoded from the packet.
+    //! Signature: DECODE_CALLBACK_RESULT (NetworkAckField&)
+    //! \param singleack Called when a a single whole ack number is loaded.
+    //! Signature: void (uint32_t)
+    //! \param packetnumberreceived Called when a packet id is decoded.
+    //! Signature: DECODE_CALLBACK_RESULT (uint32_t)
     //! \param messagereceived Called once for every message. The actual message data
     //! is still in the packet and needs to be decoded. The callback parameters are:
-    //! message type and message number
-    DLLEXPORT static void DecodeIncomingData(sf::Packet &packet,
-        const std::function<DECODE_CALLBACK_RESULT (NetworkAckField&)> &ackcallback,
-        const std::function<void (uint32_t)> &singleack,
-        const std::function<DECODE_CALLBACK_RESULT (uint32_t)> &packetnumberreceived,
-        const std::function<DECODE_CALLBACK_RESULT (uint8_t, uint32_t,
-            sf::Packet&)> &messagereceived
-        );
-    
-    
+    //! message type and message number. This is the most important callback and may not
+    //! be null. Signature: DECODE_CALLBACK_RESULT (uint8_t, uint32_t, sf::Packet&)
+    //! \note Other callbacks than messagereceived can be nullptr to skip them
+    template<class AckCallbackT, class SingleAckCallbackT, class PacketNumberCallbackT,
+        class MessageCallbackT>
+    static void DecodeIncomingData(sf::Packet &packet, const AckCallbackT &ackcallback,
+        const SingleAckCallbackT &singleack, const PacketNumberCallbackT &packetnumberreceived,
+        const MessageCallbackT &messagereceived);
 
     //! \protected Not meant to be called directly
     //!
@@ -108,7 +141,7 @@ public:
     //! \param firstmessagenumber Pointer to first message number
     //! \param messagenumbercount Number of message numbers in firstmessagenumber
     DLLEXPORT static void PrepareHeaderForPacket(uint32_t localpacketid,
-        uint32_t* firstmessagenumber, size_t messagenumbercount,
+        const uint32_t* firstmessagenumber, size_t messagenumbercount,
         const NetworkAckField* acks, sf::Packet &tofill);
 
     //! \protected Format ack part of header
@@ -119,5 +152,133 @@ public:
 
 };
 
+// ------------------------------------ //
+template<class AckCallbackT, class SingleAckCallbackT, class PacketNumberCallbackT,
+    class MessageCallbackT>
+void WireData::DecodeIncomingData(sf::Packet &packet, const AckCallbackT &ackcallback,
+    const SingleAckCallbackT &singleack, const PacketNumberCallbackT &packetnumberreceived,
+    const MessageCallbackT &messagereceived)
+{
+    // Header //
+    uint16_t leviathanMagic = 0;
+    packet >> leviathanMagic;
+    
+    if(!packet){
+
+        LOG_ERROR("Received packet has invalid (header) format");
+        return;
+    }
+
+    switch(leviathanMagic){
+    case LEVIATHAN_NORMAL_PACKET:
+    {
+        uint32_t packetNumber = 0;
+        packet >> packetNumber;
+
+        if(!packet){
+
+            LOG_ERROR("Received packet has invalid (packet number) format");
+            return;
+        }
+
+        NetworkAckField otherreceivedpackages(packet);
+
+        if(!packet){
+
+            LOG_ERROR("Received packet has invalid format");
+        }
+
+        // Messages //
+        uint8_t messageCount = 0;
+    
+        if(!(packet >> messageCount)){
+
+            LOG_ERROR("Received packet has invalid format, missing Message Count");
+        }
+
+        // Marks things as successfully sent //
+        if constexpr(!std::is_same_v<AckCallbackT, std::nullptr_t>){
+            
+            auto callbackResult = ackcallback(otherreceivedpackages);
+
+            if(callbackResult != DECODE_CALLBACK_RESULT::Continue){
+
+                LOG_ERROR("Packet decode callback signaled error");
+                return;
+            }
+        }
+        
+        // Report the packet as received //
+        if constexpr(!std::is_same_v<PacketNumberCallbackT, std::nullptr_t>){
+            
+            auto callbackResult = packetnumberreceived(packetNumber);
+
+            if(callbackResult != DECODE_CALLBACK_RESULT::Continue){
+
+                LOG_ERROR("Packet decode callback signaled error");
+                return;
+            }
+        }
+
+        for(int i = 0; i < messageCount; ++i){
+
+            uint8_t messageType = 0;
+            packet >> messageType;
+
+            uint32_t messageNumber = 0;
+            packet >> messageNumber;
+        
+            if(!packet){
+
+                LOG_ERROR("Connection: received packet has an invalid message "
+                    "(some may have been processed already)");
+                return;
+            }
+
+            auto callbackResult = messagereceived(messageType, messageNumber, packet);
+            
+            if(callbackResult != DECODE_CALLBACK_RESULT::Continue){
+
+                LOG_ERROR("Packet decode callback signaled error");
+                return;
+            }
+        }
+        
+        return;
+    }
+    case LEVIATHAN_ACK_PACKET:
+    {
+        uint8_t ackCount = 0;
+
+        if(!(packet >> ackCount)){
+
+            LOG_ERROR("Received packet has invalid (ack number) format");
+            return;
+        }
+
+        for(uint8_t i = 0; i < ackCount; ++i){
+
+            uint32_t ack = 0;
+
+            if(!(packet >> ack)){
+
+                LOG_ERROR("Received packet ended while acks were being unpacked, "
+                    "some were applied");
+                return;
+            }
+
+            if constexpr(!std::is_same_v<SingleAckCallbackT, std::nullptr_t>)
+                singleack(ack);
+        }
+        
+        return;
+    }
+    default:
+    {
+        LOG_ERROR("Received packet has an unknown type: " + std::to_string(leviathanMagic));
+        return;
+    }
+    }
+}
 
 }
@@ -1,7 +1,12 @@
 // ------------------------------------ //
 #include "NewtonManager.h"
 
+#include "Threading/ThreadingManager.h"
+
 #include <Newton.h>
+
+#include <algorithm>
+#include <thread>
 using namespace Leviathan;
 using namespace std;
 // ------------------------------------ //
@@ -38,7 +43,28 @@ NewtonManager* Leviathan::NewtonManager::Staticaccess = NULL;
 // ------------------------------------ //
 DLLEXPORT std::shared_ptr<PhysicalWorld> Leviathan::NewtonManager::CreateWorld(GameWorld* owningworld){
 	// we are probably initialized at this point so it should be safe to just call the constructor //
-	return std::shared_ptr<PhysicalWorld>(new PhysicalWorld(owningworld));
+	auto world = std::shared_ptr<PhysicalWorld>(new PhysicalWorld(owningworld));
+
+	world->SetThreadCount(GetPhysicsThreadCount());
+	return world;
+}
+// ------------------------------------ //
+DLLEXPORT void Leviathan::NewtonManager::SetPhysicsThreadCount(int threads){
+	PhysicsThreadCount = std::max(0, threads);
+}
+
+DLLEXPORT int Leviathan::NewtonManager::GetPhysicsThreadCount() const{
+
+	if(PhysicsThreadCount > 0)
+		return PhysicsThreadCount;
+
+	// Same as the number of workers ThreadingManager uses //
+	auto threading = ThreadingManager::Get();
+
+	if(threading && threading->GetWorkerCount() > 0)
+		return static_cast<int>(threading->GetWorkerCount());
+
+	return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
 }
 // ------------------------------------ //
 
@@ -15,6 +15,18 @@ namespace Leviathan{
 		// creates a new world that will release itself when no more references //
 		DLLEXPORT std::shared_ptr<PhysicalWorld> CreateWorld(GameWorld* owningworld);
 
+		//! \brief Sets the number of threads Newton uses in worlds created after this
+		//!
+		//! By default worlds use a single thread. Material callbacks must be thread safe
+		//! before this is set to anything else. Games can call this before creating worlds
+		//! or dedicated servers can be started with the --threadedphysics command line flag,
+		//! which sets this to 0 in Engine::Init
+		//! \param threads 0 uses one for each ThreadingManager worker
+		DLLEXPORT void SetPhysicsThreadCount(int threads);
+
+		//! \returns The number of threads new worlds are created with
+		DLLEXPORT int GetPhysicsThreadCount() const;
+
 
 		DLLEXPORT static inline NewtonManager* Get(){
 			return Staticaccess;
@@ -23,6 +35,8 @@ namespace Leviathan{
 
 		// newton variables //
 
+		//! Set with SetPhysicsThreadCount, 0 means that the core count is used
+		int PhysicsThreadCount = 1;
 
 
 		// static access //
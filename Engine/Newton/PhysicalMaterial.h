@@ -75,6 +75,9 @@ struct PhysMaterialDataPair {
     }
 
     //! \brief Sets the callback functions that are called when the material interacts
+    //! \note The callbacks are called from multiple threads at once when the world uses more
+    //! than one thread, threadIndex tells which one
+    //! \see NewtonManager::SetPhysicsThreadCount
     DLLEXPORT inline PhysMaterialDataPair& SetCallbacks(
         const PhysicsMaterialAABBCallback aabb, const PhysicsMaterialContactCallback contact)
     {
@@ -6,10 +6,37 @@
 #include "Events/EventHandler.h"
 #include "NewtonConversions.h"
 #include "PhysicsMaterialManager.h"
+#include "Threading/ThreadingManager.h"
+
 #include <Newton.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 using namespace Leviathan;
 // ------------------------------------ //
-DLLEXPORT Leviathan::PhysicalWorld::PhysicalWorld(GameWorld* owner) : OwningWorld(owner)
+//! \brief State of a simulation started by BeginSimulateWorldFixed
+//!
+//! The queued task keeps this alive as it may start after WaitForSimulation has returned
+struct PhysicalWorld::BackgroundSimulation {
+
+    uint32_t MSPassed;
+    uint32_t StepCount;
+
+    //! Set by the thread that runs the simulation
+    std::atomic<bool> Claimed = {false};
+
+    std::mutex Mutex;
+    std::condition_variable Notify;
+    bool Finished = false;
+    std::exception_ptr Error;
+};
+// ------------------------------------ //
+DLLEXPORT Leviathan::PhysicalWorld::PhysicalWorld(GameWorld* owner) :
+    OwningWorld(owner),
+    PhysicsEvent(std::make_unique<ReusableEvent<PhysicsStartEventData>>(
+        EVENT_TYPE_PHYSICS_BEGIN))
 {
     // create newton world //
     World = NewtonCreate();
@@ -32,6 +59,17 @@ DLLEXPORT Leviathan::PhysicalWorld::PhysicalWorld(GameWorld* owner) : OwningWorl
 
 DLLEXPORT Leviathan::PhysicalWorld::~PhysicalWorld()
 {
+    // The background simulation uses this object //
+    try {
+        WaitForSimulation();
+    } catch(const std::exception& e) {
+
+        LOG_ERROR("PhysicalWorld: background simulation failed: " + std::string(e.what()));
+    } catch(...) {
+
+        LOG_ERROR("PhysicalWorld: background simulation failed with an unknown exception");
+    }
+
     //  Destroy the newton world
     NewtonDestroy(World);
 
@@ -70,8 +108,8 @@ DLLEXPORT void Leviathan::PhysicalWorld::SimulateWorld(int maxruns /*= -1*/)
     while(PassedTimeTotal >= NEWTON_FPS_IN_MICROSECONDS) {
 
         // Call event //
-        Engine::Get()->GetEventHandler()->CallEvent(new Event(EVENT_TYPE_PHYSICS_BEGIN,
-            new PhysicsStartEventData(NEWTON_TIMESTEP, OwningWorld)));
+        Engine::Get()->GetEventHandler()->CallEvent(
+            PhysicsEvent->Get(NEWTON_TIMESTEP, OwningWorld));
 
         NewtonUpdate(World, NEWTON_TIMESTEP);
         PassedTimeTotal -= static_cast<int64_t>(NEWTON_FPS_IN_MICROSECONDS);
@@ -94,12 +132,84 @@ DLLEXPORT void Leviathan::PhysicalWorld::SimulateWorldFixed(
 
     for(uint32_t i = 0; i < stepcount; ++i) {
 
-        Engine::Get()->GetEventHandler()->CallEvent(new Event(
-            EVENT_TYPE_PHYSICS_BEGIN, new PhysicsStartEventData(timestep, OwningWorld)));
+        Engine::Get()->GetEventHandler()->CallEvent(PhysicsEvent->Get(timestep, OwningWorld));
 
         NewtonUpdate(World, timestep);
     }
 }
+
+DLLEXPORT void PhysicalWorld::BeginSimulateWorldFixed(
+    uint32_t mspassed, uint32_t stepcount /*= 1*/)
+{
+    // Only one simulation can run at a time //
+    WaitForSimulation();
+
+    auto manager = ThreadingManager::Get();
+
+    if(!manager || manager->GetWorkerCount() == 0) {
+
+        SimulateWorldFixed(mspassed, stepcount);
+        return;
+    }
+
+    auto simulation = std::make_shared<BackgroundSimulation>();
+    simulation->MSPassed = mspassed;
+    simulation->StepCount = stepcount;
+
+    RunningSimulation = simulation;
+
+    manager->QueueTask(std::make_shared<QueuedTask>([this, simulation]() {
+        // If WaitForSimulation has already claimed this the world may be gone //
+        if(!simulation->Claimed.exchange(true))
+            _RunBackgroundSimulation(*simulation);
+    }));
+}
+
+DLLEXPORT void PhysicalWorld::WaitForSimulation()
+{
+    if(!RunningSimulation)
+        return;
+
+    const auto simulation = std::move(RunningSimulation);
+
+    // Not waiting for a worker that hasn't even started //
+    if(!simulation->Claimed.exchange(true))
+        _RunBackgroundSimulation(*simulation);
+
+    std::unique_lock<std::mutex> lock(simulation->Mutex);
+
+    simulation->Notify.wait(lock, [&]() { return simulation->Finished; });
+
+    if(simulation->Error)
+        std::rethrow_exception(simulation->Error);
+}
+
+void PhysicalWorld::_RunBackgroundSimulation(BackgroundSimulation& simulation)
+{
+    std::exception_ptr error;
+
+    try {
+        SimulateWorldFixed(simulation.MSPassed, simulation.StepCount);
+    } catch(...) {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(simulation.Mutex);
+
+    simulation.Error = error;
+    simulation.Finished = true;
+    simulation.Notify.notify_all();
+}
+// ------------------------------------ //
+DLLEXPORT void PhysicalWorld::SetThreadCount(int threads)
+{
+    NewtonSetThreadsCount(World, std::max(1, threads));
+}
+
+DLLEXPORT int PhysicalWorld::GetThreadCount() const
+{
+    return NewtonGetThreadsCount(World);
+}
 // ------------------------------------ //
 int Leviathan::SingleBodyUpdate(
     const NewtonWorld* const newtonWorld, const void* islandHandle, int bodyCount)
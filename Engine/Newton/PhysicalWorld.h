@@ -16,6 +16,7 @@
 
 #include <Newton.h>
 #include <functional>
+#include <memory>
 
 //#ifdef __GNUC__
 //#pragma GCC diagnostic pop
@@ -58,6 +59,34 @@ public:
     //! \brief Advances the simulation the specified amount of time
     DLLEXPORT void SimulateWorldFixed(uint32_t mspassed, uint32_t stepcount = 1);
 
+    //! \brief Starts SimulateWorldFixed on a ThreadingManager worker and returns immediately
+    //!
+    //! Bodies and their components must not be touched before WaitForSimulation is called.
+    //! If there are no workers this simulates before returning
+    //! \note The EVENT_TYPE_PHYSICS_BEGIN events and the body callbacks are called on the
+    //! worker thread
+    //! \warning Only the thread that ticks the world should call this and WaitForSimulation
+    DLLEXPORT void BeginSimulateWorldFixed(uint32_t mspassed, uint32_t stepcount = 1);
+
+    //! \brief Waits for the simulation started by BeginSimulateWorldFixed to finish
+    //!
+    //! Runs the simulation on this thread if a worker hasn't started it yet. Does nothing
+    //! if no simulation has been started
+    //! \exception Rethrows an exception thrown by the simulation
+    DLLEXPORT void WaitForSimulation();
+
+    //! \returns True if BeginSimulateWorldFixed has been called and WaitForSimulation hasn't
+    inline bool IsSimulationStarted() const
+    {
+        return RunningSimulation.get() != nullptr;
+    }
+
+    //! \brief Sets the number of threads Newton uses to update this world
+    //! \note NewtonManager sets this when creating worlds
+    DLLEXPORT void SetThreadCount(int threads);
+
+    DLLEXPORT int GetThreadCount() const;
+
     //! \brief Clears passed time
     DLLEXPORT void ClearTimers();
 
@@ -104,6 +133,13 @@ public:
         return World;
     }
 
+protected:
+    struct BackgroundSimulation;
+
+    //! \brief Runs the simulation and marks it finished
+    //! \pre simulation.Claimed has been set by the caller
+    void _RunBackgroundSimulation(BackgroundSimulation& simulation);
+
 protected:
     //! Total amount of microseconds required to be simulated
     int64_t PassedTimeTotal = 0;
@@ -115,6 +151,12 @@ protected:
     //! Lock for world updates
     Mutex WorldUpdateLock;
 
+    //! Sent before each physics update
+    std::unique_ptr<ReusableEvent<PhysicsStartEventData>> PhysicsEvent;
+
+    //! Set between BeginSimulateWorldFixed and WaitForSimulation
+    std::shared_ptr<BackgroundSimulation> RunningSimulation;
+
     //! Used for resimulation
     //! \todo Potentially allow this to be a vector
     NewtonBody* ResimulatedBody = nullptr;
@@ -42,7 +42,7 @@ DLLEXPORT bool Leviathan::ObjectFile::AddNamedVariable(shared_ptr<NamedVariableL
 // ------------------------------------ //
 DLLEXPORT bool Leviathan::ObjectFile::AddObject(shared_ptr<ObjectFileObject> obj){
 	// Make sure that the name is not in use //
-	if(IsObjectNameInUse(obj->GetName())){
+	if(!DefinedObjectNames.insert(obj->GetName()).second){
 
 		return false;
 	}
@@ -54,11 +54,8 @@ DLLEXPORT bool Leviathan::ObjectFile::AddObject(shared_ptr<ObjectFileObject> obj
 // ------------------------------------ //
 DLLEXPORT bool Leviathan::ObjectFile::IsObjectNameInUse(const std::string &name) const{
 	// Try to find an object with the same name //
-	for(size_t i = 0; i < DefinedObjects.size(); i++){
-
-		if(DefinedObjects[i]->GetName() == name)
-			return true;
-	}
+	if(DefinedObjectNames.find(name) != DefinedObjectNames.end())
+		return true;
 
 	// Check for matching template names //
 
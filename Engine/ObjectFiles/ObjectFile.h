@@ -8,6 +8,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_set>
 
 
 #ifdef LEVIATHAN_USING_ANGELSCRIPT
@@ -291,6 +292,11 @@ public:
         return TemplatesName;
     }
 
+    DLLEXPORT inline const std::vector<std::unique_ptr<std::string>>& GetArguments() const {
+
+        return Arguments;
+    }
+
     DLLEXPORT std::string Serialize(size_t indentspaces = 0) const;
 
 protected:
@@ -320,6 +326,17 @@ public:
     //! \brief Gets the name of this template
     DLLEXPORT const std::string& GetName() const;
 
+    DLLEXPORT inline const std::vector<std::unique_ptr<std::string>>& GetParameters() const {
+
+        return Parameters;
+    }
+
+    //! \brief Gets the object from which the instances are created
+    DLLEXPORT inline std::shared_ptr<ObjectFileObject> GetRepresentingObject() const {
+
+        return RepresentingObject;
+    }
+
 
     //! \brief Creates a ObjectFileTemplateDefinition from an ObjectFileObject and a parameter list
     //! \param obj The object from which to construct the template, the pointer will be deleted by this
@@ -489,6 +506,9 @@ protected:
 	//! Holds the defined objects
 	std::vector<std::shared_ptr<ObjectFileObject>> DefinedObjects;
 
+	//! Names of DefinedObjects for quickly checking that new names are unique
+	std::unordered_set<std::string> DefinedObjectNames;
+
 	//! Holds all the template definitions
 	std::vector<std::shared_ptr<ObjectFileTemplateDefinition>> TemplateDefinitions;
 
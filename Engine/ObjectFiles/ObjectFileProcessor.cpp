@@ -23,6 +23,20 @@
 #include "Script/ScriptExecutor.h"
 #include "Script/ScriptScript.h"
 #endif // LEVIATHAN_USING_ANGELSCRIPT
+
+// The cache uses the packet serialization of the variables //
+#if defined(SFML_PACKETS) && !defined(LEVIATHAN_UE_PLUGIN)
+#define OBJECTFILE_CACHE
+#include "Engine.h"
+#include "Exceptions.h"
+#include "Handlers/ResourceRefreshHandler.h"
+
+#include <boost/filesystem.hpp>
+
+#include <iomanip>
+#include <set>
+#include <thread>
+#endif // SFML_PACKETS
 using namespace Leviathan;
 // ------------------------------------ //
 #ifndef NO_DEFAULT_DATAINDEX
@@ -51,6 +65,432 @@ std::map<std::string, std::shared_ptr<VariableBlock>>
 std::map<std::string, std::shared_ptr<VariableBlock>>
     Leviathan::ObjectFileProcessor::RegisteredValues;
 #endif
+
+std::string Leviathan::ObjectFileProcessor::CacheFolder = "./ObjectFileCache";
+
+#ifdef OBJECTFILE_CACHE
+// ------------------ Cache helpers ------------------ //
+//! Identifies ObjectFile cache files
+constexpr sf::Uint32 OBJECTFILE_CACHE_MAGIC = 0x434F564C;
+
+//! Needs to be incremented when the cache format changes
+constexpr sf::Uint16 OBJECTFILE_CACHE_VERSION = 1;
+
+//! \brief Passes messages on and remembers if there were errors
+class ErrorCheckingReporter : public LErrorReporter{
+public:
+
+    ErrorCheckingReporter(LErrorReporter* reporter) : Reporter(reporter){}
+
+    void Write(const std::string &text) override{
+        Reporter->Write(text);
+    }
+
+    void WriteLine(const std::string &text) override{
+        Reporter->WriteLine(text);
+    }
+
+    void Info(const std::string &text) override{
+        Reporter->Info(text);
+    }
+
+    void Warning(const std::string &text) override{
+        Reporter->Warning(text);
+    }
+
+    void Error(const std::string &text) override{
+        HasErrors = true;
+        Reporter->Error(text);
+    }
+
+    void Fatal(const std::string &text) override{
+        HasErrors = true;
+        Reporter->Fatal(text);
+    }
+
+    LErrorReporter* Reporter;
+    bool HasErrors = false;
+};
+
+//! \brief The source files in a folder that have a cached version
+struct CacheWatchedFolder{
+
+    //! The cache files by the names of the source files, empty once the source has changed
+    std::map<std::string, std::string> CacheFiles;
+
+    //! Names of the files the listener was started for. All files in the folder are
+    //! listened for so that caching more of them doesn't need a new listener
+    std::set<std::string> ListenedFiles;
+
+    //! ID of the ResourceRefreshHandler listener or -1
+    int ListenerID = -1;
+
+    //! Set while an UpdateCacheWatch call is waiting to run
+    bool UpdateQueued = false;
+};
+
+static Mutex CacheWatchMutex;
+static std::map<std::string, CacheWatchedFolder> CacheWatchedFolders;
+
+//! \brief Removes the cache file of a source file that has changed
+//! \note Called by ResourceRefreshHandler while it is locked
+static void OnCachedFileChanged(const std::string &folder, const std::string &name){
+
+    std::string cachefile;
+
+    {
+        Lock lock(CacheWatchMutex);
+
+        auto watched = CacheWatchedFolders.find(folder);
+
+        if(watched == CacheWatchedFolders.end())
+            return;
+
+        auto file = watched->second.CacheFiles.find(name);
+
+        if(file == watched->second.CacheFiles.end())
+            return;
+
+        cachefile.swap(file->second);
+    }
+
+    if(cachefile.empty())
+        return;
+
+    boost::system::error_code error;
+    boost::filesystem::remove(cachefile, error);
+}
+
+//! \brief Starts a new listener for all the files in a folder if the files have changed
+//! \note Needs to be called on the main thread, outside ResourceRefreshHandler callbacks
+static void UpdateCacheWatch(const std::string &folder){
+
+    ResourceRefreshHandler* handler = ResourceRefreshHandler::Get();
+
+    std::set<std::string> files;
+
+    boost::system::error_code error;
+
+    for(boost::filesystem::directory_iterator iter(folder, error), end;
+        !error && iter != end; iter.increment(error))
+    {
+        if(boost::filesystem::is_regular_file(iter->status()))
+            files.insert(iter->path().filename().string());
+    }
+
+    int oldlistener;
+
+    {
+        Lock lock(CacheWatchMutex);
+
+        auto& watched = CacheWatchedFolders[folder];
+
+        watched.UpdateQueued = false;
+
+        for(const auto& file : watched.CacheFiles)
+            files.insert(file.first);
+
+        if(!handler || (watched.ListenerID != -1 && files == watched.ListenedFiles))
+            return;
+
+        oldlistener = watched.ListenerID;
+        watched.ListenerID = -1;
+        watched.ListenedFiles = files;
+    }
+
+    // A listener can't be changed so all the files are listened for again //
+    if(oldlistener != -1)
+        handler->StopListeningForFileChanges(oldlistener);
+
+    std::vector<std::string> paths;
+
+    for(const auto& file : files)
+        paths.push_back(folder + file);
+
+    std::vector<const std::string*> targetfiles;
+
+    for(const auto& path : paths)
+        targetfiles.push_back(&path);
+
+    int listenerid = -1;
+
+    if(!handler->ListenForFileChanges(targetfiles,
+            [folder](const std::string &name, ResourceFolderListener&){
+
+                OnCachedFileChanged(folder, name);
+            }, listenerid))
+    {
+        return;
+    }
+
+    Lock lock(CacheWatchMutex);
+    CacheWatchedFolders[folder].ListenerID = listenerid;
+}
+
+//! \brief Makes sure that the cached file is removed when the source file changes
+static void WatchForCacheInvalidation(const std::string &file, const std::string &cachefile){
+
+    const std::string folder = StringOperations::GetPath<std::string>(file);
+
+    // Files without a folder can't be listened for //
+    if(folder.empty())
+        return;
+
+    {
+        Lock lock(CacheWatchMutex);
+
+        auto& watched = CacheWatchedFolders[folder];
+
+        const std::string name = StringOperations::RemovePath<std::string>(file);
+
+        watched.CacheFiles[name] = cachefile;
+
+        // The listener only needs to be started again for files that are new to the
+        // folder //
+        if(watched.UpdateQueued || (watched.ListenerID != -1 &&
+                watched.ListenedFiles.find(name) != watched.ListenedFiles.end()))
+        {
+            return;
+        }
+
+        watched.UpdateQueued = true;
+    }
+
+    // The file might be loaded by a ResourceRefreshHandler callback so the listener is
+    // started later
+    Engine* engine = Engine::Get();
+
+    if(engine){
+
+        engine->Invoke([folder](){ UpdateCacheWatch(folder); });
+
+    } else {
+
+        Lock lock(CacheWatchMutex);
+        CacheWatchedFolders[folder].UpdateQueued = false;
+    }
+}
+
+static void StopCacheWatches(){
+
+    std::vector<int> listeners;
+
+    {
+        Lock lock(CacheWatchMutex);
+
+        for(const auto& watched : CacheWatchedFolders){
+
+            if(watched.second.ListenerID != -1)
+                listeners.push_back(watched.second.ListenerID);
+        }
+
+        CacheWatchedFolders.clear();
+    }
+
+    ResourceRefreshHandler* handler = ResourceRefreshHandler::Get();
+
+    if(!handler)
+        return;
+
+    for(int listener : listeners)
+        handler->StopListeningForFileChanges(listener);
+}
+
+static void WriteCachedVariable(sf::Packet &packet, NamedVariableList &variable){
+
+    const auto& values = variable.GetValues();
+
+    packet << variable.GetName() << static_cast<sf::Uint32>(values.size());
+
+    for(const VariableBlock* value : values){
+
+        if(!value)
+            throw InvalidArgument("variable has an empty value");
+
+        value->AddDataToPacket(packet);
+    }
+}
+
+static std::shared_ptr<NamedVariableList> ReadCachedVariable(sf::Packet &packet){
+
+    std::string name;
+    sf::Uint32 count = 0;
+
+    // Each value takes at least 2 bytes so the count is checked to not reserve too much //
+    if(!(packet >> name >> count) || count > packet.getDataSize())
+        return nullptr;
+
+    std::vector<std::unique_ptr<VariableBlock>> values;
+    values.reserve(count);
+
+    for(sf::Uint32 i = 0; i < count; ++i)
+        values.push_back(std::make_unique<VariableBlock>(packet));
+
+    if(!packet)
+        return nullptr;
+
+    std::vector<VariableBlock*> released;
+    released.reserve(values.size());
+
+    for(auto& value : values)
+        released.push_back(value.release());
+
+    auto variable = std::make_shared<NamedVariableList>(name);
+    variable->SetValue(released);
+    return variable;
+}
+
+static void WriteCachedStrings(sf::Packet &packet,
+    const std::vector<std::unique_ptr<std::string>> &strings)
+{
+    packet << static_cast<sf::Uint32>(strings.size());
+
+    for(const auto& str : strings)
+        packet << *str;
+}
+
+static bool ReadCachedStrings(sf::Packet &packet,
+    std::vector<std::unique_ptr<std::string>> &strings)
+{
+    sf::Uint32 count = 0;
+
+    if(!(packet >> count) || count > packet.getDataSize())
+        return false;
+
+    for(sf::Uint32 i = 0; i < count; ++i){
+
+        auto str = std::make_unique<std::string>();
+
+        if(!(packet >> *str))
+            return false;
+
+        strings.push_back(std::move(str));
+    }
+
+    return true;
+}
+
+//! \returns False if the object can't be cached
+static bool WriteCachedObject(sf::Packet &packet, ObjectFileObject &object){
+
+    // Scripts are modules in ScriptExecutor and can't be saved //
+    if(object.GetScript())
+        return false;
+
+    packet << object.IsThisTemplated() << object.GetName() << object.GetTypeName();
+
+    packet << static_cast<sf::Uint32>(object.GetPrefixesCount());
+
+    for(size_t i = 0; i < object.GetPrefixesCount(); ++i)
+        packet << object.GetPrefix(i);
+
+    packet << static_cast<sf::Uint32>(object.GetListCount());
+
+    for(size_t i = 0; i < object.GetListCount(); ++i){
+
+        ObjectFileList* list = object.GetList(i);
+        NamedVars& variables = list->GetVariables();
+
+        packet << list->GetName() << static_cast<sf::Uint32>(variables.GetVariableCount());
+
+        for(size_t a = 0; a < variables.GetVariableCount(); ++a)
+            WriteCachedVariable(packet, *variables.GetValueDirectRaw(a));
+    }
+
+    packet << static_cast<sf::Uint32>(object.GetTextBlockCount());
+
+    for(size_t i = 0; i < object.GetTextBlockCount(); ++i){
+
+        ObjectFileTextBlock* block = object.GetTextBlock(i);
+
+        packet << block->GetName() << static_cast<sf::Uint32>(block->GetLineCount());
+
+        for(size_t a = 0; a < block->GetLineCount(); ++a)
+            packet << block->GetLine(a);
+    }
+
+    return true;
+}
+
+static std::shared_ptr<ObjectFileObject> ReadCachedObject(sf::Packet &packet){
+
+    bool templated = false;
+    std::string name;
+    std::string type;
+    std::vector<std::unique_ptr<std::string>> prefixes;
+
+    if(!(packet >> templated >> name >> type) || !ReadCachedStrings(packet, prefixes))
+        return nullptr;
+
+    std::shared_ptr<ObjectFileObject> object;
+
+    if(templated){
+
+        object = std::make_shared<ObjectFileTemplateObject>(name, type, std::move(prefixes));
+    } else {
+
+        object = std::make_shared<ObjectFileObjectProper>(name, type, std::move(prefixes));
+    }
+
+    sf::Uint32 listcount = 0;
+
+    if(!(packet >> listcount))
+        return nullptr;
+
+    for(sf::Uint32 i = 0; i < listcount; ++i){
+
+        std::string listname;
+        sf::Uint32 variablecount = 0;
+
+        if(!(packet >> listname >> variablecount))
+            return nullptr;
+
+        auto list = std::make_unique<ObjectFileListProper>(listname);
+
+        for(sf::Uint32 a = 0; a < variablecount; ++a){
+
+            auto variable = ReadCachedVariable(packet);
+
+            if(!variable || !list->AddVariable(variable))
+                return nullptr;
+        }
+
+        if(!object->AddVariableList(std::move(list)))
+            return nullptr;
+    }
+
+    sf::Uint32 blockcount = 0;
+
+    if(!(packet >> blockcount))
+        return nullptr;
+
+    for(sf::Uint32 i = 0; i < blockcount; ++i){
+
+        std::string blockname;
+        sf::Uint32 linecount = 0;
+
+        if(!(packet >> blockname >> linecount))
+            return nullptr;
+
+        auto block = std::make_unique<ObjectFileTextBlockProper>(blockname);
+
+        for(sf::Uint32 a = 0; a < linecount; ++a){
+
+            std::string line;
+
+            if(!(packet >> line))
+                return nullptr;
+
+            block->AddTextLine(line);
+        }
+
+        if(!object->AddTextBlock(std::move(block)))
+            return nullptr;
+    }
+
+    return object;
+}
+#endif // OBJECTFILE_CACHE
 // ------------------------------------ //
 void Leviathan::ObjectFileProcessor::Initialize(){
 #if defined(_DEBUG) && !defined(NO_DEFAULT_DATAINDEX)
@@ -69,6 +509,10 @@ void Leviathan::ObjectFileProcessor::Initialize(){
 void Leviathan::ObjectFileProcessor::Release(){
 	// Release our allocated memory //
 	RegisteredValues.clear();
+
+#ifdef OBJECTFILE_CACHE
+    StopCacheWatches();
+#endif // OBJECTFILE_CACHE
 }
 // ------------------------------------ //
 DLLEXPORT  void Leviathan::ObjectFileProcessor::RegisterValue(const std::string &name,
@@ -113,7 +557,38 @@ DLLEXPORT std::unique_ptr<ObjectFile> Leviathan::ObjectFileProcessor::ProcessObj
 		filecontents = filecontents.substr(3, filecontents.size()-3);
 	}
 
+#ifdef OBJECTFILE_CACHE
+    std::string cachefile;
+
+    if(!CacheFolder.empty()){
+
+        cachefile = _GetCacheFile(filecontents);
+
+        auto cached = LoadObjectFileCache(cachefile);
+
+        if(cached){
+
+            WatchForCacheInvalidation(file, cachefile);
+            return cached;
+        }
+    }
+
+    // Files that have errors, like unsupported script blocks, need to be parsed again to
+    // report them
+    ErrorCheckingReporter checkingreporter(reporterror);
+
+    auto result = ProcessObjectFileFromString(filecontents, file, &checkingreporter);
+
+    if(result && !cachefile.empty() && !checkingreporter.HasErrors &&
+        WriteObjectFileCache(*result, cachefile))
+    {
+        WatchForCacheInvalidation(file, cachefile);
+    }
+
+    return result;
+#else
     return ProcessObjectFileFromString(filecontents, file, reporterror);
+#endif // OBJECTFILE_CACHE
 }
 
 DLLEXPORT std::unique_ptr<Leviathan::ObjectFile>
@@ -1097,4 +1572,232 @@ DLLEXPORT bool Leviathan::ObjectFileProcessor::SerializeObjectFile(ObjectFile &d
     receiver += "\n";
     return true;
 }
+// ------------------ Cache ------------------ //
+DLLEXPORT void Leviathan::ObjectFileProcessor::SetCacheFolder(const std::string &folder){
+
+    CacheFolder = folder;
+}
+
+DLLEXPORT std::string Leviathan::ObjectFileProcessor::GetCacheFolder(){
+
+    return CacheFolder;
+}
+
+DLLEXPORT bool Leviathan::ObjectFileProcessor::WriteObjectFileCache(ObjectFile &data,
+    const std::string &file)
+{
+#ifdef OBJECTFILE_CACHE
+    sf::Packet packet;
+
+    packet << OBJECTFILE_CACHE_MAGIC << OBJECTFILE_CACHE_VERSION;
+
+    try{
+
+        NamedVars* variables = data.GetVariables();
+
+        packet << static_cast<sf::Uint32>(variables->GetVariableCount());
+
+        for(size_t i = 0; i < variables->GetVariableCount(); ++i)
+            WriteCachedVariable(packet, *variables->GetValueDirectRaw(i));
+
+        packet << static_cast<sf::Uint32>(data.GetTemplateDefinitionCount());
+
+        for(size_t i = 0; i < data.GetTemplateDefinitionCount(); ++i){
+
+            auto definition = data.GetTemplateDefinition(i);
+
+            packet << definition->GetName();
+            WriteCachedStrings(packet, definition->GetParameters());
+
+            if(!WriteCachedObject(packet, *definition->GetRepresentingObject()))
+                return false;
+        }
+
+        packet << static_cast<sf::Uint32>(data.GetTemplateInstanceCount());
+
+        for(size_t i = 0; i < data.GetTemplateInstanceCount(); ++i){
+
+            auto instance = data.GetTemplateInstance(i);
+
+            packet << instance->GetNameOfParentTemplate();
+            WriteCachedStrings(packet, instance->GetArguments());
+        }
+
+        // The template instances are stored already created so that they don't need to
+        // be generated when loading
+        packet << static_cast<sf::Uint32>(data.GetTotalObjectCount());
+
+        for(size_t i = 0; i < data.GetTotalObjectCount(); ++i){
+
+            if(!WriteCachedObject(packet, *data.GetObject(i)))
+                return false;
+        }
+
+    } catch(const Exception&){
+
+        // Has a type that can't be saved //
+        return false;
+    }
+
+    const std::string folder = StringOperations::GetPath<std::string>(file);
+
+    boost::system::error_code error;
+
+    if(!folder.empty())
+        boost::filesystem::create_directories(folder, error);
+
+    // Written to a temporary file first so that a partially written file isn't loaded //
+    const auto temporary = file + "." +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+    if(!FileSystem::WriteToFile(std::string(static_cast<const char*>(packet.getData()),
+                packet.getDataSize()), temporary))
+    {
+        return false;
+    }
+
+    boost::filesystem::rename(temporary, file, error);
+
+    if(error){
+
+        boost::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif // OBJECTFILE_CACHE
+}
+
+DLLEXPORT std::unique_ptr<ObjectFile> Leviathan::ObjectFileProcessor::LoadObjectFileCache(
+    const std::string &file)
+{
+#ifdef OBJECTFILE_CACHE
+    std::string filecontents;
+
+    if(!FileSystem::FileExists(file) || !FileSystem::ReadFileEntirely(file, filecontents))
+        return nullptr;
+
+    sf::Packet packet;
+    packet.append(filecontents.data(), filecontents.size());
+
+    sf::Uint32 magic = 0;
+    sf::Uint16 version = 0;
+
+    if(!(packet >> magic >> version) || magic != OBJECTFILE_CACHE_MAGIC ||
+        version != OBJECTFILE_CACHE_VERSION)
+    {
+        return nullptr;
+    }
+
+    auto ofile = std::make_unique<ObjectFile>();
+
+    try{
+
+        sf::Uint32 count = 0;
+
+        if(!(packet >> count))
+            return nullptr;
+
+        for(sf::Uint32 i = 0; i < count; ++i){
+
+            auto variable = ReadCachedVariable(packet);
+
+            if(!variable || !ofile->AddNamedVariable(variable))
+                return nullptr;
+        }
+
+        if(!(packet >> count))
+            return nullptr;
+
+        for(sf::Uint32 i = 0; i < count; ++i){
+
+            std::string name;
+            std::vector<std::unique_ptr<std::string>> parameters;
+
+            if(!(packet >> name) || !ReadCachedStrings(packet, parameters))
+                return nullptr;
+
+            auto object = ReadCachedObject(packet);
+
+            if(!object || !ofile->AddTemplate(ObjectFileTemplateDefinition::CreateFromObject(
+                    name, object, parameters)))
+            {
+                return nullptr;
+            }
+        }
+
+        if(!(packet >> count))
+            return nullptr;
+
+        for(sf::Uint32 i = 0; i < count; ++i){
+
+            std::string name;
+            std::vector<std::unique_ptr<std::string>> arguments;
+
+            if(!(packet >> name) || !ReadCachedStrings(packet, arguments))
+                return nullptr;
+
+            ofile->AddTemplateInstance(std::make_shared<ObjectFileTemplateInstance>(name,
+                    arguments));
+        }
+
+        if(!(packet >> count))
+            return nullptr;
+
+        for(sf::Uint32 i = 0; i < count; ++i){
+
+            auto object = ReadCachedObject(packet);
+
+            if(!object || !ofile->AddObject(object))
+                return nullptr;
+        }
+
+    } catch(const Exception&){
+
+        // Invalid value type //
+        return nullptr;
+    }
+
+    if(!packet || !packet.endOfPacket())
+        return nullptr;
+
+    return ofile;
+#else
+    return nullptr;
+#endif // OBJECTFILE_CACHE
+}
+
+#ifdef OBJECTFILE_CACHE
+std::string Leviathan::ObjectFileProcessor::_GetCacheFile(const std::string &filecontents){
+
+    // FNV-1a //
+    uint64_t hash = 14695981039346656037ULL;
+
+    const auto addtohash = [&](const char* data, size_t length){
+
+        for(size_t i = 0; i < length; ++i){
 
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    for(const auto& registered : RegisteredValues){
+
+        sf::Packet value;
+        value << registered.first;
+        registered.second->AddDataToPacket(value);
+
+        addtohash(static_cast<const char*>(value.getData()), value.getDataSize());
+    }
+
+    addtohash(filecontents.data(), filecontents.size());
+
+    std::stringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << hash << ".levofc";
+
+    return (boost::filesystem::path(CacheFolder) / stream.str()).string();
+}
+#endif // OBJECTFILE_CACHE
@@ -21,6 +21,10 @@ public:
     DLLEXPORT static void Release();
 
     //! \brief Reads an ObjectFile to an in-memory data structure
+    //!
+    //! If the cache folder is set the parsed file is also written there in a binary form,
+    //! which is loaded instead of parsing the file again when it hasn't changed
+    //! \see SetCacheFolder
     DLLEXPORT static std::unique_ptr<ObjectFile> ProcessObjectFile(const std::string &file, 
         LErrorReporter* reporterror);
 
@@ -44,6 +48,24 @@ public:
     //! \returns True if succeeds, false if the object failed to be serialized for some reason
     DLLEXPORT static bool SerializeObjectFile(ObjectFile &data, std::string &receiver);
 
+    //! \brief Writes an ObjectFile in the binary format used by the cache
+    //! \returns False if the file can't be cached (it has scripts) or writing fails
+    DLLEXPORT static bool WriteObjectFileCache(ObjectFile &data, const std::string &file);
+
+    //! \brief Loads an ObjectFile written by WriteObjectFileCache
+    //! \returns Null if the file is missing, isn't valid or was written by a different
+    //! version
+    DLLEXPORT static std::unique_ptr<ObjectFile> LoadObjectFileCache(const std::string &file);
+
+    //! \brief Sets the folder where ProcessObjectFile caches parsed files
+    //!
+    //! The cached files are named by a hash of the source file contents so a changed file
+    //! is always parsed again. If ResourceRefreshHandler is running the old cached file is
+    //! removed when the source file changes. Use an empty string to disable the cache
+    //! \note Files that have script blocks are never cached
+    DLLEXPORT static void SetCacheFolder(const std::string &folder);
+    DLLEXPORT static std::string GetCacheFolder();
+
     //! \brief Registers a new value alias for the processor
     //! \warning Calling this while files are being parsed will cause undefined behavior
     DLLEXPORT static void RegisterValue(const std::string &name, VariableBlock* valuetokeep);
@@ -221,7 +243,14 @@ private:
     static bool TryToLoadScriptBlock(const std::string &file, StringIterator &itr,
         ObjectFileObject &obj, size_t startline, LErrorReporter* reporterror);
 
+    //! \brief Gets the cache file for a source file
+    //!
+    //! The registered values are part of the hash as they are replaced while parsing
+    static std::string _GetCacheFile(const std::string &filecontents);
+
     static std::map<std::string, std::shared_ptr<VariableBlock>> RegisteredValues;
+
+    static std::string CacheFolder;
 };
 
 }
@@ -0,0 +1,409 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Leviathan {
+
+//! \brief Statistics of an InvokeQueue
+struct InvokeQueueMetrics {
+
+    //! Number of functions waiting to be ran
+    size_t Depth = 0;
+
+    //! Largest Depth seen when a function was queued
+    size_t MaxDepth = 0;
+
+    //! Total number of functions that have been ran
+    uint64_t Executed = 0;
+
+    //! Number of functions that didn't fit in the ring buffer
+    uint64_t Overflowed = 0;
+
+    //! Time from queuing to running a function. Sampled from every LATENCY_SAMPLE_INTERVAL
+    //! function
+    int64_t AverageLatencyMicroseconds = 0;
+    int64_t MaxLatencyMicroseconds = 0;
+};
+
+//! \brief Queue of functions that any thread can add to and a single thread runs
+//!
+//! The functions are stored in a bounded ring buffer (Dmitry Vyukov's bounded queue with a
+//! sequence number in each cell) so queuing doesn't lock or allocate when the callable
+//! fits in INLINE_SIZE bytes. The consumer runs the functions in place and processes all
+//! the ready cells in one batch. If the ring buffer is full functions go to a locked
+//! overflow list, so queuing never blocks and a function can always queue more functions.
+//! Functions queued by one thread always run in the order they were queued
+class InvokeQueue {
+public:
+    //! Callables up to this size are stored in the ring buffer without allocating
+    static constexpr size_t INLINE_SIZE = 56;
+
+    //! Reading the clock costs more than queuing so only some functions are timed
+    static constexpr size_t LATENCY_SAMPLE_INTERVAL = 16;
+
+    using Clock = std::chrono::steady_clock;
+
+private:
+    //! \brief Type erased storage for a callable
+    class Function {
+    public:
+        Function() = default;
+
+        Function(const Function& other) = delete;
+        Function& operator=(const Function& other) = delete;
+
+        ~Function()
+        {
+            Reset();
+        }
+
+        template<class Callable>
+        void Set(Callable&& callable)
+        {
+            using StoredType = std::decay_t<Callable>;
+
+            if constexpr(sizeof(StoredType) <= INLINE_SIZE &&
+                         alignof(StoredType) <= alignof(std::max_align_t)) {
+
+                new(Storage) StoredType(std::forward<Callable>(callable));
+
+                Call = [](void* storage) { (*static_cast<StoredType*>(storage))(); };
+                Destroy = [](void* storage) {
+                    static_cast<StoredType*>(storage)->~StoredType();
+                };
+
+            } else {
+
+                // Too large, only a pointer is stored //
+                new(Storage) StoredType*(new StoredType(std::forward<Callable>(callable)));
+
+                Call = [](void* storage) { (**static_cast<StoredType**>(storage))(); };
+                Destroy = [](void* storage) { delete *static_cast<StoredType**>(storage); };
+            }
+        }
+
+        inline void operator()()
+        {
+            Call(Storage);
+        }
+
+        inline void Reset()
+        {
+            if(Destroy) {
+                Destroy(Storage);
+                Destroy = nullptr;
+                Call = nullptr;
+            }
+        }
+
+    private:
+        alignas(std::max_align_t) unsigned char Storage[INLINE_SIZE];
+
+        void (*Call)(void*) = nullptr;
+        void (*Destroy)(void*) = nullptr;
+    };
+
+    struct Cell {
+
+        //! Equals the position when the cell is free to write and position + 1 when it holds
+        //! a function
+        std::atomic<size_t> Sequence;
+
+        //! Only set for the functions that are sampled for latency
+        Clock::time_point Queued;
+        Function Callable;
+    };
+
+    //! \brief Function that went to the overflow list
+    struct OverflowFunction {
+
+        Clock::time_point Queued;
+        std::unique_ptr<Function> Callable;
+    };
+
+public:
+    //! \param capacity Size of the ring buffer, rounded up to a power of two
+    InvokeQueue(size_t capacity = 1024)
+    {
+        size_t size = 2;
+
+        while(size < capacity)
+            size *= 2;
+
+        Mask = size - 1;
+        Cells.reset(new Cell[size]);
+
+        for(size_t i = 0; i < size; ++i)
+            Cells[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+
+    InvokeQueue(const InvokeQueue& other) = delete;
+    InvokeQueue& operator=(const InvokeQueue& other) = delete;
+
+    //! \brief Adds a function to be ran. Can be called from any thread
+    template<class Callable>
+    void Push(Callable&& callable)
+    {
+        // Once something is in the overflow everything needs to go there until the consumer
+        // takes it to keep the order //
+        if(!HasOverflow.load(std::memory_order_acquire)) {
+
+            size_t position = EnqueuePosition.load(std::memory_order_relaxed);
+
+            while(true) {
+
+                Cell& cell = Cells[position & Mask];
+                const size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+
+                const auto difference = static_cast<std::ptrdiff_t>(sequence) -
+                                        static_cast<std::ptrdiff_t>(position);
+
+                if(difference == 0) {
+
+                    if(EnqueuePosition.compare_exchange_weak(
+                           position, position + 1, std::memory_order_relaxed)) {
+
+                        cell.Queued = (position % LATENCY_SAMPLE_INTERVAL) == 0 ?
+                                          Clock::now() :
+                                          Clock::time_point();
+                        cell.Callable.Set(std::forward<Callable>(callable));
+                        cell.Sequence.store(position + 1, std::memory_order_release);
+
+                        _UpdateMaxDepth();
+                        return;
+                    }
+
+                } else if(difference < 0) {
+
+                    // Full //
+                    break;
+
+                } else {
+
+                    position = EnqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        auto function = std::make_unique<Function>();
+        function->Set(std::forward<Callable>(callable));
+
+        const auto overflowed = OverflowedCount.fetch_add(1, std::memory_order_relaxed);
+
+        const auto queued = (overflowed % LATENCY_SAMPLE_INTERVAL) == 0 ?
+                                Clock::now() :
+                                Clock::time_point();
+
+        {
+            std::lock_guard<std::mutex> lock(OverflowMutex);
+            Overflow.push_back(OverflowFunction{queued, std::move(function)});
+            OverflowSize.store(Overflow.size(), std::memory_order_relaxed);
+            HasOverflow.store(true, std::memory_order_release);
+        }
+
+        _UpdateMaxDepth();
+    }
+
+    //! \brief Runs all the queued functions, including ones queued while running
+    //! \warning Only one thread may call this at a time
+    void RunAll()
+    {
+        while(true) {
+
+            bool ransomething = _RunReadyCells();
+
+            if(HasOverflow.load(std::memory_order_acquire)) {
+
+                std::vector<OverflowFunction> overflow;
+                size_t queuedbefore;
+
+                {
+                    std::lock_guard<std::mutex> lock(OverflowMutex);
+                    overflow.swap(Overflow);
+                    OverflowSize.store(0, std::memory_order_relaxed);
+
+                    // Every cell reserved before these went to the overflow is below this.
+                    // Cells reserved after the flag is cleared may need to run after these
+                    queuedbefore = EnqueuePosition.load(std::memory_order_relaxed);
+                    HasOverflow.store(false, std::memory_order_release);
+                }
+
+                // Cells that are reserved but not yet written need to be waited for to keep
+                // the order from each thread //
+                while(DequeuePosition != queuedbefore) {
+
+                    if(!_RunReadyCells(queuedbefore))
+                        std::this_thread::yield();
+                }
+
+                for(auto& function : overflow) {
+
+                    _RecordLatency(function.Queued);
+                    (*function.Callable)();
+                }
+
+                ransomething = ransomething || !overflow.empty();
+            }
+
+            if(!ransomething)
+                return;
+        }
+    }
+
+    //! \returns The current statistics. Can be called from any thread
+    InvokeQueueMetrics GetMetrics() const
+    {
+        InvokeQueueMetrics metrics;
+
+        metrics.Depth = _GetDepth();
+        metrics.MaxDepth = MaxDepth.load(std::memory_order_relaxed);
+        metrics.Executed = ExecutedCount.load(std::memory_order_relaxed);
+        metrics.Overflowed = OverflowedCount.load(std::memory_order_relaxed);
+        metrics.MaxLatencyMicroseconds = MaxLatency.load(std::memory_order_relaxed);
+
+        const auto samples = LatencySamples.load(std::memory_order_relaxed);
+
+        if(samples > 0) {
+            metrics.AverageLatencyMicroseconds =
+                TotalLatency.load(std::memory_order_relaxed) / static_cast<int64_t>(samples);
+        }
+
+        return metrics;
+    }
+
+    //! \returns The size of the ring buffer
+    size_t GetCapacity() const
+    {
+        return Mask + 1;
+    }
+
+private:
+    //! \param end Position to stop at, cells from there on are left in the queue
+    //! \returns True if something was ran
+    bool _RunReadyCells(size_t end = std::numeric_limits<size_t>::max())
+    {
+        bool ransomething = false;
+
+        while(DequeuePosition != end) {
+
+            Cell& cell = Cells[DequeuePosition & Mask];
+
+            if(cell.Sequence.load(std::memory_order_acquire) != DequeuePosition + 1)
+                return ransomething;
+
+            // Frees the cell even if the function throws //
+            struct CellReleaser {
+                ~CellReleaser()
+                {
+                    ReleasedCell.Callable.Reset();
+                    ReleasedCell.Sequence.store(
+                        Position + Capacity, std::memory_order_release);
+                }
+
+                Cell& ReleasedCell;
+                size_t Position;
+                size_t Capacity;
+            } releaser{cell, DequeuePosition, Mask + 1};
+
+            ++DequeuePosition;
+            DequeuedCount.store(DequeuePosition, std::memory_order_relaxed);
+
+            _RecordLatency(cell.Queued);
+            ransomething = true;
+
+            cell.Callable();
+        }
+
+        return ransomething;
+    }
+
+    void _RecordLatency(Clock::time_point queued)
+    {
+        // Only the consumer writes these so plain stores are enough //
+        ExecutedCount.store(
+            ExecutedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        if(queued == Clock::time_point())
+            return;
+
+        const auto latency =
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - queued)
+                .count();
+
+        LatencySamples.store(
+            LatencySamples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        TotalLatency.store(TotalLatency.load(std::memory_order_relaxed) + latency,
+            std::memory_order_relaxed);
+
+        if(latency > MaxLatency.load(std::memory_order_relaxed))
+            MaxLatency.store(latency, std::memory_order_relaxed);
+    }
+
+    size_t _GetDepth() const
+    {
+        const size_t queued = EnqueuePosition.load(std::memory_order_relaxed);
+        const size_t dequeued = DequeuedCount.load(std::memory_order_relaxed);
+
+        return (queued > dequeued ? queued - dequeued : 0) +
+               OverflowSize.load(std::memory_order_relaxed);
+    }
+
+    void _UpdateMaxDepth()
+    {
+        const size_t depth = _GetDepth();
+        size_t previous = MaxDepth.load(std::memory_order_relaxed);
+
+        while(depth > previous &&
+              !MaxDepth.compare_exchange_weak(previous, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    std::unique_ptr<Cell[]> Cells;
+    size_t Mask;
+
+    // Producers and the consumer use different cache lines //
+    alignas(64) std::atomic<size_t> EnqueuePosition = {0};
+
+    //! Only touched by the consumer
+    alignas(64) size_t DequeuePosition = 0;
+
+    //! Copy of DequeuePosition for GetMetrics
+    std::atomic<size_t> DequeuedCount = {0};
+
+    std::atomic<bool> HasOverflow = {false};
+    std::mutex OverflowMutex;
+    std::vector<OverflowFunction> Overflow;
+
+    //! Size of Overflow that can be read without locking
+    std::atomic<size_t> OverflowSize = {0};
+
+    // Metrics //
+    std::atomic<size_t> MaxDepth = {0};
+    std::atomic<uint64_t> ExecutedCount = {0};
+    std::atomic<uint64_t> OverflowedCount = {0};
+    std::atomic<uint64_t> LatencySamples = {0};
+    std::atomic<int64_t> TotalLatency = {0};
+    std::atomic<int64_t> MaxLatency = {0};
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::InvokeQueue;
+using Leviathan::InvokeQueueMetrics;
+#endif
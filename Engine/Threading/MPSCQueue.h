@@ -0,0 +1,130 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <atomic>
+#include <utility>
+
+namespace Leviathan {
+
+//! \brief Unbounded lock-free queue with any number of producers and a single consumer
+//!
+//! This is Dmitry Vyukov's intrusive MPSC node queue. Push is wait-free (one exchange) and
+//! Pop only touches the consumer end so producers never contend with the consumer.
+//! \note Pop may briefly report empty while a Push is in the middle of linking its node,
+//! the item becomes visible once that Push returns
+template<class ElementType>
+class MPSCQueue {
+    struct Node {
+
+        Node() = default;
+
+        template<class... Args>
+        Node(Args&&... args) : Value(std::forward<Args>(args)...)
+        {
+        }
+
+        std::atomic<Node*> Next = {nullptr};
+        ElementType Value;
+    };
+
+public:
+    MPSCQueue() : Head(&Stub), Tail(&Stub) {}
+
+    ~MPSCQueue()
+    {
+        ElementType discard;
+        while(Pop(discard)) {
+        }
+    }
+
+    MPSCQueue(const MPSCQueue& other) = delete;
+    MPSCQueue& operator=(const MPSCQueue& other) = delete;
+
+    //! \brief Adds an item to the back of the queue. Can be called from any thread
+    template<class... Args>
+    void Push(Args&&... args)
+    {
+        _PushNode(new Node(std::forward<Args>(args)...));
+    }
+
+    //! \brief Takes the item at the front of the queue
+    //! \returns False if the queue was empty
+    //! \warning Only one thread may call this at a time
+    bool Pop(ElementType& result)
+    {
+        Node* tail = Tail;
+        Node* next = tail->Next.load(std::memory_order_acquire);
+
+        // Skip the stub node //
+        if(tail == &Stub) {
+
+            if(!next)
+                return false;
+
+            Tail = next;
+            tail = next;
+            next = next->Next.load(std::memory_order_acquire);
+        }
+
+        if(next) {
+
+            Tail = next;
+            result = std::move(tail->Value);
+            delete tail;
+            return true;
+        }
+
+        // tail is the last node, it can only be taken if no push is in progress //
+        if(tail != Head.load(std::memory_order_acquire))
+            return false;
+
+        // Put the stub back so that tail has a successor //
+        _PushNode(&Stub);
+
+        next = tail->Next.load(std::memory_order_acquire);
+
+        if(next) {
+
+            Tail = next;
+            result = std::move(tail->Value);
+            delete tail;
+            return true;
+        }
+
+        return false;
+    }
+
+    //! \returns True if there is nothing to pop
+    //! \note Only reliable when called by the consumer
+    bool IsEmpty() const
+    {
+        const Node* tail = Tail;
+
+        if(tail == &Stub)
+            return tail->Next.load(std::memory_order_acquire) == nullptr;
+
+        return false;
+    }
+
+private:
+    void _PushNode(Node* node)
+    {
+        node->Next.store(nullptr, std::memory_order_relaxed);
+
+        Node* previous = Head.exchange(node, std::memory_order_acq_rel);
+        previous->Next.store(node, std::memory_order_release);
+    }
+
+private:
+    //! Producers add nodes here
+    std::atomic<Node*> Head;
+
+    //! Only touched by the consumer
+    Node* Tail;
+
+    Node Stub;
+};
+
+} // namespace Leviathan
@@ -41,6 +41,12 @@ DLLEXPORT bool Leviathan::QueuedTask::MustBeRanBefore(int eventtypeidentifier){
 DLLEXPORT bool Leviathan::QueuedTask::IsRepeating(){
 	return false;
 }
+
+DLLEXPORT bool Leviathan::QueuedTask::GetNextRunTime(
+    WantedClockType::time_point &runtime) const
+{
+    return false;
+}
 // ------------------ QueuedTaskCheckValues ------------------ //
 Leviathan::QueuedTaskCheckValues::QueuedTaskCheckValues() :
     CurrentTime(Time::GetThreadSafeSteadyTimePoint())
@@ -91,6 +97,13 @@ DLLEXPORT bool Leviathan::ConditionalDelayedTask::CanBeRan(
 	// Run the checking function //
 	return TaskCheckingFunc();
 }
+
+DLLEXPORT bool Leviathan::ConditionalDelayedTask::GetNextRunTime(
+    WantedClockType::time_point &runtime) const
+{
+    runtime = CheckingTime;
+    return true;
+}
 // ------------------ DelayedTask ------------------ //
 DLLEXPORT Leviathan::DelayedTask::DelayedTask(std::function<void ()> functorun,
     const MicrosecondDuration &delaytime) : QueuedTask(functorun),
@@ -116,6 +129,13 @@ DLLEXPORT bool Leviathan::DelayedTask::CanBeRan(
 	// Check is the current time past our timestamp //
 	return checkvalues->CurrentTime >= ExecutionTime;
 }
+
+DLLEXPORT bool Leviathan::DelayedTask::GetNextRunTime(
+    WantedClockType::time_point &runtime) const
+{
+    runtime = ExecutionTime;
+    return true;
+}
 // ------------------ RepeatingDelayedTask ------------------ //
 DLLEXPORT Leviathan::RepeatingDelayedTask::RepeatingDelayedTask(
     std::function<void ()> functorun, const MicrosecondDuration &bothdelays) :
@@ -210,6 +230,13 @@ DLLEXPORT bool Leviathan::RepeatCountedDelayedTask::CanBeRan(
 	return checkvalues->CurrentTime >= ExecutionTime;
 }
 
+DLLEXPORT bool Leviathan::RepeatCountedDelayedTask::GetNextRunTime(
+    WantedClockType::time_point &runtime) const
+{
+    runtime = ExecutionTime;
+    return true;
+}
+
 void Leviathan::RepeatCountedDelayedTask::_PostFunctionRun(){
 	// Set new execution point in time //
 	ExecutionTime = Time::GetThreadSafeSteadyTimePoint()+TimeBetweenExecutions;
@@ -2,6 +2,7 @@
 // ------------------------------------ //
 #include "Define.h"
 // ------------------------------------ //
+#include <atomic>
 #include <functional>
 #include "../TimeIncludes.h"
 
@@ -32,6 +33,7 @@ namespace Leviathan{
 	//! \warning Function passed to this class should be thread safe
 	//! \warning This is not explicitly thread safe, it might be through std::Thread
 	class QueuedTask{
+        friend ThreadingManager;
 	public:
 		//! Takes in the function which is ran when the Task is ran
 		DLLEXPORT QueuedTask(std::function<void ()> functorun);
@@ -63,7 +65,27 @@ namespace Leviathan{
         //! implement an execution times monitor
 		DLLEXPORT virtual bool IsRepeating();
 
+        //! \brief Function called by ThreadingManager to find out when the task can be
+        //! checked with CanBeRan next
+        //!
+        //! Tasks that return a time in the future are kept in a timer wheel until then
+        //! instead of being polled
+        //! \return By default false meaning that the task doesn't have a time. Child classes
+        //! with a delay set runtime and return true
+        DLLEXPORT virtual bool GetNextRunTime(WantedClockType::time_point &runtime) const;
+
 	private:
+        //! \brief Where the task is in ThreadingManager
+        enum class SCHEDULING_STATE : int{
+            //! Not queued or finished
+            Idle,
+            //! In a queue or the timer wheel
+            Queued,
+            Running,
+            //! Removed with RemoveFromQueue while queued, will be dropped once it is found
+            Cancelled
+        };
+
 		//! \brief Provided for child classes to do something before running the function
 		virtual void _PreFunctionRun();
 		//! \brief Provides child classes a way to execute after running the function
@@ -73,6 +95,8 @@ namespace Leviathan{
 		//! The function to run
 		std::function<void ()> FunctionToRun;
 
+        //! Used by ThreadingManager to support removing tasks from lock-free queues
+        std::atomic<SCHEDULING_STATE> SchedulingState = {SCHEDULING_STATE::Idle};
 	};
 
 	// ------------------ Specialized QueuedTasks for common operations ------------------ //
@@ -113,6 +137,9 @@ namespace Leviathan{
 		//! \brief Calls the checking function to see if the task can be ran
 		DLLEXPORT virtual bool CanBeRan(const QueuedTaskCheckValues* const checkvalues);
 
+        //! \brief Returns the next time the checking function will be called
+        DLLEXPORT virtual bool GetNextRunTime(WantedClockType::time_point &runtime) const;
+
 	protected:
 
 		//! The function for checking if the task is allowed to be run
@@ -145,6 +172,9 @@ namespace Leviathan{
         //! Controlled by the value of ExecutionTime
         DLLEXPORT virtual bool CanBeRan(const QueuedTaskCheckValues* const checkvalues);
 
+        //! \brief Returns ExecutionTime
+        DLLEXPORT virtual bool GetNextRunTime(WantedClockType::time_point &runtime) const;
+
 	protected:
 
 		//! The time after which this task may be ran
@@ -259,6 +289,9 @@ namespace Leviathan{
         //!
         //! Controlled by the value of ExecutionTime
         DLLEXPORT virtual bool CanBeRan(const QueuedTaskCheckValues* const checkvalues);
+
+        //! \brief Returns ExecutionTime
+        DLLEXPORT virtual bool GetNextRunTime(WantedClockType::time_point &runtime) const;
         
 	protected:
 		//! \brief Used to update the time when to run the task again
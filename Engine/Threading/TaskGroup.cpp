@@ -0,0 +1,86 @@
+// ------------------------------------ //
+#include "TaskGroup.h"
+
+#include "ThreadingManager.h"
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT TaskGroup::TaskGroup(ThreadingManager* manager) :
+    Manager(manager), State(std::make_shared<SharedState>())
+{
+}
+
+DLLEXPORT TaskGroup::TaskGroup() : TaskGroup(ThreadingManager::Get()) {}
+
+DLLEXPORT TaskGroup::~TaskGroup()
+{
+    try {
+        Wait();
+    } catch(...) {
+    }
+}
+// ------------------------------------ //
+DLLEXPORT void TaskGroup::Run(std::function<void()> func)
+{
+    if(!Manager) {
+
+        try {
+            func();
+        } catch(...) {
+            std::lock_guard<std::mutex> lock(State->Mutex);
+
+            if(!State->Error)
+                State->Error = std::current_exception();
+        }
+
+        return;
+    }
+
+    State->Pending.fetch_add(1, std::memory_order_relaxed);
+
+    auto state = State;
+
+    Manager->QueueTask(std::make_shared<QueuedTask>([state, func{std::move(func)}]() {
+        std::exception_ptr error;
+
+        try {
+            func();
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(state->Mutex);
+
+        if(error && !state->Error)
+            state->Error = error;
+
+        if(state->Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            state->Finished.notify_all();
+    }));
+}
+
+DLLEXPORT void TaskGroup::Wait()
+{
+    // Help with the queued tasks while waiting. Not finding a task doesn't mean that the
+    // rest of this group is running elsewhere. Starting tasks can be disallowed or another
+    // thread can be just about to take the task, so the sleep is short and then tasks are
+    // looked for again. Otherwise waiting from tasks could block all the workers
+    while(!IsDone()) {
+
+        if(Manager && Manager->TryRunOneTask())
+            continue;
+
+        std::unique_lock<std::mutex> lock(State->Mutex);
+
+        State->Finished.wait_for(lock, std::chrono::milliseconds(TASK_GROUP_WAIT_RETRY_MS),
+            [this]() { return IsDone(); });
+    }
+
+    std::lock_guard<std::mutex> lock(State->Mutex);
+
+    if(State->Error) {
+
+        auto error = State->Error;
+        State->Error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,80 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Leviathan {
+
+//! How long TaskGroup::Wait sleeps before looking for a task to run again
+constexpr auto TASK_GROUP_WAIT_RETRY_MS = 1;
+
+//! \brief A set of tasks that can be waited on together
+//!
+//! Usage:
+//! \code
+//! TaskGroup group;
+//! group.Run([&](){ UpdateFirstHalf(); });
+//! group.Run([&](){ UpdateSecondHalf(); });
+//! group.Wait();
+//! \endcode
+//! Wait runs queued tasks on the calling thread until the group is done and keeps looking
+//! for more while the rest are running elsewhere, so it is safe to use from within a task.
+//! \warning If the ThreadingManager is stopped before the queued tasks of a group run,
+//! Wait never returns
+class TaskGroup {
+    struct SharedState {
+
+        std::atomic<size_t> Pending = {0};
+
+        std::mutex Mutex;
+        std::condition_variable Finished;
+        std::exception_ptr Error;
+    };
+
+public:
+    //! \param manager The manager to run the tasks with. If null the tasks are ran
+    //! immediately in Run
+    DLLEXPORT TaskGroup(ThreadingManager* manager);
+
+    //! \brief Uses ThreadingManager::Get()
+    DLLEXPORT TaskGroup();
+
+    //! \brief Waits for the tasks. Exceptions from the tasks are lost if Wait isn't called
+    DLLEXPORT ~TaskGroup();
+
+    TaskGroup(const TaskGroup& other) = delete;
+    TaskGroup& operator=(const TaskGroup& other) = delete;
+
+    //! \brief Queues a function to run as part of this group
+    DLLEXPORT void Run(std::function<void()> func);
+
+    //! \brief Blocks until all functions given to Run have finished
+    //! \exception The first exception thrown by a function in this group
+    DLLEXPORT void Wait();
+
+    //! \returns True if there are no unfinished functions
+    inline bool IsDone() const
+    {
+        return State->Pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    ThreadingManager* const Manager;
+
+    //! Kept alive by the queued tasks as well
+    std::shared_ptr<SharedState> State;
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::TaskGroup;
+#endif
@@ -2,10 +2,12 @@
 // ------------------------------------ //
 #include "Define.h"
 // ------------------------------------ //
-#include <thread>
-#include "Common/ThreadSafe.h"
 #include "QueuedTask.h"
-#include <condition_variable>
+#include "WorkStealingDeque.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
 
 namespace Leviathan{
 
@@ -18,55 +20,64 @@ namespace Leviathan{
         std::shared_ptr<QueuedTask> QuickTaskAccess;
 	};
 
-	//! \brief Object used by ThreadingManager to easily create properly initialized threads
-	class TaskThread : public ThreadSafe{
+    //! \brief Queued task as stored in the lock-free deques
+    //!
+    //! The deques need trivially copyable elements so tasks are boxed. Whoever takes the box
+    //! out of a deque deletes it
+    using BoxedTask = std::shared_ptr<QueuedTask>*;
+
+	//! \brief Worker thread of ThreadingManager
+	//!
+	//! Each worker has its own deque of tasks. Tasks queued from a worker go to its own
+	//! deque and idle workers steal from the other workers
+	class TaskThread{
 		friend void RunNewThread(TaskThread* thisthread);
 	public:
-		//! \warning this may only be called by the main thread and while no tasks are running,
-        //! since this will register the thread in various places
-		DLLEXPORT TaskThread();
+		//! \warning this may only be called by the ThreadingManager
+		DLLEXPORT TaskThread(ThreadingManager* owner, size_t index);
 
+		//! \pre ThreadingManager has told the workers to stop
 		DLLEXPORT ~TaskThread();
 
-		DLLEXPORT void SetTaskAndNotify(std::shared_ptr<QueuedTask> task);
-
-		DLLEXPORT void NotifyKill(Lock &guard);
-		DLLEXPORT void NotifyKill();
+		//! \brief Returns true if the thread has performed initialization
+		DLLEXPORT bool HasStarted() const;
 
-		DLLEXPORT void NotifyThread();
+		inline ThreadingManager* GetOwner() const{
+			return Owner;
+		}
 
-		//! \brief Returns true if the thread has performed initialization
-		DLLEXPORT bool HasStarted();
-        
-		//! \brief Returns true if the thread has a task to run
-		DLLEXPORT bool HasRunningTask();
+		//! \brief Returns the index of this thread in its ThreadingManager
+		inline size_t GetIndex() const{
+			return Index;
+		}
 
-        //! \brief Returns true if the current task pointer matches the argument
-        DLLEXPORT bool IsRunningTask(std::shared_ptr<QueuedTask> task) const;
+		//! \brief Returns the deque of this worker, only this thread may push and pop
+		inline WorkStealingDeque<BoxedTask>& GetQueue(){
+			return Queue;
+		}
 
 		//! \brief Returns the internal ThisThread variable
 		DLLEXPORT std::thread& GetInternalThreadObject();
 
 		//! \brief Returns thread specific data about QueuedTask and TaskThread object
+		//!
+		//! Threads that aren't workers also get an object as they can run tasks while
+		//! waiting for them. ThreadObject is null in that case
 		DLLEXPORT static ThreadSpecificData* GetThreadSpecificThreadObject();
 
-
-
 	private:
 
-		void _NewThreadEntryRegister(Lock &guard);
-		void _ThreadEndClean(Lock &guard);
+		void _NewThreadEntryRegister();
+		void _ThreadEndClean();
 
 		// ------------------------------------ //
 
-		// For notifying the thread //
-		std::condition_variable ThreadNotify;
+		ThreadingManager* const Owner;
+		const size_t Index;
 
-		// The task needed to be completed //
-        std::shared_ptr<QueuedTask> SetTask;
+		WorkStealingDeque<BoxedTask> Queue;
 
-		bool StartUpDone;
-		bool KillSelf;
+		std::atomic<bool> StartUpDone = {false};
 		std::thread ThisThread;
 
 		// Stores the thread object for the thread to access //
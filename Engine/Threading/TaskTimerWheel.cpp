@@ -0,0 +1,133 @@
+// ------------------------------------ //
+#include "TaskTimerWheel.h"
+
+#include "QueuedTask.h"
+
+#include <algorithm>
+#include <limits>
+using namespace Leviathan;
+// ------------------------------------ //
+DLLEXPORT TaskTimerWheel::TaskTimerWheel(const MicrosecondDuration& tickduration,
+    size_t slotcount, const WantedClockType::time_point& start) :
+    TickDuration(std::max(tickduration, MicrosecondDuration(1))),
+    Start(start), Slots(std::max<size_t>(slotcount, 1))
+{
+}
+// ------------------------------------ //
+int64_t TaskTimerWheel::_TickOf(const WantedClockType::time_point& time) const
+{
+    const auto sinceStart =
+        std::chrono::duration_cast<MicrosecondDuration>(time - Start).count();
+
+    if(sinceStart < 0)
+        return 0;
+
+    return sinceStart / TickDuration.count();
+}
+
+DLLEXPORT void TaskTimerWheel::Add(
+    std::shared_ptr<QueuedTask> task, const WantedClockType::time_point& due)
+{
+    // Rounded up so that the task isn't expired before its time //
+    int64_t dueTick = _TickOf(due + TickDuration - MicrosecondDuration(1));
+
+    if(dueTick <= CurrentTick)
+        dueTick = CurrentTick + 1;
+
+    Slots[static_cast<size_t>(dueTick % Slots.size())].push_back(
+        Entry{std::move(task), dueTick});
+
+    ++TaskCount;
+}
+
+DLLEXPORT void TaskTimerWheel::Advance(
+    const WantedClockType::time_point& now, std::vector<std::shared_ptr<QueuedTask>>& expired)
+{
+    const int64_t nowTick = _TickOf(now);
+
+    if(nowTick <= CurrentTick)
+        return;
+
+    // Each slot needs to be checked at most once even if a lot of time has passed //
+    const int64_t slotCount = static_cast<int64_t>(Slots.size());
+    const int64_t lastTick = std::min(nowTick, CurrentTick + slotCount);
+
+    for(int64_t tick = CurrentTick + 1; tick <= lastTick; ++tick) {
+
+        auto& slot = Slots[static_cast<size_t>(tick % slotCount)];
+
+        for(size_t i = 0; i < slot.size();) {
+
+            if(slot[i].DueTick <= nowTick) {
+
+                expired.push_back(std::move(slot[i].Task));
+
+                slot[i] = std::move(slot.back());
+                slot.pop_back();
+                --TaskCount;
+
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    CurrentTick = nowTick;
+}
+
+DLLEXPORT bool TaskTimerWheel::Remove(const QueuedTask* task)
+{
+    for(auto& slot : Slots) {
+        for(size_t i = 0; i < slot.size(); ++i) {
+
+            if(slot[i].Task.get() == task) {
+
+                slot[i] = std::move(slot.back());
+                slot.pop_back();
+                --TaskCount;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+DLLEXPORT void TaskTimerWheel::Clear(std::vector<std::shared_ptr<QueuedTask>>& removed)
+{
+    for(auto& slot : Slots) {
+
+        for(auto& entry : slot)
+            removed.push_back(std::move(entry.Task));
+
+        slot.clear();
+    }
+
+    TaskCount = 0;
+}
+// ------------------------------------ //
+DLLEXPORT bool TaskTimerWheel::GetNextWakeTime(WantedClockType::time_point& wake) const
+{
+    if(TaskCount == 0)
+        return false;
+
+    const int64_t slotCount = static_cast<int64_t>(Slots.size());
+
+    // Entries in the slot of a tick are due on that tick or whole revolutions later so the
+    // scan can stop once it reaches the earliest tick seen so far
+    int64_t earliest = std::numeric_limits<int64_t>::max();
+
+    for(int64_t tick = CurrentTick + 1; tick <= CurrentTick + slotCount; ++tick) {
+
+        const auto& slot = Slots[static_cast<size_t>(tick % slotCount)];
+
+        for(const auto& entry : slot)
+            earliest = std::min(earliest, entry.DueTick);
+
+        if(earliest <= tick)
+            break;
+    }
+
+    wake = Start + TickDuration * earliest;
+    return true;
+}
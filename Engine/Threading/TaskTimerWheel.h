@@ -0,0 +1,74 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include "../TimeIncludes.h"
+
+#include <memory>
+#include <vector>
+
+namespace Leviathan {
+
+class QueuedTask;
+
+//! \brief Hashed timer wheel used by ThreadingManager for tasks that can't run yet
+//!
+//! Time is split into ticks and each tick maps to one slot. Adding a task and expiring a
+//! tick are constant time unlike keeping all the waiting tasks in a sorted container. Tasks
+//! further away than one revolution stay in their slot until their tick comes around
+//! \note This is not thread safe, ThreadingManager locks it
+class TaskTimerWheel {
+    struct Entry {
+
+        std::shared_ptr<QueuedTask> Task;
+        int64_t DueTick;
+    };
+
+public:
+    DLLEXPORT TaskTimerWheel(const MicrosecondDuration& tickduration, size_t slotcount,
+        const WantedClockType::time_point& start);
+
+    //! \brief Adds a task that will be expired once time reaches due
+    DLLEXPORT void Add(std::shared_ptr<QueuedTask> task, const WantedClockType::time_point& due);
+
+    //! \brief Moves the tasks that are due at or before now to expired
+    DLLEXPORT void Advance(
+        const WantedClockType::time_point& now, std::vector<std::shared_ptr<QueuedTask>>& expired);
+
+    //! \brief Removes a task from the wheel
+    //! \returns True if found
+    DLLEXPORT bool Remove(const QueuedTask* task);
+
+    //! \brief Moves all tasks to removed
+    DLLEXPORT void Clear(std::vector<std::shared_ptr<QueuedTask>>& removed);
+
+    //! \brief Returns the start time of the tick the earliest task is due on
+    //! \returns False if the wheel is empty
+    DLLEXPORT bool GetNextWakeTime(WantedClockType::time_point& wake) const;
+
+    inline size_t GetTaskCount() const
+    {
+        return TaskCount;
+    }
+
+private:
+    int64_t _TickOf(const WantedClockType::time_point& time) const;
+
+private:
+    const MicrosecondDuration TickDuration;
+    const WantedClockType::time_point Start;
+
+    std::vector<std::vector<Entry>> Slots;
+
+    //! All ticks up to and including this have been expired
+    int64_t CurrentTick = 0;
+
+    size_t TaskCount = 0;
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::TaskTimerWheel;
+#endif
@@ -5,9 +5,14 @@
 #include "OgreRoot.h"
 #endif //LEVIATHAN_USING_OGRE
 #include "QueuedTask.h"
+#include <algorithm>
 #include <thread>
 #include "../Utility/Convert.h"
 #include "../Statistics/TimingMonitor.h"
+
+#ifdef ALLOW_INTERNAL_EXCEPTIONS
+#include "Exceptions.h"
+#endif //ALLOW_INTERNAL_EXCEPTIONS
 using namespace Leviathan;
 using namespace std;
 // ------------------------------------ //
@@ -34,11 +39,11 @@ DLLEXPORT void Leviathan::UnregisterOgreOnThread(){
 // ------------------ ThreadingManager ------------------ //
 DLLEXPORT Leviathan::ThreadingManager::ThreadingManager(int basethreadspercore
     /*= DEFAULT_THREADS_PER_CORE*/) :
-    AllowStartTasksFromQueue(true), StopProcessing(false),
-    TaksMustBeRanBeforeState(TASK_MUSTBERAN_BEFORE_EXIT),
-    AllowRepeats(true), AllowConditionalWait(true)
+    Timer(MicrosecondDuration(TASK_TIMER_TICK_MICROSECONDS), TASK_TIMER_SLOTS,
+        Time::GetThreadSafeSteadyTimePoint())
 {
-	WantedThreadCount = std::thread::hardware_concurrency()*basethreadspercore;
+	WantedThreadCount = std::max(1,
+        static_cast<int>(std::thread::hardware_concurrency()) * basethreadspercore);
 
 	staticaccess = this;
 }
@@ -46,7 +51,9 @@ DLLEXPORT Leviathan::ThreadingManager::ThreadingManager(int basethreadspercore
 DLLEXPORT Leviathan::ThreadingManager::~ThreadingManager(){
 
     // Joins all threads before quitting //
-    UsableThreads.clear();
+    if(!StopProcessing)
+        Release();
+
 	staticaccess = nullptr;
 }
 
@@ -58,51 +65,44 @@ ThreadingManager* Leviathan::ThreadingManager::staticaccess = NULL;
 // ------------------------------------ //
 DLLEXPORT bool Leviathan::ThreadingManager::Init(){
 
-	GUARD_LOCK();
-
-	// Start the queuer //
-	WorkQueueHandler = std::thread(RunTaskQueuerThread, this);
-
-
 	// Start appropriate amount of threads //
-
 	for(int i = 0; i < WantedThreadCount; i++){
 
-
-		UsableThreads.push_back(shared_ptr<TaskThread>(new TaskThread()));
+		UsableThreads.push_back(std::make_unique<TaskThread>(this, UsableThreads.size()));
 	}
 
+    // The workers can now look at each other's queues //
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        WorkersCreated = true;
+        ++WakeEpoch;
+    }
+
+    WorkAvailable.notify_all();
+
+	// Start the timer //
+	TimerThread = std::thread(RunTaskTimerThread, this);
+
 	return true;
 }
 
 DLLEXPORT bool Leviathan::ThreadingManager::CheckInit(){
-	// Check are there running threads //
-	GUARD_LOCK();
 
-
-	bool started = false;
 	int loopcount = 0;
 
-	std::this_thread::yield();
-
 	// This might need to be repeated for a while //
-	while(!started){
+	while(true){
 
 		// Check that at least one thread is running //
 		for(auto iter = UsableThreads.begin(); iter != UsableThreads.end(); ++iter){
 			// Check is this thread running //
 			if((*iter)->HasStarted()){
-				// Something has started //
-				started = true;
 
 				// Set the thread names //
-				int threadnumber = 0;
-				for(auto iter2 = UsableThreads.begin(); iter2 != UsableThreads.end(); ++iter2){
-
-					// Set the name //
-					SetThreadName((*iter2).get(), "Lev_Task_"+Convert::ToString(threadnumber));
+				for(const auto& thread : UsableThreads){
 
-					threadnumber++;
+					SetThreadName(thread.get(), "Lev_Task_" +
+                        Convert::ToString(thread->GetIndex()));
 				}
 
 				return true;
@@ -120,90 +120,364 @@ DLLEXPORT bool Leviathan::ThreadingManager::CheckInit(){
 
 		std::this_thread::yield();
 	}
+}
 
-	LEVIATHAN_ASSERT(0, "Shouldn't get out of that loop");
-	return false;
+DLLEXPORT void Leviathan::ThreadingManager::Release(){
 
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        StopProcessing = true;
+        ++WakeEpoch;
+    }
 
-}
+    WorkAvailable.notify_all();
 
+    {
+        std::lock_guard<std::mutex> lock(TimerMutex);
+        TimerChanged = true;
+    }
 
+    TimerNotify.notify_all();
 
-DLLEXPORT void Leviathan::ThreadingManager::Release(){
-	// Disallow new tasks //
-	{
-		GUARD_LOCK();
-		AllowStartTasksFromQueue = false;
-	}
+    if(TimerThread.joinable())
+        TimerThread.join();
 
-	// Wait for all to finish //
-	//WaitForAllTasksToFinish();
+    // All workers need to stop before any is destroyed as they steal from each other //
+    for(auto& thread : UsableThreads){
 
-	{
-		GUARD_LOCK();
-		StopProcessing = true;
-	}
-	// Wait for the queuer to exit //
-	TaskQueueNotify.notify_all();
-	WorkQueueHandler.join();
+        if(thread->GetInternalThreadObject().joinable())
+            thread->GetInternalThreadObject().join();
+    }
 
-	// Tell all threads to quit //
-	for(auto iter = UsableThreads.begin(); iter != UsableThreads.end(); ++iter){
-		(*iter)->NotifyKill();
-	}
+    UsableThreads.clear();
+
+    // Discard what wasn't ran //
+    std::vector<std::shared_ptr<QueuedTask>> discarded;
+
+    {
+        std::lock_guard<std::mutex> lock(TimerMutex);
+        Timer.Clear(discarded);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(InjectionMutex);
+        InjectionQueue.clear();
+        InjectionCount = 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(IdleMutex);
+        OutstandingTasks = 0;
+    }
+
+    IdleNotify.notify_all();
 }
 // ------------------------------------ //
 DLLEXPORT void Leviathan::ThreadingManager::QueueTask(shared_ptr<QueuedTask> task){
-	{
-		GUARD_LOCK();
 
-		WaitingTasks.push_back(task);
-	}
-	// Notify the thread //
-	TaskQueueNotify.notify_all();
+    task->SchedulingState.store(QueuedTask::SCHEDULING_STATE::Queued,
+        std::memory_order_relaxed);
+
+    OutstandingTasks.fetch_add(1, std::memory_order_relaxed);
+
+    _ScheduleTask(std::move(task));
 }
 
-DLLEXPORT bool Leviathan::ThreadingManager::RemoveFromQueue(shared_ptr<QueuedTask> task){
-    // Best case scenario is finding it in the wait queue //
+void Leviathan::ThreadingManager::_ScheduleTask(shared_ptr<QueuedTask> task){
+
+    WantedClockType::time_point runtime;
+
+    if(task->GetNextRunTime(runtime) && runtime > Time::GetThreadSafeSteadyTimePoint()){
+
+        if(!AllowConditionalWait){
+
+            // Can't run right now so it is discarded //
+            task->SchedulingState = QueuedTask::SCHEDULING_STATE::Idle;
+            _OnTaskRetired();
+            return;
+        }
+
+        _AddToTimer(std::move(task), runtime);
+        return;
+    }
+
+    _PushReady(std::move(task));
+}
+
+void Leviathan::ThreadingManager::_PushReady(shared_ptr<QueuedTask> task){
+
+    TaskThread* self = TaskThread::GetThreadSpecificThreadObject()->ThreadObject;
+
+    if(self && self->GetOwner() == this){
+
+        // Workers keep their own work //
+        self->GetQueue().Push(new shared_ptr<QueuedTask>(std::move(task)));
+
+    } else {
+
+        std::lock_guard<std::mutex> lock(InjectionMutex);
+        InjectionQueue.push_back(std::move(task));
+        InjectionCount.fetch_add(1, std::memory_order_release);
+    }
+
+    _NotifyWorkAvailable();
+}
+
+void Leviathan::ThreadingManager::_AddToTimer(shared_ptr<QueuedTask> task,
+    const WantedClockType::time_point &due)
+{
     {
-        GUARD_LOCK();
+        std::lock_guard<std::mutex> lock(TimerMutex);
+        Timer.Add(std::move(task), due);
+        TimerChanged = true;
+    }
 
-        auto end = WaitingTasks.end();
-        for(auto iter = WaitingTasks.begin(); iter != end; ++iter){
-            
-            if((*iter).get() == task.get()){
+    TimerNotify.notify_one();
+}
 
-                WaitingTasks.erase(iter);
-                return true;
-            }
+void Leviathan::ThreadingManager::_NotifyWorkAvailable(){
+
+    // Pairs with the fence in RunWorkerThread so that either the worker sees the new task
+    // or we see the worker going to sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if(SleepingWorkers.load(std::memory_order_relaxed) == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        ++WakeEpoch;
+    }
+
+    WorkAvailable.notify_one();
+}
+
+void Leviathan::ThreadingManager::_OnTaskRetired(){
+
+    if(OutstandingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1){
+
+        std::lock_guard<std::mutex> lock(IdleMutex);
+        IdleNotify.notify_all();
+    }
+}
+// ------------------------------------ //
+shared_ptr<QueuedTask> Leviathan::ThreadingManager::_FindTask(TaskThread* self){
+
+    BoxedTask boxed = nullptr;
+
+    // Own work first //
+    if(self && self->GetQueue().Pop(boxed)){
+
+        shared_ptr<QueuedTask> task = std::move(*boxed);
+        delete boxed;
+        return task;
+    }
+
+    if(InjectionCount.load(std::memory_order_acquire) > 0){
+
+        std::lock_guard<std::mutex> lock(InjectionMutex);
+
+        if(!InjectionQueue.empty()){
+
+            shared_ptr<QueuedTask> task = std::move(InjectionQueue.front());
+            InjectionQueue.pop_front();
+            InjectionCount.fetch_sub(1, std::memory_order_relaxed);
+            return task;
         }
     }
 
-    // The worse case is it having finished already //
-    // And the worst case is it being currently executed //
-    bool wasrunning = false;
-    bool isrunning = false;
-    
-    do{
+    // Steal from the others starting from the next worker to spread out thieves //
+    const size_t count = UsableThreads.size();
+
+    if(count == 0)
+        return nullptr;
+
+    static thread_local size_t nextVictim = 0;
+
+    const size_t start = self ? self->GetIndex() + 1 : nextVictim++;
+
+    for(size_t i = 0; i < count; ++i){
+
+        TaskThread* victim = UsableThreads[(start + i) % count].get();
+
+        if(victim == self)
+            continue;
+
+        if(victim->GetQueue().Steal(boxed)){
+
+            shared_ptr<QueuedTask> task = std::move(*boxed);
+            delete boxed;
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+void Leviathan::ThreadingManager::_RunTask(shared_ptr<QueuedTask> task){
+
+    using STATE = QueuedTask::SCHEDULING_STATE;
+
+    if(task->SchedulingState.load(std::memory_order_acquire) == STATE::Cancelled){
+
+        task->SchedulingState = STATE::Idle;
+        _OnTaskRetired();
+        return;
+    }
+
+    QueuedTaskCheckValues checkvalues;
+
+    if(!task->CanBeRan(&checkvalues)){
+
+        if(!AllowConditionalWait){
+
+            task->SchedulingState = STATE::Idle;
+            _OnTaskRetired();
+            return;
+        }
+
+        // Wait in the timer until it could be ran or should be checked again //
+        WantedClockType::time_point runtime;
+
+        if(!task->GetNextRunTime(runtime) || runtime <= checkvalues.CurrentTime){
+
+            runtime = checkvalues.CurrentTime + MicrosecondDuration(
+                TASK_CONDITIONAL_RECHECK_MICROSECONDS);
+        }
+
+        _AddToTimer(std::move(task), runtime);
+        return;
+    }
+
+    STATE expected = STATE::Queued;
+
+    if(!task->SchedulingState.compare_exchange_strong(expected, STATE::Running,
+            std::memory_order_acq_rel))
+    {
+        // Got cancelled just now //
+        task->SchedulingState = STATE::Idle;
+        _OnTaskRetired();
+        return;
+    }
+
+    RunningTasks.fetch_add(1, std::memory_order_relaxed);
+
+    // Tasks can access themselves through this //
+    ThreadSpecificData* threadData = TaskThread::GetThreadSpecificThreadObject();
+    std::shared_ptr<QueuedTask> previousTask = std::move(threadData->QuickTaskAccess);
+    threadData->QuickTaskAccess = task;
+
+    try{
+        // Run the task //
+        task->RunTask();
 
-        isrunning = false;
-        
-        GUARD_LOCK();
+    } catch(const Exception &e){
+
+    #ifndef LEVIATHAN_UE_PLUGIN
+        Logger::Get()->Error("TaskThread: task threw a Leviathan exception: ");
+        e.PrintToLog();
+    #else
+        NOT_UNUSED(e);
+    #endif //LEVIATHAN_UE_PLUGIN
+        DEBUG_BREAK;
+
+    } catch(const std::exception &e){
+
+    #ifndef LEVIATHAN_UE_PLUGIN
+        Logger::Get()->Error("TaskThread: task threw a generic exception: ");
+        Logger::Get()->Write(string("\t> ")+e.what());
+    #else
+        NOT_UNUSED(e);
+    #endif //LEVIATHAN_UE_PLUGIN
+
+        DEBUG_BREAK;
+    }
+
+    threadData->QuickTaskAccess = std::move(previousTask);
+
+    if(RunningTasks.fetch_sub(1, std::memory_order_acq_rel) == 1){
+
+        std::lock_guard<std::mutex> lock(IdleMutex);
+        IdleNotify.notify_all();
+    }
+
+    NotifyTaskFinished(std::move(task));
+}
+
+DLLEXPORT void Leviathan::ThreadingManager::NotifyTaskFinished(shared_ptr<QueuedTask> task){
+
+    using STATE = QueuedTask::SCHEDULING_STATE;
+
+	// Queue again if it repeats and we aren't quitting //
+	if(task->IsRepeating() && AllowRepeats){
+
+        // Fails if RemoveFromQueue cancelled this while it was running //
+        STATE expected = STATE::Running;
+
+        if(task->SchedulingState.compare_exchange_strong(expected, STATE::Queued,
+                std::memory_order_acq_rel))
+        {
+            _ScheduleTask(std::move(task));
+            return;
+        }
+	}
+
+    task->SchedulingState.store(STATE::Idle, std::memory_order_release);
+    _OnTaskRetired();
+}
+// ------------------------------------ //
+DLLEXPORT bool Leviathan::ThreadingManager::RemoveFromQueue(shared_ptr<QueuedTask> task){
 
-        auto end = UsableThreads.end();
-        for(auto iter = UsableThreads.begin(); iter != end; ++iter){
+    using STATE = QueuedTask::SCHEDULING_STATE;
 
-            if((*iter)->IsRunningTask(task)){
+    while(true){
 
-                isrunning = true;
-                wasrunning = true;
-                break;
+        STATE expected = STATE::Queued;
+
+        // Best case scenario is it waiting somewhere //
+        if(task->SchedulingState.compare_exchange_strong(expected, STATE::Cancelled,
+                std::memory_order_acq_rel))
+        {
+            // Tasks in the deques are dropped when they are popped but the timer wheel may
+            // hold them for a long time
+            bool removed = false;
+
+            {
+                std::lock_guard<std::mutex> lock(TimerMutex);
+                removed = Timer.Remove(task.get());
+            }
+
+            if(removed){
+
+                task->SchedulingState = STATE::Idle;
+                _OnTaskRetired();
             }
+
+            return true;
         }
 
-    } while(isrunning);
+        if(expected != STATE::Running)
+            return false;
+
+        // The worst case is it being currently executed. Marking it cancelled stops it from
+        // repeating
+        if(task->SchedulingState.compare_exchange_strong(expected, STATE::Cancelled,
+                std::memory_order_acq_rel))
+        {
+            // A task removing itself can't wait for itself //
+            if(TaskThread::GetThreadSpecificThreadObject()->QuickTaskAccess == task)
+                return true;
+
+            while(task->SchedulingState.load(std::memory_order_acquire) == STATE::Cancelled){
+
+                std::this_thread::yield();
+            }
+
+            return true;
+        }
 
-    return wasrunning;
+        // It finished or was queued again just now //
+    }
 }
 
 DLLEXPORT void Leviathan::ThreadingManager::RemoveTasksFromQueue(std::vector<shared_ptr<QueuedTask>> &tasklist){
@@ -217,115 +491,159 @@ DLLEXPORT void Leviathan::ThreadingManager::RemoveTasksFromQueue(std::vector<sha
 }
 // ------------------------------------ //
 DLLEXPORT void Leviathan::ThreadingManager::FlushActiveThreads(){
+
 	// Disallow new tasks //
-    GUARD_LOCK_NAME(lockit);
     AllowStartTasksFromQueue = false;
 
+    std::unique_lock<std::mutex> lock(IdleMutex);
 
-	bool allavailable = false;
+    IdleNotify.wait(lock, [this](){
+            return RunningTasks.load(std::memory_order_acquire) == 0;
+        });
+}
 
-	// We want to skip wait on loop //
-	goto skipfirstwaitforthreadslabel;
+DLLEXPORT void Leviathan::ThreadingManager::SetAllowStartTasks(bool allow){
 
-	while(!allavailable){
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        AllowStartTasksFromQueue = allow;
+        ++WakeEpoch;
+    }
 
-		// Wait for tasks to update //
-		TaskQueueNotify.wait_for(lockit, std::chrono::milliseconds(10));
+    WorkAvailable.notify_all();
+}
 
-skipfirstwaitforthreadslabel:
+DLLEXPORT void Leviathan::ThreadingManager::WaitForAllTasksToFinish(){
 
+    std::unique_lock<std::mutex> lock(IdleMutex);
 
-		// Set to true until a thread is busy //
-		allavailable = true;
+    IdleNotify.wait(lock, [this](){
+            return OutstandingTasks.load(std::memory_order_acquire) <= 0;
+        });
+}
+// ------------------------------------ //
+DLLEXPORT bool Leviathan::ThreadingManager::TryRunOneTask(){
 
-		for(auto iter = UsableThreads.begin(); iter != UsableThreads.end(); ++iter){
-			if((*iter)->HasRunningTask()){
-				allavailable = false;
-				break;
-			}
-		}
-	}
+    if(!AllowStartTasksFromQueue || StopProcessing)
+        return false;
+
+    TaskThread* self = TaskThread::GetThreadSpecificThreadObject()->ThreadObject;
+
+    if(self && self->GetOwner() != this)
+        self = nullptr;
+
+    auto task = _FindTask(self);
+
+    if(!task)
+        return false;
 
-	// Now free //
+    _RunTask(std::move(task));
+    return true;
 }
 
-DLLEXPORT void Leviathan::ThreadingManager::WaitForAllTasksToFinish(){
-	// Use this lock the entire function //
-	GUARD_LOCK();
-    
-	// See if empty right now and loop until it is //
-	while(true){
+namespace{
+//! \brief Shared state of a ParallelFor call
+//!
+//! Helper tasks may start after ParallelFor has returned so they keep this alive
+struct ParallelForState{
+
+    std::atomic<size_t> NextChunk = {0};
+
+    size_t ChunkCount;
+    size_t Begin;
+    size_t End;
+    size_t GrainSize;
 
-        WaitForWorkersToEmpty(guard);
+    //! Only called after successfully claiming a chunk, which can't happen after
+    //! ParallelFor has returned
+    const std::function<void(size_t, size_t)>* Function;
 
-        // Unlock us for a second
-        guard.unlock();
-		// Make the queuer run //
-		TaskQueueNotify.notify_all();
-        guard.lock();
+    std::mutex Mutex;
+    std::condition_variable Notify;
+    size_t FinishedChunks = 0;
+    std::exception_ptr Error;
+};
 
-        WaitForWorkersToEmpty(guard);        
-        WaitForWorkersToEmpty(guard);        
+void RunParallelForChunks(ParallelForState &state){
 
-        if(WaitingTasks.empty())
+    while(true){
+
+        const auto chunk = state.NextChunk.fetch_add(1);
+
+        if(chunk >= state.ChunkCount)
             return;
-	}
 
-    WaitForWorkersToEmpty(guard);
-}
+        const auto begin = state.Begin + chunk * state.GrainSize;
+        const auto end = std::min(begin + state.GrainSize, state.End);
 
-DLLEXPORT void ThreadingManager::WaitForWorkersToEmpty(Lock &guard){
+        std::exception_ptr error;
 
-    // Wait for threads to empty up //
-    bool allavailable = false;
-    
-    // We want to skip wait on loop //
-    goto skipfirstwaitforthreadslabel2;
-    
-    while(!allavailable){
-        
-        // Wait for tasks to update //
-        TaskQueueNotify.wait_for(guard, std::chrono::milliseconds(1));
-        
-    skipfirstwaitforthreadslabel2:
-        
-        // Set to true until a thread is busy //
-        allavailable = true;
-        
-        for(auto iter = UsableThreads.begin(); iter != UsableThreads.end(); ++iter){
-            if((*iter)->HasRunningTask()){
-                allavailable = false;
-                break;
-            }
+        try{
+            (*state.Function)(begin, end);
+        } catch(...){
+            error = std::current_exception();
         }
+
+        std::lock_guard<std::mutex> lock(state.Mutex);
+
+        if(error && !state.Error)
+            state.Error = error;
+
+        if(++state.FinishedChunks == state.ChunkCount)
+            state.Notify.notify_all();
     }
 }
-// ------------------------------------ //
-DLLEXPORT void Leviathan::ThreadingManager::NotifyTaskFinished(shared_ptr<QueuedTask> task){
-	// We need locking for re-adding it //
-	if(task->IsRepeating()){
-		// Add back to queue //
-		GUARD_LOCK();
-
-		// Or not if we should be quitting soon //
-		if(AllowRepeats)
-			WaitingTasks.push_back(task);
-	}
+}
 
+DLLEXPORT void Leviathan::ThreadingManager::ParallelFor(size_t begin, size_t end,
+    size_t grainsize, const std::function<void(size_t, size_t)> &func)
+{
+    if(end <= begin)
+        return;
+
+    if(grainsize == 0)
+        grainsize = 1;
+
+    const auto count = end - begin;
+    const auto chunks = (count + grainsize - 1) / grainsize;
+
+    if(chunks == 1 || UsableThreads.empty()){
+
+        func(begin, end);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->ChunkCount = chunks;
+    state->Begin = begin;
+    state->End = end;
+    state->GrainSize = grainsize;
+    state->Function = &func;
+
+    const size_t helpers = std::min<size_t>(chunks - 1, UsableThreads.size());
 
-	// We probably don't need to acquire a lock for this //
-	TaskQueueNotify.notify_all();
+    for(size_t i = 0; i < helpers; ++i){
+
+        QueueTask(std::make_shared<QueuedTask>([state](){
+                    RunParallelForChunks(*state);
+                }));
+    }
+
+    // The caller claims chunks until there are none left so it never waits for a chunk
+    // that nobody has started
+    RunParallelForChunks(*state);
+
+    std::unique_lock<std::mutex> lock(state->Mutex);
+
+    state->Notify.wait(lock, [&](){ return state->FinishedChunks == state->ChunkCount; });
+
+    if(state->Error)
+        std::rethrow_exception(state->Error);
 }
 // ------------------------------------ //
 DLLEXPORT void Leviathan::ThreadingManager::MakeThreadsWorkWithOgre(){
     
 	QUICKTIME_THISSCOPE;
-    
-	// Disallow new tasks //
-	{
-		GUARD_LOCK();
-		AllowStartTasksFromQueue = false;
-	}
 
 	// Set our main thread's name //
 	//SetThreadNameImpl(-1, "LeviathanMain");
@@ -341,34 +659,13 @@ DLLEXPORT void Leviathan::ThreadingManager::MakeThreadsWorkWithOgre(){
 #endif //LEVIATHAN_USING_OGRE
 
 	// Set the threads to run the register methods //
-	{
-		GUARD_LOCK_NAME(lockit);
-
 #ifdef LEVIATHAN_USING_OGRE
-		for(auto iter = UsableThreads.begin(); iter != UsableThreads.end(); ++iter){
-
-			//(*iter)->SetTaskAndNotify(
-            //   std::make_shared<QueuedTask>(std::bind(RegisterOgreOnThread)));
-			// Wait for it to end //
-#ifdef __GNUC__
-			while((*iter)->HasRunningTask()){
-				try{
-					TaskQueueNotify.wait_for(lockit, std::chrono::milliseconds(50));
-				}
-				catch(...){
-					LOG_WARNING("ThreadingManager: MakeThreadsWorkWithOgre: "
-                        "linux fix wait interrupted");
-				}
-			}
-#endif
+    // for(auto iter = UsableThreads.begin(); iter != UsableThreads.end(); ++iter){
 
-
-		}
+    //     (*iter)->SetTaskAndNotify(
+    //        std::make_shared<QueuedTask>(std::bind(RegisterOgreOnThread)));
+    // }
 #endif //LEVIATHAN_USING_OGRE
-	}
-
-	// Wait for threads to finish //
-	FlushActiveThreads();
 
 	// End registering functions //
 #ifdef LEVIATHAN_USING_OGRE
@@ -376,10 +673,7 @@ DLLEXPORT void Leviathan::ThreadingManager::MakeThreadsWorkWithOgre(){
 #endif //LEVIATHAN_USING_OGRE
 
 	// Allow new threads //
-	{
-		GUARD_LOCK();
-		AllowStartTasksFromQueue = true;
-	}
+	SetAllowStartTasks(true);
 }
 
 DLLEXPORT void Leviathan::ThreadingManager::UnregisterGraphics(){
@@ -387,157 +681,175 @@ DLLEXPORT void Leviathan::ThreadingManager::UnregisterGraphics(){
     // Wait for threads to finish //
 	FlushActiveThreads();
 
-    {
-		GUARD_LOCK_NAME(lockit);
-
-    #ifdef LEVIATHAN_USING_OGRE
-        
-		for(auto iter = UsableThreads.begin(); iter != UsableThreads.end(); ++iter){
+#ifdef LEVIATHAN_USING_OGRE
+    // for(auto iter = UsableThreads.begin(); iter != UsableThreads.end(); ++iter){
 
-			//(*iter)->SetTaskAndNotify(
-            //    std::make_shared<QueuedTask>(std::bind(UnregisterOgreOnThread)));
-			// Wait for it to end //
-        // #ifdef __GNUC__
-		// 	while((*iter)->HasRunningTask()){
-		// 		try{
-		// 			TaskQueueNotify.wait_for(lockit, std::chrono::milliseconds(50));
-		// 		}
-		// 		catch(...){
-		// 			LOG_WARNING("ThreadingManager: MakeThreadsWorkWithOgre: "
-        //                 "linux fix wait interrupted");
-		// 		}
-		// 	}
-        // #endif
-		}
-    #endif //LEVIATHAN_USING_OGRE
-	}
+    //     (*iter)->SetTaskAndNotify(
+    //         std::make_shared<QueuedTask>(std::bind(UnregisterOgreOnThread)));
+    // }
+#endif //LEVIATHAN_USING_OGRE
 
-    FlushActiveThreads();
-    
     // Allow new threads //
-	{
-		GUARD_LOCK();
-		AllowStartTasksFromQueue = true;
-	}
+	SetAllowStartTasks(true);
 }
 // ------------------------------------ //
 DLLEXPORT void Leviathan::ThreadingManager::NotifyQueuerThread(){
 
-	TaskQueueNotify.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(TimerMutex);
+        TimerChanged = true;
+    }
+
+	TimerNotify.notify_all();
 }
 
 DLLEXPORT void Leviathan::ThreadingManager::SetDisallowRepeatingTasks(bool disallow){
-	AllowRepeats = disallow;
+	AllowRepeats = !disallow;
 }
 
 DLLEXPORT void Leviathan::ThreadingManager::SetDiscardConditionalTasks(bool discard){
 	AllowConditionalWait = !discard;
+
+    if(discard)
+        _DiscardWaitingTasks();
+}
+
+void Leviathan::ThreadingManager::_DiscardWaitingTasks(){
+
+    std::vector<std::shared_ptr<QueuedTask>> discarded;
+
+    {
+        std::lock_guard<std::mutex> lock(TimerMutex);
+
+        // Tasks that are already due are still ran //
+        std::vector<std::shared_ptr<QueuedTask>> due;
+        Timer.Advance(Time::GetThreadSafeSteadyTimePoint(), due);
+
+        for(auto& task : due)
+            _PushReady(std::move(task));
+
+        Timer.Clear(discarded);
+    }
+
+    for(auto& task : discarded){
+
+        task->SchedulingState = QueuedTask::SCHEDULING_STATE::Idle;
+        _OnTaskRetired();
+    }
 }
 // ------------------------------------ //
-void Leviathan::RunTaskQueuerThread(ThreadingManager* manager){
+void Leviathan::RunWorkerThread(ThreadingManager* manager, TaskThread* thread){
 
-	// Lock the object //
-	GUARD_LOCK_OTHER(manager);
+    // Wait until all the workers exist //
+    {
+        std::unique_lock<std::mutex> lock(manager->SleepMutex);
 
-	while(!manager->StopProcessing){
+        manager->WorkAvailable.wait(lock, [manager](){
+                return manager->WorkersCreated || manager->StopProcessing;
+            });
+    }
 
-		// Wait until task queue needs work //
-		manager->TaskQueueNotify.wait_for(guard, std::chrono::milliseconds(100));
+    // Number of failed searches before going to sleep //
+    constexpr int SPIN_COUNT = 32;
 
-		// Quickly continue if it is empty //
-		if(!manager->AllowStartTasksFromQueue || manager->WaitingTasks.empty()){
-			
-			continue;
-		}
+    int failedSearches = 0;
 
-		// Keep iterator consistent with the whole loop, (to avoid excessive calling of CanBeRan) //
-		auto taskiter = manager->WaitingTasks.begin();
-		// Used to iterate again, but just checking if they can be ran (allows more important tasks to run first) //
-		auto nonimportantiter = manager->WaitingTasks.begin();
-
-		// We need some common values for tasks to use for checking if they can run //
-		QueuedTaskCheckValues commontaskcheck;
-
-		// Find an empty thread and queue tasks //
-		for(auto iter = manager->UsableThreads.begin(); iter != manager->UsableThreads.end(); ++iter){
-
-			if(!(*iter)->HasRunningTask()){
-
-				// Break if no tasks //
-				if(manager->WaitingTasks.empty())
-					break;
-
-				// Queue a task //
-				shared_ptr<QueuedTask> tmptask;
-
-				// Try to find a suitable one //
-				for( ; taskiter != manager->WaitingTasks.end(); ){
-
-					// Check does the task want to run now //
-					if((*taskiter)->MustBeRanBefore(manager->TaksMustBeRanBeforeState)){
-						// Check is allowed to run //
-						if((*taskiter)->CanBeRan(&commontaskcheck)){
-							// Run it! //
-							tmptask = (*taskiter);
-							// Erase, might be temporary //
-							taskiter = manager->WaitingTasks.erase(taskiter);
-
-							// Just to be safe, TODO: performance could be improved //
-							nonimportantiter = taskiter;
-
-							break;
-						} else if(!manager->AllowConditionalWait){
-							// Discard it //
-							taskiter = manager->WaitingTasks.erase(taskiter);
-							// Just to be safe, TODO: performance could be improved //
-							nonimportantiter = taskiter;
-						}
-					} else if(!manager->AllowConditionalWait){
-						// Discard it //
-						taskiter = manager->WaitingTasks.erase(taskiter);
-						// Just to be safe, TODO: performance could be improved //
-						nonimportantiter = taskiter;
-					}
-
-					++taskiter;
-				}
+    while(!manager->StopProcessing){
 
-				if(!tmptask){
-					// Check with the other iterator, too //
-					for( ; nonimportantiter != manager->WaitingTasks.end(); ){
-						// Check is allowed to run //
-						if((*nonimportantiter)->CanBeRan(&commontaskcheck)){
-							// Run it! //
-							tmptask = (*nonimportantiter);
-							// Erase, might be temporary //
-							nonimportantiter = manager->WaitingTasks.erase(nonimportantiter);
-
-							// Just to be safe, TODO: performance could be improved //
-							taskiter = nonimportantiter;
-
-							break;
-						} else if(!manager->AllowConditionalWait){
-							// Discard it //
-							nonimportantiter = manager->WaitingTasks.erase(taskiter);
-                            
-							// Just to be safe, TODO: performance could be improved //
-							taskiter = nonimportantiter;
-						}
-
-						++nonimportantiter;
-					}
-				}
+        if(manager->AllowStartTasksFromQueue){
 
-				// If still nothing, nothing cannot run //
-				if(!tmptask)
-					break;
+            auto task = manager->_FindTask(thread);
 
-				// This won't actually finish it so to re-queue it, if it repeats, we use the callback called
-                // when it is finished
-				(*iter)->SetTaskAndNotify(tmptask);
-			}
-		}
-	}
+            if(task){
+
+                failedSearches = 0;
+                manager->_RunTask(std::move(task));
+                continue;
+            }
+
+            if(++failedSearches < SPIN_COUNT){
+
+                std::this_thread::yield();
+                continue;
+            }
+        }
+
+        failedSearches = 0;
+
+        // Announce going to sleep and then check once more so that no wakeup is missed //
+        uint64_t seenEpoch;
+
+        {
+            std::lock_guard<std::mutex> lock(manager->SleepMutex);
+            manager->SleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            seenEpoch = manager->WakeEpoch;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if(manager->AllowStartTasksFromQueue && !manager->StopProcessing){
+
+            auto task = manager->_FindTask(thread);
+
+            if(task){
+
+                manager->SleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+                manager->_RunTask(std::move(task));
+                continue;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(manager->SleepMutex);
+
+        manager->WorkAvailable.wait(lock, [&](){
+                return manager->WakeEpoch != seenEpoch || manager->StopProcessing;
+            });
+
+        manager->SleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void Leviathan::RunTaskTimerThread(ThreadingManager* manager){
+
+    std::vector<std::shared_ptr<QueuedTask>> expired;
+
+    std::unique_lock<std::mutex> lock(manager->TimerMutex);
+
+    while(!manager->StopProcessing){
+
+        WantedClockType::time_point wake;
+
+        // Sleep until the next task is due or the wheel changes //
+        if(manager->Timer.GetNextWakeTime(wake)){
+
+            manager->TimerNotify.wait_until(lock, wake, [manager](){
+                    return manager->TimerChanged || manager->StopProcessing;
+                });
+
+        } else {
+
+            manager->TimerNotify.wait(lock, [manager](){
+                    return manager->TimerChanged || manager->StopProcessing;
+                });
+        }
+
+        manager->TimerChanged = false;
+
+        manager->Timer.Advance(Time::GetThreadSafeSteadyTimePoint(), expired);
+
+        if(expired.empty())
+            continue;
+
+        lock.unlock();
+
+        // The workers check CanBeRan again before running these //
+        for(auto& task : expired)
+            manager->_PushReady(std::move(task));
+
+        expired.clear();
+
+        lock.lock();
+    }
 }
 // ------------------------------------ //
 #ifdef _WIN32
@@ -2,9 +2,15 @@
 // ------------------------------------ //
 #include "Define.h"
 // ------------------------------------ //
+#include "Common/ThreadSafe.h"
 #include "QueuedTask.h"
 #include "TaskThread.h"
-#include <list>
+#include "TaskTimerWheel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <vector>
 
 #ifdef _WIN32
@@ -13,6 +19,14 @@
 
 #define DEFAULT_THREADS_PER_CORE		1
 
+//! Length of one tick of the timer wheel for delayed tasks
+#define TASK_TIMER_TICK_MICROSECONDS    1000
+//! Number of slots in the timer wheel, the wheel makes a full revolution in
+//! TASK_TIMER_TICK_MICROSECONDS * TASK_TIMER_SLOTS
+#define TASK_TIMER_SLOTS                512
+//! How often tasks that have only a CanBeRan check are checked again
+#define TASK_CONDITIONAL_RECHECK_MICROSECONDS 5000
+
 namespace Leviathan{
 
 #ifdef LEVIATHAN_USING_OGRE
@@ -20,8 +34,11 @@ DLLEXPORT void RegisterOgreOnThread();
 DLLEXPORT void UnregisterOgreOnThread();
 #endif //LEVIATHAN_USING_OGRE
 
-	//! \todo Improve performance
-	void RunTaskQueuerThread(ThreadingManager* manager);
+	//! \brief Main loop of the worker threads
+	void RunWorkerThread(ThreadingManager* manager, TaskThread* thread);
+
+	//! \brief Moves tasks from the timer wheel to the workers once they are due
+	void RunTaskTimerThread(ThreadingManager* manager);
 
 #ifdef _WIN32
 
@@ -29,27 +46,37 @@ DLLEXPORT void UnregisterOgreOnThread();
 	void SetThreadNameImpl(DWORD threadid, const std::string &name);
 #else
     void SetThreadName(TaskThread* thread, const std::string &name);
-    
+
 #endif // _WIN32
 
 
 	//! \brief Manages delayed execution of functions through use of QueuedTask and subclasses
+	//!
+	//! Each worker thread has a lock-free deque. Tasks queued from a worker go to the end
+	//! of its own deque, tasks from other threads go to a shared injection queue and idle
+	//! workers steal from the other workers. Tasks that can't run yet (DelayedTask and
+	//! friends) wait in a timer wheel that is handled by a separate timer thread which
+	//! sleeps until the next task is due. Tasks that only have a CanBeRan check are
+	//! checked again every TASK_CONDITIONAL_RECHECK_MICROSECONDS
 	class ThreadingManager : public ThreadSafe{
-		friend void RunTaskQueuerThread(ThreadingManager* manager);
+		friend void RunWorkerThread(ThreadingManager* manager, TaskThread* thread);
+		friend void RunTaskTimerThread(ThreadingManager* manager);
 	public:
 		DLLEXPORT ThreadingManager(int basethreadspercore = DEFAULT_THREADS_PER_CORE);
 		DLLEXPORT virtual ~ThreadingManager();
 
-		//! Sets up the work queue
+		//! Starts the worker and timer threads
 		DLLEXPORT virtual bool Init();
 		//! \brief Checks has Init worked
 		DLLEXPORT virtual bool CheckInit();
 
-		//! This will take a long time, since it will wait until all tasks are done
-		//! \todo Do something about unfinished tasks here
+		//! \brief Stops and joins all the threads. Tasks that haven't been started are
+		//! discarded
 		DLLEXPORT virtual void Release();
 
-		//! Adds a task to the queue
+		//! \brief Adds a task to be ran
+		//!
+		//! Can be called from any thread. Doesn't wait for the task to be started
 		DLLEXPORT void QueueTask(std::shared_ptr<QueuedTask> task);
 
         //! \brief Removes a task from the queue
@@ -69,22 +96,21 @@ DLLEXPORT void UnregisterOgreOnThread();
 			QueueTask(std::shared_ptr<QueuedTask>(newdtask));
 		}
 
-		//! This function waits for all tasks to complete
+		//! \brief Stops starting new tasks and waits for the running ones to finish
+		//! \note Starting tasks needs to be allowed again with SetAllowStartTasks
 		DLLEXPORT void FlushActiveThreads();
 
+		//! \brief Allows workers to start tasks again after FlushActiveThreads
+		DLLEXPORT void SetAllowStartTasks(bool allow);
+
 		//! \brief Blocks until all queued tasks are finished
 		//!
-		//! \warning This function will ignore MustBeRanBefore return value by
-        //! passing TASK_MUSTBERAN_BEFORE_EXIT
-		//! \bug This doesn't properly handle tasks that are repeating
+		//! This also waits for delayed tasks that are in the timer wheel
+		//! \warning Must not be called from a task
+		//! \bug This doesn't return while repeating tasks are queued
 		DLLEXPORT void WaitForAllTasksToFinish();
 
-
-        //! \brief Blocks until all threads are empty
-        DLLEXPORT void WaitForWorkersToEmpty(Lock &guard);
-
-
-		//! \brief Notifies the queuer thread to check task setting
+		//! \brief Wakes up the timer thread to check delayed and conditional tasks now
 		DLLEXPORT void NotifyQueuerThread();
 
 
@@ -93,6 +119,8 @@ DLLEXPORT void UnregisterOgreOnThread();
 		DLLEXPORT void SetDisallowRepeatingTasks(bool disallow);
 
 		//! \brief Sets the task queuer to discard all conditional tasks
+		//!
+		//! When set all tasks that can't run right now are discarded
 		//! \note This should only be called by the Engine
 		DLLEXPORT void SetDiscardConditionalTasks(bool discard);
 
@@ -105,33 +133,104 @@ DLLEXPORT void UnregisterOgreOnThread();
         //! Must be called if MakeThreadsWorkWithOgre has been called, BEFORE releasing graphics
         DLLEXPORT void UnregisterGraphics();
 
+        // ------------------------------------ //
+        // Fork-join helpers
+
+        //! \brief Runs a single ready task on the calling thread
+        //!
+        //! Threads waiting for tasks to finish call this to help instead of blocking
+        //! \returns False if no task was available
+        DLLEXPORT bool TryRunOneTask();
+
+        //! \brief Splits [begin, end) into chunks of grainsize and runs them in parallel
+        //!
+        //! The calling thread also processes chunks and then sleeps until the chunks taken
+        //! by the workers are done. Safe to call from within a task
+        //! \param func Called with the [begin, end) of each chunk. Needs to be thread safe
+        //! \exception The first exception thrown by func is rethrown after all chunks are done
+        DLLEXPORT void ParallelFor(size_t begin, size_t end, size_t grainsize,
+            const std::function<void(size_t, size_t)> &func);
+
+        //! \returns The number of worker threads
+        inline size_t GetWorkerCount() const{
+            return UsableThreads.size();
+        }
+
 		DLLEXPORT static ThreadingManager* Get();
 	protected:
 
-		bool AllowStartTasksFromQueue;
-		bool StopProcessing;
+        //! \brief Puts a task in a deque or the timer wheel based on when it can run
+        void _ScheduleTask(std::shared_ptr<QueuedTask> task);
 
-		int WantedThreadCount;
+        //! \brief Puts a task into the current worker's deque or the injection queue
+        void _PushReady(std::shared_ptr<QueuedTask> task);
+
+        void _AddToTimer(std::shared_ptr<QueuedTask> task, const WantedClockType::time_point &due);
 
-		//! Used to allow QueuedTask::MustBeRanBefore function to work, shared between staticaccess worker thread and
-        //! the main object
-		int TaksMustBeRanBeforeState;
+        //! \brief Finds a task to run from the worker's own deque, the injection queue or
+        //! by stealing
+        //! \param self The current worker or null if not called by a worker
+        std::shared_ptr<QueuedTask> _FindTask(TaskThread* self);
+
+        //! \brief Runs a task if it is still allowed to and handles repeating
+        void _RunTask(std::shared_ptr<QueuedTask> task);
+
+        //! \brief Wakes up a sleeping worker if there is one
+        void _NotifyWorkAvailable();
+
+        //! \brief Called once a queued task is done for good
+        void _OnTaskRetired();
+
+        //! \brief Drops the tasks in the timer wheel that aren't due yet
+        void _DiscardWaitingTasks();
+
+		std::atomic<bool> AllowStartTasksFromQueue = {true};
+		std::atomic<bool> StopProcessing = {false};
+
+		int WantedThreadCount;
 
 		//! Can tasks be repeated
-		bool AllowRepeats;
+		std::atomic<bool> AllowRepeats = {true};
 
-		//! Controls whether tasks can be conditional. Setting this to false will remove all tasks that cannot be ran
-        //! instantly
-		bool AllowConditionalWait;
+		//! Controls whether tasks can be conditional. Setting this to false will remove all
+		//! tasks that cannot be ran instantly
+		std::atomic<bool> AllowConditionalWait = {true};
 
+		std::vector<std::unique_ptr<TaskThread>> UsableThreads;
 
-		//! List of the tasks queued by the application
-		std::list<std::shared_ptr<QueuedTask>> WaitingTasks;
-		std::condition_variable_any TaskQueueNotify;
-		std::vector<std::shared_ptr<TaskThread>> UsableThreads;
+        //! Set once all workers are created so that they can start stealing
+        bool WorkersCreated = false;
 
-		//! Thread used to set tasks to threads
-		std::thread WorkQueueHandler;
+        //! Tasks queued from threads that aren't workers
+        std::mutex InjectionMutex;
+        std::deque<std::shared_ptr<QueuedTask>> InjectionQueue;
+        std::atomic<size_t> InjectionCount = {0};
+
+        // Sleeping workers //
+        std::mutex SleepMutex;
+        std::condition_variable WorkAvailable;
+        std::atomic<int> SleepingWorkers = {0};
+        //! Incremented when work is added while workers sleep, protected by SleepMutex
+        uint64_t WakeEpoch = 0;
+
+        //! Tasks that have been queued and haven't finished for good
+        std::atomic<int64_t> OutstandingTasks = {0};
+        std::atomic<int64_t> RunningTasks = {0};
+
+        //! Notified when OutstandingTasks or RunningTasks hits 0
+        std::mutex IdleMutex;
+        std::condition_variable IdleNotify;
+
+        // Timer wheel //
+        std::mutex TimerMutex;
+        std::condition_variable TimerNotify;
+        TaskTimerWheel Timer;
+        //! Set when the wheel has been changed so the timer thread needs to recheck its
+        //! wake time
+        bool TimerChanged = false;
+
+		//! Thread running the timer wheel
+		std::thread TimerThread;
 
 		static ThreadingManager* staticaccess;
 	};
@@ -147,4 +246,3 @@ using Leviathan::ConditionalDelayedTask;
 using Leviathan::RepeatingDelayedTask;
 using Leviathan::RepeatCountedDelayedTask;
 #endif
-
@@ -0,0 +1,179 @@
+// Leviathan Game Engine
+// Copyright (c) 2012-2017 Henri Hyyryläinen
+#pragma once
+#include "Define.h"
+// ------------------------------------ //
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Leviathan {
+
+//! \brief Lock-free deque where only the owning thread pushes and pops and other threads
+//! can steal from the other end
+//!
+//! This is the Chase-Lev deque with the memory orderings from "Correct and Efficient
+//! Work-Stealing for Weak Memory Models" (Lê et al. 2013). The owner uses the bottom end
+//! (LIFO) which keeps recently pushed work hot in the cache and thieves take the oldest
+//! items from the top
+//! \note ElementType must be trivially copyable, usually a pointer
+template<class ElementType>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<ElementType>::value,
+        "WorkStealingDeque elements need to be trivially copyable");
+
+    //! \brief Circular buffer, size is always a power of two
+    class Buffer {
+    public:
+        Buffer(int64_t capacity) :
+            Capacity(capacity), Mask(capacity - 1),
+            Items(new std::atomic<ElementType>[static_cast<size_t>(capacity)])
+        {
+        }
+
+        inline ElementType Get(int64_t index) const
+        {
+            return Items[static_cast<size_t>(index & Mask)].load(std::memory_order_relaxed);
+        }
+
+        inline void Put(int64_t index, ElementType item)
+        {
+            Items[static_cast<size_t>(index & Mask)].store(item, std::memory_order_relaxed);
+        }
+
+        //! \brief Creates a twice as large buffer with the items in [top, bottom)
+        Buffer* Grow(int64_t bottom, int64_t top) const
+        {
+            auto* grown = new Buffer(Capacity * 2);
+
+            for(int64_t i = top; i < bottom; ++i)
+                grown->Put(i, Get(i));
+
+            return grown;
+        }
+
+        const int64_t Capacity;
+        const int64_t Mask;
+
+    private:
+        std::unique_ptr<std::atomic<ElementType>[]> Items;
+    };
+
+public:
+    //! \param initialcapacity Rounded up to a power of two
+    WorkStealingDeque(int64_t initialcapacity = 256)
+    {
+        int64_t capacity = 2;
+
+        while(capacity < initialcapacity)
+            capacity *= 2;
+
+        Buffers.emplace_back(new Buffer(capacity));
+        CurrentBuffer.store(Buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque& other) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+
+    //! \brief Adds an item to the bottom
+    //! \note May only be called by the owning thread
+    void Push(ElementType item)
+    {
+        const int64_t bottom = Bottom.load(std::memory_order_relaxed);
+        const int64_t top = Top.load(std::memory_order_acquire);
+        Buffer* buffer = CurrentBuffer.load(std::memory_order_relaxed);
+
+        if(bottom - top > buffer->Capacity - 1) {
+
+            // Old buffers are kept as thieves may still be reading from them //
+            Buffers.emplace_back(buffer->Grow(bottom, top));
+            buffer = Buffers.back().get();
+            CurrentBuffer.store(buffer, std::memory_order_release);
+        }
+
+        buffer->Put(bottom, item);
+
+        std::atomic_thread_fence(std::memory_order_release);
+        Bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    //! \brief Takes the most recently pushed item
+    //! \returns False if empty
+    //! \note May only be called by the owning thread
+    bool Pop(ElementType& item)
+    {
+        const int64_t bottom = Bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = CurrentBuffer.load(std::memory_order_relaxed);
+
+        Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        int64_t top = Top.load(std::memory_order_relaxed);
+
+        if(top > bottom) {
+
+            // Was empty //
+            Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = buffer->Get(bottom);
+
+        if(top == bottom) {
+
+            // Last item, race against thieves //
+            const bool won = Top.compare_exchange_strong(
+                top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+            Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        return true;
+    }
+
+    //! \brief Takes the oldest item
+    //! \returns False if empty or another thread won the race for the item
+    //! \note Can be called from any thread
+    bool Steal(ElementType& item)
+    {
+        int64_t top = Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = Bottom.load(std::memory_order_acquire);
+
+        if(top >= bottom)
+            return false;
+
+        Buffer* buffer = CurrentBuffer.load(std::memory_order_acquire);
+        const ElementType stolen = buffer->Get(top);
+
+        if(!Top.compare_exchange_strong(
+               top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false;
+
+        item = stolen;
+        return true;
+    }
+
+    //! \returns True if there seems to be nothing in the deque. Only exact when no other
+    //! thread is using this
+    bool IsEmpty() const
+    {
+        return Bottom.load(std::memory_order_relaxed) <= Top.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int64_t> Top = {0};
+    std::atomic<int64_t> Bottom = {0};
+    std::atomic<Buffer*> CurrentBuffer = {nullptr};
+
+    //! All buffers ever used. Only modified by the owner
+    std::vector<std::unique_ptr<Buffer>> Buffers;
+};
+
+} // namespace Leviathan
+
+#ifdef LEAK_INTO_GLOBAL
+using Leviathan::WorkStealingDeque;
+#endif
@@ -4,7 +4,11 @@
 #include "Define.h"
 // ------------------------------------ //
 #include "../Common/Types.h"
+
+#include <charconv>
 #include <sstream>
+#include <string_view>
+#include <type_traits>
 
 namespace Leviathan{
 
@@ -26,28 +30,145 @@ public:
 
     DLLEXPORT static bool IsStringBool(const std::string &val, bool* receiver);
 
+    //! \brief Parses a number without allocating or using the global locale
+    //!
+    //! Leading whitespace and a '+' sign are skipped like the stream operators do. Parsing
+    //! stops at the first character that can't be part of the number
+    //! \param used If not null receives the number of characters that were consumed
+    //! \returns False if str doesn't start with a number or it doesn't fit in T. result is
+    //! not changed in that case
+    template<class T>
+        static bool ParseNumber(std::string_view str, T& result, size_t* used = nullptr){
+
+        static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+            "ParseNumber only handles numbers");
+
+        const char* const begin = str.data();
+        const char* const end = begin + str.size();
+        const char* current = begin;
+
+        while(current != end && (*current == ' ' || (*current >= '\t' && *current <= '\r')))
+            ++current;
+
+        // from_chars doesn't accept '+' but a following '-' must still be an error //
+        if(current != end && *current == '+'){
+            ++current;
+
+            if(current != end && *current == '-')
+                return false;
+        }
+
+        std::from_chars_result parsed;
+
+        if constexpr(std::is_floating_point_v<T>){
+#ifdef __cpp_lib_to_chars
+            parsed = std::from_chars(current, end, result);
+#else
+            // Only integer from_chars is available. This allocates but is at least locale
+            // independent
+            std::istringstream stream(std::string(current, end));
+            stream.imbue(std::locale::classic());
+
+            T value;
+            if(!(stream >> value))
+                return false;
+
+            result = value;
+
+            if(used)
+                *used = (current - begin) + (stream.eof() ? (end - current) :
+                    static_cast<size_t>(stream.tellg()));
+            return true;
+#endif //__cpp_lib_to_chars
+        } else {
+            parsed = std::from_chars(current, end, result);
+        }
+
+        if(parsed.ec != std::errc())
+            return false;
+
+        if(used)
+            *used = parsed.ptr - begin;
+
+        return true;
+    }
+
+    //! \brief Wide string version of ParseNumber
+    //!
+    //! Numbers are always ASCII so anything else ends the number
+    template<class T>
+        static bool ParseNumber(std::wstring_view str, T& result, size_t* used = nullptr){
+
+        // Numbers are short so this almost never needs to allocate //
+        char buffer[64];
+        std::string longbuffer;
+
+        char* narrow = buffer;
+
+        if(str.size() > sizeof(buffer)){
+            longbuffer.resize(str.size());
+            narrow = &longbuffer[0];
+        }
+
+        for(size_t i = 0; i < str.size(); ++i){
+            narrow[i] = (str[i] >= 0 && str[i] < 0x80) ? static_cast<char>(str[i]) : '\0';
+        }
+
+        return ParseNumber<T>(std::string_view(narrow, str.size()), result, used);
+    }
+
     template<class T>
         static inline T WstringTo(const std::wstring &str){
-        T tempval(0);
-        std::wstringstream stream;
-        std::locale globallocale("C");
-        stream.imbue(globallocale);
-            
-        stream.str(str.c_str());
-        stream >> tempval;
-        return tempval;
+        if constexpr(IsParsedAsNumber<T>()){
+
+            T tempval(0);
+            ParseNumber<T>(std::wstring_view(str), tempval);
+            return tempval;
+
+        } else {
+
+            T tempval(0);
+            std::wstringstream stream;
+            stream.imbue(std::locale::classic());
+
+            stream.str(str.c_str());
+            stream >> tempval;
+            return tempval;
+        }
     }
-        
+
+    //! \brief Converts a string to T
+    //! \returns The converted value or 0 if the string doesn't start with a valid value
     template<class T>
         static inline T StringTo(const std::string &str){
-        T tempval(0);
-        std::stringstream stream;
-        std::locale globallocale("C");
-        stream.imbue(globallocale);
-            
-        stream.str(str.c_str());
-        stream >> tempval;
-        return tempval;
+        if constexpr(IsParsedAsNumber<T>()){
+
+            T tempval(0);
+            ParseNumber<T>(std::string_view(str), tempval);
+            return tempval;
+
+        } else {
+
+            T tempval(0);
+            std::stringstream stream;
+            stream.imbue(std::locale::classic());
+
+            stream.str(str.c_str());
+            stream >> tempval;
+            return tempval;
+        }
+    }
+
+    //! \returns True if StringTo<T> uses ParseNumber instead of a stream
+    //!
+    //! Character types are read as characters and bools as 0 or 1 by streams so they keep
+    //! using a stream
+    template<class T>
+        static constexpr bool IsParsedAsNumber(){
+        return std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+            !std::is_same_v<T, char> && !std::is_same_v<T, signed char> &&
+            !std::is_same_v<T, unsigned char> && !std::is_same_v<T, wchar_t> &&
+            !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
     }
 
 
@@ -478,11 +478,15 @@ end
 
 class GameWorldClass < OutputClass
 
+  # physicsaccess: the names in system reads and writes that the physics update changes.
+  # Systems accessing these wait for an overlapped physics update to finish
   def initialize(name, componentTypes: [], systems: [], systemspreticksetup: nil,
-                 framesystemrun: "")
+                 framesystemrun: "", physicsaccess: [])
 
     super name
 
+    @PhysicsAccess = physicsaccess
+
     @BaseClass = "GameWorld"
 
     @FrameSystemRun = framesystemrun
@@ -492,8 +496,9 @@ class GameWorldClass < OutputClass
     @Systems = systems
 
     @ComponentTypes.each{|c|
-      @Members.push(Variable.new("Component" + c.type, "Leviathan::ComponentHolder<" + c.type +
-                                                       ">"))
+      @Members.push(Variable.new("Component" + c.type, "Leviathan::" +
+                                                       (c.Dense ? "DenseComponentHolder<" :
+                                                          "ComponentHolder<") + c.type + ">"))
 
       if c.StateType
         @Members.push(Variable.new(c.type + "States", "Leviathan::StateHolder<" + c.type +
@@ -503,10 +508,278 @@ class GameWorldClass < OutputClass
 
     @Systems.each{|s|
       @Members.push(Variable.new("_" + s.Type, s.Type))
+
+      # Nodes keep references to components which dense holders would invalidate
+      s.NodeComponents.each{|c|
+        if @ComponentTypes.any?{|t| t.type == c and t.Dense}
+          raise "component type #{c} is dense and can't be used in nodes of #{s.Type}"
+        end
+      }
     }
+
+    # Component types of the parent world. The parent world tells about creating and
+    # destroying these through _OnComponentCreated and _OnComponentDestroyed
+    @ParentNodeComponentTypes = @Systems.map{|s| s.NodeComponents}.flatten.uniq.select{|c|
+      !@ComponentTypes.any?{|t| t.type == c}
+    }
+
+    # Signature bits are only needed for types that are part of nodes
+    @NodeComponentTypes = @ComponentTypes.select{|c|
+      @Systems.any?{|s| s.NodeComponents.include? c.type}
+    }.map{|c| c.type} + @ParentNodeComponentTypes
+
+    if @NodeComponentTypes.length > 64
+      raise "too many component types used in nodes for ComponentSignature"
+    end
+
+    # Bits for the data that tick systems declare to access
+    @AccessNames = (@Systems.map{|s| (s.Reads || []) + (s.Writes || [])}.flatten +
+                    @PhysicsAccess).uniq
+
+    if @AccessNames.length > 64
+      raise "too many different names in system reads and writes for SystemScheduler"
+    end
     
   end
 
+  def accessName(name)
+    "SYSTEM_ACCESS_#{name}"
+  end
+
+  def formatAccessMask(names)
+    if names.nil? or names.empty?
+      "0"
+    else
+      names.map{|n| accessName n}.join(" | ")
+    end
+  end
+
+  def signatureName(c)
+    "COMPONENT_SIGNATURE_#{c}"
+  end
+
+  def systemSignatureName(s)
+    "SYSTEM_SIGNATURE_#{s.Type}"
+  end
+
+  # Systems that have nodes that contain the component type
+  def nodeSystemsUsing(c)
+    @Systems.select{|s| s.NodeComponents.include? c}
+  end
+
+  def nodeSystems
+    @Systems.select{|s| !s.NodeComponents.empty?}
+  end
+
+  # Creates nodes for systems that match after component of type c is created as 'created'
+  def genNodeCreation(f, c)
+
+    systems = nodeSystemsUsing c
+
+    return if systems.empty?
+
+    f.puts "const auto signature = _AddToEntityComponentSignature(id, " +
+           "#{signatureName c});"
+
+    systems.each{|s|
+      f.puts "if((signature & #{systemSignatureName s}) == #{systemSignatureName s})"
+      f.puts "    _#{s.Type}.CreateNode(id, " + s.NodeComponents.map{|n|
+        if n == c
+          "created"
+        else
+          "*Component#{n}.Find(id)"
+        end
+      }.join(", ") + ");"
+    }
+  end
+
+  # Destroys nodes that contain component type c before it is destroyed
+  def genNodeDestruction(f, c)
+
+    systems = nodeSystemsUsing c
+
+    return if systems.empty?
+
+    systems.each{|s|
+      f.puts "_#{s.Type}.DestroyNode(id);"
+    }
+
+    f.puts "_RemoveFromEntityComponentSignature(id, #{signatureName c});"
+  end
+
+  # Creates and destroys nodes for component types of the parent world
+  def genParentNodeHooks(f, opts)
+
+    return if @ParentNodeComponentTypes.empty?
+
+    if @BaseClass == "GameWorld"
+      raise "component types #{@ParentNodeComponentTypes.join(', ')} used in nodes are " +
+            "not types of this world"
+    end
+
+    f.write "#{export}void #{qualifier opts}_OnComponentCreated(ObjectID id, " +
+            "Leviathan::COMPONENT_TYPE type)#{override opts}"
+
+    if opts.include?(:impl)
+      f.puts "{"
+      f.puts @BaseClass + "::_OnComponentCreated(id, type);"
+      f.puts ""
+      f.puts "switch(static_cast<uint16_t>(type)){"
+
+      @ParentNodeComponentTypes.each{|c|
+        f.puts "case static_cast<uint16_t>(#{c}::TYPE):"
+        f.puts "{"
+        f.puts "auto& created = *Component#{c}.Find(id);"
+        genNodeCreation f, c
+        f.puts "break;"
+        f.puts "}"
+      }
+
+      f.puts "default:"
+      f.puts "break;"
+      f.puts "}"
+      f.puts "}"
+    else
+      f.puts ";"
+    end
+
+    f.write "#{export}void #{qualifier opts}_OnComponentDestroyed(ObjectID id, " +
+            "Leviathan::COMPONENT_TYPE type)#{override opts}"
+
+    if opts.include?(:impl)
+      f.puts "{"
+      f.puts @BaseClass + "::_OnComponentDestroyed(id, type);"
+      f.puts ""
+      f.puts "switch(static_cast<uint16_t>(type)){"
+
+      @ParentNodeComponentTypes.each{|c|
+        f.puts "case static_cast<uint16_t>(#{c}::TYPE):"
+        f.puts "{"
+        genNodeDestruction f, c
+        f.puts "break;"
+        f.puts "}"
+      }
+
+      f.puts "default:"
+      f.puts "break;"
+      f.puts "}"
+      f.puts "}"
+    else
+      f.puts ";"
+    end
+  end
+
+  # Methods used by EntitySerializer to write and read whole components
+  def genSerializationMethods(f, opts)
+
+    serialized = @ComponentTypes.select{|c| c.Serialize}
+
+    f.write "#{export}const std::vector<Leviathan::COMPONENT_TYPE>& " +
+            "#{qualifier opts}GetSerializableComponentTypes() const#{override opts}"
+
+    if opts.include?(:impl)
+      f.puts "{"
+      f.puts "static const std::vector<Leviathan::COMPONENT_TYPE> types = {"
+      serialized.each{|c|
+        f.puts "    #{c.type}::TYPE,"
+      }
+      f.puts "};"
+      f.puts "return types;"
+      f.puts "}"
+    else
+      f.puts ";"
+    end
+
+    f.write "#{export}bool #{qualifier opts}SerializeComponent(ObjectID id, " +
+            "Leviathan::COMPONENT_TYPE type, sf::Packet& packet)#{override opts}"
+
+    if opts.include?(:impl)
+      f.puts "{"
+      f.puts "switch(static_cast<uint16_t>(type)){"
+
+      serialized.each{|c|
+        f.puts "case static_cast<uint16_t>(#{c.type}::TYPE):"
+        f.puts "{"
+        f.puts "const auto* component = Component#{c.type}.Find(id);"
+        f.puts "if(!component)"
+        f.puts "    return false;"
+
+        c.serializedValues.each{|value|
+          f.puts "packet << component->#{value};"
+        }
+
+        f.puts "return true;"
+        f.puts "}"
+      }
+
+      f.puts "default:"
+      f.puts "return #{@BaseClass}::SerializeComponent(id, type, packet);"
+      f.puts "}"
+      f.puts "}"
+    else
+      f.puts ";"
+    end
+
+    f.write "#{export}bool #{qualifier opts}DeserializeComponent(ObjectID id, " +
+            "Leviathan::COMPONENT_TYPE type, sf::Packet& packet)#{override opts}"
+
+    if opts.include?(:impl)
+      f.puts "{"
+      f.puts "switch(static_cast<uint16_t>(type)){"
+
+      serialized.each{|c|
+        f.puts "case static_cast<uint16_t>(#{c.type}::TYPE):"
+        f.puts "{"
+
+        parameters = c.serializedParameters
+        members = c.serializedMembers
+
+        (parameters + members).each{|v|
+          f.puts "#{v.Type} #{v.Name.downcase};"
+        }
+
+        if !parameters.empty? or !members.empty?
+          f.puts "packet" + (parameters + members).map{|v| " >> #{v.Name.downcase}"}.join +
+                 ";"
+          f.puts "if(!packet)"
+          f.puts "    throw Leviathan::InvalidArgument(\"packet ends before the end of " +
+                 "#{c.type} data\");"
+        end
+
+        if c.ClientReplacement
+          f.puts "if(!IsOnServer){"
+          f.puts "    Create_#{c.ClientReplacement}(id);"
+          f.puts "    return true;"
+          f.puts "}"
+        end
+
+        if c.Graphical
+          f.puts "// Needs a scene //"
+          f.puts "if(!GraphicalMode)"
+          f.puts "    return true;"
+        end
+
+        f.write(if members.empty? then "" else "auto& created = " end)
+        f.puts "Create_#{c.type}(id" + parameters.map{|v| ", #{v.Name.downcase}"}.join +
+               ");"
+
+        members.each{|v|
+          f.puts "created.#{v.Name} = #{v.Name.downcase};"
+        }
+
+        f.puts "return true;"
+        f.puts "}"
+      }
+
+      f.puts "default:"
+      f.puts "return #{@BaseClass}::DeserializeComponent(id, type, packet);"
+      f.puts "}"
+      f.puts "}"
+    else
+      f.puts ";"
+    end
+  end
+
   def genMemberConstructor(f, opts)
 
     f.write "#{export}#{qualifier opts}#{@Name}()"
@@ -528,6 +801,40 @@ class GameWorldClass < OutputClass
 
   def genMethods(f, opts)    
 
+    if opts.include?(:header)
+      f.puts "//! Number of ComponentSignature bits used by this and the parent worlds"
+      f.puts "static constexpr int USED_COMPONENT_SIGNATURE_BITS = " +
+             "#{@BaseClass}::USED_COMPONENT_SIGNATURE_BITS + #{@NodeComponentTypes.length};"
+      f.puts "static_assert(USED_COMPONENT_SIGNATURE_BITS <= 64, " +
+             "\"too many component types used in nodes for ComponentSignature\");"
+      f.puts ""
+    end
+
+    if opts.include?(:header) and !@NodeComponentTypes.empty?
+      f.puts "//! Bits for component types in system nodes. These come after the bits of " +
+             "the parent worlds"
+      @NodeComponentTypes.each_with_index{|c, i|
+        f.puts "static constexpr Leviathan::ComponentSignature #{signatureName c} = " +
+               "1ull << (#{@BaseClass}::USED_COMPONENT_SIGNATURE_BITS + #{i});"
+      }
+
+      f.puts "//! The component types each system needs to create a node for an entity"
+      nodeSystems.each{|s|
+        f.puts "static constexpr Leviathan::ComponentSignature #{systemSignatureName s} = " +
+               s.NodeComponents.map{|c| signatureName c}.join(" | ") + ";"
+      }
+      f.puts ""
+    end
+
+    if opts.include?(:header) and !@AccessNames.empty?
+      f.puts "//! Bits for the data tick systems access"
+      @AccessNames.each_with_index{|n, i|
+        f.puts "static constexpr Leviathan::SystemScheduler::AccessMask #{accessName n} = " +
+               "1ull << #{i};"
+      }
+      f.puts ""
+    end
+
     f.write "#{export}void #{qualifier opts}_ResetOrReleaseComponents()#{override opts}"
 
     if opts.include?(:impl)
@@ -609,6 +916,9 @@ class GameWorldClass < OutputClass
       if opts.include?(:impl)
         f.puts "{"
 
+        genNodeDestruction f, c.type
+        f.puts "_OnComponentDestroyed(id, #{c.type}::TYPE);"
+
         if c.Release
           f.puts "    const bool destroyed = Component#{c.type}.ReleaseIfExists(id, true" +
                  if c.Release.length > 0
@@ -618,7 +928,6 @@ class GameWorldClass < OutputClass
         else
           f.puts "    const bool destroyed = Component#{c.type}.DestroyIfExists(id, true);"
         end
-        f.puts "    //_OnComponentDestroyed(id, #{c.type}::TYPE());"
         f.puts "    return destroyed;"
         
         f.puts "}"
@@ -640,8 +949,12 @@ class GameWorldClass < OutputClass
           f.write "\n"
           f.puts "{"
 
-          f.puts "return *Component#{c.type}.ConstructNew(id" +
+          f.puts "auto& created = *Component#{c.type}.ConstructNew(id" +
                  a.formatNames(c.type) + ");"
+          genNodeCreation f, c.type
+          # Derived worlds may have nodes with this type
+          f.puts "_OnComponentCreated(id, #{c.type}::TYPE);"
+          f.puts "return created;"
           
           f.puts "}"
         else
@@ -696,7 +1009,19 @@ class GameWorldClass < OutputClass
 
     if opts.include?(:impl)
       f.puts "{"
+
+      # Nodes can contain components of the parent world
+      if !nodeSystems.empty?
+        f.puts "// Destroy nodes before the components in them //"
+        nodeSystems.each{|s|
+          f.puts "_#{s.Type}.DestroyNode(id);"
+        }
+        f.puts "_ClearEntityComponentSignature(id);"
+        f.puts ""
+      end
+
       f.puts @BaseClass + "::DestroyAllIn(id);"
+
       @ComponentTypes.each{|c|
         if c.Release
           f.puts "Component#{c.type}.ReleaseIfExists(id, true" +
@@ -823,7 +1148,8 @@ class GameWorldClass < OutputClass
     else
       f.puts ";"
     end
-    
+
+    genSerializationMethods f, opts
 
     # Gets for systems
     if opts.include?(:header)
@@ -943,6 +1269,8 @@ END
       f.puts "protected:"
     end
 
+    genParentNodeHooks f, opts
+
     f.write "#{export}void #{qualifier opts}_RunTickSystems()#{override opts}"
 
     if opts.include?(:impl)
@@ -957,6 +1285,18 @@ END
       tickSystems = @Systems.select{|s| !s.RunTick.nil?}.sort_by {|x| x.RunTick[:group]}
 
       outGroup = nil
+
+      # Systems are added in the group order and only systems that don't access the same
+      # data run at the same time
+      f.puts "TickSystemScheduler.BeginSystems();"
+
+      # Systems not touching the physics data can run while physics is being simulated
+      if !@PhysicsAccess.empty?
+        f.puts "TickSystemScheduler.AddSystem(\"PhysicsUpdate\", 0, " +
+               "#{formatAccessMask @PhysicsAccess}, [&](){"
+        f.puts "_WaitForPhysicsUpdate();"
+        f.puts "});"
+      end
       
       tickSystems.each{|s|
 
@@ -964,102 +1304,21 @@ END
           outGroup = s.RunTick[:group]
           f.puts "// Begin of group #{s.RunTick[:group]} //"
         end
+
+        if s.declaresAccess
+          f.puts "TickSystemScheduler.AddSystem(\"#{s.Type}\", " +
+                 "#{formatAccessMask s.Reads}, #{formatAccessMask s.Writes}, [&](){"
+        else
+          f.puts "TickSystemScheduler.AddExclusiveSystem(\"#{s.Type}\", [&](){"
+        end
         
         f.puts "_#{s.Type}.Run(*this" +
                formatEntitySystemParameters(s.RunTick) + ");"
-      }
-      f.puts "}"
-    else
-      f.puts ";"
-    end
-
-    f.write "#{export}void #{qualifier opts}HandleAddedAndDeleted()#{override opts}"
-
-    if opts.include?(:impl)
-      f.puts "{"
-      f.puts @BaseClass + "::HandleAddedAndDeleted();"
-      f.puts ""
-      
-      @ComponentTypes.each{|c|
-        f.puts "const auto& added#{c.type} = Component#{c.type}.GetAdded();"
-      }
-
-      addedComment = false
-
-      # Added types from parent world types
-      alreadySet = {}
-      
-      @Systems.each{|s|
-        
-        if s.NodeComponents.empty?
-          next
-        end
-
-        s.NodeComponents.each{|c|
-          found = false
-
-          @ComponentTypes.each{|doesMatch|
-            if doesMatch.type == c
-              found = true
-              break
-            end
-          }
-
-          if !found
-            found = alreadySet.include? c
-          end
-
-          if !found
-            alreadySet[c] = true
-              
-            if !addedComment
-              addedComment = true
-              f.puts ""
-              f.puts "// Component types of parent type"
-            end
-
-            f.puts "const auto& added#{c} = Component#{c}.GetAdded();"
-            f.puts "const auto& removed#{c} = Component#{c}.GetRemoved();"
-          end
-        }
+        f.puts "});"
       }
 
       f.puts ""
-      f.puts ""
-      f.puts "// Added"
-      
-      @Systems.each{|s|
-        
-        if !s.NodeComponents.empty?
-
-          f.write "if(" + s.NodeComponents.map{|c| "!added" + c + ".empty()" }.join(" || ")
-          f.puts "){"
-          
-          f.puts "    _#{s.Type}.CreateNodes("
-          f.puts "        " + (s.NodeComponents.map{|c| "added" + c }.join(", ")) + ","
-          f.puts "        " + (s.NodeComponents.map{|c| "Component" + c }.join(", ")) + ");"
-          f.puts "}"
-        end
-      }
-
-      f.puts "// Removed"
-      @ComponentTypes.each{|c|
-        f.puts "const auto& removed#{c.type} = Component#{c.type}.GetRemoved();"
-      }
-
-      @Systems.each{|s|
-        
-        if !s.NodeComponents.empty?
-
-          f.write "if(" + s.NodeComponents.map{|c| "!removed" + c + ".empty()" }.join(" || ")
-          f.puts "){"
-          
-          f.puts "    _#{s.Type}.DestroyNodes("
-          f.puts "        " + (s.NodeComponents.map{|c| "removed" + c }.join(", ")) + ");"
-          f.puts "}"
-        end
-      }      
-
+      f.puts "TickSystemScheduler.Run();"
       f.puts "}"
     else
       f.puts ";"
@@ -1420,26 +1679,71 @@ end
 # Components for adding to gameworld
 class EntityComponent
   
-  attr_reader :type, :constructors, :StateType, :Release
+  attr_reader :type, :constructors, :StateType, :Release, :Dense, :Serialize, :Graphical,
+              :ClientReplacement
   
-  def initialize(type, constructors=[ConstructorInfo.new], statetype: nil, releaseparams: nil)
+  # If dense is true the components are kept in a DenseComponentHolder. These can't be used
+  # in system nodes and the component type needs to be move constructible
+  #
+  # serialize makes EntitySerializer save the component. The strings in it are members that
+  # are passed to the parameters of the first constructor in order. Variables are members
+  # that are set after the component is created. graphical components are skipped when
+  # loading into a world without graphics and on clients clientreplacement is created
+  # instead of this type
+  def initialize(type, constructors=[ConstructorInfo.new], statetype: nil, releaseparams: nil,
+                 dense: false, serialize: nil, graphical: false, clientreplacement: nil)
     @type = type
     @constructors = constructors
     @StateType = statetype
     @Release = releaseparams
+    @Dense = dense
+    @Serialize = serialize
+    @Graphical = graphical
+    @ClientReplacement = clientreplacement
+
+    if @Serialize and serializedValues.length != serializedValues.uniq.length
+      raise "component #{type} serializes the same member twice"
+    end
+
+    if @Serialize and serializedParameters.length !=
+                      @Serialize.select{|s| s.is_a? String}.length
+      raise "component #{type} serialize doesn't match the parameters of its first " +
+            "constructor"
+    end
+  end
+
+  # Constructor parameters that are read from serialized data
+  def serializedParameters
+    @constructors[0].Parameters.select{|p| !p.NonMethodParam}
+  end
+
+  # Members that are set after the component is created from serialized data
+  def serializedMembers
+    @Serialize.select{|s| s.is_a? Variable}
+  end
+
+  # The members in the order they are written
+  def serializedValues
+    @Serialize.select{|s| s.is_a? String} + serializedMembers.map(&:Name)
   end
 
 end
 
 class EntitySystem
   attr_reader :Type, :NodeComponents, :RunTick, :RunRender, :Init, :Release, :NoState,
-              :VisibleToScripts
+              :VisibleToScripts, :Reads, :Writes
 
   # Leave nodeComponens empty if not using combined nodes
+  # reads and writes list the names of the data (component types, state holders etc.) the
+  # tick run of this system accesses. If neither is given the system can't run in parallel
+  # with any other system
   def initialize(type, nodeComponents=[], runtick: nil, runrender: nil, init: nil, 
-                 release: nil, nostate: nil, visibletoscripts: false)
+                 release: nil, nostate: nil, visibletoscripts: false, reads: nil,
+                 writes: nil)
     @Type = type
     @NodeComponents = nodeComponents
+    @Reads = reads
+    @Writes = writes
     @RunTick = runtick
     @RunRender = runrender
     @Init = init
@@ -1454,6 +1758,17 @@ class EntitySystem
     if @Release
       raise "wrong type" unless @Release.is_a? Array
     end
+    if @Reads
+      raise "wrong type" unless @Reads.is_a? Array
+    end
+    if @Writes
+      raise "wrong type" unless @Writes.is_a? Array
+    end
+  end
+
+  # True if the system has declared what it accesses
+  def declaresAccess
+    !@Reads.nil? or !@Writes.nil?
   end
 end
 
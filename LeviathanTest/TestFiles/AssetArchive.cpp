@@ -0,0 +1,149 @@
+#include "AssetArchive.h"
+#include "Exceptions.h"
+#include "FileSystem.h"
+
+#include "../PartialEngine.h"
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <random>
+
+using namespace Leviathan;
+using namespace Leviathan::Test;
+
+constexpr auto TEST_ARCHIVE = "Test/AssetArchiveTest.lvpk";
+constexpr auto TEXT_FILE = "Test/AssetArchiveTest_text.txt";
+constexpr auto RANDOM_FILE = "Test/AssetArchiveTest_random.bin";
+constexpr auto EMPTY_FILE = "Test/AssetArchiveTest_empty.txt";
+
+//! Creates the files for the tests and returns their contents
+std::vector<std::string> CreateArchiveTestFiles()
+{
+    std::string text;
+
+    for(int i = 0; i < 200; ++i)
+        text += "Line " + std::to_string(i % 10) + " of the compressible file\n";
+
+    std::string random;
+    std::mt19937 generator(42);
+
+    for(int i = 0; i < 4000; ++i)
+        random.push_back(static_cast<char>(generator()));
+
+    REQUIRE(FileSystem::WriteToFile(text, TEXT_FILE));
+    REQUIRE(FileSystem::WriteToFile(random, RANDOM_FILE));
+    REQUIRE(FileSystem::WriteToFile(std::string(), EMPTY_FILE));
+
+    return {text, random, ""};
+}
+
+TEST_CASE("AssetArchive packs and reads files", "[filesystem]")
+{
+    const auto contents = CreateArchiveTestFiles();
+
+    DummyReporter reporter;
+    AssetArchivePackStats stats;
+
+    REQUIRE(AssetArchive::Pack(
+        TEST_ARCHIVE, {TEXT_FILE, RANDOM_FILE, EMPTY_FILE}, &reporter, &stats));
+
+    CHECK(stats.Files == 3);
+    CHECK(stats.CompressedFiles == 1);
+    CHECK(stats.StoredBytes < stats.OriginalBytes);
+
+    AssetArchive archive(TEST_ARCHIVE);
+
+    REQUIRE(archive.GetEntryCount() == 3);
+
+    CHECK(archive.Find("Test/not a file.txt") == nullptr);
+
+    const auto* text = archive.Find(TEXT_FILE);
+    const auto* random = archive.Find(RANDOM_FILE);
+    const auto* empty = archive.Find(EMPTY_FILE);
+
+    REQUIRE(text);
+    REQUIRE(random);
+    REQUIRE(empty);
+
+    CHECK(archive.GetPath(*text) == TEXT_FILE);
+
+    std::string data;
+
+    CHECK(archive.IsCompressed(*text));
+    CHECK(archive.GetUncompressedData(*text).empty());
+    REQUIRE(archive.ReadEntry(*text, data));
+    CHECK(data == contents[0]);
+
+    // Random data doesn't compress so it can be used from the mapping directly //
+    CHECK(!archive.IsCompressed(*random));
+    CHECK(archive.GetUncompressedData(*random) == contents[1]);
+    REQUIRE(archive.ReadEntry(*random, data));
+    CHECK(data == contents[1]);
+
+    REQUIRE(archive.ReadEntry(*empty, data));
+    CHECK(data.empty());
+
+    SECTION("Duplicate files can't be packed")
+    {
+        CHECK(!AssetArchive::Pack(TEST_ARCHIVE, {TEXT_FILE, TEXT_FILE}, &reporter));
+    }
+}
+
+TEST_CASE("AssetArchive rejects invalid files", "[filesystem]")
+{
+    CHECK_THROWS_AS(AssetArchive("Test/AssetArchiveTest_missing.lvpk"), InvalidArgument);
+
+    const auto contents = CreateArchiveTestFiles();
+
+    CHECK_THROWS_AS(AssetArchive(TEXT_FILE), InvalidArgument);
+
+    DummyReporter reporter;
+    REQUIRE(AssetArchive::Pack(TEST_ARCHIVE, {TEXT_FILE}, &reporter));
+
+    // Cut off the data //
+    std::string archivedata;
+    REQUIRE(FileSystem::ReadFileEntirely(TEST_ARCHIVE, archivedata));
+    archivedata.resize(archivedata.size() - 10);
+    REQUIRE(FileSystem::WriteToFile(archivedata, TEST_ARCHIVE));
+
+    CHECK_THROWS_AS(AssetArchive(TEST_ARCHIVE), InvalidArgument);
+}
+
+TEST_CASE("FileSystem finds and reads files in mounted archives", "[filesystem]")
+{
+    PartialEngine<false> engine;
+
+    const auto contents = CreateArchiveTestFiles();
+
+    DummyReporter reporter;
+    REQUIRE(AssetArchive::Pack(TEST_ARCHIVE, {TEXT_FILE, RANDOM_FILE}, &reporter));
+
+    // The files are only in the archive //
+    std::remove(TEXT_FILE);
+    std::remove(RANDOM_FILE);
+
+    FileSystem filesystem;
+    REQUIRE(filesystem.Init(&engine.Log));
+
+    CHECK(!FileSystem::FileExists(TEXT_FILE));
+
+    REQUIRE(filesystem.MountArchive(TEST_ARCHIVE));
+
+    CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "AssetArchiveTest_text", "txt") ==
+          TEXT_FILE);
+
+    CHECK(filesystem
+              .FindAllMatchingFiles(FILEGROUP_OTHER, "AssetArchiveTest_.*", "txt|bin")
+              .size() == 2);
+
+    CHECK(FileSystem::FileExists(TEXT_FILE));
+    CHECK(FileSystem::GetFileLength(TEXT_FILE) == contents[0].size());
+
+    std::string data;
+    REQUIRE(FileSystem::ReadFileEntirely(TEXT_FILE, data));
+    CHECK(data == contents[0]);
+
+    CHECK(filesystem.GetArchivedFileData(TEXT_FILE).empty());
+    CHECK(filesystem.GetArchivedFileData(RANDOM_FILE) == contents[1]);
+}
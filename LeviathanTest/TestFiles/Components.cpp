@@ -66,12 +66,21 @@ TEST_CASE("RenderingPositionSystem creates nodes", "[entity]"){
     
     RenderingPositionSystem _RenderingPositionSystem;
     
-    _RenderingPositionSystem.CreateNodes(
-        addedRenderNode, addedPosition,
-        ComponentRenderNode, ComponentPosition);    
-    
+    _RenderingPositionSystem.CreateNode(
+        id, *ComponentRenderNode.Find(id), *ComponentPosition.Find(id));
+
+    CHECK(_RenderingPositionSystem.GetCachedComponentCollectionCount() == 1);
+
+    // Creating again must not duplicate the node
+    _RenderingPositionSystem.CreateNode(
+        id, *ComponentRenderNode.Find(id), *ComponentPosition.Find(id));
+
     CHECK(_RenderingPositionSystem.GetCachedComponentCollectionCount() == 1);
 
+    CHECK(_RenderingPositionSystem.DestroyNode(id));
+    CHECK(!_RenderingPositionSystem.DestroyNode(id));
+    CHECK(_RenderingPositionSystem.GetCachedComponentCollectionCount() == 0);
+
 }
 
 TEST_CASE("PositionStateSystem creates state objects", "[entity]"){
@@ -370,3 +379,98 @@ TEST_CASE("PositionStateSystem multiple states with gaps can be interpolated", "
 }
 
 
+
+TEST_CASE("DenseComponentHolder keeps components packed on removal", "[entity]"){
+
+    DenseComponentHolder<Position> ComponentPosition;
+
+    for(ObjectID id = 1; id <= 5; ++id){
+
+        ComponentPosition.ConstructNew(id,
+            Position::Data{Float3(static_cast<float>(id), 0, 0),
+                    Float4::IdentityQuaternion()});
+    }
+
+    CHECK(ComponentPosition.GetObjectCount() == 5);
+    CHECK(ComponentPosition.GetAdded().size() == 5);
+
+    CHECK(ComponentPosition.DestroyIfExists(2, true));
+    CHECK(!ComponentPosition.DestroyIfExists(2, true));
+
+    CHECK(ComponentPosition.GetObjectCount() == 4);
+    CHECK(ComponentPosition.GetRemoved().size() == 1);
+    CHECK(ComponentPosition.GetAdded().size() == 4);
+    CHECK(!ComponentPosition.Find(2));
+
+    // The last element was moved to the freed slot
+    REQUIRE(ComponentPosition.Find(5));
+    CHECK(ComponentPosition.Find(5) == &ComponentPosition.GetElements()[1]);
+    CHECK(ComponentPosition.Find(5)->Members._Position == Float3(5, 0, 0));
+
+    // Added pointers are refreshed
+    for(const auto& added : ComponentPosition.GetAdded()){
+
+        CHECK(std::get<0>(added) == ComponentPosition.Find(std::get<1>(added)));
+    }
+
+    size_t count = 0;
+    auto& index = ComponentPosition.GetIndex();
+    for(auto iter = index.begin(); iter != index.end(); ++iter){
+
+        CHECK(iter->second->Members._Position.X == static_cast<float>(iter->first));
+        ++count;
+    }
+
+    CHECK(count == 4);
+}
+
+TEST_CASE("Iterating Position components in holder backends", "[entity][benchmark][.slow]"){
+
+    PartialEngine<false> engine;
+
+    constexpr ObjectID ENTITY_COUNT = 100000;
+
+    ComponentHolder<Position> ComponentPosition;
+    DenseComponentHolder<Position> DenseComponentPosition;
+
+    for(ObjectID id = 1; id <= ENTITY_COUNT; ++id){
+
+        const Position::Data data{Float3(static_cast<float>(id), 1, 2),
+                Float4::IdentityQuaternion()};
+
+        ComponentPosition.ConstructNew(id, data);
+        DenseComponentPosition.ConstructNew(id, data);
+    }
+
+    // Make the layouts more realistic by removing some of the entities
+    for(ObjectID id = 1; id <= ENTITY_COUNT; id += 7){
+
+        ComponentPosition.Destroy(id);
+        DenseComponentPosition.Destroy(id);
+    }
+
+    REQUIRE(ComponentPosition.GetObjectCount() == DenseComponentPosition.GetObjectCount());
+
+    int64_t sparseSum = 0;
+    int64_t denseSum = 0;
+
+    BENCHMARK("ComponentHolder (boost::pool + unordered_map)"){
+
+        auto& index = ComponentPosition.GetIndex();
+        for(auto iter = index.begin(); iter != index.end(); ++iter){
+
+            sparseSum += static_cast<int64_t>(iter->second->Members._Position.X);
+        }
+    }
+
+    BENCHMARK("DenseComponentHolder"){
+
+        auto& index = DenseComponentPosition.GetIndex();
+        for(auto iter = index.begin(); iter != index.end(); ++iter){
+
+            denseSum += static_cast<int64_t>(iter->second->Members._Position.X);
+        }
+    }
+
+    CHECK(sparseSum == denseSum);
+}
@@ -5,6 +5,9 @@
 
 #include "catch.hpp"
 
+#include <array>
+#include <thread>
+
 using namespace Leviathan;
 
 class InvokeTestPartialEngine : public Test::PartialEngine<false>{
@@ -12,12 +15,11 @@ public:
 
     void RunInvokes(){
 
-        {
-            RecursiveLock lock(InvokeLock);
-            CHECK(!InvokeQueue.empty());
-        }
+        CHECK(GetInvokeMetrics().Depth > 0);
 
         ProcessInvokes();
+
+        CHECK(GetInvokeMetrics().Depth == 0);
     }
 };
 
@@ -62,6 +64,185 @@ TEST_CASE("Invokes work", "[engine][threading]"){
     }
 }
 
+TEST_CASE("InvokeQueue runs functions in order", "[engine][threading]"){
+
+    // Small so that the overflow is used //
+    InvokeQueue queue(4);
+
+    CHECK(queue.GetCapacity() == 4);
+
+    std::vector<int> ran;
+
+    for(int i = 0; i < 10; ++i)
+        queue.Push([&ran, i](){ ran.push_back(i); });
+
+    auto metrics = queue.GetMetrics();
+
+    CHECK(metrics.Depth == 10);
+    CHECK(metrics.MaxDepth == 10);
+    CHECK(metrics.Overflowed == 6);
+
+    queue.RunAll();
+
+    REQUIRE(ran.size() == 10);
+
+    for(int i = 0; i < 10; ++i)
+        CHECK(ran[i] == i);
+
+    metrics = queue.GetMetrics();
+
+    CHECK(metrics.Depth == 0);
+    CHECK(metrics.Executed == 10);
+    CHECK(metrics.MaxLatencyMicroseconds >= metrics.AverageLatencyMicroseconds);
+
+    SECTION("Large callables and callables queuing more"){
+
+        ran.clear();
+
+        std::array<int, 64> large;
+        large.fill(5);
+
+        queue.Push([&, large](){
+
+            ran.push_back(large[63]);
+
+            for(int i = 0; i < 6; ++i)
+                queue.Push([&ran, i](){ ran.push_back(i); });
+        });
+
+        queue.RunAll();
+
+        CHECK(ran == std::vector<int>{5, 0, 1, 2, 3, 4, 5});
+    }
+
+    SECTION("Unran functions are released"){
+
+        auto shared = std::make_shared<int>(1);
+
+        {
+            InvokeQueue other(2);
+
+            for(int i = 0; i < 4; ++i)
+                other.Push([shared](){});
+
+            CHECK(shared.use_count() == 5);
+        }
+
+        CHECK(shared.use_count() == 1);
+    }
+}
+
+TEST_CASE("InvokeQueue with multiple producer threads", "[engine][threading]"){
+
+    InvokeQueue queue(64);
+
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 5000;
+
+    std::vector<int> lastseen(THREADS, -1);
+    bool inorder = true;
+    int count = 0;
+
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+
+    for(int thread = 0; thread < THREADS; ++thread){
+
+        threads.emplace_back([&, thread](){
+
+            for(int i = 0; i < PER_THREAD; ++i){
+
+                queue.Push([&, thread, i](){
+
+                    if(lastseen[thread] + 1 != i)
+                        inorder = false;
+
+                    lastseen[thread] = i;
+                    ++count;
+                });
+            }
+
+            ++finished;
+        });
+    }
+
+    while(finished < THREADS)
+        queue.RunAll();
+
+    for(auto& thread : threads)
+        thread.join();
+
+    queue.RunAll();
+
+    CHECK(inorder);
+    CHECK(count == THREADS * PER_THREAD);
+    CHECK(queue.GetMetrics().Executed == static_cast<uint64_t>(THREADS * PER_THREAD));
+}
+
+//! Callable that blocks when copied into the queue so that its cell stays reserved but
+//! not written
+class BlockingInvoke{
+public:
+    BlockingInvoke(std::vector<int>& ran, std::atomic<bool>& reserved,
+        std::atomic<bool>& release) :
+        Ran(ran), Reserved(reserved), Release(release)
+    {}
+
+    BlockingInvoke(const BlockingInvoke& other) :
+        Ran(other.Ran), Reserved(other.Reserved), Release(other.Release)
+    {
+        Reserved = true;
+
+        while(!Release)
+            std::this_thread::yield();
+    }
+
+    void operator()(){
+        Ran.push_back(0);
+    }
+
+    std::vector<int>& Ran;
+    std::atomic<bool>& Reserved;
+    std::atomic<bool>& Release;
+};
+
+TEST_CASE("InvokeQueue overflow waits for reserved cells", "[engine][threading]"){
+
+    InvokeQueue queue(4);
+
+    std::vector<int> ran;
+    std::atomic<bool> reserved{false};
+    std::atomic<bool> release{false};
+
+    std::thread blocked([&](){
+            queue.Push(BlockingInvoke(ran, reserved, release));
+        });
+
+    while(!reserved)
+        std::this_thread::yield();
+
+    // Fills the ring buffer behind the unwritten cell and then goes to the overflow //
+    for(int i = 1; i < 5; ++i)
+        queue.Push([&ran, i](){ ran.push_back(i); });
+
+    CHECK(queue.GetMetrics().Overflowed == 1);
+
+    std::thread consumer([&](){
+            queue.RunAll();
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+
+    blocked.join();
+    consumer.join();
+
+    REQUIRE(ran.size() == 5);
+
+    for(int i = 0; i < 5; ++i)
+        CHECK(ran[i] == i);
+}
+
 TEST_CASE("Invokes work from scripts", "[engine][script]"){
 
     CHECK(Engine::Get() == nullptr);
@@ -8,22 +8,223 @@
 
 #include "catch.hpp"
 
+#include <deque>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
+constexpr float POSITION_TOLERANCE = 1.f / POSITION_STATE_UNITS_PER_METER;
+constexpr float ORIENTATION_TOLERANCE = 1.f / ORIENTATION_STATE_UNITS;
 
 TEST_CASE("Positionable delta state interpolation", "[networking][entity]"){
 
+    Position first(Position::Data{Float3(0, 0, 0), Float4::IdentityQuaternion()});
+    Position second(Position::Data{Float3(2, 4, -8), Float4::IdentityQuaternion()});
+
+    PositionComponentState firstState(1, first);
+    PositionComponentState secondState(2, second);
+
+    Position target(Position::Data{Float3(0, 0, 0), Float4::IdentityQuaternion()});
+    target.Marked = false;
+
+    firstState.Interpolate(target, secondState, 0.5f);
+
+    CHECK(target.Marked);
+    CHECK(target.Members._Position.X == Approx(1));
+    CHECK(target.Members._Position.Y == Approx(2));
+    CHECK(target.Members._Position.Z == Approx(-4));
 }
 
 TEST_CASE("Position state through packet and interpolate", "[networking][entity]")
 {
+    Position position(Position::Data{Float3(1.3f, -20.75f, 1000.1f),
+        Float4::CreateQuaternionFromAngles(Float3(0.2f, 1.f, 0.5f))});
+
+    PositionComponentState original(5, position);
+
+    SECTION("Full update"){
+
+        sf::Packet packet;
+        original.CreateUpdatePacket(nullptr, packet);
+
+        PositionComponentState loaded(5, packet, nullptr);
+
+        CHECK(loaded.Matches(original));
+        CHECK(loaded._Position.BitsSetUntil(2));
+        CHECK(loaded._Rotation.BitsSetUntil(3));
+
+        CHECK(loaded._Position.Value.X == Approx(1.3f).margin(POSITION_TOLERANCE));
+        CHECK(loaded._Position.Value.Y == Approx(-20.75f).margin(POSITION_TOLERANCE));
+        CHECK(loaded._Position.Value.Z == Approx(1000.1f).margin(POSITION_TOLERANCE));
+        CHECK(loaded._Rotation.Value.W == Approx(position.Members._Orientation.W).margin(
+                ORIENTATION_TOLERANCE));
+    }
+
+    SECTION("Delta update"){
+
+        position.Members._Position.X += 0.5f;
+
+        PositionComponentState moved(6, position);
+
+        sf::Packet packet;
+        moved.CreateUpdatePacket(&original, packet);
+
+        // Only the changed axis is included //
+        CHECK(packet.getDataSize() <= 3);
 
+        sf::Packet copy = packet;
+        CHECK_THROWS_AS(PositionComponentState(6, copy, nullptr), InvalidArgument);
+
+        PositionComponentState loaded(6, packet, &original);
+
+        CHECK(loaded.Matches(moved));
+        CHECK(!loaded.Matches(original));
+        CHECK(loaded._Position.Value.X == Approx(1.8f).margin(POSITION_TOLERANCE));
+
+        // And it can be interpolated to //
+        Position target(Position::Data{Float3(0, 0, 0), Float4::IdentityQuaternion()});
+
+        original.Interpolate(target, loaded, 0.5f);
+
+        CHECK(target.Members._Position.X == Approx(1.55f).margin(POSITION_TOLERANCE));
+        CHECK(target.Members._Position.Z == Approx(1000.1f).margin(POSITION_TOLERANCE));
+    }
+
+    SECTION("Truncated packet is detected"){
+
+        sf::Packet packet;
+        original.CreateUpdatePacket(nullptr, packet);
+
+        sf::Packet truncated;
+        truncated.append(packet.getData(), packet.getDataSize() - 1);
+
+        CHECK_THROWS_AS(PositionComponentState(5, truncated, nullptr), InvalidArgument);
+    }
 }
 
-TEST_CASE("Position state fill missing data", "[networking][entity"){
+TEST_CASE("Position state fill missing data", "[networking][entity]"){
+
+    Position position(Position::Data{Float3(1, 2, 3), Float4::IdentityQuaternion()});
+
+    PositionComponentState full(1, position);
+
+    // A full update that only has the X axis //
+    sf::Packet packet;
+    packet << static_cast<uint8_t>(1) << static_cast<uint8_t>(4);
 
+    PositionComponentState partial(2, packet, nullptr);
+
+    CHECK(partial._Position.IsBitSet(0));
+    CHECK(!partial._Position.IsBitSet(1));
+    CHECK(!partial._Rotation.IsBitSet(0));
+
+    CHECK(partial.FillMissingData(full));
+
+    CHECK(partial._Position.Value.X == Approx(2.f / POSITION_STATE_UNITS_PER_METER));
+    CHECK(partial._Position.Value.Y == Approx(2));
+    CHECK(partial._Position.Value.Z == Approx(3));
+    CHECK(partial._Rotation.Value.W == Approx(1));
 }
 
+TEST_CASE("Sendable drops too old delta references", "[networking][entity]"){
+
+    Position position(Position::Data{Float3(1, 2, 3), Float4::IdentityQuaternion()});
 
+    Sendable::ActiveConnection connection(nullptr);
 
+    CHECK(!connection.GetDeltaReference(1));
+
+    connection.LastConfirmedTickNumber = 10;
+    connection.LastConfirmedData = std::make_shared<PositionComponentState>(10, position);
+
+    CHECK(connection.GetDeltaReference(11));
+    CHECK(connection.GetDeltaReference(10 + BASESENDABLE_STORED_RECEIVED_STATES - 2));
+
+    // The client no longer has the state //
+    CHECK(!connection.GetDeltaReference(10 + BASESENDABLE_STORED_RECEIVED_STATES - 1));
+    CHECK(!connection.LastConfirmedData);
+    CHECK(connection.LastConfirmedTickNumber == -1);
+}
+
+TEST_CASE("Delta updates use fewer bytes than full states", "[networking][entity]"){
+
+    constexpr int ENTITY_COUNT = 1000;
+    constexpr int TICKS = 60;
+    // Updates are confirmed this many ticks after they are sent //
+    constexpr int CONFIRM_DELAY = 2;
+
+    static_assert(CONFIRM_DELAY < BASESENDABLE_STORED_RECEIVED_STATES - 1,
+        "test assumes that references don't expire");
+
+    std::vector<Position> positions;
+    positions.reserve(ENTITY_COUNT);
+
+    for(int i = 0; i < ENTITY_COUNT; ++i){
+
+        positions.emplace_back(Position::Data{Float3(i * 2.f, 0, -i * 0.5f),
+                Float4::IdentityQuaternion()});
+    }
+
+    // The states each entity had at the ticks the client has confirmed //
+    std::deque<std::vector<std::shared_ptr<PositionComponentState>>> sentStates;
+
+    size_t fullBytes = 0;
+    size_t deltaBytes = 0;
+
+    for(int tick = 1; tick <= TICKS; ++tick){
+
+        // A quarter of the entities walk, a tenth also turn and the rest stand still //
+        for(int i = 0; i < ENTITY_COUNT; ++i){
+
+            if(i % 4 == 0)
+                positions[i].Members._Position.X += 0.05f;
+
+            if(i % 10 == 0){
+                positions[i].Members._Orientation = Float4::CreateQuaternionFromAngles(
+                    Float3(0, tick * 0.02f, 0));
+            }
+        }
+
+        std::vector<std::shared_ptr<PositionComponentState>> current;
+        current.reserve(ENTITY_COUNT);
+
+        const auto* reference = sentStates.size() >= CONFIRM_DELAY ?
+            &sentStates[sentStates.size() - CONFIRM_DELAY] : nullptr;
+
+        for(int i = 0; i < ENTITY_COUNT; ++i){
+
+            // What was sent before delta updates //
+            sf::Packet full;
+            full << positions[i].Members._Position << positions[i].Members._Orientation;
+            fullBytes += full.getDataSize();
+
+            current.push_back(std::make_shared<PositionComponentState>(tick, positions[i]));
+
+            auto* confirmed = reference ? (*reference)[i].get() : nullptr;
+
+            // Like SendableSystem nothing is sent once the client has the state //
+            if(confirmed && confirmed->Matches(*current.back()))
+                continue;
+
+            sf::Packet delta;
+            current.back()->CreateUpdatePacket(confirmed, delta);
+            deltaBytes += delta.getDataSize();
+
+            // The client can decode it //
+            PositionComponentState decoded(tick, delta, confirmed);
+            REQUIRE(decoded.Matches(*current.back()));
+        }
+
+        sentStates.push_back(std::move(current));
+
+        if(sentStates.size() > BASESENDABLE_STORED_RECEIVED_STATES)
+            sentStates.pop_front();
+    }
+
+    const double fullPerEntity = static_cast<double>(fullBytes) / (ENTITY_COUNT * TICKS);
+    const double deltaPerEntity = static_cast<double>(deltaBytes) / (ENTITY_COUNT * TICKS);
+
+    WARN("Bytes per entity per tick, full: " << fullPerEntity << " delta: " << deltaPerEntity);
+
+    CHECK(deltaPerEntity * 4 < fullPerEntity);
+}
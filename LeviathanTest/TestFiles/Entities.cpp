@@ -2,12 +2,21 @@
 
 #include "Entities/GameWorld.h"
 #include "Entities/Components.h"
+#include "Entities/Serializers/EntitySerializer.h"
+#include "Entities/SystemScheduler.h"
 #include "Handlers/ObjectLoader.h"
+#include "Newton/NewtonManager.h"
+#include "Newton/PhysicsMaterialManager.h"
+#include "Threading/ThreadingManager.h"
 
 #include "Generated/StandardWorld.h"
 
 #include "catch.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -59,3 +68,412 @@ TEST_CASE("Entity parent destruction deletes children", "[entity]"){
     TargetWorld.Release();
     CHECK(TargetWorld.GetEntityCount() == 0);
 }
+
+TEST_CASE("Entity parent can be replaced and destroyed children are unparented", "[entity]")
+{
+    PartialEngine<false> engine;
+
+    StandardWorld world;
+
+    const auto first = world.CreateEntity();
+    const auto second = world.CreateEntity();
+    const auto child = world.CreateEntity();
+    const auto grandchild = world.CreateEntity();
+
+    world.Create_Position(grandchild, Float3(0), Float4::IdentityQuaternion());
+
+    world.SetEntitysParent(child, first);
+    world.SetEntitysParent(grandchild, child);
+
+    // Moves child and its children to second //
+    world.SetEntitysParent(child, second);
+    CHECK(world.GetEntityParents().size() == 2);
+
+    world.DestroyEntity(first);
+    CHECK(world.IsEntityAlive(child));
+    CHECK(world.IsEntityAlive(grandchild));
+
+    // A destroyed child no longer has a parent //
+    world.DestroyEntity(grandchild);
+    CHECK(!world.IsEntityAlive(grandchild));
+    CHECK(world.GetEntityParents().size() == 1);
+
+    // Loops don't destroy anything twice //
+    world.SetEntitysParent(second, child);
+
+    world.DestroyEntity(second);
+    CHECK(!world.IsEntityAlive(second));
+    CHECK(!world.IsEntityAlive(child));
+    CHECK(world.GetEntityCount() == 0);
+    CHECK(world.GetEntityParents().empty());
+
+    world.Release();
+}
+
+TEST_CASE("GameWorld destroys 50k queued entities in one tick", "[entity]")
+{
+    PartialEngine<false> engine;
+
+    NewtonManager newtonInstance;
+
+    PhysicsMaterialManager physMan(&newtonInstance);
+
+    StandardWorld world;
+
+    REQUIRE(world.Init(NETWORKED_TYPE::Client, nullptr, nullptr));
+
+    constexpr auto ENTITY_COUNT = 50000;
+
+    const auto root = world.CreateEntity();
+    const auto other = world.CreateEntity();
+
+    std::vector<ObjectID> entities;
+    entities.reserve(ENTITY_COUNT);
+
+    // Half of the entities form a single deep chain and the rest are children of root //
+    ObjectID previous = root;
+
+    for(int i = 0; i < ENTITY_COUNT; ++i) {
+
+        const auto id = world.CreateEntity();
+        world.Create_Position(id, Float3(0), Float4::IdentityQuaternion());
+
+        if(i < ENTITY_COUNT / 2) {
+
+            world.SetEntitysParent(id, previous);
+            previous = id;
+
+        } else {
+
+            world.SetEntitysParent(id, root);
+        }
+
+        entities.push_back(id);
+    }
+
+    CHECK(world.GetEntityCount() == ENTITY_COUNT + 2);
+
+    // Some of these are also destroyed as children, and some are queued twice //
+    for(int i = ENTITY_COUNT - 1; i >= 0; i -= 3)
+        world.QueueDestroyEntity(entities[i]);
+
+    world.QueueDestroyEntity(root);
+    world.QueueDestroyEntity(root);
+
+    world.Tick(1);
+
+    CHECK(world.GetEntityCount() == 1);
+    CHECK(world.IsEntityAlive(other));
+    CHECK(world.GetEntityParents().empty());
+
+    CHECK(!world.GetComponentPtr_Position(entities.front()));
+    CHECK(!world.GetComponentPtr_Position(entities.back()));
+
+    world.Release();
+}
+
+TEST_CASE("EntitySerializer saves and loads whole worlds", "[entity]")
+{
+    PartialEngine<false> engine;
+
+    EntitySerializer serializer;
+
+    StandardWorld world;
+
+    const auto first = world.CreateEntity();
+    world.Create_Position(first, Float3(1, 2, 3), Float4::IdentityQuaternion());
+    world.Create_Sendable(first);
+
+    const auto second = world.CreateEntity();
+    world.Create_BoxGeometry(second, Float3(4, 5, 6), "box material");
+    world.Create_Camera(second, 60, false);
+
+    world.SetEntitysParent(second, first);
+
+    sf::Packet packet;
+    REQUIRE(serializer.SaveWorld(world, packet));
+
+    StandardWorld loaded;
+    REQUIRE(serializer.LoadWorld(loaded, packet));
+    CHECK(packet.endOfPacket());
+
+    CHECK(loaded.GetEntityCount() == 2);
+
+    REQUIRE(loaded.GetComponentPtr_Position(first));
+    CHECK(loaded.GetComponent_Position(first).Members._Position == Float3(1, 2, 3));
+    CHECK(loaded.GetComponent_Position(first).Members._Orientation ==
+          Float4::IdentityQuaternion());
+
+    // Worlds that aren't on a server receive updates for Sendable entities //
+    CHECK(loaded.GetComponentPtr_Received(first));
+    CHECK(!loaded.GetComponentPtr_Sendable(first));
+
+    REQUIRE(loaded.GetComponentPtr_BoxGeometry(second));
+    CHECK(loaded.GetComponent_BoxGeometry(second).Sizes == Float3(4, 5, 6));
+    CHECK(loaded.GetComponent_BoxGeometry(second).Material == "box material");
+
+    REQUIRE(loaded.GetComponentPtr_Camera(second));
+    CHECK(loaded.GetComponent_Camera(second).FOVY == 60);
+    CHECK(!loaded.GetComponent_Camera(second).SoundPerceiver);
+
+    CHECK(!loaded.GetComponentPtr_Position(second));
+
+    // Loaded ids aren't reused //
+    CHECK(loaded.CreateEntity() > second);
+
+    // Parents are restored //
+    loaded.DestroyEntity(first);
+    CHECK(!loaded.GetComponentPtr_Camera(second));
+    CHECK(loaded.GetEntityCount() == 1);
+
+    world.Release();
+    loaded.Release();
+}
+
+TEST_CASE("EntitySerializer skips unknown components", "[entity]")
+{
+    PartialEngine<false> engine;
+
+    EntitySerializer serializer;
+
+    StandardWorld world;
+
+    sf::Packet packet;
+    packet << WORLD_SAVE_MAGIC << ENTITY_SERIALIZE_VERSION << static_cast<uint32_t>(1)
+           << static_cast<ObjectID>(5) << static_cast<uint8_t>(2);
+
+    // Type that no world knows //
+    packet << static_cast<uint16_t>(static_cast<uint16_t>(COMPONENT_TYPE::Custom) + 5)
+           << static_cast<uint16_t>(3) << static_cast<uint8_t>(1) << static_cast<uint8_t>(2)
+           << static_cast<uint8_t>(3);
+
+    packet << static_cast<uint16_t>(COMPONENT_TYPE::Camera) << static_cast<uint16_t>(2)
+           << static_cast<uint8_t>(70) << true;
+
+    // No parents //
+    packet << static_cast<uint32_t>(0);
+
+    ObjectID id = 0;
+    REQUIRE(serializer.DeserializeWholeEntityFromPacket(&world, id, packet));
+
+    CHECK(id == 5);
+    REQUIRE(world.GetComponentPtr_Camera(id));
+    CHECK(world.GetComponent_Camera(id).FOVY == 70);
+    CHECK(world.GetComponent_Camera(id).SoundPerceiver);
+
+    SECTION("Other versions are rejected")
+    {
+        sf::Packet old;
+        old << WORLD_SAVE_MAGIC << static_cast<uint8_t>(ENTITY_SERIALIZE_VERSION + 1)
+            << static_cast<uint32_t>(1) << static_cast<ObjectID>(6) << static_cast<uint8_t>(0)
+            << static_cast<uint32_t>(0);
+
+        CHECK(!serializer.DeserializeWholeEntityFromPacket(&world, id, old));
+    }
+
+    world.Release();
+}
+
+TEST_CASE("EntitySerializer saves entity snapshots in size limited parts", "[entity]")
+{
+    PartialEngine<false> engine;
+
+    EntitySerializer serializer;
+
+    StandardWorld world;
+
+    std::vector<ObjectID> entities;
+
+    for(int i = 0; i < 3; ++i) {
+
+        entities.push_back(world.CreateEntity());
+        world.Create_Position(entities.back(), Float3(i, 0, 0), Float4::IdentityQuaternion());
+        world.Create_Sendable(entities.back());
+    }
+
+    world.SetEntitysParent(entities[1], entities[0]);
+    world.SetEntitysParent(entities[2], entities[0]);
+
+    SECTION("Everything fits in one packet")
+    {
+        sf::Packet packet;
+        REQUIRE(serializer.SaveEntities(world, entities, 0, packet) == 3);
+
+        StandardWorld loaded;
+        std::vector<ObjectID> created;
+        REQUIRE(serializer.LoadWorld(loaded, packet, &created));
+        CHECK(packet.endOfPacket());
+
+        CHECK(created == entities);
+        REQUIRE(loaded.GetComponentPtr_Position(entities[2]));
+        CHECK(loaded.GetComponent_Position(entities[2]).Members._Position == Float3(2, 0, 0));
+
+        // Parents are included //
+        loaded.DestroyEntity(entities[0]);
+        CHECK(loaded.GetEntityCount() == 0);
+
+        loaded.Release();
+    }
+
+    SECTION("Too small limit still writes one entity")
+    {
+        size_t first = 0;
+        std::vector<ObjectID> created;
+
+        StandardWorld loaded;
+
+        while(first < entities.size()) {
+
+            sf::Packet packet;
+            const auto written = serializer.SaveEntities(world, entities, first, packet, 1);
+            REQUIRE(written == 1);
+
+            REQUIRE(serializer.LoadWorld(loaded, packet, &created));
+            CHECK(packet.endOfPacket());
+            first += written;
+        }
+
+        CHECK(created == entities);
+
+        // Relations to entities in other parts aren't included //
+        loaded.DestroyEntity(entities[0]);
+        CHECK(loaded.GetEntityCount() == 2);
+
+        loaded.Release();
+    }
+
+    world.Release();
+}
+
+TEST_CASE("EntitySerializer rejects components with a wrong length", "[entity]")
+{
+    PartialEngine<false> engine;
+
+    EntitySerializer serializer;
+
+    StandardWorld world;
+
+    sf::Packet packet;
+    packet << WORLD_SAVE_MAGIC << ENTITY_SERIALIZE_VERSION << static_cast<uint32_t>(1)
+           << static_cast<ObjectID>(5) << static_cast<uint8_t>(2);
+
+    SECTION("Too long")
+    {
+        // The extra byte would otherwise be read as the start of the next component //
+        packet << static_cast<uint16_t>(COMPONENT_TYPE::Camera) << static_cast<uint16_t>(3)
+               << static_cast<uint8_t>(70) << true << static_cast<uint8_t>(1);
+    }
+
+    SECTION("Too short")
+    {
+        packet << static_cast<uint16_t>(COMPONENT_TYPE::Camera) << static_cast<uint16_t>(1)
+               << static_cast<uint8_t>(70) << true;
+    }
+
+    packet << static_cast<uint16_t>(COMPONENT_TYPE::BoxGeometry) << static_cast<uint16_t>(0)
+           << static_cast<uint32_t>(0);
+
+    ObjectID id = 0;
+    CHECK(!serializer.DeserializeWholeEntityFromPacket(&world, id, packet));
+
+    world.Release();
+}
+
+TEST_CASE("SystemScheduler orders conflicting systems", "[entity][threading]")
+{
+    ThreadingManager manager;
+    REQUIRE(manager.Init());
+
+    SystemScheduler scheduler;
+
+    constexpr SystemScheduler::AccessMask POSITION = 1 << 0;
+    constexpr SystemScheduler::AccessMask PHYSICS = 1 << 1;
+    constexpr SystemScheduler::AccessMask STATES = 1 << 2;
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+
+    const auto record = [&](int system) {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(system);
+    };
+
+    // Run a few times to make sure the timings are kept
+    for(int i = 0; i < 3; ++i) {
+
+        order.clear();
+
+        scheduler.BeginSystems();
+        scheduler.AddSystem("WritePosition", 0, POSITION, [&]() { record(0); });
+        scheduler.AddSystem("ReadPhysics", PHYSICS, 0, [&]() { record(1); });
+        scheduler.AddSystem("PositionToStates", POSITION, STATES, [&]() { record(2); });
+        scheduler.AddExclusiveSystem("Undeclared", [&]() { record(3); });
+
+        CHECK(scheduler.GetSystemCount() == 4);
+
+        scheduler.Run();
+
+        REQUIRE(order.size() == 4);
+
+        const auto position = [&](int system) {
+            return std::find(order.begin(), order.end(), system) - order.begin();
+        };
+
+        CHECK(position(2) > position(0));
+        CHECK(position(3) == 3);
+    }
+
+    REQUIRE(scheduler.GetTimings().size() == 4);
+
+    for(const auto& timing : scheduler.GetTimings())
+        CHECK(timing.RunCount == 3);
+
+    CHECK(scheduler.GetTimingReport().find("PositionToStates") != std::string::npos);
+
+    SECTION("Conflicts")
+    {
+        CHECK(SystemScheduler::Conflicts(0, POSITION, POSITION, 0));
+        CHECK(SystemScheduler::Conflicts(POSITION, 0, 0, POSITION));
+        CHECK(SystemScheduler::Conflicts(0, POSITION, 0, POSITION));
+        CHECK(!SystemScheduler::Conflicts(POSITION, 0, POSITION, 0));
+        CHECK(!SystemScheduler::Conflicts(POSITION, STATES, PHYSICS, 0));
+    }
+
+    SECTION("Exceptions are passed to the caller")
+    {
+        bool otherRan = false;
+
+        scheduler.BeginSystems();
+        scheduler.AddSystem(
+            "Throws", 0, POSITION, []() { throw InvalidState("system failed"); });
+        scheduler.AddSystem("Other", 0, STATES, [&]() { otherRan = true; });
+
+        CHECK_THROWS_AS(scheduler.Run(), InvalidState);
+        CHECK(otherRan);
+    }
+
+    manager.Release();
+}
+
+TEST_CASE("SystemScheduler ParallelFor covers the whole range", "[entity][threading]")
+{
+    ThreadingManager manager;
+    REQUIRE(manager.Init());
+
+    constexpr size_t count = 100000;
+
+    std::vector<int> values(count, 0);
+    std::atomic<int> chunks = {0};
+
+    SystemScheduler::ParallelFor(count, 4096, [&](size_t begin, size_t end) {
+        ++chunks;
+
+        for(size_t i = begin; i < end; ++i)
+            values[i] += 1;
+    });
+
+    CHECK(chunks == static_cast<int>((count + 4095) / 4096));
+    CHECK(std::all_of(values.begin(), values.end(), [](int value) { return value == 1; }));
+
+    manager.Release();
+}
@@ -2,6 +2,11 @@
 
 #include "catch.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
 using namespace Leviathan;
 // using namespace Leviathan::Test;
 
@@ -27,3 +32,219 @@ TEST_CASE("Events are properly released by EventHandler", "[event]"){
 
 
 
+//! Counts the events it gets
+class CountingListener : public CallableObject{
+public:
+    int OnEvent(Event* event) override{
+
+        ++EventCount;
+
+        if(event->GetIntegerDataForEvent())
+            LastValue = event->GetIntegerDataForEvent()->IntegerDataValue;
+
+        return UnregisterOnEvent ? -1 : 0;
+    }
+
+    int OnGenericEvent(GenericEvent* event) override{
+
+        ++GenericEventCount;
+        return UnregisterOnEvent ? -1 : 0;
+    }
+
+    std::atomic<int> EventCount = {0};
+    std::atomic<int> GenericEventCount = {0};
+    std::atomic<int> LastValue = {-1};
+    bool UnregisterOnEvent = false;
+};
+
+TEST_CASE("EventHandler calls only the listeners of the type", "[event]"){
+
+    EventHandler handler;
+
+    CountingListener tick;
+    CountingListener frame;
+
+    CHECK(handler.RegisterForEvent(&tick, EVENT_TYPE_TICK));
+    CHECK(handler.RegisterForEvent(&frame, EVENT_TYPE_FRAME_END));
+    CHECK(!handler.RegisterForEvent(&frame, EVENT_TYPE_ALL));
+
+    CHECK(handler.GetListenerCount(EVENT_TYPE_TICK) == 1);
+
+    handler.CallEvent(new Event(EVENT_TYPE_TICK, new IntegerEventData(5)));
+
+    CHECK(tick.EventCount == 1);
+    CHECK(tick.LastValue == 5);
+    CHECK(frame.EventCount == 0);
+
+    SECTION("Returning -1 unregisters"){
+
+        tick.UnregisterOnEvent = true;
+
+        handler.CallEvent(new Event(EVENT_TYPE_TICK, new IntegerEventData(6)));
+        handler.CallEvent(new Event(EVENT_TYPE_TICK, new IntegerEventData(7)));
+
+        CHECK(tick.EventCount == 2);
+        CHECK(handler.GetListenerCount(EVENT_TYPE_TICK) == 0);
+        CHECK(handler.GetListenerCount(EVENT_TYPE_FRAME_END) == 1);
+    }
+
+    SECTION("Unregister all removes every type"){
+
+        CHECK(handler.RegisterForEvent(&tick, EVENT_TYPE_FRAME_END));
+
+        handler.Unregister(&tick, EVENT_TYPE_ALL, true);
+
+        handler.CallEvent(new Event(EVENT_TYPE_TICK, new IntegerEventData(6)));
+        handler.CallEvent(new Event(EVENT_TYPE_FRAME_END, new IntegerEventData(6)));
+
+        CHECK(tick.EventCount == 1);
+        CHECK(frame.EventCount == 1);
+    }
+}
+
+TEST_CASE("EventHandler generic events use interned types", "[event]"){
+
+    EventHandler handler;
+
+    CountingListener first;
+    CountingListener second;
+
+    CHECK(GenericEvent::InternType("EventTestFirst") ==
+        GenericEvent::InternType("EventTestFirst"));
+    CHECK(GenericEvent::InternType("EventTestFirst") !=
+        GenericEvent::InternType("EventTestSecond"));
+
+    handler.RegisterForEvent(&first, "EventTestFirst");
+    handler.RegisterForEvent(&second, "EventTestSecond");
+
+    handler.CallEvent(new GenericEvent("EventTestFirst"));
+    handler.CallEvent(new GenericEvent("EventTestNobodyListens"));
+
+    CHECK(first.GenericEventCount == 1);
+    CHECK(second.GenericEventCount == 0);
+
+    handler.Unregister(&first, "EventTestFirst");
+
+    handler.CallEvent(new GenericEvent("EventTestFirst"));
+    handler.CallEvent(new GenericEvent("EventTestSecond"));
+
+    CHECK(first.GenericEventCount == 1);
+    CHECK(second.GenericEventCount == 1);
+    CHECK(handler.GetListenerCount("EventTestFirst") == 0);
+
+    handler.Unregister(&second, "", true);
+    CHECK(handler.GetListenerCount("EventTestSecond") == 0);
+}
+
+TEST_CASE("ReusableEvent doesn't reuse events that are still referenced", "[event]"){
+
+    ReusableEvent<IntegerEventData> reused(EVENT_TYPE_TICK);
+
+    Event* first = &reused.Get(1);
+    CHECK(first->GetIntegerDataForEvent()->IntegerDataValue == 1);
+
+    Event* second = &reused.Get(2);
+    CHECK(first == second);
+    CHECK(second->GetIntegerDataForEvent()->IntegerDataValue == 2);
+
+    // Like a listener that keeps the event //
+    second->AddRef();
+
+    Event* third = &reused.Get(3);
+    CHECK(third != second);
+    CHECK(second->GetIntegerDataForEvent()->IntegerDataValue == 2);
+    CHECK(third->GetIntegerDataForEvent()->IntegerDataValue == 3);
+    CHECK(third->GetRefCount() == 1);
+
+    second->Release();
+}
+
+TEST_CASE("EventHandler can be used from multiple threads", "[event][threading]"){
+
+    EventHandler handler;
+
+    constexpr int THREAD_COUNT = 4;
+    constexpr int EVENTS_PER_THREAD = 2000;
+
+    CountingListener always;
+    handler.RegisterForEvent(&always, EVENT_TYPE_TEST);
+
+    std::atomic<bool> done = {false};
+
+    // Listeners come and go while the events are running //
+    std::thread registerer([&](){
+
+        while(!done){
+
+            CountingListener temporary;
+            handler.RegisterForEvent(&temporary, EVENT_TYPE_TEST);
+            handler.Unregister(&temporary, EVENT_TYPE_TEST);
+        }
+    });
+
+    std::vector<std::thread> threads;
+
+    for(int i = 0; i < THREAD_COUNT; ++i){
+
+        threads.emplace_back([&](){
+
+            ReusableEvent<IntegerEventData> event(EVENT_TYPE_TEST);
+
+            for(int j = 0; j < EVENTS_PER_THREAD; ++j)
+                handler.CallEvent(event.Get(j));
+        });
+    }
+
+    for(auto& thread : threads)
+        thread.join();
+
+    done = true;
+    registerer.join();
+
+    CHECK(always.EventCount == THREAD_COUNT * EVENTS_PER_THREAD);
+}
+
+TEST_CASE("EventHandler dispatch speed", "[event][benchmark][.slow]"){
+
+    constexpr int EVENT_COUNT = 200000;
+
+    for(const int listenercount : {1, 10, 100, 1000}){
+
+        EventHandler handler;
+
+        std::vector<std::unique_ptr<CountingListener>> listeners;
+
+        for(int i = 0; i < listenercount; ++i){
+
+            listeners.push_back(std::make_unique<CountingListener>());
+
+            // Every type has listeners so that looking at the other types costs time //
+            handler.RegisterForEvent(listeners.back().get(),
+                static_cast<EVENT_TYPE>(i % EVENT_TYPE_ALL));
+            handler.RegisterForEvent(listeners.back().get(), "EventTestBenchmark");
+        }
+
+        ReusableEvent<IntegerEventData> event(EVENT_TYPE_TICK);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for(int i = 0; i < EVENT_COUNT; ++i)
+            handler.CallEvent(event.Get(i));
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        const auto genericstart = std::chrono::steady_clock::now();
+
+        for(int i = 0; i < EVENT_COUNT / 10; ++i)
+            handler.CallEvent(new GenericEvent("EventTestBenchmark"));
+
+        const auto genericelapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - genericstart).count();
+
+        WARN(listenercount << " listeners: " << EVENT_COUNT /
+            (std::max<int64_t>(elapsed, 1) / 1000000.0) << " events per second, " <<
+            (EVENT_COUNT / 10) / (std::max<int64_t>(genericelapsed, 1) / 1000000.0) <<
+            " generic events per second");
+    }
+}
@@ -0,0 +1,241 @@
+#include "FileSystem.h"
+
+#include "../PartialEngine.h"
+
+#include "catch.hpp"
+
+#include <boost/filesystem.hpp>
+
+using namespace Leviathan;
+using namespace Leviathan::Test;
+
+constexpr auto INDEX_TEST_FOLDER = "./Data/FileIndexTest";
+constexpr auto INDEX_TEST_CACHE = "Test/FileIndexTest.cache";
+
+//! Creates files in the data folder for the tests and removes them at the end
+class IndexTestFiles {
+public:
+    IndexTestFiles()
+    {
+        boost::filesystem::remove_all(INDEX_TEST_FOLDER);
+        boost::filesystem::create_directories(INDEX_TEST_FOLDER);
+
+        Add("IndexTestFile.txt");
+        Add("IndexTestFile.png");
+        Add("IndexTestOther.txt");
+
+        OriginalCacheFile = FileSystem::GetIndexCacheFile();
+        FileSystem::SetIndexCacheFile(INDEX_TEST_CACHE);
+        boost::filesystem::remove(INDEX_TEST_CACHE);
+    }
+
+    ~IndexTestFiles()
+    {
+        boost::filesystem::remove_all(INDEX_TEST_FOLDER);
+        boost::filesystem::remove(INDEX_TEST_CACHE);
+        FileSystem::SetIndexCacheFile(OriginalCacheFile);
+    }
+
+    //! Makes the folders look like they weren't just modified so that the cache is saved
+    void Backdate()
+    {
+        for(const auto folder : {"./Data", INDEX_TEST_FOLDER}) {
+            boost::filesystem::last_write_time(
+                folder, boost::filesystem::last_write_time(folder) - 10);
+        }
+    }
+
+    std::string Add(const std::string& name)
+    {
+        const auto path = std::string(INDEX_TEST_FOLDER) + "/" + name;
+        REQUIRE(FileSystem::WriteToFile(name, path));
+        return path;
+    }
+
+    std::string OriginalCacheFile;
+};
+
+TEST_CASE("FileIndex finds the trigrams of regexes", "[filesystem]")
+{
+    std::vector<uint32_t> trigrams;
+
+    SECTION("Literal names")
+    {
+        CHECK(FileIndex::GetRequiredTrigrams("Logo", trigrams));
+
+        std::vector<uint32_t> expected;
+        FileIndex::GetTrigrams("logo", expected);
+
+        CHECK(trigrams == expected);
+        CHECK(trigrams.size() == 2);
+    }
+
+    SECTION("Optional characters aren't required")
+    {
+        CHECK(FileIndex::GetRequiredTrigrams("Logos?", trigrams));
+
+        std::vector<uint32_t> expected;
+        FileIndex::GetTrigrams("logo", expected);
+
+        CHECK(trigrams == expected);
+    }
+
+    SECTION("Wildcards split literals")
+    {
+        CHECK(FileIndex::GetRequiredTrigrams("ab.*cdef\\d[xyz]ghi", trigrams));
+
+        std::vector<uint32_t> expected;
+        FileIndex::GetTrigrams("cdef", expected);
+        FileIndex::GetTrigrams("ghi", expected);
+
+        CHECK(trigrams == expected);
+    }
+
+    SECTION("Escaped characters are literals")
+    {
+        CHECK(FileIndex::GetRequiredTrigrams("a\\.b", trigrams));
+        CHECK(trigrams.size() == 1);
+    }
+
+    SECTION("Hex escapes are not literals")
+    {
+        CHECK(FileIndex::GetRequiredTrigrams("Logo\\x41Icon", trigrams));
+
+        std::vector<uint32_t> expected;
+        FileIndex::GetTrigrams("logo", expected);
+        FileIndex::GetTrigrams("icon", expected);
+        CHECK(trigrams == expected);
+
+        trigrams.clear();
+        CHECK(!FileIndex::GetRequiredTrigrams("ab\\u0041cd", trigrams));
+    }
+
+    SECTION("Alternatives and groups aren't handled")
+    {
+        CHECK(!FileIndex::GetRequiredTrigrams("Logo|Icon", trigrams));
+        CHECK(!FileIndex::GetRequiredTrigrams("(Logo)?Icon", trigrams));
+    }
+
+    SECTION("Short patterns have no trigrams")
+    {
+        CHECK(!FileIndex::GetRequiredTrigrams(".*", trigrams));
+        CHECK(!FileIndex::GetRequiredTrigrams("ab", trigrams));
+        CHECK(trigrams.empty());
+    }
+}
+
+TEST_CASE("FileSystem index finds files", "[filesystem]")
+{
+    PartialEngine<false> engine;
+
+    IndexTestFiles files;
+
+    // Searches that don't find anything report errors //
+    DummyReporter reporter;
+
+    FileSystem filesystem;
+    REQUIRE(filesystem.Init(&reporter));
+
+    const auto expectedtxt = std::string(INDEX_TEST_FOLDER) + "/IndexTestFile.txt";
+    const auto expectedpng = std::string(INDEX_TEST_FOLDER) + "/IndexTestFile.png";
+
+    CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestFile", "txt") == expectedtxt);
+
+    SECTION("Extensions are preferred in order")
+    {
+        CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestFile", "png|txt") ==
+              expectedpng);
+        CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestFile", "txt|png") ==
+              expectedtxt);
+        CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestFile", "ogg|png") ==
+              expectedpng);
+    }
+
+    SECTION("Regex searches use the trigrams")
+    {
+        const auto found =
+            filesystem.FindAllMatchingFiles(FILEGROUP_OTHER, "indextest.*", "txt|png");
+
+        REQUIRE(found.size() == 3);
+
+        // Sorted by name //
+        CHECK(found[0]->Name == "IndexTestFile");
+        CHECK(found[1]->Name == "IndexTestFile");
+        CHECK(found[2]->Name == "IndexTestOther");
+
+        CHECK(filesystem.FindAllMatchingFiles(FILEGROUP_OTHER, "IndexTestOther", "txt")
+                  .size() == 1);
+        CHECK(filesystem.FindAllMatchingFiles(FILEGROUP_OTHER, "IndexTestMissing", "txt")
+                  .empty());
+    }
+
+    SECTION("Files can be added and removed")
+    {
+        const auto added = files.Add("IndexTestAdded.txt");
+
+        CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestAdded", "txt").empty());
+
+        filesystem.AddToIndex(added);
+
+        // Adding again doesn't duplicate it //
+        filesystem.AddToIndex(INDEX_TEST_FOLDER);
+
+        CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestAdded", "txt") == added);
+        CHECK(filesystem.FindAllMatchingFiles(FILEGROUP_OTHER, "IndexTestAdded", "txt")
+                  .size() == 1);
+
+        filesystem.RemoveFromIndex(added);
+
+        CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestAdded", "txt").empty());
+
+        filesystem.RemoveFromIndex(INDEX_TEST_FOLDER);
+
+        CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestFile", "txt").empty());
+        CHECK(filesystem.FindAllMatchingFiles(FILEGROUP_OTHER, "indextest.*", "txt|png")
+                  .empty());
+    }
+}
+
+TEST_CASE("FileSystem index cache has the same files", "[filesystem]")
+{
+    PartialEngine<false> engine;
+
+    IndexTestFiles files;
+
+    files.Backdate();
+
+    size_t filecount = 0;
+
+    {
+        FileSystem filesystem;
+        REQUIRE(filesystem.Init(&engine.Log));
+        CHECK(!filesystem.WasIndexLoadedFromCache());
+
+        filecount = filesystem.GetAllFiles().size();
+    }
+
+    REQUIRE(boost::filesystem::exists(INDEX_TEST_CACHE));
+
+    {
+        FileSystem filesystem;
+        REQUIRE(filesystem.Init(&engine.Log));
+        CHECK(filesystem.WasIndexLoadedFromCache());
+
+        CHECK(filesystem.GetAllFiles().size() == filecount);
+        CHECK(!filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestOther", "txt").empty());
+    }
+
+    // Changing the folder makes the cache invalid //
+    const auto added = files.Add("IndexTestAdded.txt");
+    boost::filesystem::last_write_time(
+        INDEX_TEST_FOLDER, boost::filesystem::last_write_time(INDEX_TEST_FOLDER) + 10);
+
+    {
+        FileSystem filesystem;
+        REQUIRE(filesystem.Init(&engine.Log));
+        CHECK(!filesystem.WasIndexLoadedFromCache());
+
+        CHECK(filesystem.GetAllFiles().size() == filecount + 1);
+        CHECK(filesystem.SearchForFile(FILEGROUP_OTHER, "IndexTestAdded", "txt") == added);
+    }
+}
@@ -0,0 +1,134 @@
+#include "Logger.h"
+#include "FileSystem.h"
+
+#include "catch.hpp"
+
+#include <thread>
+
+using namespace Leviathan;
+
+constexpr auto LOGGER_TEST_FILE = "Test/LoggerTest.txt";
+
+static size_t CountOccurrences(const std::string& text, const std::string& tofind)
+{
+    size_t count = 0;
+
+    for(auto pos = text.find(tofind); pos != std::string::npos;
+        pos = text.find(tofind, pos + tofind.size())) {
+        ++count;
+    }
+
+    return count;
+}
+
+static std::string ReadLog()
+{
+    std::string contents;
+    REQUIRE(FileSystem::ReadFileEntirely(LOGGER_TEST_FILE, contents));
+    return contents;
+}
+
+TEST_CASE("Logger writes messages to the file", "[logger]")
+{
+    {
+        Logger log(LOGGER_TEST_FILE);
+
+        log.Info("first message");
+        log.Warning("second message");
+
+        log.Save();
+
+        const auto contents = ReadLog();
+
+        CHECK(contents.find("[INFO] first message\n") != std::string::npos);
+        CHECK(contents.find("[WARNING] second message\n") != std::string::npos);
+        CHECK(contents.find("first message") < contents.find("second message"));
+
+        // Destroying the logger writes the rest //
+        log.Error("third message");
+    }
+
+    CHECK(ReadLog().find("[ERROR] third message\n") != std::string::npos);
+}
+
+TEST_CASE("Logger level skips messages", "[logger]")
+{
+    Logger log(LOGGER_TEST_FILE);
+
+    CHECK(log.GetLevel() == LOG_LEVEL::Info);
+    CHECK(log.IsEnabled(LOG_LEVEL::Info));
+
+    log.SetLevel(LOG_LEVEL::Error);
+
+    CHECK(!log.IsEnabled(LOG_LEVEL::Info));
+    CHECK(!log.IsEnabled(LOG_LEVEL::Warning));
+    CHECK(log.IsEnabled(LOG_LEVEL::Error));
+    CHECK(log.IsEnabled(LOG_LEVEL::Fatal));
+
+    log.Info("skipped info");
+    log.Write("skipped write");
+    log.Warning("skipped warning");
+    log.Error("logged error");
+
+    // The macros don't build disabled messages //
+    int built = 0;
+
+    const auto buildmessage = [&](const std::string& text) {
+        ++built;
+        return text;
+    };
+
+    REQUIRE(Logger::Get() == &log);
+
+    LOG_INFO(buildmessage("skipped macro"));
+    LOG_ERROR(buildmessage("logged macro"));
+
+    CHECK(built == 1);
+
+    log.Save();
+
+    const auto contents = ReadLog();
+
+    CHECK(contents.find("skipped") == std::string::npos);
+    CHECK(contents.find("[ERROR] logged error\n") != std::string::npos);
+    CHECK(contents.find("[ERROR] logged macro\n") != std::string::npos);
+}
+
+TEST_CASE("Logger keeps messages from multiple threads", "[logger][threading]")
+{
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 500;
+
+    {
+        Logger log(LOGGER_TEST_FILE);
+
+        // Console output isn't needed //
+        log.SetLevel(LOG_LEVEL::Error);
+
+        std::vector<std::thread> threads;
+
+        for(int thread = 0; thread < THREADS; ++thread) {
+            threads.emplace_back([&log, thread]() {
+                for(int i = 0; i < PER_THREAD; ++i)
+                    log.DirectWriteBuffer("thread " + std::to_string(thread) + " message " +
+                                          std::to_string(i) + "\n");
+            });
+        }
+
+        for(auto& thread : threads)
+            thread.join();
+    }
+
+    const auto contents = ReadLog();
+
+    CHECK(CountOccurrences(contents, " message ") == THREADS * PER_THREAD);
+
+    // Messages from one thread are in order //
+    for(int thread = 0; thread < THREADS; ++thread) {
+
+        const auto prefix = "thread " + std::to_string(thread) + " message ";
+
+        CHECK(contents.find(prefix + "0\n") < contents.find(prefix + "1\n"));
+        CHECK(contents.find(prefix + "498\n") < contents.find(prefix + "499\n"));
+    }
+}
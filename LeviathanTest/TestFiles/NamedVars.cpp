@@ -5,6 +5,8 @@
 #include "catch.hpp"
 #include "../DummyLog.h"
 
+#include <chrono>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -266,6 +268,72 @@ TEST_CASE("Converting empty std::string blocks", "[variable][datablock]"){
     
 }
 
+TEST_CASE("Convert number parsing matches the stream conversions", "[variable][convert]"){
+
+    CHECK(Convert::StringTo<int>("42") == 42);
+    CHECK(Convert::StringTo<int>("  -17") == -17);
+    CHECK(Convert::StringTo<int>("+5") == 5);
+    CHECK(Convert::StringTo<int>("12abc") == 12);
+    CHECK(Convert::StringTo<int>("3.75") == 3);
+    CHECK(Convert::StringTo<int>("abc") == 0);
+    CHECK(Convert::StringTo<int>("+-5") == 0);
+    CHECK(Convert::StringTo<int>("") == 0);
+    CHECK(Convert::StringTo<uint32_t>("4000000000") == 4000000000u);
+    CHECK(Convert::StringTo<size_t>("123456789") == 123456789);
+
+    CHECK(Convert::StringTo<float>("13.5") == 13.5f);
+    CHECK(Convert::StringTo<float>("-0.25") == -0.25f);
+    CHECK(Convert::StringTo<float>(".5") == 0.5f);
+    CHECK(Convert::StringTo<float>("1e3") == 1000.f);
+    CHECK(Convert::StringTo<double>("0.123456789012") == 0.123456789012);
+
+    CHECK(Convert::WstringTo<int>(L"1280") == 1280);
+    CHECK(Convert::WstringTo<float>(L" 2.5") == 2.5f);
+    CHECK(Convert::WstringTo<int>(L"\u00e4") == 0);
+
+    // Characters are still read as characters //
+    CHECK(Convert::StringTo<char>("5") == '5');
+
+    SECTION("ParseNumber reports what was used"){
+
+        size_t used = 0;
+        int value = 0;
+
+        CHECK(Convert::ParseNumber(std::string_view(" 123;"), value, &used));
+        CHECK(value == 123);
+        CHECK(used == 4);
+
+        // Failing doesn't change the value //
+        CHECK(!Convert::ParseNumber(std::string_view("x"), value));
+        CHECK(!Convert::ParseNumber(std::string_view("99999999999"), value));
+        CHECK(value == 123);
+
+        float floatvalue = 0;
+        CHECK(Convert::ParseNumber(std::wstring_view(L"-1.5f"), floatvalue, &used));
+        CHECK(floatvalue == -1.5f);
+        CHECK(used == 4);
+    }
+}
+
+TEST_CASE("VariableBlock text type detection", "[variable][datablock]"){
+
+    CHECK(VariableBlock("15", nullptr).GetBlockConst()->Type == DATABLOCK_TYPE_INT);
+    CHECK(VariableBlock("-15", nullptr).GetBlockConst()->Type == DATABLOCK_TYPE_INT);
+    CHECK(VariableBlock("1.5", nullptr).GetBlockConst()->Type == DATABLOCK_TYPE_FLOAT);
+    CHECK(VariableBlock("0.12345678901", nullptr).GetBlockConst()->Type ==
+        DATABLOCK_TYPE_DOUBLE);
+    CHECK(VariableBlock("true", nullptr).GetBlockConst()->Type == DATABLOCK_TYPE_BOOL);
+    CHECK(VariableBlock("1.5a", nullptr).GetBlockConst()->Type == DATABLOCK_TYPE_STRING);
+    CHECK(VariableBlock("\"12\"", nullptr).GetBlockConst()->Type == DATABLOCK_TYPE_STRING);
+
+    CHECK(static_cast<int>(VariableBlock("-15", nullptr)) == -15);
+    CHECK(static_cast<float>(VariableBlock("+1.5", nullptr)) == 1.5f);
+    CHECK(static_cast<double>(VariableBlock("0.12345678901", nullptr)) == 0.12345678901);
+
+    // "1" and "0" are numbers even though IsStringBool accepts them //
+    CHECK(VariableBlock("1", nullptr).GetBlockConst()->Type == DATABLOCK_TYPE_INT);
+}
+
 TEST_CASE("Allow missing ending';'", "[variable][datablock]") {
 
     DummyReporter dummy;
@@ -376,6 +444,112 @@ TEST_CASE("Parsing values back from ToText", "[variable][datablock]") {
     }
 }
 
+TEST_CASE("NamedVars name index and keys", "[variable]"){
+
+    NamedVars vars;
+
+    // Enough values that the index is used //
+    constexpr int COUNT = static_cast<int>(NamedVars::NAME_INDEX_THRESHOLD) * 4;
+
+    for(int i = 0; i < COUNT; ++i)
+        vars.AddVar("value" + std::to_string(i), new VariableBlock(i));
+
+    REQUIRE(vars.GetVariableCount() == COUNT);
+
+    for(int i = 0; i < COUNT; ++i){
+
+        int value = -1;
+        CHECK(vars.GetValueAndConvertTo("value" + std::to_string(i), value));
+        CHECK(value == i);
+    }
+
+    CHECK(vars.Find("missing") >= vars.GetVariableCount());
+
+    NamedVars::Key key("value5");
+
+    CHECK(vars.Find(key) == 5);
+    // Found again from the remembered index //
+    CHECK(vars.Find(key) == 5);
+
+    SECTION("Insertion order and serialization stay the same"){
+
+        std::string expected;
+
+        for(int i = 0; i < COUNT; ++i)
+            expected += "value" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+
+        CHECK(vars.Serialize() == expected);
+    }
+
+    SECTION("Removing values moves the others"){
+
+        vars.Remove("value2");
+
+        CHECK(vars.Find("value2") >= vars.GetVariableCount());
+        CHECK(vars.Find(key) == 4);
+        CHECK(vars.Find("value6") == 5);
+
+        // Adding an existing name moves it to the end //
+        vars.AddVar("value0", new VariableBlock(100));
+
+        CHECK(vars.Find("value0") == vars.GetVariableCount() - 1);
+        CHECK(vars.Find(key) == 3);
+    }
+
+    SECTION("Renaming is noticed"){
+
+        vars.GetValueDirectRaw("value5")->SetName("renamed");
+
+        CHECK(vars.Find(key) >= vars.GetVariableCount());
+        CHECK(vars.Find("renamed") == 5);
+
+        vars.SetName("renamed", "value5");
+
+        CHECK(vars.Find(key) == 5);
+        CHECK(vars.Find("renamed") >= vars.GetVariableCount());
+    }
+
+    SECTION("The first one of duplicate names is found"){
+
+        vars.GetVec()->push_back(std::make_shared<NamedVariableList>("value5",
+                new VariableBlock(-5)));
+
+        CHECK(vars.Find("value5") == 5);
+        CHECK(vars.Find(key) == 5);
+
+        vars.Remove(5);
+
+        CHECK(vars.Find("value5") == vars.GetVariableCount() - 1);
+        CHECK(vars.Find(key) == vars.GetVariableCount() - 1);
+    }
+
+    SECTION("Values can be set and read with keys"){
+
+        CHECK(vars.SetValue(key, VariableBlock(50)));
+
+        int value = 0;
+        CHECK(vars.GetValueAndConvertTo(key, value));
+        CHECK(value == 50);
+
+        REQUIRE(vars.GetValue(key));
+        CHECK(static_cast<int>(*vars.GetValue(key)) == 50);
+
+        CHECK(vars.GetValueDirectRaw(key) == vars.GetValueDirectRaw("value5"));
+
+        // Keys work with other NamedVars //
+        NamedVars other;
+        other.AddVar("value5", new VariableBlock(3));
+
+        CHECK(other.Find(key) == 0);
+        CHECK(vars.Find(key) == 5);
+
+        NamedVars::Key missing("missing");
+        CHECK(!vars.SetValue(missing, VariableBlock(1)));
+        CHECK(!vars.GetValueAndConvertTo(missing, value));
+        CHECK(vars.GetValueDirectRaw(missing) == nullptr);
+    }
+}
+
 TEST_CASE("Access name"){
 
     // Not that useful, for making sure functions are defined properly
@@ -385,3 +559,40 @@ TEST_CASE("Access name"){
     CHECK(list.GetValue().ConvertAndReturnVariable<int>() == 24);
 
 }
+
+TEST_CASE("NamedVars number parsing speed", "[variable][benchmark][.slow]"){
+
+    DummyReporter reporter;
+
+    constexpr size_t LINE_COUNT = 100000;
+
+    const auto benchmark = [&](const std::string& type, const auto& valuegenerator){
+
+        std::string data;
+
+        for(size_t i = 0; i < LINE_COUNT; ++i){
+
+            data += "Value" + std::to_string(i) + " = [" + valuegenerator(i) + ", " +
+                valuegenerator(i + 1) + ", " + valuegenerator(i + 2) + "];\n";
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        NamedVars values(data, &reporter);
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        CHECK(values.GetVariableCount() == LINE_COUNT);
+
+        WARN("Parsed " << (data.size() / (1024.0 * 1024.0)) << " MiB of " << type <<
+            " values: " << (data.size() / (1024.0 * 1024.0)) /
+            (std::max<int64_t>(elapsed, 1) / 1000000.0) << " MiB per second");
+    };
+
+    benchmark("int", [](size_t i){ return std::to_string(static_cast<int>(i * 7919) - 5000); });
+
+    benchmark("float", [](size_t i){ return std::to_string(i * 0.37f); });
+
+    benchmark("bool", [](size_t i){ return std::string(i % 2 ? "true" : "false"); });
+}
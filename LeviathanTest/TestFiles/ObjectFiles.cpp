@@ -1,8 +1,12 @@
 #include "ObjectFiles/ObjectFileProcessor.h"
 
 #ifndef LEVIATHAN_UE_PLUGIN
+#include "FileSystem.h"
 #include "Script/ScriptExecutor.h"
+#include "TimeIncludes.h"
 #include "../PartialEngine.h"
+
+#include <boost/filesystem.hpp>
 using namespace Leviathan::Test;
 #endif //LEVIATHAN_UE_PLUGIN
 
@@ -111,6 +115,203 @@ TEST_CASE("ObjectFiles parser read test file", "[objectfile]"){
 
     // TODO: add rest of tests
 }
+
+constexpr auto CACHE_TEST_FOLDER = "Test/ObjectFileCacheTest";
+constexpr auto CACHE_TEST_FILE = "Test/ObjectFileCacheTest.levof";
+
+//! Uses a separate cache folder for the tests and removes it at the end
+class CacheTestFolder {
+public:
+    CacheTestFolder()
+    {
+        OriginalCacheFolder = ObjectFileProcessor::GetCacheFolder();
+        ObjectFileProcessor::SetCacheFolder(CACHE_TEST_FOLDER);
+        boost::filesystem::remove_all(CACHE_TEST_FOLDER);
+    }
+
+    ~CacheTestFolder()
+    {
+        boost::filesystem::remove_all(CACHE_TEST_FOLDER);
+        boost::filesystem::remove(CACHE_TEST_FILE);
+        ObjectFileProcessor::SetCacheFolder(OriginalCacheFolder);
+    }
+
+    std::vector<std::string> GetCachedFiles() const
+    {
+        std::vector<std::string> files;
+
+        for(const auto& entry : boost::filesystem::directory_iterator(CACHE_TEST_FOLDER))
+            files.push_back(entry.path().string());
+
+        return files;
+    }
+
+    std::string OriginalCacheFolder;
+};
+
+TEST_CASE("ObjectFiles parsing speed", "[objectfile][benchmark][.slow]"){
+
+    DummyReporter reporter;
+    CacheTestFolder folder;
+
+    // The test file is scaled up by repeating its object with different names //
+    std::string testfile;
+    REQUIRE(FileSystem::ReadFileEntirely("Data/Scripts/tests/SimpleTest.levof", testfile));
+
+    const auto objectstart = testfile.find("\no ");
+    REQUIRE(objectstart != std::string::npos);
+
+    const std::string object = testfile.substr(objectstart);
+    const std::string objectname = "\"Named1\"";
+    const auto nameposition = object.find(objectname);
+    REQUIRE(nameposition != std::string::npos);
+
+    constexpr size_t TARGET_SIZE = 8 * 1024 * 1024;
+
+    std::string data = testfile.substr(0, objectstart);
+    size_t objectcount = 0;
+
+    while(data.size() < TARGET_SIZE){
+
+        data += object.substr(0, nameposition) + "\"Named" + std::to_string(++objectcount) +
+            "\"" + object.substr(nameposition + objectname.size());
+    }
+
+    const auto start = Time::GetTimeMicro64();
+
+    auto ofile = ObjectFileProcessor::ProcessObjectFileFromString(data, "benchmark",
+        &reporter);
+
+    const auto elapsed = Time::GetTimeMicro64() - start;
+
+    REQUIRE(ofile != nullptr);
+    CHECK(ofile->GetTotalObjectCount() == objectcount);
+
+    WARN("Parsed " << (data.size() / (1024.0 * 1024.0)) << " MiB with " << objectcount <<
+        " objects: " << (data.size() / (1024.0 * 1024.0)) /
+        (std::max<int64_t>(elapsed, 1) / 1000000.0) << " MiB per second");
+
+    // Loading the same file again uses the cache //
+    constexpr auto benchmarkfile = "Test/ObjectFileBenchmark.levof";
+    REQUIRE(FileSystem::WriteToFile(data, benchmarkfile));
+
+    REQUIRE(ObjectFileProcessor::ProcessObjectFile(benchmarkfile, &reporter));
+
+    const auto cachedstart = Time::GetTimeMicro64();
+
+    auto cached = ObjectFileProcessor::ProcessObjectFile(benchmarkfile, &reporter);
+
+    const auto cachedelapsed = Time::GetTimeMicro64() - cachedstart;
+
+    REQUIRE(cached != nullptr);
+    CHECK(cached->GetTotalObjectCount() == objectcount);
+
+    WARN("Loaded the same file from the cache in " << (cachedelapsed / 1000.0) <<
+        " ms, parsing took " << (elapsed / 1000.0) << " ms");
+
+    boost::filesystem::remove(benchmarkfile);
+}
+
+TEST_CASE("ObjectFile cache gives the same result as parsing", "[objectfile]"){
+
+    DummyReporter reporter;
+    CacheTestFolder folder;
+
+    std::string contents;
+    REQUIRE(FileSystem::ReadFileEntirely("Data/Scripts/tests/SimpleTest.levof", contents));
+
+    contents += "\n"
+        "template<Value, Name> Valued:\n"
+        "    o Type \"Name\" {\n"
+        "        l values {\n"
+        "            value = Value;\n"
+        "        }\n"
+        "    }\n"
+        "\n"
+        "template<> Valued<12, Twelve>\n";
+
+    REQUIRE(FileSystem::WriteToFile(contents, CACHE_TEST_FILE));
+
+    auto parsed = ObjectFileProcessor::ProcessObjectFile(CACHE_TEST_FILE, &reporter);
+
+    REQUIRE(parsed);
+    REQUIRE(parsed->GetTotalObjectCount() == 2);
+
+    std::string expected;
+    REQUIRE(ObjectFileProcessor::SerializeObjectFile(*parsed, expected));
+
+    auto cachedfiles = folder.GetCachedFiles();
+    REQUIRE(cachedfiles.size() == 1);
+
+    SECTION("The cached file has everything"){
+
+        auto cached = ObjectFileProcessor::LoadObjectFileCache(cachedfiles[0]);
+
+        REQUIRE(cached);
+
+        std::string serialized;
+        REQUIRE(ObjectFileProcessor::SerializeObjectFile(*cached, serialized));
+        CHECK(serialized == expected);
+
+        REQUIRE(cached->GetTotalObjectCount() == 2);
+        CHECK(cached->GetTemplateDefinitionCount() == 1);
+        CHECK(cached->GetTemplateInstanceCount() == 1);
+        CHECK(!cached->GetObject(0)->IsThisTemplated());
+        CHECK(cached->GetObject(1)->IsThisTemplated());
+
+        ObjectFileTextBlock* block = cached->GetObject(0)->GetTextBlockWithName("block2");
+        REQUIRE(block);
+        CHECK(block->GetLineCount() == 4);
+    }
+
+    SECTION("Loading the file again uses the cache"){
+
+        // Replacing the cached file shows whether it is used //
+        ObjectFile replacement;
+        replacement.AddObject(std::make_shared<ObjectFileObjectProper>("Replaced", "Type",
+                std::vector<std::unique_ptr<std::string>>()));
+
+        REQUIRE(ObjectFileProcessor::WriteObjectFileCache(replacement, cachedfiles[0]));
+
+        auto loaded = ObjectFileProcessor::ProcessObjectFile(CACHE_TEST_FILE, &reporter);
+
+        REQUIRE(loaded);
+        REQUIRE(loaded->GetTotalObjectCount() == 1);
+        CHECK(loaded->GetObject(0)->GetName() == "Replaced");
+    }
+
+    SECTION("Changed files are parsed again"){
+
+        REQUIRE(FileSystem::WriteToFile(contents + "\nAdded = 1;\n", CACHE_TEST_FILE));
+
+        auto loaded = ObjectFileProcessor::ProcessObjectFile(CACHE_TEST_FILE, &reporter);
+
+        REQUIRE(loaded);
+        CHECK(loaded->GetVariables()->GetValueDirectRaw("Added"));
+        CHECK(folder.GetCachedFiles().size() == 2);
+    }
+
+    SECTION("Invalid cached files are replaced"){
+
+        std::string cacheddata;
+        REQUIRE(FileSystem::ReadFileEntirely(cachedfiles[0], cacheddata));
+
+        REQUIRE(FileSystem::WriteToFile(cacheddata.substr(0, cacheddata.size() / 2),
+                cachedfiles[0]));
+
+        CHECK(!ObjectFileProcessor::LoadObjectFileCache(cachedfiles[0]));
+
+        auto loaded = ObjectFileProcessor::ProcessObjectFile(CACHE_TEST_FILE, &reporter);
+
+        REQUIRE(loaded);
+
+        std::string serialized;
+        REQUIRE(ObjectFileProcessor::SerializeObjectFile(*loaded, serialized));
+        CHECK(serialized == expected);
+
+        CHECK(ObjectFileProcessor::LoadObjectFileCache(cachedfiles[0]));
+    }
+}
 #endif //LEVIATHAN_UE_PLUGIN
 
 TEST_CASE("Allow missing ending ';' in objectfile", "[objectfile]") {
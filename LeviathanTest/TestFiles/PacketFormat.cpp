@@ -1,8 +1,10 @@
 #include "Networking/Connection.h"
+#include "Networking/MessageCompressor.h"
 #include "Networking/NetworkResponse.h"
 #include "Networking/NetworkRequest.h"
 #include "Networking/SentNetworkThing.h"
 #include "Networking/WireData.h"
+#include "TimeIncludes.h"
 
 #include "../PartialEngine.h"
 
@@ -10,6 +12,10 @@
 
 #include "catch.hpp"
 
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
 /**!
 * @brief \file Tests that check that the \ref networkformat Is followed
 */
@@ -17,6 +23,67 @@
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
+//! \brief Counts the allocations the current thread makes while this exists
+//!
+//! Used to check that decoding packets doesn't allocate memory. Allocations from other
+//! threads and outside the scope of the counter aren't counted
+class AllocationCounter{
+public:
+    AllocationCounter() : Previous(Active){
+
+        Active = this;
+    }
+
+    ~AllocationCounter(){
+
+        Active = Previous;
+    }
+
+    AllocationCounter(const AllocationCounter& other) = delete;
+    AllocationCounter& operator=(const AllocationCounter& other) = delete;
+
+    size_t GetCount() const{
+
+        return Count;
+    }
+
+    static void OnAllocation(){
+
+        if(Active)
+            ++Active->Count;
+    }
+
+private:
+    size_t Count = 0;
+    AllocationCounter* Previous;
+
+    static thread_local AllocationCounter* Active;
+};
+
+thread_local AllocationCounter* AllocationCounter::Active = nullptr;
+
+// The decoding code is in the engine so the allocation functions need to be replaced for
+// the counters to see its allocations. The array versions call these
+void* operator new(std::size_t size){
+
+    AllocationCounter::OnAllocation();
+
+    if(void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept{
+
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept{
+
+    operator delete(memory);
+}
+
 
 // This is sort of unnecessary with the test "Packet header bytes test"
 // But I guess it's fine to test the same thing but directly with WireData...
@@ -592,9 +659,10 @@ public:
     void FillJustAcks(sf::Packet &tofill){
 
         const auto fullpacketid = ++LastUsedLocalID;
-        auto acks = _GetAcksToSend(fullpacketid);
+        NetworkAckField acks;
+        const bool hasAcks = _GetAcksToSend(fullpacketid, acks);
         
-        WireData::FillHeaderAckData(acks.get(), tofill);
+        WireData::FillHeaderAckData(hasAcks ? &acks : nullptr, tofill);
     }
 
     void SetPacketReceived(uint32_t packetid, RECEIVED_STATE state){
@@ -1006,6 +1074,8 @@ TEST_CASE_METHOD(UDPSocketAndClientFixture, "Resend shouldn't happen inside a te
     const auto inPacket = sent->PacketNumber;
 
     CHECK(inPacket == 2);
+
+    ClientConnection->FlushPendingMessages();
     
     sf::Packet received;
 
@@ -1104,4 +1174,454 @@ TEST_CASE_METHOD(UDPSocketAndClientFixture, "Client Responses get acks", "[netwo
 
 }
 
+TEST_CASE("Multiple messages in a packet with WireData", "[networking]"){
+
+    sf::Packet messages;
+    std::vector<uint32_t> messageNumbers;
+
+    WireData::FormatRequestMessage(RequestNone(NETWORK_REQUEST_TYPE::Echo), 5, messages);
+    messageNumbers.push_back(5);
+
+    WireData::FormatResponseMessage(ResponseNone(NETWORK_RESPONSE_TYPE::Keepalive), 6,
+        messages);
+    messageNumbers.push_back(6);
+
+    WireData::FormatResponseMessage(ResponseNone(NETWORK_RESPONSE_TYPE::CloseConnection), 7,
+        messages);
+    messageNumbers.push_back(7);
+
+    sf::Packet packet;
+    WireData::FormatMultiMessagePacket(3, messageNumbers, nullptr, messages, packet);
+
+    uint32_t receivedPacketNumber = 0;
+    std::vector<uint32_t> receivedNumbers;
+    std::vector<uint8_t> receivedTypes;
+
+    WireData::DecodeIncomingData(packet, nullptr, nullptr,
+        [&](uint32_t packetnumber) -> WireData::DECODE_CALLBACK_RESULT
+        {
+            receivedPacketNumber = packetnumber;
+            return WireData::DECODE_CALLBACK_RESULT::Continue;
+        },
+        [&](uint8_t messagetype, uint32_t messagenumber, sf::Packet &packet)
+        -> WireData::DECODE_CALLBACK_RESULT
+        {
+            receivedTypes.push_back(messagetype);
+            receivedNumbers.push_back(messagenumber);
+
+            if(messagetype == NORMAL_REQUEST_TYPE){
+
+                auto request = NetworkRequest::LoadFromPacket(packet, messagenumber);
+                REQUIRE(request);
+                CHECK(request->GetType() == NETWORK_REQUEST_TYPE::Echo);
+
+            } else {
+
+                auto response = NetworkResponse::LoadFromPacket(packet);
+                REQUIRE(response);
+            }
+
+            return WireData::DECODE_CALLBACK_RESULT::Continue;
+        });
+
+    CHECK(receivedPacketNumber == 3);
+    CHECK(receivedNumbers == messageNumbers);
+    CHECK(receivedTypes == std::vector<uint8_t>{NORMAL_REQUEST_TYPE, NORMAL_RESPONSE_TYPE,
+            NORMAL_RESPONSE_TYPE});
+}
+
+TEST_CASE_METHOD(UDPSocketAndClientFixture, "Messages sent during a tick share a packet",
+    "[networking]")
+{
+    sf::Packet received;
+
+    sf::IpAddress sender;
+    unsigned short sentport;
+
+    // Connect request
+    REQUIRE(socket.receive(received, sender, sentport) == sf::Socket::Done);
+
+    SECTION("Small messages go in a single packet"){
+
+        std::vector<std::shared_ptr<SentResponse>> sent;
+
+        for(int i = 0; i < 10; ++i){
+
+            sent.push_back(ClientConnection->SendPacketToConnection(
+                    std::make_shared<ResponseNone>(NETWORK_RESPONSE_TYPE::Keepalive),
+                    RECEIVE_GUARANTEE::Critical));
+
+            REQUIRE(sent.back());
+            CHECK(sent.back()->PacketNumber == sent.front()->PacketNumber);
+        }
+
+        CHECK(ClientConnection->GetPendingMessageCount() == 10);
+
+        // Nothing is sent before the tick //
+        REQUIRE(socket.receive(received, sender, sentport) != sf::Socket::Done);
+
+        ClientConnection->FlushPendingMessages();
+
+        CHECK(ClientConnection->GetPendingMessageCount() == 0);
+
+        REQUIRE(socket.receive(received, sender, sentport) == sf::Socket::Done);
+
+        int messageCount = 0;
+
+        WireData::DecodeIncomingData(received, nullptr, nullptr, nullptr,
+            [&](uint8_t messagetype, uint32_t messagenumber, sf::Packet &packet)
+            -> WireData::DECODE_CALLBACK_RESULT
+            {
+                CHECK(messagetype == NORMAL_RESPONSE_TYPE);
+                CHECK(NetworkResponse::LoadFromPacket(packet));
+                ++messageCount;
+                return WireData::DECODE_CALLBACK_RESULT::Continue;
+            });
+
+        CHECK(messageCount == 10);
+
+        // Nothing else was sent //
+        REQUIRE(socket.receive(received, sender, sentport) != sf::Socket::Done);
+
+        // A single ack confirms all of them //
+        sf::Packet ackPacket;
+        ackPacket << LEVIATHAN_ACK_PACKET << uint8_t(1) << sent.front()->PacketNumber;
+
+        REQUIRE(socket.send(ackPacket, sf::IpAddress::LocalHost, Client.GetOurPort()) ==
+            sf::Socket::Done);
+
+        Client.UpdateAllConnections();
+
+        for(const auto& response : sent)
+            CHECK(response->IsDone == SentNetworkThing::DONE_STATUS::DONE);
+    }
+
+    SECTION("Full packets are sent right away"){
+
+        const std::string text(100, 'a');
+
+        size_t sentMessages = 0;
+        
+        while(sentMessages * text.size() < DEFAULT_PACKET_FILL_AMOUNT * 3){
+
+            REQUIRE(ClientConnection->SendPacketToConnection(
+                    ResponseServerStatus(0, text, true, SERVER_JOIN_RESTRICT::None,
+                        SERVER_STATUS::Running, 0, 0, 0)));
+            ++sentMessages;
+        }
+
+        ClientConnection->FlushPendingMessages();
+
+        size_t receivedMessages = 0;
+        int packets = 0;
+
+        while(socket.receive(received, sender, sentport) == sf::Socket::Done){
+
+            ++packets;
+            CHECK(received.getDataSize() < DEFAULT_PACKET_FILL_AMOUNT + 64);
+
+            WireData::DecodeIncomingData(received, nullptr, nullptr, nullptr,
+                [&](uint8_t messagetype, uint32_t messagenumber, sf::Packet &packet)
+                -> WireData::DECODE_CALLBACK_RESULT
+                {
+                    CHECK(NetworkResponse::LoadFromPacket(packet));
+                    ++receivedMessages;
+                    return WireData::DECODE_CALLBACK_RESULT::Continue;
+                });
+        }
+
+        CHECK(packets > 3);
+        CHECK(packets < static_cast<int>(sentMessages));
+        CHECK(receivedMessages == sentMessages);
+    }
+}
+
+TEST_CASE("Serialized response data formats the same message", "[networking]"){
+
+    const ResponseServerStatus response(0, "my server", true, SERVER_JOIN_RESTRICT::None,
+        SERVER_STATUS::Running, 2, 8, 0);
+
+    sf::Packet normal;
+    WireData::FormatResponseMessage(response, 12, normal);
+
+    const auto serialized = WireData::SerializeResponseData(response);
+    REQUIRE(serialized);
+
+    sf::Packet fromSerialized;
+    WireData::FormatResponseMessage(*serialized, 12, fromSerialized);
+
+    REQUIRE(normal.getDataSize() == fromSerialized.getDataSize());
+    CHECK(std::memcmp(normal.getData(), fromSerialized.getData(), normal.getDataSize()) == 0);
+}
+
+TEST_CASE("Compressed messages decode to the original message", "[networking]"){
+
+    MessageCompressor compressor;
+
+    std::string data;
+
+    for(int i = 0; i < 100; ++i)
+        data += "entity " + std::to_string(i % 10) + " is at 0 0 0\n";
+
+    sf::Packet message;
+    WireData::FormatResponseMessage(ResponseSyncResourceData(0, data), 8, message);
+
+    sf::Packet compressed;
+    REQUIRE(compressor.CompressMessage(message, compressed));
+    CHECK(compressed.getDataSize() < message.getDataSize());
+
+    sf::Packet messages;
+    messages.append(compressed.getData(), compressed.getDataSize());
+
+    // Small messages are sent as is //
+    message.clear();
+    WireData::FormatRequestMessage(RequestNone(NETWORK_REQUEST_TYPE::Echo), 9, message);
+    CHECK(!compressor.CompressMessage(message, compressed));
+
+    messages.append(message.getData(), message.getDataSize());
+
+    sf::Packet packet;
+    WireData::FormatMultiMessagePacket(4, {8, 9}, nullptr, messages, packet);
+
+    DecodedPacket decoded;
+    Connection::DecodePacket(packet, decoded);
+
+    REQUIRE(decoded.Messages.size() == 2);
+
+    CHECK(decoded.Messages[0].MessageNumber == 8);
+    REQUIRE(decoded.Messages[0].Response);
+    REQUIRE(decoded.Messages[0].Response->GetType() ==
+            NETWORK_RESPONSE_TYPE::SyncResourceData);
+    CHECK(static_cast<ResponseSyncResourceData*>(
+              decoded.Messages[0].Response.get())->OurCustomData == data);
+
+    CHECK(decoded.Messages[1].MessageNumber == 9);
+    CHECK(decoded.Messages[1].Request);
+
+    CHECK(compressor.GetStats().CompressedMessages == 1);
+    CHECK(compressor.GetStats().GetCompressionRatio() > 2.f);
+
+    SECTION("Data that doesn't compress is sent as is")
+    {
+        std::string random;
+
+        for(int i = 0; i < 1000; ++i)
+            random.push_back(static_cast<char>(std::rand()));
+
+        message.clear();
+        WireData::FormatResponseMessage(ResponseSyncResourceData(0, random), 10, message);
+
+        CHECK(!compressor.CompressMessage(message, compressed));
+        CHECK(compressor.GetStats().IncompressibleMessages == 1);
+    }
+}
+
+TEST_CASE_METHOD(UDPSocketAndClientFixture, "Broadcast responses share serialized data",
+    "[networking]")
+{
+    sf::Packet received;
+
+    sf::IpAddress sender;
+    unsigned short sentport;
+
+    // Connect request
+    REQUIRE(socket.receive(received, sender, sentport) == sf::Socket::Done);
+
+    auto response = std::make_shared<ResponseServerStatus>(0, "my server", true,
+        SERVER_JOIN_RESTRICT::None, SERVER_STATUS::Running, 2, 8, 0);
+
+    const auto serialized = WireData::SerializeResponseData(*response);
+
+    auto sent = ClientConnection->SendPacketToConnection(response, serialized,
+        RECEIVE_GUARANTEE::Critical);
+
+    REQUIRE(sent);
+    CHECK(sent->SerializedData == serialized);
+    CHECK(sent->SentResponseData == response);
+
+    // Unreliable ones aren't tracked //
+    CHECK(!ClientConnection->SendPacketToConnection(response, serialized,
+            RECEIVE_GUARANTEE::None));
+
+    ClientConnection->FlushPendingMessages();
+
+    REQUIRE(socket.receive(received, sender, sentport) == sf::Socket::Done);
+
+    std::vector<std::shared_ptr<NetworkResponse>> responses;
+
+    WireData::DecodeIncomingData(received, nullptr, nullptr, nullptr,
+        [&](uint8_t messagetype, uint32_t messagenumber, sf::Packet &packet)
+        -> WireData::DECODE_CALLBACK_RESULT
+        {
+            CHECK(messagetype == NORMAL_RESPONSE_TYPE);
+            responses.push_back(NetworkResponse::LoadFromPacket(packet));
+            return WireData::DECODE_CALLBACK_RESULT::Continue;
+        });
+
+    REQUIRE(responses.size() == 2);
+
+    for(const auto& loaded : responses){
+
+        REQUIRE(loaded);
+        REQUIRE(loaded->GetType() == NETWORK_RESPONSE_TYPE::ServerStatus);
+        CHECK(static_cast<ResponseServerStatus*>(loaded.get())->ServerNameString ==
+            "my server");
+        CHECK(static_cast<ResponseServerStatus*>(loaded.get())->MaxPlayers == 8);
+    }
+}
+
+//! Creates a packet with an ack field and keepalive messages
+static sf::Packet CreateDecodeTestPacket(uint32_t packetid, int messagecount){
+
+    NetworkAckField::PacketReceiveStatus received;
+
+    for(uint32_t i = 1; i < 30; i += 2)
+        received[i] = RECEIVED_STATE::StateReceived;
+
+    NetworkAckField acks(1, 32, received);
+
+    sf::Packet messages;
+    std::vector<uint32_t> messageNumbers;
+
+    for(int i = 0; i < messagecount; ++i){
+
+        WireData::FormatResponseMessage(ResponseNone(NETWORK_RESPONSE_TYPE::Keepalive),
+            packetid * 10 + i, messages);
+        messageNumbers.push_back(packetid * 10 + i);
+    }
+
+    sf::Packet packet;
+    WireData::FormatMultiMessagePacket(packetid, messageNumbers, &acks, messages, packet);
+    return packet;
+}
+
+TEST_CASE("Decoding packet headers doesn't allocate", "[networking]"){
+
+    // The copies need to be made before counting //
+    std::vector<sf::Packet> packets(10, CreateDecodeTestPacket(5, 1));
+
+    sf::Packet ackPacket;
+    WireData::FormatAckOnlyPacket({1, 2, 3, 4, 5, 6, 7, 8}, ackPacket);
+    std::vector<sf::Packet> ackPackets(10, ackPacket);
+
+    uint32_t ackSum = 0;
+    int messages = 0;
+    uint32_t packetNumber = 0;
+
+    // Makes the vectors big enough //
+    DecodedPacket decoded;
+    Connection::DecodePacket(ackPackets.back(), decoded);
+    ackPackets.pop_back();
+
+    size_t allocations;
+
+    {
+        AllocationCounter counter;
+
+        for(auto& packet : packets){
+
+            WireData::DecodeIncomingData(packet,
+                [&](NetworkAckField& acks) -> WireData::DECODE_CALLBACK_RESULT
+                {
+                    acks.InvokeForEachAck([&](uint32_t id){ ackSum += id; });
+                    return WireData::DECODE_CALLBACK_RESULT::Continue;
+                },
+                nullptr,
+                [&](uint32_t packetnumber) -> WireData::DECODE_CALLBACK_RESULT
+                {
+                    packetNumber = packetnumber;
+                    return WireData::DECODE_CALLBACK_RESULT::Continue;
+                },
+                [&](uint8_t messagetype, uint32_t messagenumber, sf::Packet &packet)
+                -> WireData::DECODE_CALLBACK_RESULT
+                {
+                    ++messages;
+                    return WireData::DECODE_CALLBACK_RESULT::Continue;
+                });
+        }
+
+        for(auto& packet : ackPackets)
+            Connection::DecodePacket(packet, decoded);
+
+        allocations = counter.GetCount();
+    }
+
+    CHECK(allocations == 0);
+
+    CHECK(packetNumber == 5);
+    CHECK(messages == 10);
+    // Odd numbers from 1 to 29 in each packet
+    CHECK(ackSum == 225 * 10);
+    CHECK(decoded.SingleAcks.size() == 8);
+}
+
+TEST_CASE("Packet decoding speed", "[networking][benchmark][.slow]"){
+
+    constexpr auto PACKET_COUNT = 100000;
+    constexpr auto MESSAGES_PER_PACKET = 4;
+
+    std::vector<sf::Packet> packets;
+    packets.reserve(PACKET_COUNT);
 
+    for(uint32_t i = 1; i <= PACKET_COUNT; ++i)
+        packets.push_back(CreateDecodeTestPacket(i, MESSAGES_PER_PACKET));
+
+    sf::Packet ackPacket;
+    WireData::FormatAckOnlyPacket({1, 2, 3, 4, 5, 6, 7, 8}, ackPacket);
+    std::vector<sf::Packet> ackPackets(PACKET_COUNT, ackPacket);
+
+    DecodedPacket decoded;
+    size_t decodedMessages = 0;
+
+    size_t normalAllocations;
+    auto start = Time::GetTimeMicro64();
+
+    {
+        AllocationCounter counter;
+
+        for(auto& packet : packets){
+
+            Connection::DecodePacket(packet, decoded);
+            decodedMessages += decoded.Messages.size();
+        }
+
+        normalAllocations = counter.GetCount();
+    }
+
+    auto elapsed = Time::GetTimeMicro64() - start;
+
+    CHECK(decodedMessages == PACKET_COUNT * MESSAGES_PER_PACKET);
+
+    WARN("Packets with " << MESSAGES_PER_PACKET << " messages: " <<
+        (PACKET_COUNT * 1000000.0 / std::max<int64_t>(elapsed, 1)) <<
+        " packets per second, " <<
+        (static_cast<double>(normalAllocations) / PACKET_COUNT) << " allocations per packet");
+
+    // Only the messages themselves should need memory //
+    CHECK(normalAllocations <= static_cast<size_t>(PACKET_COUNT * MESSAGES_PER_PACKET) + 8);
+
+    // Makes SingleAcks big enough //
+    Connection::DecodePacket(ackPackets.back(), decoded);
+    ackPackets.pop_back();
+
+    size_t ackAllocations;
+    start = Time::GetTimeMicro64();
+
+    {
+        AllocationCounter counter;
+
+        for(auto& packet : ackPackets)
+            Connection::DecodePacket(packet, decoded);
+
+        ackAllocations = counter.GetCount();
+    }
+
+    elapsed = Time::GetTimeMicro64() - start;
+
+    WARN("Ack only packets: " <<
+        (ackPackets.size() * 1000000.0 / std::max<int64_t>(elapsed, 1)) <<
+        " packets per second, " <<
+        (static_cast<double>(ackAllocations) / ackPackets.size()) << " allocations per packet");
+
+    CHECK(ackAllocations == 0);
+}
@@ -1,3 +1,4 @@
+#include "Networking/BatchedUdpSocket.h"
 #include "Networking/Connection.h"
 #include "Networking/NetworkResponse.h"
 #include "Networking/NetworkRequest.h"
@@ -8,6 +9,9 @@
 
 #include "catch.hpp"
 
+#include <chrono>
+#include <thread>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -78,6 +82,8 @@ TEST_CASE_METHOD(ClientConnectionTestFixture, "Client sends JoinServer message w
 
     REQUIRE(ClientInterface.JoinServer(ClientConnection));
 
+    ClientConnection->FlushPendingMessages();
+
     // Read the message
     sf::Packet packet;
     REQUIRE(ReadPacket(packet));
@@ -133,6 +139,132 @@ TEST_CASE_METHOD(ConnectionTestFixture, "Connect to localhost socket", "[network
 
 }
 
+TEST_CASE_METHOD(ConnectionTestFixture, "Connections are found by address", "[networking]"){
+
+    CHECK(Client.OpenConnectionTo(sf::IpAddress::LocalHost, Server.GetOurPort()) ==
+        ClientConnection);
+    CHECK(Server.OpenConnectionTo(sf::IpAddress::LocalHost, Client.GetOurPort()) ==
+        ServerConnection);
+
+    VerifyEstablishConnection();
+}
+
+TEST_CASE_METHOD(ConnectionTestFixture, "Connect with packets decoded on other threads",
+    "[networking]")
+{
+    Client.SetPacketDecodeThreads(2);
+    Server.SetPacketDecodeThreads(3);
+
+    // The decoded packets are handled on a later update //
+    for(int i = 0; i < 200; ++i){
+
+        RunListeningLoop(1);
+
+        if(ClientConnection->GetState() == CONNECTION_STATE::Authenticated &&
+            ServerConnection->GetState() == CONNECTION_STATE::Authenticated)
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    CHECK(ClientConnection->GetState() == CONNECTION_STATE::Authenticated);
+    CHECK(ServerConnection->GetState() == CONNECTION_STATE::Authenticated);
+}
+
+TEST_CASE_METHOD(ConnectionTestFixture, "Connections agree on message compression",
+    "[networking]")
+{
+    SECTION("Both sides allow compression")
+    {
+        Client.SetAllowMessageCompression(true);
+        Server.SetAllowMessageCompression(true);
+
+        VerifyEstablishConnection();
+
+        CHECK(ClientConnection->IsCompressingMessages());
+        CHECK(ServerConnection->IsCompressingMessages());
+
+        CHECK(ServerConnection->SendPacketToConnection(
+            std::make_shared<ResponseSyncResourceData>(0, std::string(2000, 'a')),
+            RECEIVE_GUARANTEE::Critical));
+
+        RunListeningLoop();
+
+        const auto& stats = ServerConnection->GetCompressionStats();
+        CHECK(stats.CompressedMessages == 1);
+        CHECK(stats.UncompressedBytes > 2000);
+        CHECK(stats.GetCompressionRatio() > 10.f);
+    }
+
+    SECTION("Only the client allows compression")
+    {
+        Client.SetAllowMessageCompression(true);
+
+        VerifyEstablishConnection();
+
+        CHECK(!ClientConnection->IsCompressingMessages());
+        CHECK(!ServerConnection->IsCompressingMessages());
+        CHECK(ServerConnection->GetCompressionStats().CompressedMessages == 0);
+    }
+}
+
+TEST_CASE("BatchedUdpSocket receives multiple datagrams at once", "[networking]"){
+
+    BatchedUdpSocket receiver;
+    receiver.setBlocking(false);
+    REQUIRE(receiver.bind(sf::Socket::AnyPort) == sf::Socket::Done);
+
+    sf::UdpSocket sender;
+    REQUIRE(sender.bind(sf::Socket::AnyPort) == sf::Socket::Done);
+
+    std::vector<BatchedUdpSocket::ReceivedDatagram> received(NETWORK_RECEIVE_BATCH_SIZE);
+    size_t count = 0;
+
+    CHECK(receiver.ReceiveBatch(received, count) == sf::Socket::NotReady);
+    CHECK(count == 0);
+
+    constexpr int SENT_COUNT = NETWORK_RECEIVE_BATCH_SIZE * 2 + 3;
+
+    for(int32_t i = 0; i < SENT_COUNT; ++i){
+
+        sf::Packet packet;
+        packet << i << std::string(i * 10, 'a');
+
+        REQUIRE(sender.send(packet, sf::IpAddress::LocalHost, receiver.getLocalPort()) ==
+            sf::Socket::Done);
+    }
+
+    int32_t expected = 0;
+    int batches = 0;
+
+    while(receiver.ReceiveBatch(received, count) == sf::Socket::Done){
+
+        ++batches;
+        REQUIRE(count > 0);
+        REQUIRE(count <= received.size());
+
+        for(size_t i = 0; i < count; ++i){
+
+            CHECK(received[i].Sender == sf::IpAddress::LocalHost);
+            CHECK(received[i].SenderPort == sender.getLocalPort());
+
+            int32_t number = -1;
+            std::string text;
+            received[i].Data >> number >> text;
+
+            REQUIRE(received[i].Data);
+            CHECK(number == expected);
+            CHECK(text.size() == static_cast<size_t>(expected * 10));
+            ++expected;
+        }
+    }
+
+    CHECK(expected == SENT_COUNT);
+    CHECK(batches >= 3);
+}
+
 // TEST_CASE_METHOD(ConnectionTestFixture, "No infinite acks", "[networking]"){
 
 //     RunListeningLoop(6);
@@ -6,11 +6,18 @@
 #include "Newton/NewtonManager.h"
 #include "Newton/PhysicalWorld.h"
 #include "Newton/PhysicsMaterialManager.h"
+#include "Events/CallableObject.h"
+#include "Events/EventHandler.h"
+#include "Threading/ThreadingManager.h"
 
 #include "../PartialEngine.h"
 
 #include "catch.hpp"
 
+#include <chrono>
+#include <map>
+#include <thread>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -115,6 +122,349 @@ TEST_CASE("Physics spheres fall down", "[physics][entity]")
     world.Release();
 }
 
+//! Ticks its worlds like Engine::Tick does without the rest of the engine tick
+class WorldTickingEngine : public PartialEngine<false> {
+public:
+    WorldTickingEngine(ThreadingManager* manager)
+    {
+        _ThreadingManager = manager;
+    }
+
+    ~WorldTickingEngine()
+    {
+        _ThreadingManager = nullptr;
+        GameWorlds.clear();
+    }
+
+    bool TickWorlds(int tick)
+    {
+        TickCount = tick;
+
+        Lock lock(GameWorldsLock);
+        return _TickWorlds();
+    }
+
+    void SetWorlds(const std::vector<std::shared_ptr<GameWorld>>& worlds)
+    {
+        GameWorlds = worlds;
+    }
+
+    void SetNoGui(bool nogui)
+    {
+        NoGui = nogui;
+    }
+
+    const std::vector<GameWorld*>& GetWorldTickOrder() const
+    {
+        return WorldTickOrder;
+    }
+};
+
+TEST_CASE("Engine ticks physics worlds in parallel", "[physics][entity][threading]")
+{
+    ThreadingManager manager;
+    REQUIRE(manager.Init());
+
+    WorldTickingEngine engine(&manager);
+
+    NewtonManager newtonInstance;
+
+    PhysicsMaterialManager physMan(&newtonInstance);
+
+    constexpr auto WORLD_COUNT = 4;
+
+    std::vector<std::shared_ptr<GameWorld>> worlds;
+    std::vector<Position*> positions;
+
+    for(int i = 0; i < WORLD_COUNT; ++i) {
+
+        auto world = std::make_shared<StandardWorld>();
+        worlds.push_back(world);
+
+        REQUIRE(world->Init(NETWORKED_TYPE::Client, nullptr, nullptr));
+
+        // Half of the worlds simulate physics while their systems run
+        world->SetOverlapPhysicsUpdate(i % 2 == 0);
+
+        PhysicalWorld* physWorld = world->GetPhysicalWorld();
+        REQUIRE(physWorld);
+
+        // Later worlds have more bodies so that their ticks take longer //
+        for(int body = 0; body < 1 + i * 50; ++body) {
+
+            auto object = world->CreateEntity();
+
+            auto& pos = world->Create_Position(
+                object, Float3(body * 3.f, 10, 0), Float4::IdentityQuaternion());
+            auto& physics = world->Create_Physics(object, world.get(), pos, nullptr);
+            physics.SetCollision(physWorld->CreateSphere(1));
+            physics.CreatePhysicsBody(physWorld);
+            physics.SetMass(10);
+
+            if(body == 0)
+                positions.push_back(&pos);
+        }
+    }
+
+    engine.SetWorlds(worlds);
+
+    SECTION("Enabled with the command line")
+    {
+        char name[] = "test";
+        char flag[] = "--parallelworlds";
+        char* args[] = {name, flag};
+
+        REQUIRE(engine.PassCommandLine(2, args));
+        CHECK(engine.IsTickingWorldsInParallel());
+
+        CHECK(engine.TickWorlds(1));
+    }
+
+    SECTION("Slowest worlds are started first")
+    {
+        engine.SetTickWorldsInParallel(true);
+
+        for(int tick = 1; tick <= 2; ++tick)
+            CHECK(engine.TickWorlds(tick));
+
+        std::map<GameWorld*, int64_t> previous;
+
+        for(const auto& world : worlds)
+            previous[world.get()] = world->GetTickStatistics().LastTickMicroseconds;
+
+        CHECK(engine.TickWorlds(3));
+
+        const auto& order = engine.GetWorldTickOrder();
+        REQUIRE(order.size() == WORLD_COUNT);
+
+        for(size_t i = 1; i < order.size(); ++i)
+            CHECK(previous[order[i - 1]] >= previous[order[i]]);
+
+        for(int i = 0; i < WORLD_COUNT; ++i) {
+
+            CHECK(worlds[i]->GetTickNumber() == 3);
+            CHECK(positions[i]->Members._Position.Y < 9.9f);
+            CHECK(worlds[i]->GetTickStatistics().LastTickMicroseconds > 0);
+            CHECK(worlds[i]->GetTickStatistics().MaxTickMicroseconds >=
+                  worlds[i]->GetTickStatistics().LastTickMicroseconds);
+        }
+    }
+
+    SECTION("Worlds are ticked on the calling thread in GUI mode")
+    {
+        engine.SetTickWorldsInParallel(true);
+        engine.SetNoGui(false);
+
+        CHECK(!engine.TickWorlds(1));
+        CHECK(engine.GetWorldTickOrder().empty());
+
+        for(const auto& world : worlds)
+            CHECK(world->GetTickNumber() == 1);
+    }
+
+    SECTION("A single world is ticked on the calling thread")
+    {
+        engine.SetTickWorldsInParallel(true);
+        engine.SetWorlds({worlds.front()});
+
+        CHECK(!engine.TickWorlds(1));
+        CHECK(engine.GetWorldTickOrder().empty());
+        CHECK(worlds.front()->GetTickNumber() == 1);
+    }
+
+    SECTION("Disabled by default")
+    {
+        CHECK(!engine.IsTickingWorldsInParallel());
+        CHECK(!engine.TickWorlds(1));
+    }
+
+    for(auto& world : worlds)
+        world->Release();
+
+    engine.SetWorlds({});
+    manager.Release();
+}
+
+//! Records where physics updates are simulated and can make them fail
+class PhysicsBeginListener : public CallableObject {
+public:
+    int OnEvent(Event* event) override
+    {
+        SimulationThread = std::this_thread::get_id();
+        ++Calls;
+
+        if(Fail)
+            throw std::runtime_error("simulation failed");
+
+        return 0;
+    }
+
+    int OnGenericEvent(GenericEvent* event) override
+    {
+        return 0;
+    }
+
+    std::thread::id SimulationThread;
+    std::atomic<int> Calls = {0};
+    bool Fail = false;
+};
+
+TEST_CASE("Background physics is simulated by the waiter if no worker started it",
+    "[physics][threading]")
+{
+    PartialEngine<false> engine;
+
+    ThreadingManager manager;
+    REQUIRE(manager.Init());
+
+    NewtonManager newtonInstance;
+
+    PhysicsMaterialManager physMan(&newtonInstance);
+
+    PhysicsBeginListener listener;
+    REQUIRE(engine.GetEventHandler()->RegisterForEvent(&listener, EVENT_TYPE_PHYSICS_BEGIN));
+
+    {
+        PhysicalWorld phys(nullptr);
+
+        // Keep all the workers busy so that the simulation task can't start //
+        std::atomic<bool> release = {false};
+        std::atomic<size_t> blocked = {0};
+
+        for(size_t i = 0; i < manager.GetWorkerCount(); ++i) {
+
+            manager.QueueTask(std::make_shared<QueuedTask>([&]() {
+                ++blocked;
+
+                while(!release)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }));
+        }
+
+        while(blocked < manager.GetWorkerCount())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        phys.BeginSimulateWorldFixed(10, 2);
+
+        CHECK(phys.IsSimulationStarted());
+        CHECK(listener.Calls == 0);
+
+        phys.WaitForSimulation();
+
+        CHECK(!phys.IsSimulationStarted());
+        CHECK(listener.Calls == 2);
+        CHECK(listener.SimulationThread == std::this_thread::get_id());
+
+        // The queued task must not simulate again once it gets to run //
+        release = true;
+        manager.WaitForAllTasksToFinish();
+
+        CHECK(listener.Calls == 2);
+    }
+
+    engine.GetEventHandler()->Unregister(&listener, EVENT_TYPE_ALL, true);
+    manager.Release();
+}
+
+TEST_CASE("Background physics exceptions are thrown from WaitForSimulation",
+    "[physics][threading]")
+{
+    PartialEngine<false> engine;
+
+    ThreadingManager manager;
+    REQUIRE(manager.Init());
+
+    NewtonManager newtonInstance;
+
+    PhysicsMaterialManager physMan(&newtonInstance);
+
+    PhysicsBeginListener listener;
+    listener.Fail = true;
+    REQUIRE(engine.GetEventHandler()->RegisterForEvent(&listener, EVENT_TYPE_PHYSICS_BEGIN));
+
+    {
+        PhysicalWorld phys(nullptr);
+
+        SECTION("Waiting rethrows")
+        {
+            phys.BeginSimulateWorldFixed(10, 1);
+
+            CHECK_THROWS_AS(phys.WaitForSimulation(), std::runtime_error);
+
+            CHECK(!phys.IsSimulationStarted());
+            CHECK_NOTHROW(phys.WaitForSimulation());
+        }
+
+        SECTION("Destroying the world doesn't throw")
+        {
+            phys.BeginSimulateWorldFixed(10, 1);
+        }
+    }
+
+    CHECK(listener.Calls == 1);
+
+    engine.GetEventHandler()->Unregister(&listener, EVENT_TYPE_ALL, true);
+    manager.Release();
+}
+
+TEST_CASE("Background physics is simulated immediately without workers", "[physics]")
+{
+    PartialEngine<false> engine;
+
+    REQUIRE(!ThreadingManager::Get());
+
+    NewtonManager newtonInstance;
+
+    PhysicsMaterialManager physMan(&newtonInstance);
+
+    PhysicsBeginListener listener;
+    REQUIRE(engine.GetEventHandler()->RegisterForEvent(&listener, EVENT_TYPE_PHYSICS_BEGIN));
+
+    {
+        PhysicalWorld phys(nullptr);
+
+        phys.BeginSimulateWorldFixed(10, 3);
+
+        CHECK(!phys.IsSimulationStarted());
+        CHECK(listener.Calls == 3);
+        CHECK(listener.SimulationThread == std::this_thread::get_id());
+
+        // Nothing to wait for //
+        phys.WaitForSimulation();
+        CHECK(listener.Calls == 3);
+    }
+
+    engine.GetEventHandler()->Unregister(&listener, EVENT_TYPE_ALL, true);
+}
+
+TEST_CASE("Physics worlds use the thread count set in NewtonManager", "[physics][threading]")
+{
+    ThreadingManager manager;
+    REQUIRE(manager.Init());
+
+    NewtonManager newtonInstance;
+
+    PhysicsMaterialManager physMan(&newtonInstance);
+
+    // Single threaded by default //
+    CHECK(newtonInstance.GetPhysicsThreadCount() == 1);
+    CHECK(newtonInstance.CreateWorld(nullptr)->GetThreadCount() == 1);
+
+    newtonInstance.SetPhysicsThreadCount(2);
+    CHECK(newtonInstance.CreateWorld(nullptr)->GetThreadCount() == 2);
+
+    // 0 matches the workers //
+    newtonInstance.SetPhysicsThreadCount(0);
+    CHECK(newtonInstance.GetPhysicsThreadCount() ==
+          static_cast<int>(manager.GetWorkerCount()));
+
+    const auto threads = newtonInstance.CreateWorld(nullptr)->GetThreadCount();
+    CHECK(threads >= 1);
+    CHECK(threads <= newtonInstance.GetPhysicsThreadCount());
+
+    manager.Release();
+}
+
 std::atomic<int> TestHit = 0;
 
 int TestAABBCallback(const NewtonMaterial* material, const NewtonBody* body0,
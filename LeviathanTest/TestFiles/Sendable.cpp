@@ -5,11 +5,14 @@
 #include "Entities/Components.h"
 #include "Common/SFMLPackets.h"
 #include "Entities/CommonStateObjects.h"
+#include "Entities/InterestManager.h"
 #include "Networking/NetworkResponse.h"
 
 
 #include "catch.hpp"
 
+#include <algorithm>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -36,3 +39,208 @@ TEST_CASE("GameWorld properly loads and applies state packets", "[networking][en
 
     
 }
+
+// The manager only uses connections as keys //
+static const Connection* const FIRST_VIEWER = reinterpret_cast<const Connection*>(0x10);
+static const Connection* const SECOND_VIEWER = reinterpret_cast<const Connection*>(0x20);
+
+TEST_CASE("InterestManager finds nearby entities from the grid", "[entity][networking]"){
+
+    InterestManager interest;
+
+    interest.UpdateEntity(1, Float3(0, 0, 0));
+    interest.UpdateEntity(2, Float3(10, 5, -10));
+    interest.UpdateEntity(3, Float3(500, 0, 0));
+
+    std::vector<ObjectID> found;
+    interest.GetEntitiesInRadius(Float3(0, 0, 0), 100, found);
+
+    std::sort(found.begin(), found.end());
+    CHECK(found == std::vector<ObjectID>{1, 2});
+
+    // Moving to a different cell //
+    interest.UpdateEntity(3, Float3(-50, 0, 20));
+    interest.UpdateEntity(2, Float3(300, 0, 0));
+
+    found.clear();
+    interest.GetEntitiesInRadius(Float3(0, 0, 0), 100, found);
+
+    std::sort(found.begin(), found.end());
+    CHECK(found == std::vector<ObjectID>{1, 3});
+
+    interest.RemoveEntity(1);
+
+    found.clear();
+    interest.GetEntitiesInRadius(Float3(0, 0, 0), 100, found);
+
+    CHECK(found == std::vector<ObjectID>{3});
+    CHECK(interest.GetEntityCount() == 2);
+}
+
+TEST_CASE("InterestManager relevance has hysteresis", "[entity][networking]"){
+
+    InterestManager interest;
+    const auto& settings = interest.GetSettings();
+
+    // Without a viewer everything is sent //
+    interest.UpdateEntity(1, Float3(settings.LeaveRadius * 10, 0, 0));
+    interest.UpdateRelevance();
+
+    CHECK(interest.IsRelevant(FIRST_VIEWER, 1));
+    CHECK(interest.GetRelevantCount(FIRST_VIEWER) == -1);
+
+    interest.SetViewer(FIRST_VIEWER, Float3(0, 0, 0));
+    interest.UpdateRelevance();
+
+    CHECK(!interest.IsRelevant(FIRST_VIEWER, 1));
+
+    const float between = (settings.EnterRadius + settings.LeaveRadius) / 2;
+
+    // Not relevant before getting within the enter radius //
+    interest.UpdateEntity(1, Float3(between, 0, 0));
+    interest.UpdateRelevance();
+    CHECK(!interest.IsRelevant(FIRST_VIEWER, 1));
+
+    interest.UpdateEntity(1, Float3(settings.EnterRadius - 1, 0, 0));
+    interest.UpdateRelevance();
+    CHECK(interest.IsRelevant(FIRST_VIEWER, 1));
+
+    // And stays relevant until past the leave radius //
+    interest.UpdateEntity(1, Float3(between, 0, 0));
+    interest.UpdateRelevance();
+    CHECK(interest.IsRelevant(FIRST_VIEWER, 1));
+
+    interest.UpdateEntity(1, Float3(settings.LeaveRadius + 1, 0, 0));
+    interest.UpdateRelevance();
+    CHECK(!interest.IsRelevant(FIRST_VIEWER, 1));
+
+    interest.RemoveViewer(FIRST_VIEWER);
+    CHECK(interest.IsRelevant(FIRST_VIEWER, 1));
+}
+
+TEST_CASE("InterestManager reports entities moving into and out of range",
+    "[entity][networking]"){
+
+    InterestManager interest;
+    const auto& settings = interest.GetSettings();
+
+    std::vector<InterestManager::RelevanceChange> changes;
+
+    // Created out of range //
+    interest.SetViewer(FIRST_VIEWER, Float3(0, 0, 0));
+    interest.UpdateEntity(1, Float3(settings.LeaveRadius * 2, 0, 0));
+    interest.UpdateRelevance(&changes);
+
+    CHECK(changes.empty());
+
+    // Moving into range needs to create the entity on the client //
+    interest.UpdateEntity(1, Float3(settings.EnterRadius - 1, 0, 0));
+    interest.UpdateRelevance(&changes);
+
+    REQUIRE(changes.size() == 1);
+    CHECK(changes[0].ViewerConnection == FIRST_VIEWER);
+    CHECK(changes[0].Entity == 1);
+    CHECK(changes[0].Entered);
+
+    // Nothing new while staying in range //
+    changes.clear();
+    interest.UpdateRelevance(&changes);
+    CHECK(changes.empty());
+
+    // And leaving it needs to destroy it //
+    interest.UpdateEntity(1, Float3(settings.LeaveRadius + 1, 0, 0));
+    interest.UpdateRelevance(&changes);
+
+    REQUIRE(changes.size() == 1);
+    CHECK(changes[0].ViewerConnection == FIRST_VIEWER);
+    CHECK(changes[0].Entity == 1);
+    CHECK(!changes[0].Entered);
+}
+
+TEST_CASE("InterestManager removes far entities when a player gets a position",
+    "[entity][networking]"){
+
+    InterestManager interest;
+    const auto& settings = interest.GetSettings();
+
+    std::vector<InterestManager::RelevanceChange> changes;
+
+    interest.UpdateEntity(1, Float3(settings.EnterRadius - 1, 0, 0));
+    interest.UpdateEntity(2, Float3(settings.LeaveRadius * 2, 0, 0));
+    interest.UpdateEntity(3, Float3(settings.LeaveRadius - 1, 0, 0));
+
+    // Without a position everything has been received, 4 has no position //
+    const std::vector<ObjectID> received = {1, 2, 3, 4};
+
+    interest.SetViewer(FIRST_VIEWER, Float3(0, 0, 0), &received);
+    interest.UpdateRelevance(&changes);
+
+    // Only the far one needs to be destroyed, the others are already on the client //
+    REQUIRE(changes.size() == 1);
+    CHECK(changes[0].ViewerConnection == FIRST_VIEWER);
+    CHECK(changes[0].Entity == 2);
+    CHECK(!changes[0].Entered);
+
+    CHECK(interest.IsRelevant(FIRST_VIEWER, 1));
+    CHECK(!interest.IsRelevant(FIRST_VIEWER, 2));
+    CHECK(interest.IsRelevant(FIRST_VIEWER, 3));
+
+    // Moving an existing viewer doesn't reset what it has //
+    changes.clear();
+    interest.SetViewer(FIRST_VIEWER, Float3(1, 0, 0), &received);
+    interest.UpdateRelevance(&changes);
+
+    CHECK(changes.empty());
+}
+
+TEST_CASE("InterestManager sends far entities less often", "[entity][networking]"){
+
+    InterestManager interest;
+    const auto& settings = interest.GetSettings();
+
+    interest.SetViewer(FIRST_VIEWER, Float3(0, 0, 0));
+
+    interest.UpdateEntity(1, Float3(settings.FullRateRadius / 2, 0, 0));
+    interest.UpdateEntity(2, Float3(settings.EnterRadius - 1, 0, 0));
+    interest.UpdateRelevance();
+
+    int nearUpdates = 0;
+    int farUpdates = 0;
+
+    for(int tick = 0; tick < 100; ++tick){
+
+        nearUpdates += interest.ShouldSendUpdate(FIRST_VIEWER, 1, tick) ? 1 : 0;
+        farUpdates += interest.ShouldSendUpdate(FIRST_VIEWER, 2, tick) ? 1 : 0;
+    }
+
+    CHECK(nearUpdates == 100);
+    CHECK(farUpdates == 100 / settings.MaxUpdateInterval);
+}
+
+TEST_CASE("InterestManager viewer cost depends on nearby entities", "[entity][networking]"){
+
+    InterestManager interest;
+
+    // A large world with entities every 50 units //
+    ObjectID id = 1;
+
+    for(int x = 0; x < 200; ++x){
+        for(int z = 0; z < 200; ++z){
+
+            interest.UpdateEntity(id++, Float3(x * 50.f, 0, z * 50.f));
+        }
+    }
+
+    interest.SetViewer(FIRST_VIEWER, Float3(0, 0, 0));
+    interest.SetViewer(SECOND_VIEWER, Float3(5000, 0, 5000));
+    interest.UpdateRelevance();
+
+    const auto corner = interest.GetRelevantCount(FIRST_VIEWER);
+    const auto middle = interest.GetRelevantCount(SECOND_VIEWER);
+
+    // The viewer in the corner only has a quarter of the area around it //
+    CHECK(corner > 0);
+    CHECK(middle > corner * 2);
+    CHECK(middle < 100);
+    CHECK(interest.GetEntityCount() == 40000);
+}
@@ -4,6 +4,8 @@
 
 #include "catch.hpp"
 
+#include <random>
+
 using namespace Leviathan;
 using namespace Leviathan::Test;
 
@@ -646,3 +648,93 @@ TEST_CASE("StringIterator new line handling", "[string]") {
     }
 }
 
+
+//! Same as UTF8PointerDataIterator but makes StringIterator look at every character
+class NoBulkSkipDataIterator : public UTF8PointerDataIterator {
+public:
+    NoBulkSkipDataIterator(const std::string& str) : UTF8PointerDataIterator(str) {}
+
+    bool GetRemainingBytes(const char*& current, const char*& end) const override
+    {
+        return false;
+    }
+};
+
+TEST_CASE("StringIterator bulk skipping gives the same results", "[string]")
+{
+    const std::vector<std::string> pieces = {" ", "  ", "\t", "\n", "\r\n", "\v", "a", "name",
+        "value", "\"", "'", "\\", "/", "//", "/*", "*/", "*", ";", "=", ":", "<", ">", "{",
+        "}", "[", "]", "1.5", "-", "_", "\xc3\xa4", "\xe2\x80\xa8",
+        "a long run of plain characters that is longer than one vector "};
+
+    std::mt19937 random(12);
+
+    for(int i = 0; i < 2000; ++i) {
+
+        std::string text;
+        const auto piececount = random() % 120;
+
+        for(size_t piece = 0; piece < piececount; ++piece)
+            text += pieces[random() % pieces.size()];
+
+        StringIterator fast(std::make_unique<UTF8PointerDataIterator>(text));
+        StringIterator slow(std::make_unique<NoBulkSkipDataIterator>(text));
+
+        for(int operation = 0; operation < 50 && !slow.IsOutOfBounds(); ++operation) {
+
+            const int flags = (random() % 2 ? SPECIAL_ITERATOR_ONNEWLINE_STOP : 0) |
+                              (random() % 2 ? SPECIAL_ITERATOR_HANDLECOMMENTS_ASSTRING : 0);
+
+            std::unique_ptr<std::string> fastresult;
+            std::unique_ptr<std::string> slowresult;
+
+            switch(random() % 7) {
+            case 0:
+                fast.SkipWhiteSpace(flags);
+                slow.SkipWhiteSpace(flags);
+                break;
+            case 1:
+                fastresult = fast.GetUntilNextCharacterOrAll<std::string>(';', flags);
+                slowresult = slow.GetUntilNextCharacterOrAll<std::string>(';', flags);
+                break;
+            case 2:
+                fastresult = fast.GetUntilNextCharacterOrNothing<std::string>('>', flags);
+                slowresult = slow.GetUntilNextCharacterOrNothing<std::string>('>', flags);
+                break;
+            case 3:
+                fastresult = fast.GetStringInQuotes<std::string>(QUOTETYPE_BOTH, flags);
+                slowresult = slow.GetStringInQuotes<std::string>(QUOTETYPE_BOTH, flags);
+                break;
+            case 4:
+                fastresult = fast.GetUntilLineEnd<std::string>();
+                slowresult = slow.GetUntilLineEnd<std::string>();
+                break;
+            case 5:
+                fastresult = fast.GetNextCharacterSequence<std::string>(
+                    UNNORMALCHARACTER_TYPE_LOWCODES, flags);
+                slowresult = slow.GetNextCharacterSequence<std::string>(
+                    UNNORMALCHARACTER_TYPE_LOWCODES, flags);
+                break;
+            case 6:
+                fast.MoveToNext();
+                slow.MoveToNext();
+                break;
+            }
+
+            INFO("text: " << text);
+            REQUIRE((fastresult == nullptr) == (slowresult == nullptr));
+
+            if(fastresult)
+                CHECK(*fastresult == *slowresult);
+
+            REQUIRE(fast.IsOutOfBounds() == slow.IsOutOfBounds());
+
+            if(!slow.IsOutOfBounds())
+                REQUIRE(fast.GetPosition() == slow.GetPosition());
+
+            REQUIRE(fast.GetCurrentLine() == slow.GetCurrentLine());
+            REQUIRE(fast.IsInsideString() == slow.IsInsideString());
+            REQUIRE(fast.IsInsideComment() == slow.IsInsideComment());
+        }
+    }
+}
@@ -1,8 +1,13 @@
+#include "Threading/TaskGroup.h"
+#include "Threading/TaskTimerWheel.h"
+#include "Threading/MPSCQueue.h"
 #include "Threading/ThreadingManager.h"
+#include "Threading/WorkStealingDeque.h"
 #include "TimeIncludes.h"
 
 #include <future>
 #include <chrono>
+#include <thread>
 
 #include "catch.hpp"
 
@@ -98,3 +103,361 @@ TEST_CASE("Tasks run", "[task][threading]"){
 
     manager.Release();
 }
+
+TEST_CASE("WorkStealingDeque owner is LIFO and thieves FIFO", "[task][threading]"){
+
+    WorkStealingDeque<int> deque(2);
+
+    int value = 0;
+
+    CHECK(!deque.Pop(value));
+    CHECK(!deque.Steal(value));
+
+    // Grows past the initial capacity //
+    for(int i = 0; i < 10; ++i)
+        deque.Push(i);
+
+    REQUIRE(deque.Steal(value));
+    CHECK(value == 0);
+
+    REQUIRE(deque.Pop(value));
+    CHECK(value == 9);
+
+    int count = 0;
+
+    while(deque.Pop(value))
+        ++count;
+
+    CHECK(count == 8);
+    CHECK(deque.IsEmpty());
+}
+
+TEST_CASE("WorkStealingDeque items are taken exactly once", "[task][threading]"){
+
+    constexpr int ITEMS = 100000;
+
+    WorkStealingDeque<int> deque;
+    std::vector<std::atomic<int>> taken(ITEMS);
+    std::atomic<bool> done = {false};
+
+    std::vector<std::thread> thieves;
+
+    for(int i = 0; i < 3; ++i){
+
+        thieves.emplace_back([&](){
+                int value;
+
+                while(!done || !deque.IsEmpty()){
+
+                    if(deque.Steal(value))
+                        ++taken[value];
+                }
+            });
+    }
+
+    int value;
+
+    for(int i = 0; i < ITEMS; ++i){
+
+        deque.Push(i);
+
+        if(i % 3 == 0 && deque.Pop(value))
+            ++taken[value];
+    }
+
+    while(deque.Pop(value))
+        ++taken[value];
+
+    done = true;
+
+    for(auto& thread : thieves)
+        thread.join();
+
+    for(int i = 0; i < ITEMS; ++i)
+        CHECK(taken[i] == 1);
+}
+
+TEST_CASE("MPSCQueue keeps the order of each producer", "[task][threading]"){
+
+    constexpr int PRODUCERS = 4;
+    constexpr int ITEMS = 50000;
+
+    MPSCQueue<std::pair<int, int>> queue;
+
+    std::pair<int, int> item;
+    CHECK(!queue.Pop(item));
+    CHECK(queue.IsEmpty());
+
+    std::vector<std::thread> producers;
+
+    for(int i = 0; i < PRODUCERS; ++i){
+
+        producers.emplace_back([&queue, i](){
+
+                for(int number = 0; number < ITEMS; ++number)
+                    queue.Push(i, number);
+            });
+    }
+
+    std::vector<int> lastNumbers(PRODUCERS, -1);
+    int received = 0;
+    bool inOrder = true;
+
+    while(received < PRODUCERS * ITEMS){
+
+        if(!queue.Pop(item))
+            continue;
+
+        if(item.second != lastNumbers[item.first] + 1)
+            inOrder = false;
+
+        lastNumbers[item.first] = item.second;
+        ++received;
+    }
+
+    for(auto& thread : producers)
+        thread.join();
+
+    CHECK(inOrder);
+    CHECK(!queue.Pop(item));
+    CHECK(queue.IsEmpty());
+}
+
+TEST_CASE("TaskTimerWheel expires tasks on time", "[task][threading]"){
+
+    const auto start = Time::GetThreadSafeSteadyTimePoint();
+
+    TaskTimerWheel wheel(MicrosecondDuration(1000), 8, start);
+
+    auto first = std::make_shared<QueuedTask>([](){});
+    auto second = std::make_shared<QueuedTask>([](){});
+    // More than a revolution away //
+    auto far = std::make_shared<QueuedTask>([](){});
+
+    wheel.Add(first, start + MicrosecondDuration(2500));
+    wheel.Add(second, start + MicrosecondDuration(5000));
+    wheel.Add(far, start + MicrosecondDuration(20000));
+
+    CHECK(wheel.GetTaskCount() == 3);
+
+    WantedClockType::time_point wake;
+    REQUIRE(wheel.GetNextWakeTime(wake));
+    CHECK(wake == start + MicrosecondDuration(3000));
+
+    std::vector<std::shared_ptr<QueuedTask>> expired;
+
+    wheel.Advance(start + MicrosecondDuration(2900), expired);
+    CHECK(expired.empty());
+
+    wheel.Advance(start + MicrosecondDuration(3000), expired);
+    REQUIRE(expired.size() == 1);
+    CHECK(expired[0] == first);
+    expired.clear();
+
+    CHECK(wheel.Remove(second.get()));
+    CHECK(!wheel.Remove(second.get()));
+
+    wheel.Advance(start + MicrosecondDuration(12000), expired);
+    CHECK(expired.empty());
+
+    REQUIRE(wheel.GetNextWakeTime(wake));
+    CHECK(wake == start + MicrosecondDuration(20000));
+
+    wheel.Advance(start + MicrosecondDuration(25000), expired);
+    REQUIRE(expired.size() == 1);
+    CHECK(expired[0] == far);
+
+    CHECK(wheel.GetTaskCount() == 0);
+    CHECK(!wheel.GetNextWakeTime(wake));
+}
+
+TEST_CASE("Delayed tasks don't wait for a polling interval", "[task][threading]"){
+
+    ThreadingManager manager;
+
+    REQUIRE(manager.Init());
+
+    const auto start = Time::GetThreadSafeSteadyTimePoint();
+    std::atomic<int64_t> ranAfter = {0};
+
+    manager.QueueTask(new DelayedTask([&](){
+                ranAfter = std::chrono::duration_cast<MicrosecondDuration>(
+                    Time::GetThreadSafeSteadyTimePoint() - start).count();
+            }, MillisecondDuration(20)));
+
+    manager.WaitForAllTasksToFinish();
+
+    CHECK(ranAfter >= 20000);
+    // The old queuer thread could take up to 100 milliseconds more //
+    CHECK(ranAfter < 60000);
+
+    manager.Release();
+}
+
+TEST_CASE("Removed tasks don't run", "[task][threading]"){
+
+    ThreadingManager manager;
+
+    REQUIRE(manager.Init());
+
+    std::atomic<int> delayedRuns = {0};
+
+    auto delayed = std::make_shared<DelayedTask>([&](){ ++delayedRuns; },
+        MillisecondDuration(200));
+
+    manager.QueueTask(delayed);
+    CHECK(manager.RemoveFromQueue(delayed));
+
+    std::atomic<int> repeatRuns = {0};
+
+    auto repeating = std::make_shared<RepeatingDelayedTask>([&](){ ++repeatRuns; },
+        MillisecondDuration(1));
+
+    manager.QueueTask(repeating);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    CHECK(manager.RemoveFromQueue(repeating));
+
+    // Returns as the removed tasks don't count //
+    manager.WaitForAllTasksToFinish();
+
+    const int repeatsAtRemove = repeatRuns;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    CHECK(delayedRuns == 0);
+    CHECK(repeatRuns == repeatsAtRemove);
+
+    manager.Release();
+}
+
+TEST_CASE("TaskGroup waits for nested tasks", "[task][threading]"){
+
+    ThreadingManager manager;
+
+    REQUIRE(manager.Init());
+
+    std::atomic<int> count = {0};
+
+    {
+        TaskGroup group(&manager);
+
+        for(int i = 0; i < 100; ++i){
+
+            group.Run([&](){
+                    ++count;
+
+                    // Waiting inside a task helps instead of deadlocking //
+                    TaskGroup inner(&manager);
+                    inner.Run([&](){ ++count; });
+                    inner.Wait();
+                });
+        }
+
+        group.Wait();
+
+        CHECK(group.IsDone());
+        CHECK(count == 200);
+    }
+
+    TaskGroup failing(&manager);
+    failing.Run([](){ throw std::runtime_error("task failed"); });
+
+    CHECK_THROWS_AS(failing.Wait(), std::runtime_error);
+
+    manager.Release();
+}
+
+TEST_CASE("TaskGroup waits don't block when waiters outnumber workers", "[task][threading]"){
+
+    ThreadingManager manager;
+
+    REQUIRE(manager.Init());
+
+    const auto workers = manager.GetWorkerCount();
+    REQUIRE(workers > 0);
+
+    std::atomic<size_t> started = {0};
+    std::atomic<bool> release = {false};
+    std::atomic<int> count = {0};
+
+    TaskGroup outer(&manager);
+
+    // One waiting task for each worker and more from the main thread //
+    for(size_t i = 0; i < workers * 2; ++i){
+
+        outer.Run([&](){
+                ++started;
+
+                while(!release)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+                TaskGroup inner(&manager);
+
+                for(int j = 0; j < 3; ++j){
+                    inner.Run([&](){
+
+                            TaskGroup innermost(&manager);
+                            innermost.Run([&](){ ++count; });
+                            innermost.Wait();
+                        });
+                }
+
+                inner.Wait();
+            });
+    }
+
+    while(started < workers)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // The waits start while no task can be started so they don't find anything //
+    manager.SetAllowStartTasks(false);
+    release = true;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    manager.SetAllowStartTasks(true);
+
+    // The main thread doesn't help before the workers are done with their groups //
+    const auto start = std::chrono::steady_clock::now();
+
+    while(count < static_cast<int>(workers * 3) &&
+        std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    CHECK(count >= static_cast<int>(workers * 3));
+
+    outer.Wait();
+
+    CHECK(count == static_cast<int>(workers * 2 * 3));
+
+    manager.Release();
+}
+
+TEST_CASE("ThreadingManager ParallelFor covers the range once", "[task][threading]"){
+
+    ThreadingManager manager;
+
+    REQUIRE(manager.Init());
+
+    std::vector<std::atomic<int>> hits(10000);
+
+    manager.ParallelFor(0, hits.size(), 64, [&](size_t begin, size_t end){
+
+            for(size_t i = begin; i < end; ++i)
+                ++hits[i];
+        });
+
+    for(const auto& hit : hits)
+        CHECK(hit == 1);
+
+    CHECK_THROWS_AS(manager.ParallelFor(0, 100, 1, [](size_t begin, size_t){
+                if(begin == 50)
+                    throw std::runtime_error("chunk failed");
+            }), std::runtime_error);
+
+    manager.Release();
+}